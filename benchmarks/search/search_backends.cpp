@@ -0,0 +1,468 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/point_types.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/kdtree/kdtree_flann.h>
+#include <pcl/search/brute_force.h>
+#include <pcl/search/flann_search.h>
+#include <pcl/search/impl/flann_search.hpp>
+#include <pcl/search/kdtree.h>
+#include <pcl/search/octree.h>
+#include <pcl/search/organized.h>
+
+#include <benchmark/benchmark.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Benchmarks the search backends on the point clouds given on the command line and on synthetic organized clouds of
+// increasing size. For every backend and cloud, three benchmarks are registered:
+//   build/<backend>/<cloud>   building the search structure, with the heap memory it holds ("memory")
+//   knn/<backend>/<cloud>     k nearest neighbor queries, with the recall against an exhaustive search ("recall")
+//   radius/<backend>/<cloud>  radius queries, with the recall against an exhaustive search ("recall")
+// KdTreeFLANN searches dense clouds in place, without FLANN's reordering copy. KdTreeFLANNCopied builds the same tree
+// on a reordered copy of the points, as KdTreeFLANN always did before: knn/KdTreeFLANN and radius/KdTreeFLANN should
+// not be slower than their KdTreeFLANNCopied counterparts.
+// The usual Google Benchmark options apply, e.g. --benchmark_filter=knn/.*/synthetic
+
+namespace
+{
+  typedef pcl::PointXYZ PointT;
+  typedef pcl::PointCloud<PointT> Cloud;
+
+  /** \brief Number of query points drawn from every cloud. */
+  const int nr_queries = 1000;
+
+  /** \brief Number of neighbors of the k nearest neighbor queries. */
+  const int nr_neighbors = 10;
+
+  /** \brief Sizes of the synthetic organized clouds. */
+  const int synthetic_sizes[][2] = { {160, 120}, {320, 240}, {640, 480}, {1280, 960} };
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief A point cloud to benchmark on, with its queries and their exact neighbors.
+    *
+    * The radius of the radius queries is twice the median distance of the k-th nearest neighbor of the queries, and
+    * the resolution of the octree is set to that radius. The exact neighbors are found by search::BruteForce, on first
+    * use, so that filtered out clouds cost nothing.
+    */
+  class Dataset
+  {
+    public:
+      Dataset (const std::string &name, const Cloud::ConstPtr &cloud)
+        : name (name), cloud (cloud), radius (0.0), computed_ (false)
+      {
+        std::vector<int> valid;
+        for (std::size_t i = 0; i < cloud->size (); ++i)
+          if (pcl::isFinite ((*cloud)[i]))
+            valid.push_back (static_cast<int> (i));
+        const std::size_t step = std::max<std::size_t> (valid.size () / nr_queries, 1);
+        for (std::size_t i = 0; i < valid.size () && queries.size () < static_cast<std::size_t> (nr_queries); i += step)
+          queries.push_back (valid[i]);
+      }
+
+      /** \brief Compute the radius and the exact neighbors of the queries, if not done yet. */
+      void
+      computeGroundTruth ()
+      {
+        if (computed_)
+          return;
+        computed_ = true;
+
+        pcl::search::BruteForce<PointT> search (true);
+        search.setInputCloud (cloud);
+
+        knn_truth.resize (queries.size ());
+        std::vector<float> kth_distances;
+        std::vector<float> distances;
+        for (std::size_t i = 0; i < queries.size (); ++i)
+        {
+          search.nearestKSearch (*cloud, queries[i], nr_neighbors, knn_truth[i], distances);
+          kth_distances.push_back (distances.back ());
+          knn_truth_max.push_back (distances.back ());
+        }
+        std::nth_element (kth_distances.begin (), kth_distances.begin () + kth_distances.size () / 2,
+                          kth_distances.end ());
+        radius = 2.0 * std::sqrt (kth_distances[kth_distances.size () / 2]);
+
+        radius_truth.resize (queries.size ());
+        for (std::size_t i = 0; i < queries.size (); ++i)
+        {
+          search.radiusSearch (*cloud, queries[i], radius, radius_truth[i], distances);
+          std::sort (radius_truth[i].begin (), radius_truth[i].end ());
+        }
+      }
+
+      /** \brief Name of the cloud in the benchmark names. */
+      std::string name;
+      /** \brief The cloud to search in. */
+      Cloud::ConstPtr cloud;
+      /** \brief The indices of the query points. */
+      std::vector<int> queries;
+      /** \brief The search radius of the radius queries. */
+      double radius;
+      /** \brief The exact k nearest neighbors of every query. */
+      std::vector<std::vector<int> > knn_truth;
+      /** \brief The squared distance of the k-th nearest neighbor of every query. */
+      std::vector<float> knn_truth_max;
+      /** \brief The exact neighbors within the radius of every query, sorted by index. */
+      std::vector<std::vector<int> > radius_truth;
+
+    private:
+      bool computed_;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Common interface of pcl::KdTree and pcl::search::Search based backends. */
+  class Backend
+  {
+    public:
+      virtual ~Backend () {}
+
+      /** \brief Build the search structure, return false if the backend can not search in this cloud. */
+      virtual bool
+      build (const Cloud::ConstPtr &cloud) = 0;
+
+      virtual int
+      nearestKSearch (const Cloud &cloud, int index, int k,
+                      std::vector<int> &indices, std::vector<float> &sqr_distances) const = 0;
+
+      virtual int
+      radiusSearch (const Cloud &cloud, int index, double radius,
+                    std::vector<int> &indices, std::vector<float> &sqr_distances) const = 0;
+  };
+
+  template <typename SearchT> bool
+  isValid (const SearchT &)
+  {
+    return (true);
+  }
+
+  bool
+  isValid (const pcl::search::OrganizedNeighbor<PointT> &search)
+  {
+    return (search.getInputCloud ()->isOrganized () && search.isValid ());
+  }
+
+  template <typename SearchT>
+  class SearchBackend : public Backend
+  {
+    public:
+      explicit SearchBackend (SearchT *search) : search_ (search) {}
+
+      bool
+      build (const Cloud::ConstPtr &cloud) override
+      {
+        search_->setInputCloud (cloud);
+        return (isValid (*search_));
+      }
+
+      int
+      nearestKSearch (const Cloud &cloud, int index, int k,
+                      std::vector<int> &indices, std::vector<float> &sqr_distances) const override
+      {
+        return (search_->nearestKSearch (cloud, index, k, indices, sqr_distances));
+      }
+
+      int
+      radiusSearch (const Cloud &cloud, int index, double radius,
+                    std::vector<int> &indices, std::vector<float> &sqr_distances) const override
+      {
+        return (search_->radiusSearch (cloud, index, radius, indices, sqr_distances));
+      }
+
+    protected:
+      boost::shared_ptr<SearchT> search_;
+  };
+
+  /** \brief A backend built with the indices of all the points of the cloud. This keeps KdTreeFLANN from searching
+    * the cloud in place: it searches a copy of the points reordered by FLANN instead, as it always did before.
+    */
+  template <typename SearchT>
+  class IndexedSearchBackend : public SearchBackend<SearchT>
+  {
+    public:
+      explicit IndexedSearchBackend (SearchT *search) : SearchBackend<SearchT> (search) {}
+
+      bool
+      build (const Cloud::ConstPtr &cloud) override
+      {
+        boost::shared_ptr<std::vector<int> > indices (new std::vector<int> (cloud->size ()));
+        for (std::size_t i = 0; i < indices->size (); ++i)
+          (*indices)[i] = static_cast<int> (i);
+        this->search_->setInputCloud (cloud, indices);
+        return (isValid (*this->search_));
+      }
+  };
+
+  template <typename SearchT> Backend*
+  makeBackend (SearchT *search)
+  {
+    return (new SearchBackend<SearchT> (search));
+  }
+
+  typedef Backend* (*BackendFactory) (const Dataset &dataset);
+
+  /** \brief The benchmarked backends, created with their default parameters. */
+  const struct
+  {
+    const char *name;
+    BackendFactory create;
+  } backends[] = {
+    { "KdTreeFLANN", [] (const Dataset &) { return (makeBackend (new pcl::KdTreeFLANN<PointT> ())); } },
+    { "KdTreeFLANNCopied", [] (const Dataset &) -> Backend*
+      { return (new IndexedSearchBackend<pcl::KdTreeFLANN<PointT> > (new pcl::KdTreeFLANN<PointT> ())); } },
+    { "KdTree", [] (const Dataset &) { return (makeBackend (new pcl::search::KdTree<PointT> ())); } },
+    { "FlannSearch", [] (const Dataset &) { return (makeBackend (new pcl::search::FlannSearch<PointT> ())); } },
+    { "Octree", [] (const Dataset &dataset)
+      { return (makeBackend (new pcl::search::Octree<PointT> (dataset.radius))); } },
+    { "OrganizedNeighbor", [] (const Dataset &)
+      { return (makeBackend (new pcl::search::OrganizedNeighbor<PointT> ())); } },
+    { "BruteForce", [] (const Dataset &) { return (makeBackend (new pcl::search::BruteForce<PointT> ())); } },
+    { "BruteForceTiled", [] (const Dataset &)
+      {
+        pcl::search::BruteForce<PointT> *search = new pcl::search::BruteForce<PointT> ();
+        search->setTiledSearch (true);
+        return (makeBackend (search));
+      } },
+  };
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Bytes currently allocated on the heap, or 0 if this is not known on this platform. */
+  std::size_t
+  getHeapUsage ()
+  {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2 ();
+    return (info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+    const struct mallinfo info = mallinfo ();
+    return (static_cast<unsigned int> (info.uordblks) + static_cast<unsigned int> (info.hblkhd));
+#else
+    return (0);
+#endif
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Create the backend and build it on the dataset, or mark the benchmark as skipped. */
+  std::unique_ptr<Backend>
+  prepareBackend (benchmark::State &state, Dataset &dataset, BackendFactory create)
+  {
+    dataset.computeGroundTruth ();
+    std::unique_ptr<Backend> backend (create (dataset));
+    if (!backend->build (dataset.cloud))
+    {
+      state.SkipWithError ("the backend can not search in this cloud");
+      backend.reset ();
+    }
+    return (backend);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  void
+  benchmarkBuild (benchmark::State &state, Dataset *dataset, BackendFactory create)
+  {
+    if (!prepareBackend (state, *dataset, create))
+      return;
+
+    std::size_t memory = 0;
+    for (auto _ : state)
+    {
+      state.PauseTiming ();
+      std::unique_ptr<Backend> backend (create (*dataset));
+      const std::size_t heap_usage = getHeapUsage ();
+      state.ResumeTiming ();
+
+      backend->build (dataset->cloud);
+
+      state.PauseTiming ();
+      const std::size_t new_heap_usage = getHeapUsage ();
+      memory = new_heap_usage > heap_usage ? new_heap_usage - heap_usage : 0;
+      backend.reset ();
+      state.ResumeTiming ();
+    }
+
+    state.SetItemsProcessed (state.iterations () * dataset->cloud->size ());
+    if (memory > 0)
+    {
+      state.counters["memory"] = benchmark::Counter (static_cast<double> (memory), benchmark::Counter::kDefaults,
+                                                     benchmark::Counter::kIs1024);
+      state.counters["bytes_per_point"] = static_cast<double> (memory) / static_cast<double> (dataset->cloud->size ());
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  void
+  benchmarkNearestK (benchmark::State &state, Dataset *dataset, BackendFactory create)
+  {
+    const std::unique_ptr<Backend> backend = prepareBackend (state, *dataset, create);
+    if (!backend)
+      return;
+
+    std::vector<int> indices;
+    std::vector<float> sqr_distances;
+    for (auto _ : state)
+      for (const int query : dataset->queries)
+      {
+        backend->nearestKSearch (*dataset->cloud, query, nr_neighbors, indices, sqr_distances);
+        benchmark::DoNotOptimize (indices.data ());
+      }
+    state.SetItemsProcessed (state.iterations () * dataset->queries.size ());
+
+    // A neighbor is counted as found if it is not farther than the k-th exact neighbor, so that the recall does not
+    // depend on how ties are broken
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < dataset->queries.size (); ++i)
+    {
+      backend->nearestKSearch (*dataset->cloud, dataset->queries[i], nr_neighbors, indices, sqr_distances);
+      const float max_sqr_distance = dataset->knn_truth_max[i] * (1.0f + 1e-5f);
+      std::size_t nr_found = 0;
+      for (const float sqr_distance : sqr_distances)
+        if (sqr_distance <= max_sqr_distance)
+          ++nr_found;
+      found += std::min (nr_found, dataset->knn_truth[i].size ());
+    }
+    state.counters["recall"] = static_cast<double> (found) /
+                               static_cast<double> (dataset->queries.size () * nr_neighbors);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  void
+  benchmarkRadius (benchmark::State &state, Dataset *dataset, BackendFactory create)
+  {
+    const std::unique_ptr<Backend> backend = prepareBackend (state, *dataset, create);
+    if (!backend)
+      return;
+
+    std::vector<int> indices;
+    std::vector<float> sqr_distances;
+    std::size_t nr_neighbors_found = 0;
+    for (auto _ : state)
+      for (const int query : dataset->queries)
+        nr_neighbors_found += backend->radiusSearch (*dataset->cloud, query, dataset->radius, indices, sqr_distances);
+    state.SetItemsProcessed (state.iterations () * dataset->queries.size ());
+    state.counters["neighbors"] = static_cast<double> (nr_neighbors_found) /
+                                  static_cast<double> (state.iterations () * dataset->queries.size ());
+
+    std::size_t found = 0, expected = 0;
+    std::vector<int> common;
+    for (std::size_t i = 0; i < dataset->queries.size (); ++i)
+    {
+      backend->radiusSearch (*dataset->cloud, dataset->queries[i], dataset->radius, indices, sqr_distances);
+      std::sort (indices.begin (), indices.end ());
+      common.clear ();
+      std::set_intersection (indices.begin (), indices.end (),
+                             dataset->radius_truth[i].begin (), dataset->radius_truth[i].end (),
+                             std::back_inserter (common));
+      found += common.size ();
+      expected += dataset->radius_truth[i].size ();
+    }
+    state.counters["recall"] = expected > 0 ? static_cast<double> (found) / static_cast<double> (expected) : 1.0;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Organized cloud of a wavy surface seen by a pinhole camera, with the given resolution. */
+  Cloud::Ptr
+  makeSyntheticCloud (int width, int height)
+  {
+    Cloud::Ptr cloud (new Cloud (width, height));
+    const float focal_length = 0.8f * static_cast<float> (width);
+    const float center_x = 0.5f * static_cast<float> (width - 1);
+    const float center_y = 0.5f * static_cast<float> (height - 1);
+    for (int v = 0; v < height; ++v)
+      for (int u = 0; u < width; ++u)
+      {
+        const float x = (static_cast<float> (u) - center_x) / focal_length;
+        const float y = (static_cast<float> (v) - center_y) / focal_length;
+        const float depth = 2.0f + 0.25f * std::sin (8.0f * x) * std::cos (6.0f * y) + 0.5f * y;
+        (*cloud)(u, v) = PointT (x * depth, y * depth, depth);
+      }
+    return (cloud);
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  benchmark::Initialize (&argc, argv);
+
+  std::vector<boost::shared_ptr<Dataset> > datasets;
+  for (int i = 1; i < argc; ++i)
+  {
+    Cloud::Ptr cloud (new Cloud);
+    if (pcl::io::loadPCDFile (argv[i], *cloud) < 0)
+    {
+      std::cerr << "Failed to read test file " << argv[i] << std::endl;
+      return (-1);
+    }
+    datasets.push_back (boost::shared_ptr<Dataset> (
+          new Dataset (boost::filesystem::path (argv[i]).stem ().string (), cloud)));
+  }
+  for (const auto &size : synthetic_sizes)
+    datasets.push_back (boost::shared_ptr<Dataset> (
+          new Dataset ("synthetic_" + std::to_string (size[0]) + "x" + std::to_string (size[1]),
+                       makeSyntheticCloud (size[0], size[1]))));
+
+  for (const auto &dataset : datasets)
+    for (const auto &backend : backends)
+    {
+      const std::string suffix = std::string ("/") + backend.name + "/" + dataset->name;
+      benchmark::RegisterBenchmark (("build" + suffix).c_str (), benchmarkBuild, dataset.get (), backend.create)
+        ->Unit (benchmark::kMillisecond);
+      benchmark::RegisterBenchmark (("knn" + suffix).c_str (), benchmarkNearestK, dataset.get (), backend.create)
+        ->Unit (benchmark::kMillisecond);
+      benchmark::RegisterBenchmark (("radius" + suffix).c_str (), benchmarkRadius, dataset.get (), backend.create)
+        ->Unit (benchmark::kMillisecond);
+    }
+
+  benchmark::RunSpecifiedBenchmarks ();
+  benchmark::Shutdown ();
+  return (0);
+}
+/* ]--- */
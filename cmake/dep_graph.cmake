@@ -5,6 +5,7 @@ function(MAKE_DEP_GRAPH)
     file(WRITE ${_dot_file} "digraph pcl {\n")
     foreach(_ss ${PCL_SUBSYSTEMS})
       if(NOT _ss STREQUAL "global_tests" AND
+         NOT _ss STREQUAL "benchmarks" AND
          NOT _ss STREQUAL "apps" AND
          NOT _ss STREQUAL "tools" AND
          NOT _ss STREQUAL "test" AND
@@ -108,7 +108,7 @@ endmacro(PCL_MAKE_CPACK_INPUT)
 macro(PCL_CPACK_MAKE_COMPS_OPTS _var _current)
     set(_comps_list)
     set(PCL_CPACK_SUBSYSTEMS ${PCL_SUBSYSTEMS})
-    list(REMOVE_ITEM PCL_CPACK_SUBSYSTEMS global_tests examples)
+    list(REMOVE_ITEM PCL_CPACK_SUBSYSTEMS global_tests benchmarks examples)
     foreach(_ss ${PCL_CPACK_SUBSYSTEMS})
         PCL_GET_SUBSYS_STATUS(_status ${_ss})
         if(_status)
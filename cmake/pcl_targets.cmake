@@ -455,6 +455,31 @@ macro(PCL_ADD_TEST _name _exename)
     add_dependencies(tests ${_exename})
 endmacro(PCL_ADD_TEST)
 
+###############################################################################
+# Add a benchmark target.
+# _name The benchmark name, the executable is called benchmark_${_name}.
+# ARGN :
+#    FILES the source files for the benchmark
+#    ARGUMENTS Arguments for the benchmark executable when run by the run_benchmarks target
+#    LINK_WITH link benchmark executable with libraries
+macro(PCL_ADD_BENCHMARK _name)
+    set(options)
+    set(oneValueArgs)
+    set(multiValueArgs FILES ARGUMENTS LINK_WITH)
+    cmake_parse_arguments(PCL_ADD_BENCHMARK "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
+    add_executable(benchmark_${_name} ${PCL_ADD_BENCHMARK_FILES})
+    if(NOT WIN32)
+      set_target_properties(benchmark_${_name} PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR})
+    endif(NOT WIN32)
+    target_link_libraries(benchmark_${_name} benchmark::benchmark ${PCL_ADD_BENCHMARK_LINK_WITH} ${Boost_LIBRARIES})
+    if(USE_PROJECT_FOLDERS)
+      set_target_properties(benchmark_${_name} PROPERTIES FOLDER "Benchmarks")
+    endif(USE_PROJECT_FOLDERS)
+
+    add_custom_target(run_benchmark_${_name} benchmark_${_name} ${PCL_ADD_BENCHMARK_ARGUMENTS} VERBATIM)
+    add_dependencies(run_benchmarks run_benchmark_${_name})
+endmacro(PCL_ADD_BENCHMARK)
+
 ###############################################################################
 # Add an example target.
 # _name The example name.
@@ -40,6 +40,7 @@
 #define PCL_POINT_CLOUD_ITERATOR_H_
 
 #include <pcl/point_cloud.h>
+#include <pcl/point_cloud_view.h>
 #include <pcl/PointIndices.h>
 #include <pcl/correspondence.h>
 
@@ -129,6 +130,10 @@ namespace pcl
 
       ConstCloudIterator (const PointCloud<PointT>& cloud, const Correspondences& corrs, bool source);
 
+      ConstCloudIterator (const PointCloudView<PointT>& cloud);
+
+      ConstCloudIterator (const PointCloudView<PointT>& cloud, const std::vector<int>& indices);
+
       ~ConstCloudIterator ();
 
       void operator ++ ();
@@ -183,6 +188,7 @@ namespace pcl
 
       class DefaultConstIterator;
       class ConstIteratorIdx;
+      class ViewConstIterator;
       Iterator* iterator_;
   };
 
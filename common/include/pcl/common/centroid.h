@@ -40,6 +40,7 @@
 #define PCL_COMMON_CENTROID_H_
 
 #include <pcl/point_cloud.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/point_traits.h>
 #include <pcl/PointIndices.h>
 #include <pcl/cloud_iterator.h>
@@ -105,6 +106,18 @@ namespace pcl
     return (compute3DCentroid <PointT, double> (cloud, centroid));
   }
 
+  /** \brief Compute the 3D (X-Y-Z) centroid of a structure of arrays point cloud.
+    * \param[in] cloud the input point cloud
+    * \param[out] centroid the output centroid
+    * \return number of valid point used to determine the centroid. In case of dense point clouds, this is the same as the size of input cloud.
+    * \note if return value is 0, the centroid is not changed, thus not valid.
+    * The last compononent of the vector is set to 1, this allow to transform the centroid vector with 4x4 matrices.
+    * \ingroup common
+    */
+  template <typename Scalar> inline unsigned int
+  compute3DCentroid (const pcl::PointCloudSoA &cloud,
+                     Eigen::Matrix<Scalar, 4, 1> &centroid);
+
   /** \brief Compute the 3D (X-Y-Z) centroid of a set of points using their indices and
     * return it as a 3D vector.
     * \param[in] cloud the input point cloud
@@ -493,6 +506,125 @@ namespace pcl
     return (computeMeanAndCovarianceMatrix<PointT, double> (cloud, indices, covariance_matrix, centroid));
   }
 
+  /** \brief Compute the normalized 3x3 covariance matrix and the centroid of a structure of arrays
+    * point cloud in a single loop.
+    * Normalized means that every entry has been divided by the number of valid points.
+    * \param[in] cloud the input point cloud
+    * \param[out] covariance_matrix the resultant 3x3 covariance matrix
+    * \param[out] centroid the centroid of the set of points in the cloud
+    * \return number of valid point used to determine the covariance matrix.
+    * In case of dense point clouds, this is the same as the size of input cloud.
+    * \ingroup common
+    */
+  template <typename Scalar> inline unsigned int
+  computeMeanAndCovarianceMatrix (const pcl::PointCloudSoA &cloud,
+                                  Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                                  Eigen::Matrix<Scalar, 4, 1> &centroid);
+
+  /** \brief Compute the 3D (X-Y-Z) centroid of a set of points with a parallel, numerically stable reduction.
+    * The points are split into fixed size blocks which are reduced independently in double precision
+    * relative to a local origin, and the partial results are merged pairwise. The result does not depend
+    * on the number of threads and stays accurate for clouds far away from the origin (e.g. UTM coordinates).
+    * \param[in] cloud the input point cloud
+    * \param[out] centroid the output centroid
+    * \param[in] nr_threads the number of threads to use (0 sets the value automatically)
+    * \return number of valid point used to determine the centroid. In case of dense point clouds, this is the same as the size of input cloud.
+    * \note if return value is 0, the centroid is not changed, thus not valid.
+    * The last component of the vector is set to 1, this allow to transform the centroid vector with 4x4 matrices.
+    * \ingroup common
+    */
+  template <typename PointT, typename Scalar> inline unsigned int
+  compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
+                     Eigen::Matrix<Scalar, 4, 1> &centroid,
+                     unsigned int nr_threads);
+
+  /** \brief Compute the 3D (X-Y-Z) centroid of a subset of points with a parallel, numerically stable reduction.
+    * \param[in] cloud the input point cloud
+    * \param[in] indices the point cloud indices that need to be used
+    * \param[out] centroid the output centroid
+    * \param[in] nr_threads the number of threads to use (0 sets the value automatically)
+    * \return number of valid point used to determine the centroid. In case of dense point clouds, this is the same as the size of input indices.
+    * \note if return value is 0, the centroid is not changed, thus not valid.
+    * \ingroup common
+    */
+  template <typename PointT, typename Scalar> inline unsigned int
+  compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
+                     const std::vector<int> &indices,
+                     Eigen::Matrix<Scalar, 4, 1> &centroid,
+                     unsigned int nr_threads);
+
+  /** \brief Compute the 3x3 covariance matrix of a given set of points about a given centroid with a
+    * parallel reduction in double precision. The result is \b not normalized, as for the serial version.
+    * \param[in] cloud the input point cloud
+    * \param[in] centroid the centroid of the set of points in the cloud
+    * \param[out] covariance_matrix the resultant 3x3 covariance matrix
+    * \param[in] nr_threads the number of threads to use (0 sets the value automatically)
+    * \return number of valid point used to determine the covariance matrix.
+    * In case of dense point clouds, this is the same as the size of input cloud.
+    * \ingroup common
+    */
+  template <typename PointT, typename Scalar> inline unsigned int
+  computeCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
+                           const Eigen::Matrix<Scalar, 4, 1> &centroid,
+                           Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                           unsigned int nr_threads);
+
+  /** \brief Compute the 3x3 covariance matrix of a subset of points about a given centroid with a
+    * parallel reduction in double precision. The result is \b not normalized, as for the serial version.
+    * \param[in] cloud the input point cloud
+    * \param[in] indices the point cloud indices that need to be used
+    * \param[in] centroid the centroid of the set of points in the cloud
+    * \param[out] covariance_matrix the resultant 3x3 covariance matrix
+    * \param[in] nr_threads the number of threads to use (0 sets the value automatically)
+    * \return number of valid point used to determine the covariance matrix.
+    * In case of dense point clouds, this is the same as the size of input indices.
+    * \ingroup common
+    */
+  template <typename PointT, typename Scalar> inline unsigned int
+  computeCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
+                           const std::vector<int> &indices,
+                           const Eigen::Matrix<Scalar, 4, 1> &centroid,
+                           Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                           unsigned int nr_threads);
+
+  /** \brief Compute the normalized 3x3 covariance matrix and the centroid of a given set of points in a single
+    * pass, using a parallel and numerically stable reduction.
+    * Every block of points is reduced to its mean and scatter matrix in double precision, and the partial
+    * results are combined pairwise (Chan et al.), so that no large sums of squares are ever subtracted.
+    * This avoids the cancellation of the serial version for points far away from the origin, and gives
+    * the same result for any number of threads.
+    * \param[in] cloud the input point cloud
+    * \param[out] covariance_matrix the resultant 3x3 covariance matrix
+    * \param[out] centroid the centroid of the set of points in the cloud
+    * \param[in] nr_threads the number of threads to use (0 sets the value automatically)
+    * \return number of valid point used to determine the covariance matrix.
+    * In case of dense point clouds, this is the same as the size of input cloud.
+    * \ingroup common
+    */
+  template <typename PointT, typename Scalar> inline unsigned int
+  computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
+                                  Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                                  Eigen::Matrix<Scalar, 4, 1> &centroid,
+                                  unsigned int nr_threads);
+
+  /** \brief Compute the normalized 3x3 covariance matrix and the centroid of a subset of points in a single
+    * pass, using a parallel and numerically stable reduction.
+    * \param[in] cloud the input point cloud
+    * \param[in] indices subset of points given by their indices
+    * \param[out] covariance_matrix the resultant 3x3 covariance matrix
+    * \param[out] centroid the centroid of the set of points in the cloud
+    * \param[in] nr_threads the number of threads to use (0 sets the value automatically)
+    * \return number of valid point used to determine the covariance matrix.
+    * In case of dense point clouds, this is the same as the size of input indices.
+    * \ingroup common
+    */
+  template <typename PointT, typename Scalar> inline unsigned int
+  computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
+                                  const std::vector<int> &indices,
+                                  Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                                  Eigen::Matrix<Scalar, 4, 1> &centroid,
+                                  unsigned int nr_threads);
+
   /** \brief Compute the normalized 3x3 covariance matrix for a already demeaned point cloud.
     * Normalized means that every entry has been divided by the number of entries in indices.
     * For small number of points, or if you want explicitely the sample-variance, scale the covariance matrix
@@ -135,6 +135,21 @@ namespace pcl
   template <typename Matrix, typename Vector> void
   eigen33 (const Matrix &mat, Matrix &evecs, Vector &evals);
 
+  /** \brief determines the smallest eigenvalue and the corresponding eigenvector of an array of symmetric positive
+    * semi definite 3x3 matrices. The matrices are solved in blocks of eight, one SIMD lane per matrix (e.g. eight
+    * float matrices per AVX register), which is considerably faster than calling eigen33 for each of them.
+    * \param[in] matrices pointer to the symmetric positive semi definite input matrices (only the upper triangle is used)
+    * \param[in] nr_matrices the number of input matrices
+    * \param[out] eigenvalues the smallest eigenvalue of each input matrix (nr_matrices entries)
+    * \param[out] eigenvectors the eigenvector corresponding to the smallest eigenvalue of each input matrix (nr_matrices entries)
+    * \note the results agree with eigen33 up to floating point accuracy. If the smallest eigenvalue is not unique,
+    * this function may return any eigenvector that is consistent to the eigenvalue.
+    * \ingroup common
+    */
+  template <typename Scalar> void
+  eigen33 (const Eigen::Matrix<Scalar, 3, 3> *matrices, size_t nr_matrices,
+           Scalar *eigenvalues, Eigen::Matrix<Scalar, 3, 1> *eigenvectors);
+
   /** \brief Calculate the inverse of a 2x2 matrix
     * \param[in] matrix matrix to be inverted
     * \param[out] inverse the resultant inverted matrix
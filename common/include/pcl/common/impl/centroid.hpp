@@ -43,6 +43,7 @@
 
 #include <pcl/common/centroid.h>
 #include <pcl/conversions.h>
+#include <pcl/common/parallel.h>
 #include <boost/mpl/size.hpp>
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -122,6 +123,49 @@ pcl::compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename Scalar> inline unsigned int
+pcl::compute3DCentroid (const pcl::PointCloudSoA &cloud,
+                        Eigen::Matrix<Scalar, 4, 1> &centroid)
+{
+  if (cloud.empty ())
+    return (0);
+
+  const float *x = &cloud.x[0], *y = &cloud.y[0], *z = &cloud.z[0];
+  const size_t n = cloud.size ();
+  Scalar sx = 0, sy = 0, sz = 0;
+  size_t cp = 0;
+  if (cloud.is_dense)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      sx += x[i];
+      sy += y[i];
+      sz += z[i];
+    }
+    cp = n;
+  }
+  else
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (!pcl_isfinite (x[i]) || !pcl_isfinite (y[i]) || !pcl_isfinite (z[i]))
+        continue;
+      sx += x[i];
+      sy += y[i];
+      sz += z[i];
+      ++cp;
+    }
+    if (cp == 0)
+      return (0);
+  }
+  centroid[0] = sx / static_cast<Scalar> (cp);
+  centroid[1] = sy / static_cast<Scalar> (cp);
+  centroid[2] = sz / static_cast<Scalar> (cp);
+  centroid[3] = 1;
+  return (static_cast<unsigned int> (cp));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Scalar> inline unsigned int
 pcl::compute3DCentroid (const pcl::PointCloud<PointT> &cloud, 
@@ -648,6 +692,294 @@ pcl::computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
   return (computeMeanAndCovarianceMatrix (cloud, indices.indices, covariance_matrix, centroid));
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename Scalar> inline unsigned int
+pcl::computeMeanAndCovarianceMatrix (const pcl::PointCloudSoA &cloud,
+                                     Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                                     Eigen::Matrix<Scalar, 4, 1> &centroid)
+{
+  if (cloud.empty ())
+    return (0);
+
+  const float *x = &cloud.x[0], *y = &cloud.y[0], *z = &cloud.z[0];
+  const size_t n = cloud.size ();
+  // Keep the accumulators in independent scalars so the loop can be vectorized
+  Scalar xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0, sx = 0, sy = 0, sz = 0;
+  size_t point_count = 0;
+  if (cloud.is_dense)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      const Scalar px = x[i], py = y[i], pz = z[i];
+      xx += px * px; xy += px * py; xz += px * pz;
+      yy += py * py; yz += py * pz; zz += pz * pz;
+      sx += px; sy += py; sz += pz;
+    }
+    point_count = n;
+  }
+  else
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (!pcl_isfinite (x[i]) || !pcl_isfinite (y[i]) || !pcl_isfinite (z[i]))
+        continue;
+      const Scalar px = x[i], py = y[i], pz = z[i];
+      xx += px * px; xy += px * py; xz += px * pz;
+      yy += py * py; yz += py * pz; zz += pz * pz;
+      sx += px; sy += py; sz += pz;
+      ++point_count;
+    }
+  }
+  if (point_count == 0)
+    return (0);
+
+  const Scalar norm = Scalar (1) / static_cast<Scalar> (point_count);
+  sx *= norm; sy *= norm; sz *= norm;
+  centroid[0] = sx; centroid[1] = sy; centroid[2] = sz;
+  centroid[3] = 1;
+  covariance_matrix.coeffRef (0) = xx * norm - sx * sx;
+  covariance_matrix.coeffRef (1) = xy * norm - sx * sy;
+  covariance_matrix.coeffRef (2) = xz * norm - sx * sz;
+  covariance_matrix.coeffRef (4) = yy * norm - sy * sy;
+  covariance_matrix.coeffRef (5) = yz * norm - sy * sz;
+  covariance_matrix.coeffRef (8) = zz * norm - sz * sz;
+  covariance_matrix.coeffRef (3) = covariance_matrix.coeff (1);
+  covariance_matrix.coeffRef (6) = covariance_matrix.coeff (2);
+  covariance_matrix.coeffRef (7) = covariance_matrix.coeff (5);
+  return (static_cast<unsigned int> (point_count));
+}
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Number of points reduced at once by the parallel centroid and covariance functions. The
+      * blocking is independent of the number of threads, which keeps the results reproducible.
+      */
+    const int centroid_block_size = 1024;
+
+    /** \brief Partial result of a parallel centroid / covariance reduction: the number of points, their
+      * mean and their scatter matrix (sum of the outer products of the deviations from the mean).
+      */
+    struct CentroidAccumulator
+    {
+      CentroidAccumulator () : count (0), mean (Eigen::Vector3d::Zero ()), scatter (Eigen::Matrix3d::Zero ()) {}
+
+      /** \brief Merge another partial result into this one, using the pairwise update of Chan et al. */
+      inline void
+      merge (const CentroidAccumulator &other)
+      {
+        if (other.count == 0)
+          return;
+        if (count == 0)
+        {
+          *this = other;
+          return;
+        }
+        const double w = static_cast<double> (other.count) / static_cast<double> (count + other.count);
+        const Eigen::Vector3d delta = other.mean - mean;
+        scatter += other.scatter + (delta * delta.transpose ()) * (static_cast<double> (count) * w);
+        mean += delta * w;
+        count += other.count;
+      }
+
+      size_t count;
+      Eigen::Vector3d mean;
+      Eigen::Matrix3d scatter;
+    };
+
+    /** \brief Reduce the points [begin, end) of a cloud (or of an index list, if \a indices is not NULL).
+      * The coordinates are gathered into double precision arrays relative to the first valid point of the
+      * block, so the sums are computed on small numbers and with Eigen's vectorized reductions.
+      */
+    template <typename PointT, bool with_scatter> void
+    reduceCentroidBlock (const pcl::PointCloud<PointT> &cloud, const int *indices,
+                         size_t begin, size_t end, CentroidAccumulator &acc)
+    {
+      double x[centroid_block_size], y[centroid_block_size], z[centroid_block_size];
+      int n = 0;
+      for (size_t i = begin; i < end; ++i)
+      {
+        const PointT &point = indices ? cloud.points[indices[i]] : cloud.points[i];
+        // Like the serial functions, skip the invalid points of a non-dense cloud (a single NaN coordinate
+        // would otherwise poison the whole block)
+        if (!cloud.is_dense && !isFinite (point))
+          continue;
+        x[n] = point.x;
+        y[n] = point.y;
+        z[n] = point.z;
+        ++n;
+      }
+      if (n == 0)
+        return;
+
+      const Eigen::Vector3d origin (x[0], y[0], z[0]);
+      Eigen::Map<Eigen::VectorXd> dx (x, n), dy (y, n), dz (z, n);
+      dx.array () -= origin[0];
+      dy.array () -= origin[1];
+      dz.array () -= origin[2];
+
+      const Eigen::Vector3d sum (dx.sum (), dy.sum (), dz.sum ());
+      const double inv_n = 1.0 / static_cast<double> (n);
+      acc.count = n;
+      acc.mean = origin + sum * inv_n;
+      if (with_scatter)
+      {
+        acc.scatter (0, 0) = dx.squaredNorm ();
+        acc.scatter (0, 1) = dx.dot (dy);
+        acc.scatter (0, 2) = dx.dot (dz);
+        acc.scatter (1, 1) = dy.squaredNorm ();
+        acc.scatter (1, 2) = dy.dot (dz);
+        acc.scatter (2, 2) = dz.squaredNorm ();
+        acc.scatter (1, 0) = acc.scatter (0, 1);
+        acc.scatter (2, 0) = acc.scatter (0, 2);
+        acc.scatter (2, 1) = acc.scatter (1, 2);
+        acc.scatter -= (sum * sum.transpose ()) * inv_n;
+      }
+    }
+
+    /** \brief Reduce a whole cloud (or the points given by \a indices) block by block in parallel and merge
+      * the partial results pairwise, in a fixed order.
+      * \return the number of valid points
+      */
+    template <typename PointT, bool with_scatter> unsigned int
+    reduceCentroid (const pcl::PointCloud<PointT> &cloud, const std::vector<int> *indices,
+                    unsigned int nr_threads, CentroidAccumulator &result)
+    {
+      const size_t nr_points = indices ? indices->size () : cloud.size ();
+      if (nr_points == 0)
+        return (0);
+      const int *idx = indices ? &(*indices)[0] : NULL;
+
+      const int nr_blocks = static_cast<int> ((nr_points + centroid_block_size - 1) / centroid_block_size);
+      std::vector<CentroidAccumulator> partial (nr_blocks);
+      const pcl::parallel::ThreadReservation reservation (nr_blocks > 1 ? nr_threads : 1u);
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ()) schedule(static) if (nr_blocks > 1)
+      for (int b = 0; b < nr_blocks; ++b)
+      {
+        const size_t begin = static_cast<size_t> (b) * centroid_block_size;
+        const size_t end = std::min (begin + centroid_block_size, nr_points);
+        reduceCentroidBlock<PointT, with_scatter> (cloud, idx, begin, end, partial[b]);
+      }
+
+      for (size_t stride = 1; stride < partial.size (); stride *= 2)
+        for (size_t i = 0; i + stride < partial.size (); i += 2 * stride)
+          partial[i].merge (partial[i + stride]);
+
+      result = partial[0];
+      return (static_cast<unsigned int> (result.count));
+    }
+
+    template <typename PointT, typename Scalar> inline unsigned int
+    compute3DCentroid (const pcl::PointCloud<PointT> &cloud, const std::vector<int> *indices,
+                       Eigen::Matrix<Scalar, 4, 1> &centroid, unsigned int nr_threads)
+    {
+      CentroidAccumulator acc;
+      const unsigned int point_count = reduceCentroid<PointT, false> (cloud, indices, nr_threads, acc);
+      if (point_count != 0)
+      {
+        centroid.template head<3> () = acc.mean.cast<Scalar> ();
+        centroid[3] = 1;
+      }
+      return (point_count);
+    }
+
+    template <typename PointT, typename Scalar> inline unsigned int
+    computeCovarianceMatrix (const pcl::PointCloud<PointT> &cloud, const std::vector<int> *indices,
+                             const Eigen::Matrix<Scalar, 4, 1> &centroid,
+                             Eigen::Matrix<Scalar, 3, 3> &covariance_matrix, unsigned int nr_threads)
+    {
+      if (indices ? indices->empty () : cloud.empty ())
+        return (0);
+
+      CentroidAccumulator acc;
+      const unsigned int point_count = reduceCentroid<PointT, true> (cloud, indices, nr_threads, acc);
+      // Move the scatter matrix from the mean of the points to the given centroid
+      const Eigen::Vector3d offset = acc.mean - centroid.template head<3> ().template cast<double> ();
+      acc.scatter += (offset * offset.transpose ()) * static_cast<double> (point_count);
+      covariance_matrix = acc.scatter.cast<Scalar> ();
+      return (point_count);
+    }
+
+    template <typename PointT, typename Scalar> inline unsigned int
+    computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud, const std::vector<int> *indices,
+                                    Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                                    Eigen::Matrix<Scalar, 4, 1> &centroid, unsigned int nr_threads)
+    {
+      CentroidAccumulator acc;
+      const unsigned int point_count = reduceCentroid<PointT, true> (cloud, indices, nr_threads, acc);
+      if (point_count != 0)
+      {
+        centroid.template head<3> () = acc.mean.cast<Scalar> ();
+        centroid[3] = 1;
+        covariance_matrix = (acc.scatter / static_cast<double> (point_count)).cast<Scalar> ();
+      }
+      return (point_count);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Scalar> inline unsigned int
+pcl::compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
+                        Eigen::Matrix<Scalar, 4, 1> &centroid,
+                        unsigned int nr_threads)
+{
+  return (detail::compute3DCentroid (cloud, NULL, centroid, nr_threads));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Scalar> inline unsigned int
+pcl::compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
+                        const std::vector<int> &indices,
+                        Eigen::Matrix<Scalar, 4, 1> &centroid,
+                        unsigned int nr_threads)
+{
+  return (detail::compute3DCentroid (cloud, &indices, centroid, nr_threads));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Scalar> inline unsigned int
+pcl::computeCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
+                              const Eigen::Matrix<Scalar, 4, 1> &centroid,
+                              Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                              unsigned int nr_threads)
+{
+  return (detail::computeCovarianceMatrix (cloud, NULL, centroid, covariance_matrix, nr_threads));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Scalar> inline unsigned int
+pcl::computeCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
+                              const std::vector<int> &indices,
+                              const Eigen::Matrix<Scalar, 4, 1> &centroid,
+                              Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                              unsigned int nr_threads)
+{
+  return (detail::computeCovarianceMatrix (cloud, &indices, centroid, covariance_matrix, nr_threads));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Scalar> inline unsigned int
+pcl::computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
+                                     Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                                     Eigen::Matrix<Scalar, 4, 1> &centroid,
+                                     unsigned int nr_threads)
+{
+  return (detail::computeMeanAndCovarianceMatrix (cloud, NULL, covariance_matrix, centroid, nr_threads));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Scalar> inline unsigned int
+pcl::computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
+                                     const std::vector<int> &indices,
+                                     Eigen::Matrix<Scalar, 3, 3> &covariance_matrix,
+                                     Eigen::Matrix<Scalar, 4, 1> &centroid,
+                                     unsigned int nr_threads)
+{
+  return (detail::computeMeanAndCovarianceMatrix (cloud, &indices, covariance_matrix, centroid, nr_threads));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Scalar> void
 pcl::demeanPointCloud (ConstCloudIterator<PointT> &cloud_iterator,
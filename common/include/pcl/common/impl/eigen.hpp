@@ -480,6 +480,152 @@ pcl::eigen33 (const Matrix& mat, Matrix& evecs, Vector& evals)
   evals *= scale;
 }
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Number of matrices solved together by the batched eigen33 (one AVX register of floats). */
+    const int eigen33_batch_width = 8;
+
+    /** \brief Lane-wise math functions used by the batched eigen33. The generic version relies on the standard
+      * library, the float version below uses polynomial approximations which vectorize.
+      */
+    template <typename Scalar>
+    struct Eigen33Lanes
+    {
+      typedef Eigen::Array<Scalar, eigen33_batch_width, 1> Lanes;
+
+      /** \brief atan2 (y, x) for y >= 0 */
+      static inline Lanes
+      atan2 (const Lanes &y, const Lanes &x)
+      {
+        Lanes result;
+        for (int l = 0; l < eigen33_batch_width; ++l)
+          result[l] = std::atan2 (y[l], x[l]);
+        return (result);
+      }
+
+      /** \brief cos (a) for a in [0, pi/3] */
+      static inline Lanes
+      cos (const Lanes &a) { return (a.cos ()); }
+
+      /** \brief sin (a) for a in [0, pi/3] */
+      static inline Lanes
+      sin (const Lanes &a) { return (a.sin ()); }
+    };
+
+    template <>
+    struct Eigen33Lanes<float>
+    {
+      typedef Eigen::Array<float, eigen33_batch_width, 1> Lanes;
+
+      static inline Lanes
+      atan2 (const Lanes &y, const Lanes &x)
+      {
+        // Reduce to atan (t) with t in [0, 1], then to [-tan(pi/8), tan(pi/8)] (Cephes atanf)
+        const Lanes ax = x.abs ();
+        const Lanes num = y.min (ax), den = y.max (ax);
+        Lanes t = (den > 0.0f).select (num / den, Lanes::Zero ());
+        const Eigen::Array<bool, eigen33_batch_width, 1> reduce = t > 0.4142135623730950f;
+        t = reduce.select ((t - 1.0f) / (t + 1.0f), t);
+        const Lanes z = t * t;
+        Lanes result = (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * t + t;
+        result = reduce.select (result + static_cast<float> (M_PI / 4), result);
+        result = (y > ax).select (static_cast<float> (M_PI / 2) - result, result);
+        return ((x < 0.0f).select (static_cast<float> (M_PI) - result, result));
+      }
+
+      static inline Lanes
+      cos (const Lanes &a)
+      {
+        const Lanes a2 = a * a;
+        return (((((-2.7557319e-7f * a2 + 2.4801587e-5f) * a2 - 1.3888889e-3f) * a2 + 4.1666667e-2f) * a2 - 0.5f) * a2 + 1.0f);
+      }
+
+      static inline Lanes
+      sin (const Lanes &a)
+      {
+        const Lanes a2 = a * a;
+        return (((((-2.5052108e-8f * a2 + 2.7557319e-6f) * a2 - 1.9841270e-4f) * a2 + 8.3333333e-3f) * a2 - 1.6666667e-1f) * a2 * a + a);
+      }
+    };
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename Scalar> void
+pcl::eigen33 (const Eigen::Matrix<Scalar, 3, 3> *matrices, size_t nr_matrices,
+              Scalar *eigenvalues, Eigen::Matrix<Scalar, 3, 1> *eigenvectors)
+{
+  typedef detail::Eigen33Lanes<Scalar> Math;
+  typedef typename Math::Lanes Lanes;
+  typedef Eigen::Array<bool, detail::eigen33_batch_width, 1> Mask;
+  const int width = detail::eigen33_batch_width;
+  const Scalar s_inv3 = Scalar (1.0 / 3.0);
+  const Scalar s_sqrt3 = std::sqrt (Scalar (3.0));
+
+  for (size_t offset = 0; offset < nr_matrices; offset += width)
+  {
+    const int nr_lanes = static_cast<int> (std::min<size_t> (width, nr_matrices - offset));
+
+    // One register per coefficient of the upper triangle. Unused lanes solve the identity.
+    Lanes m00 = Lanes::Ones (), m01 = Lanes::Zero (), m02 = Lanes::Zero ();
+    Lanes m11 = Lanes::Ones (), m12 = Lanes::Zero (), m22 = Lanes::Ones ();
+    for (int l = 0; l < nr_lanes; ++l)
+    {
+      const Eigen::Matrix<Scalar, 3, 3> &mat = matrices[offset + l];
+      m00[l] = mat.coeff (0, 0); m01[l] = mat.coeff (0, 1); m02[l] = mat.coeff (0, 2);
+      m11[l] = mat.coeff (1, 1); m12[l] = mat.coeff (1, 2); m22[l] = mat.coeff (2, 2);
+    }
+
+    // Scale the matrices so their entries are in [-1,1]
+    Lanes scale = m00.abs ().max (m01.abs ()).max (m02.abs ()).max (m11.abs ()).max (m12.abs ()).max (m22.abs ());
+    scale = (scale <= std::numeric_limits<Scalar>::min ()).select (Lanes::Ones (), scale);
+    m00 /= scale; m01 /= scale; m02 /= scale;
+    m11 /= scale; m12 /= scale; m22 /= scale;
+
+    // Smallest root of the characteristic equation, in closed form (see computeRoots)
+    const Lanes c0 = m00 * m11 * m22 + Scalar (2) * m01 * m02 * m12
+                   - m00 * m12 * m12 - m11 * m02 * m02 - m22 * m01 * m01;
+    const Lanes c1 = m00 * m11 - m01 * m01 + m00 * m22 - m02 * m02 + m11 * m22 - m12 * m12;
+    const Lanes c2 = m00 + m11 + m22;
+
+    const Lanes c2_over_3 = c2 * s_inv3;
+    const Lanes a_over_3 = ((c1 - c2 * c2_over_3) * s_inv3).min (Lanes::Zero ());
+    const Lanes half_b = Scalar (0.5) * (c0 + c2_over_3 * (Scalar (2) * c2_over_3 * c2_over_3 - c1));
+    const Lanes q = (half_b * half_b + a_over_3 * a_over_3 * a_over_3).min (Lanes::Zero ());
+    const Lanes rho = (-a_over_3).sqrt ();
+    // 0 - q instead of -q: atan2 (-0, x) is -pi for negative x
+    const Lanes theta = Math::atan2 ((Lanes::Zero () - q).sqrt (), half_b) * s_inv3;
+    Lanes lambda = c2_over_3 - rho * (Math::cos (theta) + s_sqrt3 * Math::sin (theta));
+    // If one root is 0 the matrix is singular, and the smallest eigenvalue of a positive semi definite matrix is 0
+    const Mask singular = (c0.abs () < Eigen::NumTraits<Scalar>::epsilon ()) || (lambda <= Scalar (0));
+    lambda = singular.select (Lanes::Zero (), lambda);
+
+    // The eigenvector is the longest cross product of two rows of (M - lambda I)
+    const Lanes d00 = m00 - lambda, d11 = m11 - lambda, d22 = m22 - lambda;
+    const Lanes v1x = m01 * m12 - m02 * d11, v1y = m02 * m01 - d00 * m12, v1z = d00 * d11 - m01 * m01;
+    const Lanes v2x = m01 * d22 - m02 * m12, v2y = m02 * m02 - d00 * d22, v2z = d00 * m12 - m01 * m02;
+    const Lanes v3x = d11 * d22 - m12 * m12, v3y = m12 * m02 - m01 * d22, v3z = m01 * m12 - d11 * m02;
+    const Lanes len1 = v1x * v1x + v1y * v1y + v1z * v1z;
+    const Lanes len2 = v2x * v2x + v2y * v2y + v2z * v2z;
+    const Lanes len3 = v3x * v3x + v3y * v3y + v3z * v3z;
+    const Mask use1 = (len1 >= len2) && (len1 >= len3);
+    const Mask use2 = len2 >= len3;
+    const Lanes norm = use1.select (len1, use2.select (len2, len3)).sqrt ().inverse ();
+    const Lanes vx = use1.select (v1x, use2.select (v2x, v3x)) * norm;
+    const Lanes vy = use1.select (v1y, use2.select (v2y, v3y)) * norm;
+    const Lanes vz = use1.select (v1z, use2.select (v2z, v3z)) * norm;
+    lambda *= scale;
+
+    for (int l = 0; l < nr_lanes; ++l)
+    {
+      eigenvalues[offset + l] = lambda[l];
+      eigenvectors[offset + l] << vx[l], vy[l], vz[l];
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 template <typename Matrix> inline typename Matrix::Scalar
 pcl::invert2x2 (const Matrix& matrix, Matrix& inverse)
@@ -0,0 +1,112 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_COMMON_IMPL_MORTON_H_
+#define PCL_COMMON_IMPL_MORTON_H_
+
+#include <pcl/common/morton.h>
+#include <pcl/common/parallel.h>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Spread the 21 lower bits of \a value so that two zero bits follow each of them. */
+    inline uint64_t
+    spreadBits3 (uint32_t value)
+    {
+      uint64_t x = value & 0x1fffff;
+      x = (x | x << 32) & 0x1f00000000ffffULL;
+      x = (x | x << 16) & 0x1f0000ff0000ffULL;
+      x = (x | x << 8)  & 0x100f00f00f00f00fULL;
+      x = (x | x << 4)  & 0x10c30c30c30c30c3ULL;
+      x = (x | x << 2)  & 0x1249249249249249ULL;
+      return (x);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+inline uint64_t
+pcl::encodeMorton3D (uint32_t x, uint32_t y, uint32_t z)
+{
+  return (detail::spreadBits3 (x) | detail::spreadBits3 (y) << 1 | detail::spreadBits3 (z) << 2);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::computeMortonOrder (const pcl::PointCloud<PointT> &cloud, std::vector<int> &order, unsigned int nr_threads)
+{
+  if (cloud.empty ())
+  {
+    order.clear ();
+    return;
+  }
+  // The xyz coordinates of the PCL point types are consecutive floats
+  computeMortonOrder (&cloud.points[0].x, cloud.size (), sizeof (PointT) / sizeof (float), 3, order, nr_threads);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::reorderPointCloud (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloud<PointT> &cloud_out,
+                        std::vector<int> &order, unsigned int nr_threads)
+{
+  if (&cloud_in == &cloud_out)
+  {
+    pcl::PointCloud<PointT> cloud_in_copy (cloud_in);
+    reorderPointCloud (cloud_in_copy, cloud_out, order, nr_threads);
+    return;
+  }
+
+  computeMortonOrder (cloud_in, order, nr_threads);
+
+  cloud_out.header   = cloud_in.header;
+  cloud_out.is_dense = cloud_in.is_dense;
+  cloud_out.sensor_origin_      = cloud_in.sensor_origin_;
+  cloud_out.sensor_orientation_ = cloud_in.sensor_orientation_;
+  cloud_out.points.resize (cloud_in.size ());
+  cloud_out.width  = static_cast<uint32_t> (cloud_in.size ());
+  cloud_out.height = 1;
+
+  const int nr_points = static_cast<int> (order.size ());
+  const pcl::parallel::ThreadReservation reservation (nr_points > 100000 ? nr_threads : 1u);
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ()) schedule(static) if (nr_points > 100000)
+  for (int i = 0; i < nr_points; ++i)
+    cloud_out.points[i] = cloud_in.points[order[i]];
+}
+
+#endif  //#ifndef PCL_COMMON_IMPL_MORTON_H_
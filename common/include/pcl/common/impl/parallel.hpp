@@ -0,0 +1,97 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_COMMON_IMPL_PARALLEL_H_
+#define PCL_COMMON_IMPL_PARALLEL_H_
+
+#include <pcl/common/parallel.h>
+#include <algorithm>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename Body> void
+pcl::parallel::parallel_for (int begin, int end, const Body &body, int grain_size, unsigned int nr_threads)
+{
+  if (end <= begin)
+    return;
+
+  const int nr_indices = end - begin;
+  const ThreadReservation reservation (nr_threads);
+  const int threads = static_cast<int> (reservation.getNumberOfThreads ());
+  // A few chunks per thread leave room for the dynamic schedule to balance the load
+  if (grain_size <= 0)
+    grain_size = std::max (1, nr_indices / (8 * threads));
+
+  const int nr_chunks = (nr_indices - 1) / grain_size + 1;
+#pragma omp parallel for num_threads(threads) schedule(dynamic) if (threads > 1 && nr_chunks > 1)
+  for (int chunk = 0; chunk < nr_chunks; ++chunk)
+  {
+    const int chunk_begin = begin + chunk * grain_size;
+    body (chunk_begin, std::min (chunk_begin + grain_size, end));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename Body, typename Reduction> T
+pcl::parallel::parallel_reduce (int begin, int end, const T &identity, const Body &body, const Reduction &reduction,
+                                int grain_size, unsigned int nr_threads)
+{
+  if (end <= begin)
+    return (identity);
+
+  const int nr_indices = end - begin;
+  // The automatic grain size must not depend on the number of threads, see the documentation
+  if (grain_size <= 0)
+    grain_size = std::max (1, (nr_indices - 1) / 256 + 1);
+
+  const int nr_chunks = (nr_indices - 1) / grain_size + 1;
+  std::vector<T> partial (nr_chunks, identity);
+  const ThreadReservation reservation (nr_chunks > 1 ? nr_threads : 1u);
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ()) schedule(dynamic) if (nr_chunks > 1)
+  for (int chunk = 0; chunk < nr_chunks; ++chunk)
+  {
+    const int chunk_begin = begin + chunk * grain_size;
+    partial[chunk] = body (chunk_begin, std::min (chunk_begin + grain_size, end));
+  }
+
+  T result = identity;
+  for (int chunk = 0; chunk < nr_chunks; ++chunk)
+    result = reduction (result, partial[chunk]);
+  return (result);
+}
+
+#endif  //#ifndef PCL_COMMON_IMPL_PARALLEL_H_
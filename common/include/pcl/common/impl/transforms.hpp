@@ -37,6 +37,114 @@
  *
  */
 
+#include <pcl/common/parallel.h>
+
+// SSE2 is part of the x86-64 baseline, so every translation unit built for that target
+// sees the same Transformer<float>, whatever -m flags it was compiled with
+#if defined(__x86_64__) || defined(_M_X64)
+#define PCL_TRANSFORMS_SSE2
+#include <emmintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Minimum number of points for which the cloud transformations are split
+      * across several OpenMP threads. Below this size the thread startup costs more than
+      * the transformation itself.
+      */
+    const int transform_parallel_threshold = 20000;
+
+    /** \brief Helper that applies the rotation (so3) or the full affine transformation (se3)
+      * stored in a 4x4 matrix to a 3D vector given as three consecutive floats, e.g. the
+      * x, y, z or normal_x, normal_y, normal_z fields of a point.
+      *
+      * Only the three target floats are written, so it is safe to use with any point type.
+      * Source and target may be the same location. Non-finite input coordinates are not
+      * special-cased: they propagate through the arithmetic and produce a non-finite output,
+      * which keeps the inner loops free of branches.
+      *
+      * The generic version works with the scalar type of the transformation. On x86-64 the
+      * float version uses SSE2, which every CPU of that target has. There is deliberately no
+      * specialization chosen from optional instruction set macros such as __AVX__: this is
+      * an inline header, and translation units built with different flags would otherwise
+      * get different definitions of the same class.
+      */
+    template <typename Scalar>
+    struct Transformer
+    {
+      const Eigen::Matrix<Scalar, 4, 4> &tf;
+
+      Transformer (const Eigen::Matrix<Scalar, 4, 4> &transform) : tf (transform) {}
+
+      inline void
+      so3 (const float *src, float *tgt) const
+      {
+        const Scalar p[3] = { src[0], src[1], src[2] };
+        tgt[0] = static_cast<float> (tf (0, 0) * p[0] + tf (0, 1) * p[1] + tf (0, 2) * p[2]);
+        tgt[1] = static_cast<float> (tf (1, 0) * p[0] + tf (1, 1) * p[1] + tf (1, 2) * p[2]);
+        tgt[2] = static_cast<float> (tf (2, 0) * p[0] + tf (2, 1) * p[1] + tf (2, 2) * p[2]);
+      }
+
+      inline void
+      se3 (const float *src, float *tgt) const
+      {
+        const Scalar p[3] = { src[0], src[1], src[2] };
+        tgt[0] = static_cast<float> (tf (0, 0) * p[0] + tf (0, 1) * p[1] + tf (0, 2) * p[2] + tf (0, 3));
+        tgt[1] = static_cast<float> (tf (1, 0) * p[0] + tf (1, 1) * p[1] + tf (1, 2) * p[2] + tf (1, 3));
+        tgt[2] = static_cast<float> (tf (2, 0) * p[0] + tf (2, 1) * p[1] + tf (2, 2) * p[2] + tf (2, 3));
+      }
+
+    private:
+      Transformer& operator= (const Transformer&);
+    };
+
+#if defined(PCL_TRANSFORMS_SSE2)
+    /** \brief Store the three lower lanes of an SSE register. */
+    inline void
+    storeXYZ (float *tgt, const __m128 v)
+    {
+      _mm_storel_pi (reinterpret_cast<__m64*> (tgt), v);
+      _mm_store_ss (tgt + 2, _mm_movehl_ps (v, v));
+    }
+
+    template <>
+    struct Transformer<float>
+    {
+      /** \brief The columns of the transformation matrix. */
+      __m128 c[4];
+
+      Transformer (const Eigen::Matrix4f &transform)
+      {
+        for (int i = 0; i < 4; ++i)
+          c[i] = _mm_loadu_ps (transform.col (i).data ());
+      }
+
+      inline void
+      so3 (const float *src, float *tgt) const
+      {
+        const __m128 p0 = _mm_mul_ps (_mm_set1_ps (src[0]), c[0]);
+        const __m128 p1 = _mm_mul_ps (_mm_set1_ps (src[1]), c[1]);
+        const __m128 p2 = _mm_mul_ps (_mm_set1_ps (src[2]), c[2]);
+        storeXYZ (tgt, _mm_add_ps (_mm_add_ps (p0, p1), p2));
+      }
+
+      inline void
+      se3 (const float *src, float *tgt) const
+      {
+        const __m128 p0 = _mm_mul_ps (_mm_set1_ps (src[0]), c[0]);
+        const __m128 p1 = _mm_mul_ps (_mm_set1_ps (src[1]), c[1]);
+        const __m128 p2 = _mm_mul_ps (_mm_set1_ps (src[2]), c[2]);
+        storeXYZ (tgt, _mm_add_ps (_mm_add_ps (_mm_add_ps (p0, p1), p2), c[3]));
+      }
+    };
+#endif // defined(PCL_TRANSFORMS_SSE2)
+#undef PCL_TRANSFORMS_SSE2
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Scalar> void
 pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
@@ -59,35 +167,14 @@ pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
     cloud_out.sensor_origin_      = cloud_in.sensor_origin_;
   }
 
-  if (cloud_in.is_dense)
-  {
-    // If the dataset is dense, simply transform it!
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      //cloud_out.points[i].getVector3fMap () = transform * cloud_in.points[i].getVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> pt (cloud_in[i].x, cloud_in[i].y, cloud_in[i].z);
-      cloud_out[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) + transform (0, 1) * pt.coeffRef (1) + transform (0, 2) * pt.coeffRef (2) + transform (0, 3));
-      cloud_out[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) + transform (1, 1) * pt.coeffRef (1) + transform (1, 2) * pt.coeffRef (2) + transform (1, 3));
-      cloud_out[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) + transform (2, 1) * pt.coeffRef (1) + transform (2, 2) * pt.coeffRef (2) + transform (2, 3));
-    }
-  }
-  else
-  {
-    // Dataset might contain NaNs and Infs, so check for them first,
-    // otherwise we get errors during the multiplication (?)
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-      //cloud_out.points[i].getVector3fMap () = transform * cloud_in.points[i].getVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> pt (cloud_in[i].x, cloud_in[i].y, cloud_in[i].z);
-      cloud_out[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) + transform (0, 1) * pt.coeffRef (1) + transform (0, 2) * pt.coeffRef (2) + transform (0, 3));
-      cloud_out[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) + transform (1, 1) * pt.coeffRef (1) + transform (1, 2) * pt.coeffRef (2) + transform (1, 3));
-      cloud_out[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) + transform (2, 1) * pt.coeffRef (1) + transform (2, 2) * pt.coeffRef (2) + transform (2, 3));
-    }
-  }
+  // Invalid points need no special treatment (see detail::Transformer), so dense and
+  // non-dense clouds share the same loop
+  const pcl::detail::Transformer<Scalar> tf (transform.matrix ());
+  const int npts = static_cast<int> (cloud_out.points.size ());
+  const pcl::parallel::ThreadReservation reservation (npts > pcl::detail::transform_parallel_threshold ? 0u : 1u);
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ()) if (npts > pcl::detail::transform_parallel_threshold)
+  for (int i = 0; i < npts; ++i)
+    tf.se3 (&cloud_in.points[i].x, &cloud_out.points[i].x);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -108,39 +195,16 @@ pcl::transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
   cloud_out.sensor_orientation_ = cloud_in.sensor_orientation_;
   cloud_out.sensor_origin_      = cloud_in.sensor_origin_;
 
-  if (cloud_in.is_dense)
+  const pcl::detail::Transformer<Scalar> tf (transform.matrix ());
+  const int n = static_cast<int> (npts);
+  const pcl::parallel::ThreadReservation reservation (n > pcl::detail::transform_parallel_threshold ? 0u : 1u);
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ()) if (n > pcl::detail::transform_parallel_threshold)
+  for (int i = 0; i < n; ++i)
   {
-    // If the dataset is dense, simply transform it!
-    for (size_t i = 0; i < npts; ++i)
-    {
-      // Copy fields first, then transform xyz data
-      if (copy_all_fields)
-        cloud_out.points[i] = cloud_in.points[indices[i]];
-      //cloud_out.points[i].getVector3fMap () = transform*cloud_out.points[i].getVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> pt (cloud_in[indices[i]].x, cloud_in[indices[i]].y, cloud_in[indices[i]].z);
-      cloud_out[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) + transform (0, 1) * pt.coeffRef (1) + transform (0, 2) * pt.coeffRef (2) + transform (0, 3));
-      cloud_out[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) + transform (1, 1) * pt.coeffRef (1) + transform (1, 2) * pt.coeffRef (2) + transform (1, 3));
-      cloud_out[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) + transform (2, 1) * pt.coeffRef (1) + transform (2, 2) * pt.coeffRef (2) + transform (2, 3));
-    }
-  }
-  else
-  {
-    // Dataset might contain NaNs and Infs, so check for them first,
-    // otherwise we get errors during the multiplication (?)
-    for (size_t i = 0; i < npts; ++i)
-    {
-      if (copy_all_fields)
-        cloud_out.points[i] = cloud_in.points[indices[i]];
-      if (!pcl_isfinite (cloud_in.points[indices[i]].x) || 
-          !pcl_isfinite (cloud_in.points[indices[i]].y) || 
-          !pcl_isfinite (cloud_in.points[indices[i]].z))
-        continue;
-      //cloud_out.points[i].getVector3fMap () = transform*cloud_out.points[i].getVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> pt (cloud_in[indices[i]].x, cloud_in[indices[i]].y, cloud_in[indices[i]].z);
-      cloud_out[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) + transform (0, 1) * pt.coeffRef (1) + transform (0, 2) * pt.coeffRef (2) + transform (0, 3));
-      cloud_out[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) + transform (1, 1) * pt.coeffRef (1) + transform (1, 2) * pt.coeffRef (2) + transform (1, 3));
-      cloud_out[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) + transform (2, 1) * pt.coeffRef (1) + transform (2, 2) * pt.coeffRef (2) + transform (2, 3));
-    }
+    // Copy fields first, then transform xyz data
+    if (copy_all_fields)
+      cloud_out.points[i] = cloud_in.points[indices[i]];
+    tf.se3 (&cloud_in.points[indices[i]].x, &cloud_out.points[i].x);
   }
 }
 
@@ -158,7 +222,7 @@ pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
     cloud_out.width    = cloud_in.width;
     cloud_out.height   = cloud_in.height;
     cloud_out.is_dense = cloud_in.is_dense;
-    cloud_out.points.reserve (cloud_out.points.size ());
+    cloud_out.points.reserve (cloud_in.points.size ());
     if (copy_all_fields)
       cloud_out.points.assign (cloud_in.points.begin (), cloud_in.points.end ());
     else
@@ -167,48 +231,15 @@ pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
     cloud_out.sensor_origin_      = cloud_in.sensor_origin_;
   }
 
-  // If the data is dense, we don't need to check for NaN
-  if (cloud_in.is_dense)
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      //cloud_out.points[i].getVector3fMap() = transform * cloud_in.points[i].getVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> pt (cloud_in[i].x, cloud_in[i].y, cloud_in[i].z);
-      cloud_out[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) + transform (0, 1) * pt.coeffRef (1) + transform (0, 2) * pt.coeffRef (2) + transform (0, 3));
-      cloud_out[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) + transform (1, 1) * pt.coeffRef (1) + transform (1, 2) * pt.coeffRef (2) + transform (1, 3));
-      cloud_out[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) + transform (2, 1) * pt.coeffRef (1) + transform (2, 2) * pt.coeffRef (2) + transform (2, 3));
-
-      // Rotate normals (WARNING: transform.rotation () uses SVD internally!)
-      //cloud_out.points[i].getNormalVector3fMap() = transform.rotation () * cloud_in.points[i].getNormalVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> nt (cloud_in[i].normal_x, cloud_in[i].normal_y, cloud_in[i].normal_z);
-      cloud_out[i].normal_x = static_cast<float> (transform (0, 0) * nt.coeffRef (0) + transform (0, 1) * nt.coeffRef (1) + transform (0, 2) * nt.coeffRef (2));
-      cloud_out[i].normal_y = static_cast<float> (transform (1, 0) * nt.coeffRef (0) + transform (1, 1) * nt.coeffRef (1) + transform (1, 2) * nt.coeffRef (2));
-      cloud_out[i].normal_z = static_cast<float> (transform (2, 0) * nt.coeffRef (0) + transform (2, 1) * nt.coeffRef (1) + transform (2, 2) * nt.coeffRef (2));
-    }
-  }
-  // Dataset might contain NaNs and Infs, so check for them first.
-  else
+  // Rotate normals with the linear part only (WARNING: transform.rotation () uses SVD internally!)
+  const pcl::detail::Transformer<Scalar> tf (transform.matrix ());
+  const int npts = static_cast<int> (cloud_out.points.size ());
+  const pcl::parallel::ThreadReservation reservation (npts > pcl::detail::transform_parallel_threshold ? 0u : 1u);
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ()) if (npts > pcl::detail::transform_parallel_threshold)
+  for (int i = 0; i < npts; ++i)
   {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!pcl_isfinite (cloud_in.points[i].x) || 
-          !pcl_isfinite (cloud_in.points[i].y) || 
-          !pcl_isfinite (cloud_in.points[i].z))
-        continue;
-
-      //cloud_out.points[i].getVector3fMap() = transform * cloud_in.points[i].getVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> pt (cloud_in[i].x, cloud_in[i].y, cloud_in[i].z);
-      cloud_out[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) + transform (0, 1) * pt.coeffRef (1) + transform (0, 2) * pt.coeffRef (2) + transform (0, 3));
-      cloud_out[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) + transform (1, 1) * pt.coeffRef (1) + transform (1, 2) * pt.coeffRef (2) + transform (1, 3));
-      cloud_out[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) + transform (2, 1) * pt.coeffRef (1) + transform (2, 2) * pt.coeffRef (2) + transform (2, 3));
-
-      // Rotate normals
-      //cloud_out.points[i].getNormalVector3fMap() = transform.rotation () * cloud_in.points[i].getNormalVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> nt (cloud_in[i].normal_x, cloud_in[i].normal_y, cloud_in[i].normal_z);
-      cloud_out[i].normal_x = static_cast<float> (transform (0, 0) * nt.coeffRef (0) + transform (0, 1) * nt.coeffRef (1) + transform (0, 2) * nt.coeffRef (2));
-      cloud_out[i].normal_y = static_cast<float> (transform (1, 0) * nt.coeffRef (0) + transform (1, 1) * nt.coeffRef (1) + transform (1, 2) * nt.coeffRef (2));
-      cloud_out[i].normal_z = static_cast<float> (transform (2, 0) * nt.coeffRef (0) + transform (2, 1) * nt.coeffRef (1) + transform (2, 2) * nt.coeffRef (2));
-    }
+    tf.se3 (&cloud_in.points[i].x, &cloud_out.points[i].x);
+    tf.so3 (&cloud_in.points[i].normal_x, &cloud_out.points[i].normal_x);
   }
 }
 
@@ -230,55 +261,17 @@ pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
   cloud_out.sensor_orientation_ = cloud_in.sensor_orientation_;
   cloud_out.sensor_origin_      = cloud_in.sensor_origin_;
 
-  // If the data is dense, we don't need to check for NaN
-  if (cloud_in.is_dense)
+  const pcl::detail::Transformer<Scalar> tf (transform.matrix ());
+  const int n = static_cast<int> (npts);
+  const pcl::parallel::ThreadReservation reservation (n > pcl::detail::transform_parallel_threshold ? 0u : 1u);
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ()) if (n > pcl::detail::transform_parallel_threshold)
+  for (int i = 0; i < n; ++i)
   {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      // Copy fields first, then transform
-      if (copy_all_fields)
-        cloud_out.points[i] = cloud_in.points[indices[i]];
-      //cloud_out.points[i].getVector3fMap() = transform * cloud_in.points[i].getVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> pt (cloud_in[indices[i]].x, cloud_in[indices[i]].y, cloud_in[indices[i]].z);
-      cloud_out[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) + transform (0, 1) * pt.coeffRef (1) + transform (0, 2) * pt.coeffRef (2) + transform (0, 3));
-      cloud_out[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) + transform (1, 1) * pt.coeffRef (1) + transform (1, 2) * pt.coeffRef (2) + transform (1, 3));
-      cloud_out[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) + transform (2, 1) * pt.coeffRef (1) + transform (2, 2) * pt.coeffRef (2) + transform (2, 3));
-
-      // Rotate normals
-      //cloud_out.points[i].getNormalVector3fMap() = transform.rotation () * cloud_in.points[i].getNormalVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> nt (cloud_in[indices[i]].normal_x, cloud_in[indices[i]].normal_y, cloud_in[indices[i]].normal_z);
-      cloud_out[i].normal_x = static_cast<float> (transform (0, 0) * nt.coeffRef (0) + transform (0, 1) * nt.coeffRef (1) + transform (0, 2) * nt.coeffRef (2));
-      cloud_out[i].normal_y = static_cast<float> (transform (1, 0) * nt.coeffRef (0) + transform (1, 1) * nt.coeffRef (1) + transform (1, 2) * nt.coeffRef (2));
-      cloud_out[i].normal_z = static_cast<float> (transform (2, 0) * nt.coeffRef (0) + transform (2, 1) * nt.coeffRef (1) + transform (2, 2) * nt.coeffRef (2));
-    }
-  }
-  // Dataset might contain NaNs and Infs, so check for them first.
-  else
-  {
-    for (size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      // Copy fields first, then transform
-      if (copy_all_fields)
-        cloud_out.points[i] = cloud_in.points[indices[i]];
-
-      if (!pcl_isfinite (cloud_in.points[indices[i]].x) || 
-          !pcl_isfinite (cloud_in.points[indices[i]].y) || 
-          !pcl_isfinite (cloud_in.points[indices[i]].z))
-        continue;
-
-      //cloud_out.points[i].getVector3fMap() = transform * cloud_in.points[i].getVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> pt (cloud_in[indices[i]].x, cloud_in[indices[i]].y, cloud_in[indices[i]].z);
-      cloud_out[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) + transform (0, 1) * pt.coeffRef (1) + transform (0, 2) * pt.coeffRef (2) + transform (0, 3));
-      cloud_out[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) + transform (1, 1) * pt.coeffRef (1) + transform (1, 2) * pt.coeffRef (2) + transform (1, 3));
-      cloud_out[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) + transform (2, 1) * pt.coeffRef (1) + transform (2, 2) * pt.coeffRef (2) + transform (2, 3));
-
-      // Rotate normals
-      //cloud_out.points[i].getNormalVector3fMap() = transform.rotation () * cloud_in.points[i].getNormalVector3fMap ();
-      Eigen::Matrix<Scalar, 3, 1> nt (cloud_in[indices[i]].normal_x, cloud_in[indices[i]].normal_y, cloud_in[indices[i]].normal_z);
-      cloud_out[i].normal_x = static_cast<float> (transform (0, 0) * nt.coeffRef (0) + transform (0, 1) * nt.coeffRef (1) + transform (0, 2) * nt.coeffRef (2));
-      cloud_out[i].normal_y = static_cast<float> (transform (1, 0) * nt.coeffRef (0) + transform (1, 1) * nt.coeffRef (1) + transform (1, 2) * nt.coeffRef (2));
-      cloud_out[i].normal_z = static_cast<float> (transform (2, 0) * nt.coeffRef (0) + transform (2, 1) * nt.coeffRef (1) + transform (2, 2) * nt.coeffRef (2));
-    }
+    // Copy fields first, then transform
+    if (copy_all_fields)
+      cloud_out.points[i] = cloud_in.points[indices[i]];
+    tf.se3 (&cloud_in.points[indices[i]].x, &cloud_out.points[i].x);
+    tf.so3 (&cloud_in.points[indices[i]].normal_x, &cloud_out.points[i].normal_x);
   }
 }
 
@@ -310,6 +303,107 @@ pcl::transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
   transformPointCloudWithNormals (cloud_in, cloud_out, t, copy_all_fields);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Apply the affine transform (or only its linear part if translate is false)
+      * to n points stored as three separate streams. Output and input may alias.
+      */
+    template <typename Scalar> inline void
+    transformStreams (const float *x_in, const float *y_in, const float *z_in,
+                      float *x_out, float *y_out, float *z_out, size_t n,
+                      const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
+                      bool translate)
+    {
+      const Scalar r00 = transform (0, 0), r01 = transform (0, 1), r02 = transform (0, 2);
+      const Scalar r10 = transform (1, 0), r11 = transform (1, 1), r12 = transform (1, 2);
+      const Scalar r20 = transform (2, 0), r21 = transform (2, 1), r22 = transform (2, 2);
+      const Scalar t0 = translate ? transform (0, 3) : Scalar (0);
+      const Scalar t1 = translate ? transform (1, 3) : Scalar (0);
+      const Scalar t2 = translate ? transform (2, 3) : Scalar (0);
+      const int npts = static_cast<int> (n);
+      const pcl::parallel::ThreadReservation reservation (npts > transform_parallel_threshold ? 0u : 1u);
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ()) if (npts > transform_parallel_threshold)
+      for (int i = 0; i < npts; ++i)
+      {
+        const Scalar px = x_in[i], py = y_in[i], pz = z_in[i];
+        x_out[i] = static_cast<float> (r00 * px + r01 * py + r02 * pz + t0);
+        y_out[i] = static_cast<float> (r10 * px + r11 * py + r12 * pz + t1);
+        z_out[i] = static_cast<float> (r20 * px + r21 * py + r22 * pz + t2);
+      }
+    }
+
+    /** \brief Prepare the output of a structure of arrays transformation: copy the metadata
+      * and, if requested, the streams that are not modified by the transformation.
+      */
+    inline void
+    prepareTransformOutput (const pcl::PointCloudSoA &cloud_in, pcl::PointCloudSoA &cloud_out,
+                            bool copy_normals, bool copy_color)
+    {
+      if (&cloud_in == &cloud_out)
+        return;
+      cloud_out.header   = cloud_in.header;
+      cloud_out.is_dense = cloud_in.is_dense;
+      cloud_out.resize (cloud_in.size (), copy_normals, copy_color);
+      cloud_out.width    = cloud_in.width;
+      cloud_out.height   = cloud_in.height;
+      if (copy_normals)
+      {
+        cloud_out.normal_x = cloud_in.normal_x;
+        cloud_out.normal_y = cloud_in.normal_y;
+        cloud_out.normal_z = cloud_in.normal_z;
+      }
+      if (copy_color)
+        cloud_out.rgba = cloud_in.rgba;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename Scalar> void
+pcl::transformPointCloud (const pcl::PointCloudSoA &cloud_in,
+                          pcl::PointCloudSoA &cloud_out,
+                          const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
+                          bool copy_all_fields)
+{
+  detail::prepareTransformOutput (cloud_in, cloud_out,
+                                  copy_all_fields && cloud_in.hasNormals (),
+                                  copy_all_fields && cloud_in.hasColor ());
+  if (cloud_in.empty ())
+    return;
+
+  detail::transformStreams (&cloud_in.x[0], &cloud_in.y[0], &cloud_in.z[0],
+                            &cloud_out.x[0], &cloud_out.y[0], &cloud_out.z[0],
+                            cloud_in.size (), transform, true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename Scalar> void
+pcl::transformPointCloudWithNormals (const pcl::PointCloudSoA &cloud_in,
+                                     pcl::PointCloudSoA &cloud_out,
+                                     const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
+                                     bool copy_all_fields)
+{
+  if (!cloud_in.empty () && !cloud_in.hasNormals ())
+  {
+    PCL_ERROR ("[pcl::transformPointCloudWithNormals] Input cloud has no normal streams!\n");
+    return;
+  }
+  detail::prepareTransformOutput (cloud_in, cloud_out, true, copy_all_fields && cloud_in.hasColor ());
+  if (cloud_in.empty ())
+    return;
+
+  const size_t n = cloud_in.size ();
+  detail::transformStreams (&cloud_in.x[0], &cloud_in.y[0], &cloud_in.z[0],
+                            &cloud_out.x[0], &cloud_out.y[0], &cloud_out.z[0],
+                            n, transform, true);
+  detail::transformStreams (&cloud_in.normal_x[0], &cloud_in.normal_y[0], &cloud_in.normal_z[0],
+                            &cloud_out.normal_x[0], &cloud_out.normal_y[0], &cloud_out.normal_z[0],
+                            n, transform, false);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Scalar> inline PointT
 pcl::transformPoint (const PointT &point, 
@@ -0,0 +1,114 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_COMMON_MORTON_H_
+#define PCL_COMMON_MORTON_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/pcl_macros.h>
+#include <vector>
+
+/**
+  * \file pcl/common/morton.h
+  * Define methods for sorting points along a Morton (Z-order) curve
+  * \ingroup common
+  */
+
+/*@{*/
+namespace pcl
+{
+  /** \brief Interleave the 21 lower bits of three integer coordinates into a 63 bit Morton code.
+    * \param[in] x the first coordinate
+    * \param[in] y the second coordinate
+    * \param[in] z the third coordinate
+    * \return the Morton code, with the bits of \a x as the least significant of each triplet
+    */
+  inline uint64_t
+  encodeMorton3D (uint32_t x, uint32_t y, uint32_t z);
+
+  /** \brief Stable sort of Morton codes with a parallel LSD radix sort.
+    * \param[in,out] codes the codes to sort, sorted on output
+    * \param[out] order the permutation applied to the codes: the i-th sorted code was at order[i] in the input
+    * \param[in] nr_threads the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+    */
+  PCL_EXPORTS void
+  sortMortonCodes (std::vector<uint64_t> &codes, std::vector<int> &order, unsigned int nr_threads = 0);
+
+  /** \brief Compute the order of a set of points along a Morton curve spanning their bounding cube.
+    *
+    * The coordinates of point i are read from points[i * stride], ..., points[i * stride + dimensions - 1], only
+    * the first three dimensions are used. Points with non finite coordinates are put at the end, in their
+    * original order.
+    * \param[in] points the coordinates of the points
+    * \param[in] nr_points the number of points
+    * \param[in] stride the number of floats between the coordinates of two consecutive points
+    * \param[in] dimensions the number of coordinates of a point
+    * \param[out] order the original indices of the points, in Morton order
+    * \param[in] nr_threads the number of threads to use (0: automatic)
+    */
+  PCL_EXPORTS void
+  computeMortonOrder (const float *points, size_t nr_points, size_t stride, size_t dimensions,
+                      std::vector<int> &order, unsigned int nr_threads = 0);
+
+  /** \brief Compute the order of the points of a cloud along a Morton curve spanning their bounding cube. Points
+    * with non finite coordinates are put at the end, in their original order.
+    * \param[in] cloud the input point cloud
+    * \param[out] order the indices of the points of \a cloud, in Morton order
+    * \param[in] nr_threads the number of threads to use (0: automatic)
+    */
+  template <typename PointT> void
+  computeMortonOrder (const pcl::PointCloud<PointT> &cloud, std::vector<int> &order, unsigned int nr_threads = 0);
+
+  /** \brief Reorder the points of a cloud along a Morton curve, so that points close in space are close in memory.
+    *
+    * Processing the reordered cloud makes the spatial searches and the per point neighborhood loops much more cache
+    * friendly than the sensor order. Indices into \a cloud_out are mapped back to \a cloud_in with \a order.
+    * The output cloud is unorganized.
+    * \param[in] cloud_in the input point cloud
+    * \param[out] cloud_out the reordered point cloud
+    * \param[out] order the permutation: cloud_out[i] is cloud_in[order[i]]
+    * \param[in] nr_threads the number of threads to use (0: automatic)
+    */
+  template <typename PointT> void
+  reorderPointCloud (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloud<PointT> &cloud_out,
+                     std::vector<int> &order, unsigned int nr_threads = 0);
+}
+/*@}*/
+
+#include <pcl/common/impl/morton.hpp>
+
+#endif  //#ifndef PCL_COMMON_MORTON_H_
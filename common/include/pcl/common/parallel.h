@@ -0,0 +1,166 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_COMMON_PARALLEL_H_
+#define PCL_COMMON_PARALLEL_H_
+
+#include <pcl/pcl_macros.h>
+
+/**
+  * \file pcl/common/parallel.h
+  * Define a common layer for running loops over index ranges in parallel
+  * \ingroup common
+  */
+
+/*@{*/
+namespace pcl
+{
+  namespace parallel
+  {
+    /** \brief Set the maximum number of threads used by the parallel algorithms of the library.
+      * The budget is shared by all the parallel regions running in the process (see ThreadReservation).
+      * The initial value is read from the PCL_NUM_THREADS environment variable.
+      * \param[in] nr_threads the thread budget, 0 uses all the processors of the machine
+      * \note The regions running already keep the threads they reserved.
+      */
+    PCL_EXPORTS void
+    setMaxThreads (unsigned int nr_threads);
+
+    /** \brief Get the maximum number of threads used by the parallel algorithms of the library. */
+    PCL_EXPORTS unsigned int
+    getMaxThreads ();
+
+    /** \brief Get the number of threads a parallel region may use at most.
+      *
+      * A \a nr_threads value of 0 stands for the thread budget (see setMaxThreads), larger requests are
+      * clamped to it. When called from inside an OpenMP parallel region the function returns 1, so that
+      * nested parallel algorithms run in the calling thread instead of oversubscribing the machine.
+      * \note The threads used by the other running regions are not taken into account, parallel regions
+      * get their threads from a ThreadReservation.
+      * \param[in] nr_threads the number of threads requested by the algorithm (0: automatic)
+      */
+    PCL_EXPORTS unsigned int
+    getNumberOfThreads (unsigned int nr_threads = 0);
+
+    /** \brief Reserve threads of the thread budget for a parallel region.
+      *
+      * The threads reserved by the parallel regions running in the process, whichever thread started them,
+      * count against the budget (see setMaxThreads): a region started while other ones are running gets the
+      * threads left, and at least the calling thread. The threads are given back when the reservation is
+      * destroyed.
+      *
+      * \code
+      * pcl::parallel::ThreadReservation reservation (threads_);
+      * #pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
+      * \endcode
+      */
+    class PCL_EXPORTS ThreadReservation
+    {
+      public:
+        /** \brief Reserve the threads of a parallel region.
+          * \param[in] nr_threads the number of threads requested (0: automatic, see getNumberOfThreads)
+          */
+        explicit
+        ThreadReservation (unsigned int nr_threads = 0);
+
+        /** \brief Give the reserved threads back to the budget. */
+        ~ThreadReservation ();
+
+        /** \brief Get the number of threads reserved, the calling thread included. */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (nr_threads_);
+        }
+
+      private:
+        ThreadReservation (const ThreadReservation&);
+        ThreadReservation&
+        operator= (const ThreadReservation&);
+
+        /** \brief The number of threads the region may use. */
+        unsigned int nr_threads_;
+
+        /** \brief The number of threads taken from the budget (0 for nested regions). */
+        unsigned int reserved_;
+    };
+
+    /** \brief Call \a body on consecutive sub-ranges of [begin, end), in parallel.
+      *
+      * The range is split in chunks of \a grain_size indices which are distributed dynamically over the
+      * threads, so that ranges with an uneven cost per index are balanced. The body is called as
+      * body (chunk_begin, chunk_end) and has to be safe to call concurrently on disjoint ranges.
+      *
+      * \code
+      * pcl::parallel::parallel_for (0, static_cast<int> (cloud.size ()), body, 256);
+      * \endcode
+      *
+      * \param[in] begin the first index of the range
+      * \param[in] end one past the last index of the range
+      * \param[in] body the functor processing a sub-range
+      * \param[in] grain_size the number of indices per chunk (0: automatic)
+      * \param[in] nr_threads the number of threads to use (0: automatic, see getNumberOfThreads)
+      */
+    template <typename Body> void
+    parallel_for (int begin, int end, const Body &body, int grain_size = 0, unsigned int nr_threads = 0);
+
+    /** \brief Reduce the range [begin, end) in parallel.
+      *
+      * \a body is called as body (chunk_begin, chunk_end) and returns the partial result of a chunk. The
+      * partial results are then combined in the order of the chunks, starting with \a identity:
+      * reduction (reduction (identity, partial_0), partial_1) ... The chunks only depend on the range and
+      * \a grain_size, so the result does not depend on the number of threads.
+      *
+      * \param[in] begin the first index of the range
+      * \param[in] end one past the last index of the range
+      * \param[in] identity the neutral element of the reduction
+      * \param[in] body the functor computing the partial result of a sub-range
+      * \param[in] reduction the functor combining two partial results
+      * \param[in] grain_size the number of indices per chunk (0: automatic)
+      * \param[in] nr_threads the number of threads to use (0: automatic, see getNumberOfThreads)
+      * \return the reduced value
+      */
+    template <typename T, typename Body, typename Reduction> T
+    parallel_reduce (int begin, int end, const T &identity, const Body &body, const Reduction &reduction,
+                     int grain_size = 0, unsigned int nr_threads = 0);
+  }
+}
+/*@}*/
+
+#include <pcl/common/impl/parallel.hpp>
+
+#endif  //#ifndef PCL_COMMON_PARALLEL_H_
@@ -0,0 +1,263 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_COMMON_PROFILER_H_
+#define PCL_COMMON_PROFILER_H_
+
+#include <pcl/pcl_macros.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+/**
+  * \file pcl/common/profiler.h
+  * Define a named region profiler for finding where the time of a processing pipeline is spent
+  * \ingroup common
+  */
+
+/*@{*/
+namespace pcl
+{
+  namespace profiler
+  {
+    /** \brief Timing statistics of a profiled region, aggregated over all the threads. All the times are
+      * in milliseconds.
+      */
+    struct RegionStatistics
+    {
+      RegionStatistics ()
+        : name (), calls (0), total (0.0), self (0.0), min (0.0), max (0.0), median (0.0), percentile_90 (0.0), percentile_99 (0.0)
+      {}
+
+      /** \brief The name of the region. */
+      std::string name;
+      /** \brief The number of times the region was entered. */
+      size_t calls;
+      /** \brief The time spent in the region, including the nested regions. */
+      double total;
+      /** \brief The time spent in the region, excluding the nested regions. */
+      double self;
+      /** \brief The shortest call. */
+      double min;
+      /** \brief The longest call. */
+      double max;
+      /** \brief The median duration of a call. */
+      double median;
+      /** \brief The 90th percentile of the duration of a call. */
+      double percentile_90;
+      /** \brief The 99th percentile of the duration of a call. */
+      double percentile_99;
+    };
+
+    namespace detail
+    {
+      /** \brief Whether the profiled regions are recorded, see \ref setEnabled. */
+      extern PCL_EXPORTS std::atomic<bool> enabled;
+    }
+
+    /** \brief Enable or disable the recording of the profiled regions. The profiler is disabled by default,
+      * in which case entering a region only costs a flag test.
+      * \param[in] enabled true to start recording
+      */
+    PCL_EXPORTS void
+    setEnabled (bool enabled);
+
+    /** \brief Check whether the profiled regions are recorded. */
+    inline bool
+    isEnabled ()
+    {
+      return (detail::enabled.load (std::memory_order_relaxed));
+    }
+
+    /** \brief Set the maximum number of events recorded by each thread. The events are kept in memory until
+      * \ref reset is called, once a thread reached the limit its further events are dropped (and counted, see
+      * \ref getNumberOfDroppedEvents). The default is 1048576 events (32 MB) per thread.
+      * \param[in] max_events the maximum number of events per thread, 0 for no limit
+      */
+    PCL_EXPORTS void
+    setMaxEventsPerThread (size_t max_events);
+
+    /** \brief Get the number of events dropped since the last call to \ref reset because a thread reached the
+      * maximum number of events (see \ref setMaxEventsPerThread).
+      */
+    PCL_EXPORTS size_t
+    getNumberOfDroppedEvents ();
+
+    /** \brief Get the identifier of a region name, registering the name on its first use. This takes a lock, the
+      * \ref PCL_PROFILE_SCOPE macro calls it once per call site for a string literal name.
+      * \param[in] name the name of the region
+      */
+    PCL_EXPORTS int
+    getRegionId (const std::string &name);
+
+    /** \brief Drop all the recorded events. Regions running while resetting are recorded afterwards. */
+    PCL_EXPORTS void
+    reset ();
+
+    /** \brief Get the statistics of every region recorded since the last call to reset (), sorted by
+      * decreasing total time.
+      * \param[out] statistics the statistics of the recorded regions
+      */
+    PCL_EXPORTS void
+    getStatistics (std::vector<RegionStatistics> &statistics);
+
+    /** \brief Save all the recorded events in the Chrome trace event format, which can be opened with
+      * chrome://tracing or Perfetto.
+      * \param[in] file_name the name of the JSON file to write
+      * \return true if the file was written
+      */
+    PCL_EXPORTS bool
+    saveChromeTrace (const std::string &file_name);
+
+    /** \brief Save the statistics of the recorded regions as a flat CSV table, one region per line.
+      * \param[in] file_name the name of the CSV file to write
+      * \return true if the file was written
+      */
+    PCL_EXPORTS bool
+    saveCSV (const std::string &file_name);
+
+    /** \brief Records the time spent in a scope as an event of a named region, when the profiler is enabled.
+      *
+      * \code
+      * {
+      *   PCL_PROFILE_SCOPE ("downsampling");
+      *   // ... perform calculation here
+      * }
+      * \endcode
+      *
+      * Nested regions are recorded with their nesting depth. The events are stored per thread, each buffer
+      * behind its own lock, so that regions left concurrently from several threads do not contend.
+      *
+      * \ingroup common
+      */
+    class PCL_EXPORTS ScopedRegion
+    {
+      public:
+        /** \brief Enter a region.
+          * \param[in] region the identifier of the region (see \ref getRegionId)
+          */
+        explicit ScopedRegion (int region) : region_ (-1), start_ (0)
+        {
+          if (isEnabled ())
+            enter (region);
+        }
+
+        /** \brief Enter a region. The identifier of \a name is looked up in a cache of the thread.
+          * \param[in] name the name of the region
+          */
+        explicit ScopedRegion (const std::string &name) : region_ (-1), start_ (0)
+        {
+          if (isEnabled ())
+            enter (name);
+        }
+
+        /** \brief Leave the region. */
+        ~ScopedRegion ()
+        {
+          if (region_ >= 0)
+            leave ();
+        }
+
+      private:
+        void
+        enter (int region);
+
+        void
+        enter (const std::string &name);
+
+        void
+        leave ();
+
+        /** \brief The identifier of the region, -1 if the profiler was disabled when entering it. */
+        int region_;
+
+        /** \brief The time the region was entered at, in nanoseconds. */
+        long long start_;
+
+        // Not copyable
+        ScopedRegion (const ScopedRegion &);
+        ScopedRegion& operator = (const ScopedRegion &);
+    };
+
+    namespace detail
+    {
+      /** \brief The identifier of a region at a PCL_PROFILE_SCOPE call site. A string literal name is the same
+        * at every pass, so it is registered once when the function-local static is initialized. Any other name
+        * (e.g. the std::string name of an instance) may change between passes and is looked up every time.
+        */
+      struct RegionSite
+      {
+        explicit RegionSite (const char *name) : id (getRegionId (name)) {}
+
+        explicit RegionSite (const std::string &) : id (-1) {}
+
+        const int id;
+      };
+
+      inline int
+      siteRegion (const RegionSite &site, const char *)
+      {
+        return (site.id);
+      }
+
+      inline const std::string&
+      siteRegion (const RegionSite &, const std::string &name)
+      {
+        return (name);
+      }
+    }
+  }
+}
+/*@}*/
+
+#define PCL_PROFILE_CONCATENATE_DETAIL(a, b) a ## b
+#define PCL_PROFILE_CONCATENATE(a, b) PCL_PROFILE_CONCATENATE_DETAIL(a, b)
+
+/** \brief Profile the enclosing scope as the region \a name. A const char* name has to be a string literal (or
+  * at least the same string at every pass): it is registered once per call site. Define PCL_NO_PROFILING to
+  * compile the instrumentation out entirely.
+  */
+#ifndef PCL_NO_PROFILING
+#define PCL_PROFILE_SCOPE(name) \
+  static const pcl::profiler::detail::RegionSite PCL_PROFILE_CONCATENATE (pcl_profile_site_, __LINE__) (name); \
+  pcl::profiler::ScopedRegion PCL_PROFILE_CONCATENATE (pcl_profile_region_, __LINE__) ( \
+    pcl::profiler::detail::siteRegion (PCL_PROFILE_CONCATENATE (pcl_profile_site_, __LINE__), name))
+#else
+#define PCL_PROFILE_SCOPE(name)
+#endif
+
+#endif  //#ifndef PCL_COMMON_PROFILER_H_
@@ -40,6 +40,7 @@
 #define PCL_TRANSFORMS_H_
 
 #include <pcl/point_cloud.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/point_types.h>
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
@@ -54,6 +55,12 @@ namespace pcl
     * \param[in] copy_all_fields flag that controls whether the contents of the fields
     * (other than x, y, z) should be copied into the new transformed cloud
     * \note Can be used with cloud_in equal to cloud_out
+    * \note Points with non-finite coordinates are transformed like the others: NaN or Inf
+    * in any coordinate gives NaN (or Inf) x, y, z in the output, so invalid points stay
+    * invalid. This differs from earlier versions when copy_all_fields is false and the
+    * input is not dense: such points used to be skipped, which left them at x = y = z = 0
+    * in a separate output cloud, and Inf coordinates could come out unchanged. Large
+    * clouds are processed with several OpenMP threads.
     * \ingroup common
     */
   template <typename PointT, typename Scalar> void 
@@ -78,6 +85,8 @@ namespace pcl
     * \param[in] transform an affine transformation (typically a rigid transformation)
     * \param[in] copy_all_fields flag that controls whether the contents of the fields
     * (other than x, y, z) should be copied into the new transformed cloud
+    * \note Non-finite points give NaN (or Inf) coordinates, as in the overload without
+    * indices.
     * \ingroup common
     */
   template <typename PointT, typename Scalar> void 
@@ -134,6 +143,8 @@ namespace pcl
     * (other than x, y, z, normal_x, normal_y, normal_z) should be copied into the new
     * transformed cloud
     * \note Can be used with cloud_in equal to cloud_out
+    * \note Non-finite points and normals give NaN (or Inf) coordinates, as in
+    * transformPointCloud, also when copy_all_fields is false.
     */
   template <typename PointT, typename Scalar> void 
   transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
@@ -442,6 +453,57 @@ namespace pcl
     return (transformPointCloudWithNormals<PointT, float> (cloud_in, cloud_out, offset, rotation, copy_all_fields));
   }
 
+  /** \brief Apply an affine transform defined by an Eigen Transform to a structure of arrays cloud.
+    * The x, y and z streams are processed independently of each other, which lets the
+    * compiler vectorize the loop. Non-finite coordinates are not skipped: they simply
+    * propagate through the transformation and the corresponding output point stays invalid.
+    * \param[in] cloud_in the input point cloud
+    * \param[out] cloud_out the resultant output point cloud
+    * \param[in] transform an affine transformation (typically a rigid transformation)
+    * \param[in] copy_all_fields flag that controls whether the normal and color streams
+    * should be copied into the new transformed cloud
+    * \note Can be used with cloud_in equal to cloud_out
+    * \ingroup common
+    */
+  template <typename Scalar> void
+  transformPointCloud (const pcl::PointCloudSoA &cloud_in,
+                       pcl::PointCloudSoA &cloud_out,
+                       const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
+                       bool copy_all_fields = true);
+
+  inline void
+  transformPointCloud (const pcl::PointCloudSoA &cloud_in,
+                       pcl::PointCloudSoA &cloud_out,
+                       const Eigen::Affine3f &transform,
+                       bool copy_all_fields = true)
+  {
+    return (transformPointCloud<float> (cloud_in, cloud_out, transform, copy_all_fields));
+  }
+
+  /** \brief Transform a structure of arrays cloud and rotate its normals using an Eigen transform.
+    * \param[in] cloud_in the input point cloud, must have normal streams
+    * \param[out] cloud_out the resultant output point cloud
+    * \param[in] transform an affine transformation (typically a rigid transformation)
+    * \param[in] copy_all_fields flag that controls whether the color stream should be
+    * copied into the new transformed cloud
+    * \note Can be used with cloud_in equal to cloud_out
+    * \ingroup common
+    */
+  template <typename Scalar> void
+  transformPointCloudWithNormals (const pcl::PointCloudSoA &cloud_in,
+                                  pcl::PointCloudSoA &cloud_out,
+                                  const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
+                                  bool copy_all_fields = true);
+
+  inline void
+  transformPointCloudWithNormals (const pcl::PointCloudSoA &cloud_in,
+                                  pcl::PointCloudSoA &cloud_out,
+                                  const Eigen::Affine3f &transform,
+                                  bool copy_all_fields = true)
+  {
+    return (transformPointCloudWithNormals<float> (cloud_in, cloud_out, transform, copy_all_fields));
+  }
+
   /** \brief Transform a point with members x,y,z
     * \param[in] point the point to transform
     * \param[out] transform the transformation to apply
@@ -55,6 +55,7 @@
 #ifndef Q_MOC_RUN
 #include <boost/foreach.hpp>
 #endif
+#include <algorithm>
 
 namespace pcl
 {
@@ -119,6 +120,65 @@ namespace pcl
       return (a.serialized_offset < b.serialized_offset);
     }
 
+    /** \brief Copy \a n blocks of \a Size bytes between two strided buffers. */
+    template <size_t Size> inline void
+    copyStrided (uint8_t* dst, size_t dst_step, const uint8_t* src, size_t src_step, size_t n)
+    {
+      for (size_t i = 0; i < n; ++i, dst += dst_step, src += src_step)
+        memcpy (dst, src, Size);
+    }
+
+    /** \brief Copy \a n blocks of \a size bytes between two strided buffers. The common field sizes are
+      * dispatched to a fixed size copy, which the compiler turns into plain loads and stores.
+      */
+    inline void
+    copyStrided (uint8_t* dst, size_t dst_step, const uint8_t* src, size_t src_step, size_t n, size_t size)
+    {
+      switch (size)
+      {
+        case 1:  copyStrided<1>  (dst, dst_step, src, src_step, n); break;
+        case 2:  copyStrided<2>  (dst, dst_step, src, src_step, n); break;
+        case 4:  copyStrided<4>  (dst, dst_step, src, src_step, n); break;
+        case 8:  copyStrided<8>  (dst, dst_step, src, src_step, n); break;
+        case 12: copyStrided<12> (dst, dst_step, src, src_step, n); break;
+        case 16: copyStrided<16> (dst, dst_step, src, src_step, n); break;
+        case 20: copyStrided<20> (dst, dst_step, src, src_step, n); break;
+        case 24: copyStrided<24> (dst, dst_step, src, src_step, n); break;
+        case 32: copyStrided<32> (dst, dst_step, src, src_step, n); break;
+        default:
+        {
+          for (size_t i = 0; i < n; ++i, dst += dst_step, src += src_step)
+            memcpy (dst, src, size);
+        }
+      }
+    }
+
+    /** \brief Copy the point data of \a msg into \a cloud_data, one group of contiguous fields at a time.
+      * The points are processed in chunks that stay in cache, so that every field group is copied with
+      * a tight strided loop instead of dispatching on the group size for every point.
+      */
+    template <typename PointT> void
+    copyFieldRuns (const pcl::PCLPointCloud2& msg, const MsgFieldMap& field_map, uint8_t* cloud_data)
+    {
+      const uint32_t chunk_size = 256;
+      for (uint32_t row = 0; row < msg.height; ++row)
+      {
+        const uint8_t* row_data = &msg.data[row * msg.row_step];
+        for (uint32_t col = 0; col < msg.width; col += chunk_size)
+        {
+          const uint32_t n = std::min (chunk_size, msg.width - col);
+          const uint8_t* msg_data = row_data + col * msg.point_step;
+          BOOST_FOREACH (const detail::FieldMapping& mapping, field_map)
+          {
+            copyStrided (cloud_data + mapping.struct_offset, sizeof (PointT),
+                         msg_data + mapping.serialized_offset, msg.point_step,
+                         n, mapping.size);
+          }
+          cloud_data += n * sizeof (PointT);
+        }
+      }
+    }
+
   } //namespace detail
 
   template<typename PointT> void
@@ -203,19 +263,7 @@ namespace pcl
     else
     {
       // If not, memcpy each group of contiguous fields separately
-      for (uint32_t row = 0; row < msg.height; ++row)
-      {
-        const uint8_t* row_data = &msg.data[row * msg.row_step];
-        for (uint32_t col = 0; col < msg.width; ++col)
-        {
-          const uint8_t* msg_data = row_data + col * msg.point_step;
-          BOOST_FOREACH (const detail::FieldMapping& mapping, field_map)
-          {
-            memcpy (cloud_data + mapping.struct_offset, msg_data + mapping.serialized_offset, mapping.size);
-          }
-          cloud_data += sizeof (PointT);
-        }
-      }
+      detail::copyFieldRuns<PointT> (msg, field_map, cloud_data);
     }
   }
 
@@ -231,6 +279,99 @@ namespace pcl
     fromPCLPointCloud2 (msg, cloud, field_map);
   }
 
+  /** \brief PCLPointCloud2Converter converts a stream of PCLPointCloud2 messages that share the same schema
+    * into pcl::PointCloud<T> objects.
+    *
+    * fromPCLPointCloud2 (PCLPointCloud2, PointCloud<T>) matches the message fields against the point type
+    * by name and sorts the resulting mapping for every call. The converter keeps the mapping of the last
+    * message and only compares the field descriptions of the next messages with it, rebuilding the mapping
+    * when the schema changes.
+    *
+    * \code
+    * pcl::PCLPointCloud2Converter<pcl::PointXYZ> converter;
+    * while (grabbing)
+    *   converter.fromPCLPointCloud2 (msg, cloud);
+    * \endcode
+    */
+  template <typename PointT>
+  class PCLPointCloud2Converter
+  {
+    public:
+      /** \brief Empty constructor. */
+      PCLPointCloud2Converter () : fields_ (), point_step_ (0), field_map_ (), has_mapping_ (false) {}
+
+      /** \brief Convert a PCLPointCloud2 binary data blob into a pcl::PointCloud<T> object, reusing the
+        * field mapping of the previous call if the message has the same fields.
+        * \param[in] msg the PCLPointCloud2 binary blob
+        * \param[out] cloud the resultant pcl::PointCloud<T>
+        */
+      void
+      fromPCLPointCloud2 (const pcl::PCLPointCloud2& msg, pcl::PointCloud<PointT>& cloud)
+      {
+        if (!isCached (msg))
+          updateMapping (msg);
+        pcl::fromPCLPointCloud2 (msg, cloud, field_map_);
+      }
+
+      /** \brief Get the field mapping used for the last converted message. */
+      inline const MsgFieldMap&
+      getFieldMap () const { return (field_map_); }
+
+      /** \brief Check whether the field mapping of the last converted message can be used for \a msg.
+        * \param[in] msg the PCLPointCloud2 binary blob
+        */
+      bool
+      isCached (const pcl::PCLPointCloud2& msg) const
+      {
+        if (!has_mapping_ || msg.point_step != point_step_ || msg.fields.size () != fields_.size ())
+          return (false);
+        // Compare the numeric parts first, so that the names are only compared for matching schemas
+        for (size_t i = 0; i < fields_.size (); ++i)
+          if (msg.fields[i].offset != fields_[i].offset ||
+              msg.fields[i].datatype != fields_[i].datatype ||
+              msg.fields[i].count != fields_[i].count)
+            return (false);
+        for (size_t i = 0; i < fields_.size (); ++i)
+          if (msg.fields[i].name != fields_[i].name)
+            return (false);
+        return (true);
+      }
+
+      /** \brief Forget the cached field mapping. */
+      void
+      reset ()
+      {
+        fields_.clear ();
+        point_step_ = 0;
+        field_map_.clear ();
+        has_mapping_ = false;
+      }
+
+    private:
+      /** \brief Rebuild the field mapping for the schema of \a msg. */
+      void
+      updateMapping (const pcl::PCLPointCloud2& msg)
+      {
+        field_map_.clear ();
+        createMapping<PointT> (msg.fields, field_map_);
+        fields_ = msg.fields;
+        point_step_ = msg.point_step;
+        has_mapping_ = true;
+      }
+
+      /** \brief The fields of the message the mapping was created for. */
+      std::vector<pcl::PCLPointField> fields_;
+
+      /** \brief The point step of the message the mapping was created for. */
+      uint32_t point_step_;
+
+      /** \brief The coalesced field mapping. */
+      MsgFieldMap field_map_;
+
+      /** \brief Whether field_map_ holds a valid mapping. */
+      bool has_mapping_;
+  };
+
   /** \brief Convert a pcl::PointCloud<T> object to a PCLPointCloud2 binary data blob.
     * \param[in] cloud the input pcl::PointCloud<T>
     * \param[out] msg the resultant PCLPointCloud2 binary blob
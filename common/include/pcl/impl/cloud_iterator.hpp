@@ -324,6 +324,85 @@ namespace pcl
         std::vector<int> indices_;
         std::vector<int>::iterator iterator_;
   };
+
+  /** \brief Iterates over all the points of a PointCloudView, or over the points given by indices. */
+  template <class PointT>
+  class ConstCloudIterator<PointT>::ViewConstIterator : public ConstCloudIterator<PointT>::Iterator
+  {
+    public:
+      ViewConstIterator (const PointCloudView<PointT>& cloud)
+        : points_ (cloud.data ())
+        , indices_ ()
+        , use_indices_ (false)
+        , size_ (cloud.size ())
+        , position_ (0)
+      {
+      }
+
+      ViewConstIterator (const PointCloudView<PointT>& cloud,
+                         const std::vector<int>& indices)
+        : points_ (cloud.data ())
+        , indices_ (indices)
+        , use_indices_ (true)
+        , size_ (indices.size ())
+        , position_ (0)
+      {
+      }
+
+      virtual ~ViewConstIterator () {}
+
+      void operator ++ ()
+      {
+        ++position_;
+      }
+
+      void operator ++ (int)
+      {
+        position_++;
+      }
+
+      const PointT& operator* () const
+      {
+        return (points_[getCurrentPointIndex ()]);
+      }
+
+      const PointT* operator-> () const
+      {
+        return (&points_[getCurrentPointIndex ()]);
+      }
+
+      unsigned getCurrentPointIndex () const
+      {
+        return (use_indices_ ? unsigned (indices_[position_]) : unsigned (position_));
+      }
+
+      unsigned getCurrentIndex () const
+      {
+        return (unsigned (position_));
+      }
+
+      size_t size () const
+      {
+        return (size_);
+      }
+
+      void reset ()
+      {
+        position_ = 0;
+      }
+
+      bool isValid () const
+      {
+        return (position_ < size_);
+      }
+
+    private:
+      const PointT* points_;
+      std::vector<int> indices_;
+      bool use_indices_;
+      size_t size_;
+      size_t position_;
+  };
 } // namespace pcl
 
 //////////////////////////////////////////////////////////////////////////////
@@ -483,6 +562,21 @@ pcl::ConstCloudIterator<PointT>::ConstCloudIterator (
   iterator_ = new typename pcl::ConstCloudIterator<PointT>::ConstIteratorIdx (cloud, indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+template <class PointT>
+pcl::ConstCloudIterator<PointT>::ConstCloudIterator (const PointCloudView<PointT>& cloud)
+  : iterator_ (new typename pcl::ConstCloudIterator<PointT>::ViewConstIterator (cloud))
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////
+template <class PointT>
+pcl::ConstCloudIterator<PointT>::ConstCloudIterator (
+    const PointCloudView<PointT>& cloud, const std::vector<int>& indices)
+  : iterator_ (new typename pcl::ConstCloudIterator<PointT>::ViewConstIterator (cloud, indices))
+{
+}
+
 //////////////////////////////////////////////////////////////////////////////
 template <class PointT>
 pcl::ConstCloudIterator<PointT>::~ConstCloudIterator ()
@@ -0,0 +1,164 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_IMPL_POINT_CLOUD_SOA_HPP_
+#define PCL_IMPL_POINT_CLOUD_SOA_HPP_
+
+#include <pcl/point_types.h>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /* Helpers that copy the optional attributes between a PointT and the streams of a
+     * PointCloudSoA. The specializations for point types without the corresponding
+     * fields are no-ops, so the conversion functions compile for every point type
+     * that has x, y and z. */
+
+    template <typename PointT, bool has_normal = pcl::traits::has_normal<PointT>::value>
+    struct SoANormalCopy
+    {
+      static void load (const PointT &, pcl::PointCloudSoA &, size_t) {}
+      static void store (const pcl::PointCloudSoA &, PointT &, size_t) {}
+    };
+
+    template <typename PointT>
+    struct SoANormalCopy<PointT, true>
+    {
+      static void
+      load (const PointT &p, pcl::PointCloudSoA &cloud, size_t i)
+      {
+        cloud.normal_x[i] = p.normal_x; cloud.normal_y[i] = p.normal_y; cloud.normal_z[i] = p.normal_z;
+      }
+      static void
+      store (const pcl::PointCloudSoA &cloud, PointT &p, size_t i)
+      {
+        p.normal_x = cloud.normal_x[i]; p.normal_y = cloud.normal_y[i]; p.normal_z = cloud.normal_z[i];
+      }
+    };
+
+    template <typename PointT, bool has_color = pcl::traits::has_color<PointT>::value>
+    struct SoAColorCopy
+    {
+      static void load (const PointT &, pcl::PointCloudSoA &, size_t) {}
+      static void store (const pcl::PointCloudSoA &, PointT &, size_t) {}
+    };
+
+    template <typename PointT>
+    struct SoAColorCopy<PointT, true>
+    {
+      static void
+      load (const PointT &p, pcl::PointCloudSoA &cloud, size_t i) { cloud.rgba[i] = p.rgba; }
+      static void
+      store (const pcl::PointCloudSoA &cloud, PointT &p, size_t i) { p.rgba = cloud.rgba[i]; }
+    };
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::toPointCloudSoA (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloudSoA &cloud_out)
+{
+  const size_t n = cloud_in.points.size ();
+  const bool has_normal = pcl::traits::has_normal<PointT>::value;
+  const bool has_color = pcl::traits::has_color<PointT>::value;
+
+  cloud_out.header   = cloud_in.header;
+  cloud_out.width    = cloud_in.width;
+  cloud_out.height   = cloud_in.height;
+  cloud_out.is_dense = cloud_in.is_dense;
+  cloud_out.resize (n, has_normal, has_color);
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    const PointT &p = cloud_in.points[i];
+    cloud_out.x[i] = p.x; cloud_out.y[i] = p.y; cloud_out.z[i] = p.z;
+    detail::SoANormalCopy<PointT>::load (p, cloud_out, i);
+    detail::SoAColorCopy<PointT>::load (p, cloud_out, i);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::toPointCloudSoA (const pcl::PointCloud<PointT> &cloud_in, const std::vector<int> &indices,
+                      pcl::PointCloudSoA &cloud_out)
+{
+  const size_t n = indices.size ();
+  const bool has_normal = pcl::traits::has_normal<PointT>::value;
+  const bool has_color = pcl::traits::has_color<PointT>::value;
+
+  cloud_out.header   = cloud_in.header;
+  cloud_out.width    = static_cast<uint32_t> (n);
+  cloud_out.height   = 1;
+  cloud_out.is_dense = cloud_in.is_dense;
+  cloud_out.resize (n, has_normal, has_color);
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    const PointT &p = cloud_in.points[indices[i]];
+    cloud_out.x[i] = p.x; cloud_out.y[i] = p.y; cloud_out.z[i] = p.z;
+    detail::SoANormalCopy<PointT>::load (p, cloud_out, i);
+    detail::SoAColorCopy<PointT>::load (p, cloud_out, i);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::fromPointCloudSoA (const pcl::PointCloudSoA &cloud_in, pcl::PointCloud<PointT> &cloud_out)
+{
+  const size_t n = cloud_in.size ();
+  const bool copy_normals = cloud_in.hasNormals ();
+  const bool copy_color = cloud_in.hasColor ();
+
+  cloud_out.header   = cloud_in.header;
+  cloud_out.is_dense = cloud_in.is_dense;
+  cloud_out.points.resize (n);
+  cloud_out.width    = cloud_in.width;
+  cloud_out.height   = cloud_in.height;
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    PointT &p = cloud_out.points[i];
+    p.x = cloud_in.x[i]; p.y = cloud_in.y[i]; p.z = cloud_in.z[i];
+    if (copy_normals)
+      detail::SoANormalCopy<PointT>::store (cloud_in, p, i);
+    if (copy_color)
+      detail::SoAColorCopy<PointT>::store (cloud_in, p, i);
+  }
+}
+
+#endif  //#ifndef PCL_IMPL_POINT_CLOUD_SOA_HPP_
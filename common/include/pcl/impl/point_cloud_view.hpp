@@ -0,0 +1,166 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_IMPL_POINT_CLOUD_VIEW_HPP_
+#define PCL_IMPL_POINT_CLOUD_VIEW_HPP_
+
+#include <pcl/point_cloud_view.h>
+#include <pcl/point_traits.h>
+#include <pcl/for_each_type.h>
+#include <boost/type_traits/alignment_of.hpp>
+#include <stdexcept>
+#include <cstring>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Checks that every field of PointT is present in a PCLPointCloud2, at the same offset. */
+    template <typename PointT>
+    struct FieldLayoutMatcher
+    {
+      FieldLayoutMatcher (const std::vector<pcl::PCLPointField> &fields, bool &matches)
+        : fields_ (fields), matches_ (matches) {}
+
+      template <typename Tag> void
+      operator () ()
+      {
+        for (size_t i = 0; i < fields_.size (); ++i)
+        {
+          if (FieldMatches<PointT, Tag> () (fields_[i]))
+          {
+            if (fields_[i].offset != traits::offset<PointT, Tag>::value)
+              matches_ = false;
+            return;
+          }
+        }
+        matches_ = false;
+      }
+
+      const std::vector<pcl::PCLPointField> &fields_;
+      bool &matches_;
+    };
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::PointCloudView<PointT>::isCompatible (const pcl::PCLPointCloud2 &msg)
+{
+  if (msg.point_step != sizeof (PointT))
+    return (false);
+
+  // The points are used as they are, so they have to be stored in the byte order of the host
+  const pcl::uint16_t byte_order = 1;
+  const bool host_is_bigendian = (*reinterpret_cast<const pcl::uint8_t*> (&byte_order) == 0);
+  if ((msg.is_bigendian != 0) != host_is_bigendian)
+    return (false);
+
+  const size_t nr_points = static_cast<size_t> (msg.width) * msg.height;
+  if (nr_points == 0)
+    return (true);
+
+  // The rows have to follow each other without padding
+  if (msg.height > 1 && msg.row_step != msg.width * msg.point_step)
+    return (false);
+  if (msg.data.size () < nr_points * sizeof (PointT))
+    return (false);
+
+  // The buffer has to be aligned as PointT (16 bytes for the SSE aligned point types)
+  if (reinterpret_cast<size_t> (&msg.data[0]) % boost::alignment_of<PointT>::value != 0)
+    return (false);
+
+  bool matches = true;
+  for_each_type<typename traits::fieldList<PointT>::type> (detail::FieldLayoutMatcher<PointT> (msg.fields, matches));
+  return (matches);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::PointCloudView<PointT>::setInput (const pcl::PCLPointCloud2 &msg)
+{
+  reset ();
+  if (!isCompatible (msg))
+    return (false);
+
+  header   = msg.header;
+  width    = msg.width;
+  height   = msg.height;
+  is_dense = msg.is_dense == 1;
+  points_  = size () == 0 ? NULL : reinterpret_cast<const PointT*> (&msg.data[0]);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::PointCloudView<PointT>::setInput (const pcl::PCLPointCloud2ConstPtr &msg)
+{
+  if (!msg || !setInput (*msg))
+  {
+    reset ();
+    return (false);
+  }
+  blob_ = msg;
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PointCloudView<PointT>::reset ()
+{
+  header   = pcl::PCLHeader ();
+  width    = 0;
+  height   = 0;
+  is_dense = true;
+  points_  = NULL;
+  blob_.reset ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PointCloudView<PointT>::toPointCloud (pcl::PointCloud<PointT> &cloud) const
+{
+  cloud.header   = header;
+  cloud.width    = width;
+  cloud.height   = height;
+  cloud.is_dense = is_dense;
+  cloud.points.resize (size ());
+  if (!empty ())
+    memcpy (&cloud.points[0], points_, size () * sizeof (PointT));
+}
+
+#endif  //#ifndef PCL_IMPL_POINT_CLOUD_VIEW_HPP_
@@ -0,0 +1,232 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_POINT_CLOUD_SOA_H_
+#define PCL_POINT_CLOUD_SOA_H_
+
+#include <vector>
+#include <Eigen/StdVector>
+#include <pcl/PCLHeader.h>
+#include <pcl/point_cloud.h>
+
+namespace pcl
+{
+  /** \brief PointCloudSoA stores the geometric and color attributes of a point cloud
+    * as a structure of arrays: every attribute (x, y, z, normal_x, normal_y, normal_z and
+    * the packed rgba value) lives in its own contiguous, 16-byte aligned stream.
+    *
+    * Kernels that only touch a few attributes of each point (rigid transformations,
+    * centroid/covariance accumulation, point-to-model distances) read exactly the bytes
+    * they need from such a layout, and their inner loops can be vectorized by the
+    * compiler without gather instructions. Use \ref toPointCloudSoA and \ref fromPointCloudSoA
+    * to move data between a PointCloudSoA and a regular pcl::PointCloud<PointT>.
+    *
+    * The xyz streams are always present. The normal and color streams are optional and are
+    * either empty or have the same size as the xyz streams.
+    *
+    * \ingroup common
+    */
+  class PointCloudSoA
+  {
+    public:
+      typedef std::vector<float, Eigen::aligned_allocator<float> > Stream;
+      typedef std::vector<uint32_t, Eigen::aligned_allocator<uint32_t> > ColorStream;
+
+      typedef boost::shared_ptr<PointCloudSoA> Ptr;
+      typedef boost::shared_ptr<const PointCloudSoA> ConstPtr;
+
+      /** \brief Default constructor. Sets \ref is_dense to true, \ref width and \ref height to 0. */
+      PointCloudSoA () :
+        header (), x (), y (), z (), normal_x (), normal_y (), normal_z (), rgba (),
+        width (0), height (0), is_dense (true)
+      {}
+
+      /** \brief Allocate a cloud with n points.
+        * \param[in] n the number of points
+        * \param[in] with_normals allocate the normal streams
+        * \param[in] with_color allocate the color stream
+        */
+      PointCloudSoA (size_t n, bool with_normals = false, bool with_color = false) :
+        header (), x (), y (), z (), normal_x (), normal_y (), normal_z (), rgba (),
+        width (0), height (0), is_dense (true)
+      {
+        resize (n, with_normals, with_color);
+      }
+
+      /** \brief Resize all the streams of the cloud. The cloud is made unorganized unless
+        * width * height already equals n.
+        * \param[in] n the new number of points
+        * \param[in] with_normals keep (or allocate) the normal streams
+        * \param[in] with_color keep (or allocate) the color stream
+        */
+      inline void
+      resize (size_t n, bool with_normals, bool with_color)
+      {
+        x.resize (n); y.resize (n); z.resize (n);
+        if (with_normals)
+        {
+          normal_x.resize (n); normal_y.resize (n); normal_z.resize (n);
+        }
+        else
+        {
+          normal_x.clear (); normal_y.clear (); normal_z.clear ();
+        }
+        if (with_color)
+          rgba.resize (n);
+        else
+          rgba.clear ();
+
+        if (static_cast<size_t> (width) * height != n)
+        {
+          width = static_cast<uint32_t> (n);
+          height = 1;
+        }
+      }
+
+      /** \brief Resize the cloud, keeping the set of optional streams that is currently allocated.
+        * \param[in] n the new number of points
+        */
+      inline void
+      resize (size_t n)
+      {
+        resize (n, hasNormals (), hasColor ());
+      }
+
+      /** \brief Remove all points and release the optional streams. */
+      inline void
+      clear ()
+      {
+        resize (0, false, false);
+        width = height = 0;
+      }
+
+      /** \brief Return the number of points in the cloud. */
+      inline size_t
+      size () const { return (x.size ()); }
+
+      /** \brief Return true if the cloud has no points. */
+      inline bool
+      empty () const { return (x.empty ()); }
+
+      /** \brief Return true if the normal streams are allocated. */
+      inline bool
+      hasNormals () const { return (!x.empty () && normal_x.size () == x.size ()); }
+
+      /** \brief Return true if the color stream is allocated. */
+      inline bool
+      hasColor () const { return (!x.empty () && rgba.size () == x.size ()); }
+
+      /** \brief Return whether the cloud is organized (e.g., arranged in a structured grid). */
+      inline bool
+      isOrganized () const { return (height > 1); }
+
+      /** \brief Return an Eigen vector holding the coordinates of the n-th point. */
+      inline Eigen::Vector3f
+      getVector3f (size_t n) const { return (Eigen::Vector3f (x[n], y[n], z[n])); }
+
+      /** \brief Return an Eigen vector holding the normal of the n-th point. */
+      inline Eigen::Vector3f
+      getNormalVector3f (size_t n) const { return (Eigen::Vector3f (normal_x[n], normal_y[n], normal_z[n])); }
+
+      /** \brief The point cloud header. */
+      pcl::PCLHeader header;
+
+      /** \brief The X coordinate stream. */
+      Stream x;
+      /** \brief The Y coordinate stream. */
+      Stream y;
+      /** \brief The Z coordinate stream. */
+      Stream z;
+
+      /** \brief The normal X component stream (empty if the cloud has no normals). */
+      Stream normal_x;
+      /** \brief The normal Y component stream (empty if the cloud has no normals). */
+      Stream normal_y;
+      /** \brief The normal Z component stream (empty if the cloud has no normals). */
+      Stream normal_z;
+
+      /** \brief The packed ARGB stream, same layout as the rgba field of the point types (empty if the cloud has no color). */
+      ColorStream rgba;
+
+      /** \brief The point cloud width (if organized as an image-structure). */
+      uint32_t width;
+      /** \brief The point cloud height (if organized as an image-structure). */
+      uint32_t height;
+
+      /** \brief True if no points are invalid (e.g., have NaN or Inf values). */
+      bool is_dense;
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /** \brief Convert a pcl::PointCloud<PointT> into a structure of arrays representation.
+    * The normal and color streams of the output are filled if and only if PointT has
+    * normal, respectively rgb/rgba fields.
+    * \param[in] cloud_in the input point cloud
+    * \param[out] cloud_out the resultant structure of arrays cloud
+    * \ingroup common
+    */
+  template <typename PointT> void
+  toPointCloudSoA (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloudSoA &cloud_out);
+
+  /** \brief Convert a subset of a pcl::PointCloud<PointT> into a structure of arrays representation.
+    * \param[in] cloud_in the input point cloud
+    * \param[in] indices the indices of the points to convert
+    * \param[out] cloud_out the resultant (unorganized) structure of arrays cloud
+    * \ingroup common
+    */
+  template <typename PointT> void
+  toPointCloudSoA (const pcl::PointCloud<PointT> &cloud_in, const std::vector<int> &indices,
+                   pcl::PointCloudSoA &cloud_out);
+
+  /** \brief Write the streams of a structure of arrays cloud back into a pcl::PointCloud<PointT>.
+    * Fields of PointT that have no corresponding stream in the input are left untouched if
+    * cloud_out already has the right size, and default initialized otherwise. This makes it
+    * possible to process the xyz data of a cloud in SoA form and scatter it back into the
+    * original cloud without losing its other fields.
+    * \param[in] cloud_in the input structure of arrays cloud
+    * \param[out] cloud_out the resultant point cloud
+    * \ingroup common
+    */
+  template <typename PointT> void
+  fromPointCloudSoA (const pcl::PointCloudSoA &cloud_in, pcl::PointCloud<PointT> &cloud_out);
+}
+
+#include <pcl/impl/point_cloud_soa.hpp>
+
+#endif  //#ifndef PCL_POINT_CLOUD_SOA_H_
@@ -0,0 +1,175 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_POINT_CLOUD_VIEW_H_
+#define PCL_POINT_CLOUD_VIEW_H_
+
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/point_cloud.h>
+#include <pcl/exceptions.h>
+
+namespace pcl
+{
+  /** \brief PointCloudView is a read-only, non-owning typed view of the points serialized in a PCLPointCloud2.
+    *
+    * fromPCLPointCloud2 always copies the data blob into a new PointCloud. When the binary layout of the blob is
+    * exactly the one of PointT (one contiguous field mapping at offset 0, point_step equal to sizeof (PointT), no
+    * padding between rows, and a buffer aligned for PointT), a PointCloudView can alias the blob instead:
+    *
+    * \code
+    * pcl::PointCloudView<pcl::PointXYZ> view;
+    * if (view.setInput (msg))
+    *   pcl::compute3DCentroid (pcl::ConstCloudIterator<pcl::PointXYZ> (view), centroid);
+    * else
+    *   pcl::fromPCLPointCloud2 (*msg, cloud);  // layouts differ, a copy is required
+    * \endcode
+    *
+    * The view mirrors the read interface of pcl::PointCloud (operator[], at (), begin (), end (), size (),
+    * header, width, height, is_dense), so templated code written against it works on both, and it can be
+    * traversed with a ConstCloudIterator.
+    * \note When the blob is given as a shared pointer the view keeps it alive; when it is given by reference,
+    * it must outlive the view and must not be modified while it is viewed.
+    * \ingroup common
+    */
+  template <typename PointT>
+  class PointCloudView
+  {
+    public:
+      typedef PointT PointType;
+      typedef const PointT* const_iterator;
+      typedef boost::shared_ptr<PointCloudView<PointT> > Ptr;
+      typedef boost::shared_ptr<const PointCloudView<PointT> > ConstPtr;
+
+      /** \brief Default constructor. Creates an empty view. */
+      PointCloudView () : header (), width (0), height (0), is_dense (true), points_ (NULL), blob_ () {}
+
+      /** \brief Check whether the points of a PCLPointCloud2 can be viewed as PointT without a copy: same point
+        * size and field offsets, dense rows, an aligned buffer, and the byte order of the host (see is_bigendian).
+        * \param[in] msg the PCLPointCloud2 binary blob
+        */
+      static bool
+      isCompatible (const pcl::PCLPointCloud2 &msg);
+
+      /** \brief Attach the view to a PCLPointCloud2, if its layout matches PointT.
+        * \param[in] msg the PCLPointCloud2 binary blob, which has to outlive the view
+        * \return true if the view was attached, false (and an empty view) if the points have to be converted
+        * with fromPCLPointCloud2 instead
+        */
+      bool
+      setInput (const pcl::PCLPointCloud2 &msg);
+
+      /** \brief Attach the view to a PCLPointCloud2, if its layout matches PointT. The view shares the
+        * ownership of the blob.
+        * \param[in] msg the PCLPointCloud2 binary blob
+        * \return true if the view was attached, false (and an empty view) if the points have to be converted
+        * with fromPCLPointCloud2 instead
+        */
+      bool
+      setInput (const pcl::PCLPointCloud2ConstPtr &msg);
+
+      /** \brief Detach the view from its blob. */
+      void
+      reset ();
+
+      /** \brief Return whether the view is organized (e.g., arranged in a structured grid). */
+      inline bool
+      isOrganized () const { return (height > 1); }
+
+      /** \brief Obtain the point given by the (column, row) coordinates. Only works on organized views.
+        * \param[in] column the column coordinate
+        * \param[in] row the row coordinate
+        */
+      inline const PointT&
+      at (int column, int row) const
+      {
+        if (this->height > 1)
+          return (at (row * this->width + column));
+        else
+          throw IsNotDenseException ("Can't use 2D indexing with a unorganized point cloud");
+      }
+
+      /** \brief Obtain the point given by the (column, row) coordinates, without range checking.
+        * \param[in] column the column coordinate
+        * \param[in] row the row coordinate
+        */
+      inline const PointT&
+      operator () (size_t column, size_t row) const { return (points_[row * this->width + column]); }
+
+      inline const PointT& operator[] (size_t n) const { return (points_[n]); }
+      inline const PointT&
+      at (size_t n) const
+      {
+        if (n >= size ())
+          throw std::out_of_range ("pcl::PointCloudView::at");
+        return (points_[n]);
+      }
+
+      inline const_iterator begin () const { return (points_); }
+      inline const_iterator end () const { return (points_ + size ()); }
+      inline size_t size () const { return (static_cast<size_t> (width) * height); }
+      inline bool empty () const { return (size () == 0); }
+
+      /** \brief Return a pointer to the first viewed point. */
+      inline const PointT* data () const { return (points_); }
+
+      /** \brief Copy the viewed points into a pcl::PointCloud, for algorithms which need to own their input. */
+      void
+      toPointCloud (pcl::PointCloud<PointT> &cloud) const;
+
+      /** \brief The point cloud header. It contains information about the acquisition time. */
+      pcl::PCLHeader header;
+
+      /** \brief The point cloud width (if organized as an image-structure). */
+      uint32_t width;
+      /** \brief The point cloud height (if organized as an image-structure). */
+      uint32_t height;
+
+      /** \brief True if no points are invalid (e.g., have NaN or Inf values). */
+      bool is_dense;
+
+    private:
+      /** \brief The viewed points, inside the data blob of a PCLPointCloud2. */
+      const PointT *points_;
+
+      /** \brief The viewed blob, if the view shares its ownership. */
+      pcl::PCLPointCloud2ConstPtr blob_;
+  };
+}
+
+#include <pcl/impl/point_cloud_view.hpp>
+
+#endif  //#ifndef PCL_POINT_CLOUD_VIEW_H_
@@ -41,6 +41,9 @@
 
 #include <pcl/pcl_macros.h>
 #include <pcl/common/distances.h>
+#include <pcl/common/parallel.h>
+#include <algorithm>
+#include <vector>
 
 namespace pcl
 {
@@ -225,6 +228,118 @@ RangeImage::createFromPointCloudWithViewpoints (const PointCloudTypeWithViewpoin
                         sensor_pose, coordinate_frame, noise_level, min_range, border_size);
 }
 
+namespace detail
+{
+  /** \brief The position of a point of the input cloud in a range image, see RangeImage::doZBuffer. */
+  struct RangeImageProjection
+  {
+    float x_real, y_real, range;
+    /** \brief The pixel of the point, x is -1 if the point is not used. */
+    int x, y;
+  };
+
+  /** \brief Get the first and the last band of image rows a projected point updates in the z-buffer: the rows of
+    * the point and of the neighbors interpolated by RangeImage::doZBuffer, which are at most one row apart.
+    * \param[in] p the projected point, in the image
+    * \param[in] row_band the band of every image row
+    * \param[out] first_band the band of the topmost row updated by the point
+    * \param[out] last_band the band of the bottommost row updated by the point
+    */
+  inline void
+  getZBufferBands (const RangeImageProjection &p, const std::vector<int> &row_band, int &first_band, int &last_band)
+  {
+    const int last_row = static_cast<int> (row_band.size ()) - 1;
+    const int floor_y = pcl_lrint (floor (p.y_real)), ceil_y = pcl_lrint (ceil (p.y_real));
+    first_band = row_band[(std::max) ((std::min) (floor_y, p.y), 0)];
+    last_band  = row_band[(std::min) ((std::max) (ceil_y, p.y), last_row)];
+  }
+
+  /** \brief Apply the z-buffer updates of the given projected points that fall into the rows [row_begin, row_end)
+    * of the range image, in the order of the points. Every update only reads and writes the pixel it targets,
+    * so the image rows can be processed independently and the result is the same as for a single pass.
+    * \param[in] point_indices the indices of the projected points to use, all of them if NULL
+    */
+  inline void
+  zBufferRows (RangeImage &range_image, const std::vector<RangeImageProjection> &projections,
+               const int *point_indices, int nr_point_indices, int *counters,
+               float noise_level, int row_begin, int row_end, int& top, int& right, int& bottom, int& left)
+  {
+    const int width = static_cast<int> (range_image.width);
+    for (int i = 0; i < nr_point_indices; ++i)
+    {
+      const RangeImageProjection &p = projections[point_indices ? point_indices[i] : i];
+      if (p.x < 0)
+        continue;
+      const int x = p.x, y = p.y;
+      const float range_of_current_point = p.range;
+
+      // Do some minor interpolation by checking the three closest neighbors to the point, that are not filled yet.
+      int floor_x = pcl_lrint (floor (p.x_real)), floor_y = pcl_lrint (floor (p.y_real)),
+          ceil_x  = pcl_lrint (ceil (p.x_real)),  ceil_y  = pcl_lrint (ceil (p.y_real));
+
+      int neighbor_x[4], neighbor_y[4];
+      neighbor_x[0]=floor_x; neighbor_y[0]=floor_y;
+      neighbor_x[1]=floor_x; neighbor_y[1]=ceil_y;
+      neighbor_x[2]=ceil_x;  neighbor_y[2]=floor_y;
+      neighbor_x[3]=ceil_x;  neighbor_y[3]=ceil_y;
+
+      for (int n=0; n<4; ++n)
+      {
+        int n_x=neighbor_x[n], n_y=neighbor_y[n];
+        if (n_x==x && n_y==y)
+          continue;
+        if (n_y >= row_begin && n_y < row_end && range_image.isInImage (n_x, n_y))
+        {
+          int neighbor_array_pos = n_y*width + n_x;
+          if (counters[neighbor_array_pos]==0)
+          {
+            float& neighbor_range = range_image.points[neighbor_array_pos].range;
+            neighbor_range = (pcl_isinf (neighbor_range) ? range_of_current_point : (std::min) (neighbor_range, range_of_current_point));
+            top= (std::min) (top, n_y); right= (std::max) (right, n_x); bottom= (std::max) (bottom, n_y); left= (std::min) (left, n_x);
+          }
+        }
+      }
+
+      if (y < row_begin || y >= row_end)
+        continue;
+
+      // The point itself
+      int arrayPos = y*width + x;
+      float& range_at_image_point = range_image.points[arrayPos].range;
+      int& counter = counters[arrayPos];
+      bool addCurrentPoint=false, replace_with_current_point=false;
+
+      if (counter==0)
+      {
+        replace_with_current_point = true;
+      }
+      else
+      {
+        if (range_of_current_point < range_at_image_point-noise_level)
+        {
+          replace_with_current_point = true;
+        }
+        else if (fabs (range_of_current_point-range_at_image_point)<=noise_level)
+        {
+          addCurrentPoint = true;
+        }
+      }
+
+      if (replace_with_current_point)
+      {
+        counter = 1;
+        range_at_image_point = range_of_current_point;
+        top= (std::min) (top, y); right= (std::max) (right, x); bottom= (std::max) (bottom, y); left= (std::min) (left, x);
+      }
+      else if (addCurrentPoint)
+      {
+        ++counter;
+        range_at_image_point += (range_of_current_point-range_at_image_point)/counter;
+      }
+    }
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////
 template <typename PointCloudType> void 
 RangeImage::doZBuffer (const PointCloudType& point_cloud, float noise_level, float min_range, int& top, int& right, int& bottom, int& left)
@@ -238,85 +353,92 @@ RangeImage::doZBuffer (const PointCloudType& point_cloud, float noise_level, flo
   
   top=height; right=-1; bottom=-1; left=width;
   
-  float x_real, y_real, range_of_current_point;
-  int x, y;
-  for (typename pcl::PointCloud<PointType2>::VectorType::const_iterator it=points2.begin (); it!=points2.end (); ++it)
+  // Small clouds are not worth starting the threads for
+  const int nr_points = static_cast<int> (points2.size ());
+  const pcl::parallel::ThreadReservation reservation (
+      nr_points < 10000 ? 1u : static_cast<unsigned int> ((std::max) (max_no_of_threads, 0)));
+  const int threads = static_cast<int> (reservation.getNumberOfThreads ());
+
+  // Project all the points into the image first, this is where most of the time is spent
+  std::vector<detail::RangeImageProjection> projections (nr_points);
+#pragma omp parallel for num_threads(threads) schedule(static) if (threads > 1)
+  for (int i = 0; i < nr_points; ++i)
   {
-    if (!isFinite (*it))  // Check for NAN etc
+    detail::RangeImageProjection &projection = projections[i];
+    projection.x = -1;
+    if (!isFinite (points2[i]))  // Check for NAN etc
       continue;
-    Vector3fMapConst current_point = it->getVector3fMap ();
+    Vector3fMapConst current_point = points2[i].getVector3fMap ();
     
-    this->getImagePoint (current_point, x_real, y_real, range_of_current_point);
-    this->real2DToInt2D (x_real, y_real, x, y);
+    this->getImagePoint (current_point, projection.x_real, projection.y_real, projection.range);
+    int x, y;
+    this->real2DToInt2D (projection.x_real, projection.y_real, x, y);
     
-    if (range_of_current_point < min_range|| !isInImage (x, y))
+    if (projection.range < min_range || !isInImage (x, y))
       continue;
-    //std::cout << " ("<<current_point[0]<<", "<<current_point[1]<<", "<<current_point[2]<<") falls into pixel "<<x<<","<<y<<".\n";
-    
-    // Do some minor interpolation by checking the three closest neighbors to the point, that are not filled yet.
-    int floor_x = pcl_lrint (floor (x_real)), floor_y = pcl_lrint (floor (y_real)),
-        ceil_x  = pcl_lrint (ceil (x_real)),  ceil_y  = pcl_lrint (ceil (y_real));
-    
-    int neighbor_x[4], neighbor_y[4];
-    neighbor_x[0]=floor_x; neighbor_y[0]=floor_y;
-    neighbor_x[1]=floor_x; neighbor_y[1]=ceil_y;
-    neighbor_x[2]=ceil_x;  neighbor_y[2]=floor_y;
-    neighbor_x[3]=ceil_x;  neighbor_y[3]=ceil_y;
-    //std::cout << x_real<<","<<y_real<<": ";
-    
-    for (int i=0; i<4; ++i)
-    {
-      int n_x=neighbor_x[i], n_y=neighbor_y[i];
-      //std::cout << n_x<<","<<n_y<<" ";
-      if (n_x==x && n_y==y)
-        continue;
-      if (isInImage (n_x, n_y))
-      {
-        int neighbor_array_pos = n_y*width + n_x;
-        if (counters[neighbor_array_pos]==0)
-        {
-          float& neighbor_range = points[neighbor_array_pos].range;
-          neighbor_range = (pcl_isinf (neighbor_range) ? range_of_current_point : (std::min) (neighbor_range, range_of_current_point));
-          top= (std::min) (top, n_y); right= (std::max) (right, n_x); bottom= (std::max) (bottom, n_y); left= (std::min) (left, n_x);
-        }
-      }
-    }
-    //std::cout <<std::endl;
-    
-    // The point itself
-    int arrayPos = y*width + x;
-    float& range_at_image_point = points[arrayPos].range;
-    int& counter = counters[arrayPos];
-    bool addCurrentPoint=false, replace_with_current_point=false;
-    
-    if (counter==0)
-    {
-      replace_with_current_point = true;
-    }
+    projection.x = x;
+    projection.y = y;
+  }
+
+  // Then fill the z-buffer, each thread taking care of a band of image rows
+  const int nr_bands = (std::min) (threads, static_cast<int> (height));
+  std::vector<int> band_rows (nr_bands + 1), row_band (height);
+  for (int band = 0; band <= nr_bands; ++band)
+    band_rows[band] = static_cast<int> (static_cast<long long> (height) * band / nr_bands);
+  for (int band = 0; band < nr_bands; ++band)
+    std::fill (row_band.begin () + band_rows[band], row_band.begin () + band_rows[band + 1], band);
+
+  // Bucket the points by the bands they update, in their order, so that every thread only goes through its own
+  // points: count them per band, then scatter their indices. A point next to the border of a band updates both.
+  std::vector<int> band_offsets (nr_bands + 1, 0);
+  int first_band, last_band;
+  for (int i = 0; i < nr_points && nr_bands > 1; ++i)
+  {
+    if (projections[i].x < 0)
+      continue;
+    detail::getZBufferBands (projections[i], row_band, first_band, last_band);
+    ++band_offsets[first_band + 1];
+    if (last_band != first_band)
+      ++band_offsets[last_band + 1];
+  }
+  for (int band = 0; band < nr_bands; ++band)
+    band_offsets[band + 1] += band_offsets[band];
+  std::vector<int> band_points ((std::max) (band_offsets[nr_bands], 1));
+  std::vector<int> band_positions (band_offsets.begin (), band_offsets.end () - 1);
+  for (int i = 0; i < nr_points && nr_bands > 1; ++i)
+  {
+    if (projections[i].x < 0)
+      continue;
+    detail::getZBufferBands (projections[i], row_band, first_band, last_band);
+    band_points[band_positions[first_band]++] = i;
+    if (last_band != first_band)
+      band_points[band_positions[last_band]++] = i;
+  }
+
+  std::vector<int> band_bounds (4 * nr_bands);
+#pragma omp parallel for num_threads(threads) schedule(static) if (nr_bands > 1)
+  for (int band = 0; band < nr_bands; ++band)
+  {
+    int band_top = height, band_right = -1, band_bottom = -1, band_left = width;
+    // A single band simply goes through all the points
+    if (nr_bands == 1)
+      detail::zBufferRows (*this, projections, NULL, nr_points, counters, noise_level,
+                           band_rows[band], band_rows[band + 1], band_top, band_right, band_bottom, band_left);
     else
-    {
-      if (range_of_current_point < range_at_image_point-noise_level)
-      {
-        replace_with_current_point = true;
-      }
-      else if (fabs (range_of_current_point-range_at_image_point)<=noise_level)
-      {
-        addCurrentPoint = true;
-      }
-    }
-    
-    if (replace_with_current_point)
-    {
-      counter = 1;
-      range_at_image_point = range_of_current_point;
-      top= (std::min) (top, y); right= (std::max) (right, x); bottom= (std::max) (bottom, y); left= (std::min) (left, x);
-      //std::cout << "Adding point "<<x<<","<<y<<"\n";
-    }
-    else if (addCurrentPoint)
-    {
-      ++counter;
-      range_at_image_point += (range_of_current_point-range_at_image_point)/counter;
-    }
+      detail::zBufferRows (*this, projections, &band_points[band_offsets[band]],
+                           band_offsets[band + 1] - band_offsets[band], counters, noise_level,
+                           band_rows[band], band_rows[band + 1], band_top, band_right, band_bottom, band_left);
+    band_bounds[4 * band]     = band_top;
+    band_bounds[4 * band + 1] = band_right;
+    band_bounds[4 * band + 2] = band_bottom;
+    band_bounds[4 * band + 3] = band_left;
+  }
+  for (int band = 0; band < nr_bands; ++band)
+  {
+    top    = (std::min) (top,    band_bounds[4 * band]);
+    right  = (std::max) (right,  band_bounds[4 * band + 1]);
+    bottom = (std::max) (bottom, band_bounds[4 * band + 2]);
+    left   = (std::min) (left,   band_bounds[4 * band + 3]);
   }
   
   delete[] counters;
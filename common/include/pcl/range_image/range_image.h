@@ -307,6 +307,8 @@ namespace pcl
         * \param bottom returns the maximum y pixel position in the image where a point was added
         * \param top returns the minimum y position in the image where a point was added
         * \param left   returns the minimum x pixel position in the image where a point was added
+        * \note For large clouds up to max_no_of_threads threads are used. The result does not depend on the number
+        * of threads.
         */
       template <typename PointCloudType> void
       doZBuffer (const PointCloudType& point_cloud, float noise_level,
@@ -0,0 +1,188 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/morton.h>
+#include <pcl/common/parallel.h>
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+  const int radix_bits = 11;
+  const int radix_size = 1 << radix_bits;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::sortMortonCodes (std::vector<uint64_t> &codes, std::vector<int> &order, unsigned int nr_threads)
+{
+  const size_t nr_codes = codes.size ();
+  order.resize (nr_codes);
+  for (size_t i = 0; i < nr_codes; ++i)
+    order[i] = static_cast<int> (i);
+  if (nr_codes < 2)
+    return;
+
+  // Each thread counts and scatters a contiguous chunk of the codes, which keeps the sort stable
+  const pcl::parallel::ThreadReservation reservation (nr_codes < 65536 ? 1u : nr_threads);
+  const int nr_chunks = static_cast<int> (reservation.getNumberOfThreads ());
+  std::vector<size_t> histograms (static_cast<size_t> (nr_chunks) * radix_size);
+  std::vector<uint64_t> codes_tmp (nr_codes);
+  std::vector<int> order_tmp (nr_codes);
+
+  for (int shift = 0; shift < 64; shift += radix_bits)
+  {
+    std::fill (histograms.begin (), histograms.end (), 0);
+#pragma omp parallel for num_threads(nr_chunks) schedule(static, 1) if (nr_chunks > 1)
+    for (int chunk = 0; chunk < nr_chunks; ++chunk)
+    {
+      size_t *histogram = &histograms[static_cast<size_t> (chunk) * radix_size];
+      const size_t begin = nr_codes * chunk / nr_chunks, end = nr_codes * (chunk + 1) / nr_chunks;
+      for (size_t i = begin; i < end; ++i)
+        ++histogram[(codes[i] >> shift) & (radix_size - 1)];
+    }
+
+    // Nothing to do when all the codes have the same digit
+    bool single_digit = false;
+    for (int digit = 0; digit < radix_size && !single_digit; ++digit)
+    {
+      size_t count = 0;
+      for (int chunk = 0; chunk < nr_chunks; ++chunk)
+        count += histograms[static_cast<size_t> (chunk) * radix_size + digit];
+      single_digit = count == nr_codes;
+    }
+    if (single_digit)
+      continue;
+
+    // Turn the counts into the output position of the first code of each digit in each chunk
+    size_t offset = 0;
+    for (int digit = 0; digit < radix_size; ++digit)
+    {
+      for (int chunk = 0; chunk < nr_chunks; ++chunk)
+      {
+        size_t &count = histograms[static_cast<size_t> (chunk) * radix_size + digit];
+        const size_t next = offset + count;
+        count = offset;
+        offset = next;
+      }
+    }
+
+#pragma omp parallel for num_threads(nr_chunks) schedule(static, 1) if (nr_chunks > 1)
+    for (int chunk = 0; chunk < nr_chunks; ++chunk)
+    {
+      size_t *position = &histograms[static_cast<size_t> (chunk) * radix_size];
+      const size_t begin = nr_codes * chunk / nr_chunks, end = nr_codes * (chunk + 1) / nr_chunks;
+      for (size_t i = begin; i < end; ++i)
+      {
+        const size_t target = position[(codes[i] >> shift) & (radix_size - 1)]++;
+        codes_tmp[target] = codes[i];
+        order_tmp[target] = order[i];
+      }
+    }
+    codes.swap (codes_tmp);
+    order.swap (order_tmp);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::computeMortonOrder (const float *points, size_t nr_points, size_t stride, size_t dimensions,
+                         std::vector<int> &order, unsigned int nr_threads)
+{
+  if (nr_points == 0)
+  {
+    order.clear ();
+    return;
+  }
+  dimensions = std::min (dimensions, size_t (3));
+  const int n = static_cast<int> (nr_points);
+
+  // Bounding box of the finite points
+  float min_pt[3], max_pt[3];
+  for (size_t d = 0; d < 3; ++d)
+  {
+    min_pt[d] = std::numeric_limits<float>::max ();
+    max_pt[d] = -std::numeric_limits<float>::max ();
+  }
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+    const float *p = points + i * stride;
+    bool finite = true;
+    for (size_t d = 0; d < dimensions; ++d)
+      finite = finite && pcl_isfinite (p[d]);
+    if (!finite)
+      continue;
+    for (size_t d = 0; d < dimensions; ++d)
+    {
+      min_pt[d] = std::min (min_pt[d], p[d]);
+      max_pt[d] = std::max (max_pt[d], p[d]);
+    }
+  }
+
+  // The curve spans the bounding cube, so that it has the same resolution along all the axes
+  float extent = 0.0f;
+  for (size_t d = 0; d < dimensions; ++d)
+    extent = std::max (extent, max_pt[d] - min_pt[d]);
+  const float max_cell = static_cast<float> ((1 << 21) - 1);
+  const float scale = extent > 0.0f ? max_cell / extent : 0.0f;
+
+  std::vector<uint64_t> codes (nr_points);
+  {
+    // the threads are given back before the sort reserves its own
+    const pcl::parallel::ThreadReservation reservation (n > 100000 ? nr_threads : 1u);
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ()) schedule(static) if (n > 100000)
+    for (int i = 0; i < n; ++i)
+    {
+      const float *p = points + static_cast<size_t> (i) * stride;
+      uint32_t cell[3] = {0, 0, 0};
+      bool finite = true;
+      for (size_t d = 0; d < dimensions; ++d)
+      {
+        if (!pcl_isfinite (p[d]))
+        {
+          finite = false;
+          break;
+        }
+        cell[d] = static_cast<uint32_t> (std::min ((p[d] - min_pt[d]) * scale, max_cell));
+      }
+      // Non finite points get a code larger than any valid one
+      codes[i] = finite ? encodeMorton3D (cell[0], cell[1], cell[2]) : std::numeric_limits<uint64_t>::max ();
+    }
+  }
+
+  sortMortonCodes (codes, order, nr_threads);
+}
@@ -0,0 +1,135 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/parallel.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+  /** \brief Read the initial thread budget from the PCL_NUM_THREADS environment variable. */
+  unsigned int
+  getDefaultMaxThreads ()
+  {
+    const char *value = std::getenv ("PCL_NUM_THREADS");
+    if (!value)
+      return (0);
+    const int nr_threads = std::atoi (value);
+    return (nr_threads > 0 ? static_cast<unsigned int> (nr_threads) : 0);
+  }
+
+  std::atomic<unsigned int> max_threads (getDefaultMaxThreads ());
+
+  /** \brief The number of threads reserved by the running parallel regions. */
+  std::atomic<unsigned int> reserved_threads (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::parallel::setMaxThreads (unsigned int nr_threads)
+{
+  max_threads = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int
+pcl::parallel::getMaxThreads ()
+{
+#ifdef _OPENMP
+  const unsigned int nr_threads = max_threads;
+  if (nr_threads == 0)
+    return (static_cast<unsigned int> (omp_get_num_procs ()));
+  return (nr_threads);
+#else
+  return (1);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int
+pcl::parallel::getNumberOfThreads (unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  if (omp_in_parallel ())
+    return (1);
+  const unsigned int budget = getMaxThreads ();
+  if (nr_threads == 0 || nr_threads > budget)
+    return (budget);
+  return (nr_threads);
+#else
+  (void) nr_threads;
+  return (1);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::parallel::ThreadReservation::ThreadReservation (unsigned int nr_threads) :
+  nr_threads_ (1), reserved_ (0)
+{
+#ifdef _OPENMP
+  // nested regions run in the calling thread, which the enclosing region holds already
+  if (omp_in_parallel ())
+    return;
+
+  const unsigned int requested = pcl::parallel::getNumberOfThreads (nr_threads);
+  const unsigned int budget = getMaxThreads ();
+  unsigned int in_use = reserved_threads.load ();
+  unsigned int granted;
+  do
+  {
+    const unsigned int available = in_use < budget ? budget - in_use : 0;
+    granted = std::max (1u, std::min (requested, available));
+  }
+  while (!reserved_threads.compare_exchange_weak (in_use, in_use + granted));
+
+  nr_threads_ = reserved_ = granted;
+#else
+  (void) nr_threads;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::parallel::ThreadReservation::~ThreadReservation ()
+{
+  if (reserved_ > 0)
+    reserved_threads -= reserved_;
+}
@@ -0,0 +1,398 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/profiler.h>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+
+namespace
+{
+  /** \brief A region recorded by a thread, times in nanoseconds. */
+  struct Event
+  {
+    int region;
+    long long start;
+    long long duration;
+    long long self;
+  };
+
+  /** \brief The events recorded by one thread. */
+  struct ThreadEvents
+  {
+    ThreadEvents (unsigned int id) : thread_id (id), mutex (), events (), dropped (0), children (), region_ids () {}
+
+    unsigned int thread_id;
+    /** \brief Guards events and dropped, between the thread recording them and the readers. */
+    boost::mutex mutex;
+    std::vector<Event> events;
+    /** \brief The number of events dropped after reaching the maximum number of events. */
+    size_t dropped;
+    /** \brief Time spent in the nested regions, for each region currently entered. Only used by the thread. */
+    std::vector<long long> children;
+    /** \brief Cache of the identifiers of the names that are not string literals, to avoid locking the registry.
+      * Only used by the thread.
+      */
+    std::map<std::string, int> region_ids;
+  };
+
+  /** \brief The region names and the event buffers of all the threads. */
+  struct Registry
+  {
+    ~Registry ()
+    {
+      for (size_t i = 0; i < threads.size (); ++i)
+        delete threads[i];
+    }
+
+    /** \brief Guards names, ids and threads. Taken before the mutex of a thread when both are needed. */
+    boost::mutex mutex;
+    std::vector<std::string> names;
+    std::map<std::string, int> ids;
+    std::vector<ThreadEvents*> threads;
+  };
+
+  Registry&
+  getRegistry ()
+  {
+    static Registry registry;
+    return (registry);
+  }
+
+  /** \brief The event buffers are owned by the registry, so that they outlive their thread. */
+  void
+  keepThreadEvents (ThreadEvents*) {}
+
+  std::atomic<size_t> max_events (size_t (1) << 20);
+  boost::thread_specific_ptr<ThreadEvents> thread_events (&keepThreadEvents);
+
+  inline long long
+  now ()
+  {
+    return (std::chrono::duration_cast<std::chrono::nanoseconds> (
+              std::chrono::steady_clock::now ().time_since_epoch ()).count ());
+  }
+
+  ThreadEvents&
+  getThreadEvents ()
+  {
+    ThreadEvents *events = thread_events.get ();
+    if (!events)
+    {
+      Registry &registry = getRegistry ();
+      boost::mutex::scoped_lock lock (registry.mutex);
+      events = new ThreadEvents (static_cast<unsigned int> (registry.threads.size ()));
+      registry.threads.push_back (events);
+      thread_events.reset (events);
+    }
+    return (*events);
+  }
+
+  /** \brief Nearest rank percentile of sorted durations, in milliseconds. */
+  inline double
+  percentile (const std::vector<long long> &sorted, double p)
+  {
+    size_t rank = static_cast<size_t> (p * static_cast<double> (sorted.size ()) + 0.5);
+    rank = std::min (std::max (rank, size_t (1)), sorted.size ());
+    return (static_cast<double> (sorted[rank - 1]) * 1e-6);
+  }
+
+  bool
+  compareTotal (const pcl::profiler::RegionStatistics &a, const pcl::profiler::RegionStatistics &b)
+  {
+    return (a.total > b.total);
+  }
+
+  std::string
+  escapeJSON (const std::string &value)
+  {
+    std::string result;
+    for (size_t i = 0; i < value.size (); ++i)
+    {
+      if (value[i] == '"' || value[i] == '\\')
+        result += '\\';
+      result += value[i];
+    }
+    return (result);
+  }
+}
+
+std::atomic<bool> pcl::profiler::detail::enabled (false);
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::profiler::ScopedRegion::enter (int region)
+{
+  ThreadEvents &events = getThreadEvents ();
+  region_ = region;
+  events.children.push_back (0);
+  start_ = now ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::profiler::ScopedRegion::enter (const std::string &name)
+{
+  ThreadEvents &events = getThreadEvents ();
+  std::map<std::string, int>::const_iterator it = events.region_ids.find (name);
+  int region;
+  if (it != events.region_ids.end ())
+    region = it->second;
+  else
+  {
+    region = getRegionId (name);
+    events.region_ids[name] = region;
+  }
+  enter (region);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::profiler::ScopedRegion::leave ()
+{
+  const long long duration = now () - start_;
+  ThreadEvents &events = getThreadEvents ();
+  const long long children = events.children.back ();
+  events.children.pop_back ();
+  if (!events.children.empty ())
+    events.children.back () += duration;
+
+  Event event;
+  event.region = region_;
+  event.start = start_;
+  event.duration = duration;
+  event.self = duration - children;
+
+  // Uncontended unless the events are being read at the same time
+  const size_t max_nr_events = max_events.load (std::memory_order_relaxed);
+  boost::mutex::scoped_lock lock (events.mutex);
+  if (max_nr_events == 0 || events.events.size () < max_nr_events)
+    events.events.push_back (event);
+  else
+    ++events.dropped;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::profiler::setEnabled (bool value)
+{
+  detail::enabled = value;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::profiler::setMaxEventsPerThread (size_t max_nr_events)
+{
+  max_events = max_nr_events;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+size_t
+pcl::profiler::getNumberOfDroppedEvents ()
+{
+  Registry &registry = getRegistry ();
+  boost::mutex::scoped_lock lock (registry.mutex);
+  size_t dropped = 0;
+  for (size_t i = 0; i < registry.threads.size (); ++i)
+  {
+    boost::mutex::scoped_lock thread_lock (registry.threads[i]->mutex);
+    dropped += registry.threads[i]->dropped;
+  }
+  return (dropped);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::profiler::getRegionId (const std::string &name)
+{
+  Registry &registry = getRegistry ();
+  boost::mutex::scoped_lock lock (registry.mutex);
+  std::map<std::string, int>::const_iterator it = registry.ids.find (name);
+  if (it != registry.ids.end ())
+    return (it->second);
+
+  const int id = static_cast<int> (registry.names.size ());
+  registry.names.push_back (name);
+  registry.ids[name] = id;
+  return (id);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::profiler::reset ()
+{
+  Registry &registry = getRegistry ();
+  boost::mutex::scoped_lock lock (registry.mutex);
+  for (size_t i = 0; i < registry.threads.size (); ++i)
+  {
+    boost::mutex::scoped_lock thread_lock (registry.threads[i]->mutex);
+    registry.threads[i]->events.clear ();
+    registry.threads[i]->dropped = 0;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::profiler::getStatistics (std::vector<RegionStatistics> &statistics)
+{
+  Registry &registry = getRegistry ();
+  boost::mutex::scoped_lock lock (registry.mutex);
+
+  std::vector<std::vector<long long> > durations (registry.names.size ());
+  std::vector<long long> self (registry.names.size (), 0);
+  for (size_t t = 0; t < registry.threads.size (); ++t)
+  {
+    boost::mutex::scoped_lock thread_lock (registry.threads[t]->mutex);
+    const std::vector<Event> &events = registry.threads[t]->events;
+    for (size_t i = 0; i < events.size (); ++i)
+    {
+      durations[events[i].region].push_back (events[i].duration);
+      self[events[i].region] += events[i].self;
+    }
+  }
+
+  statistics.clear ();
+  for (size_t r = 0; r < durations.size (); ++r)
+  {
+    std::vector<long long> &region_durations = durations[r];
+    if (region_durations.empty ())
+      continue;
+    std::sort (region_durations.begin (), region_durations.end ());
+
+    RegionStatistics region;
+    region.name = registry.names[r];
+    region.calls = region_durations.size ();
+    long long total = 0;
+    for (size_t i = 0; i < region_durations.size (); ++i)
+      total += region_durations[i];
+    region.total = static_cast<double> (total) * 1e-6;
+    region.self = static_cast<double> (self[r]) * 1e-6;
+    region.min = static_cast<double> (region_durations.front ()) * 1e-6;
+    region.max = static_cast<double> (region_durations.back ()) * 1e-6;
+    region.median = percentile (region_durations, 0.5);
+    region.percentile_90 = percentile (region_durations, 0.9);
+    region.percentile_99 = percentile (region_durations, 0.99);
+    statistics.push_back (region);
+  }
+  std::sort (statistics.begin (), statistics.end (), compareTotal);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::profiler::saveChromeTrace (const std::string &file_name)
+{
+  std::ofstream file (file_name.c_str ());
+  if (!file.is_open ())
+    return (false);
+
+  Registry &registry = getRegistry ();
+  boost::mutex::scoped_lock lock (registry.mutex);
+
+  // The timestamps are given in microseconds, relative to the first event
+  long long origin = 0;
+  bool has_events = false;
+  for (size_t t = 0; t < registry.threads.size (); ++t)
+  {
+    boost::mutex::scoped_lock thread_lock (registry.threads[t]->mutex);
+    const std::vector<Event> &events = registry.threads[t]->events;
+    for (size_t i = 0; i < events.size (); ++i)
+    {
+      if (!has_events || events[i].start < origin)
+        origin = events[i].start;
+      has_events = true;
+    }
+  }
+
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  file.precision (3);
+  file << std::fixed;
+  bool first = true;
+  for (size_t t = 0; t < registry.threads.size (); ++t)
+  {
+    boost::mutex::scoped_lock thread_lock (registry.threads[t]->mutex);
+    const std::vector<Event> &events = registry.threads[t]->events;
+    for (size_t i = 0; i < events.size (); ++i)
+    {
+      file << (first ? "\n" : ",\n");
+      file << "{\"name\":\"" << escapeJSON (registry.names[events[i].region])
+           << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << registry.threads[t]->thread_id
+           << ",\"ts\":" << static_cast<double> (events[i].start - origin) * 1e-3
+           << ",\"dur\":" << static_cast<double> (events[i].duration) * 1e-3 << "}";
+      first = false;
+    }
+  }
+  file << "\n]}\n";
+  return (file.good ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::profiler::saveCSV (const std::string &file_name)
+{
+  std::vector<RegionStatistics> statistics;
+  getStatistics (statistics);
+
+  std::ofstream file (file_name.c_str ());
+  if (!file.is_open ())
+    return (false);
+
+  file << "name,calls,total_ms,self_ms,mean_ms,min_ms,max_ms,median_ms,p90_ms,p99_ms\n";
+  for (size_t i = 0; i < statistics.size (); ++i)
+  {
+    const RegionStatistics &r = statistics[i];
+    std::string name = r.name;
+    if (name.find_first_of (",\"") != std::string::npos)
+    {
+      std::string quoted ("\"");
+      for (size_t c = 0; c < name.size (); ++c)
+      {
+        if (name[c] == '"')
+          quoted += '"';
+        quoted += name[c];
+      }
+      name = quoted + "\"";
+    }
+    file << name << "," << r.calls << "," << r.total << "," << r.self << ","
+         << r.total / static_cast<double> (r.calls) << "," << r.min << "," << r.max << ","
+         << r.median << "," << r.percentile_90 << "," << r.percentile_99 << "\n";
+  }
+  return (file.good ());
+}
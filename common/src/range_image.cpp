@@ -39,6 +39,7 @@
 #include <cmath>
 #include <set>
 #include <pcl/common/eigen.h>
+#include <pcl/common/parallel.h>
 #include <pcl/range_image/range_image.h>
 #include <pcl/common/transformation_from_correspondences.h>
 
@@ -273,6 +274,10 @@ RangeImage::cropImage (int borderSize, int top, int right, int bottom, int left)
 void 
 RangeImage::recalculate3DPointPositions () 
 {
+  // Clamped by the thread budget of the library, and serial when called from a parallel region
+  const pcl::parallel::ThreadReservation reservation (static_cast<unsigned int> ((std::max) (max_no_of_threads, 0)));
+  const int threads = static_cast<int> (reservation.getNumberOfThreads ());
+  # pragma omp parallel for num_threads (threads) default (shared) schedule (static)
   for (int y = 0; y < static_cast<int> (height); ++y) 
   {
     for (int x = 0; x < static_cast<int> (width); ++x) 
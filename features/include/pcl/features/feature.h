@@ -85,6 +85,21 @@ namespace pcl
   solvePlaneParameters (const Eigen::Matrix3f &covariance_matrix,
                         float &nx, float &ny, float &nz, float &curvature);
 
+  /** \brief Solve the eigenvalues and eigenvectors of many 3x3 covariance matrices at once, and estimate the
+    * least-squares plane normals and surface curvatures. The matrices are solved with the batched pcl::eigen33.
+    * \param covariance_matrices pointer to the 3x3 covariance matrices
+    * \param nr_matrices the number of covariance matrices
+    * \param normals the resultant plane normals (nr_matrices entries)
+    * \param curvatures the estimated surface curvatures (nr_matrices entries) as a measure of
+    * \f[
+    * \lambda_0 / (\lambda_0 + \lambda_1 + \lambda_2)
+    * \f]
+    * \ingroup features
+    */
+  inline void
+  solvePlaneParameters (const Eigen::Matrix3f *covariance_matrices, size_t nr_matrices,
+                        Eigen::Vector3f *normals, float *curvatures);
+
   ////////////////////////////////////////////////////////////////////////////////////////////
   ////////////////////////////////////////////////////////////////////////////////////////////
   ////////////////////////////////////////////////////////////////////////////////////////////
@@ -42,6 +42,7 @@
 #define PCL_FEATURES_IMPL_FEATURE_H_
 
 #include <pcl/search/pcl_search.h>
+#include <pcl/common/profiler.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 inline void
@@ -86,6 +87,26 @@ pcl::solvePlaneParameters (const Eigen::Matrix3f &covariance_matrix,
     curvature = 0;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+inline void
+pcl::solvePlaneParameters (const Eigen::Matrix3f *covariance_matrices, size_t nr_matrices,
+                           Eigen::Vector3f *normals, float *curvatures)
+{
+  // Extract the smallest eigenvalues and their eigenvectors
+  pcl::eigen33 (covariance_matrices, nr_matrices, curvatures, normals);
+
+  // Compute the curvature surface change
+  for (size_t i = 0; i < nr_matrices; ++i)
+  {
+    const Eigen::Matrix3f &covariance_matrix = covariance_matrices[i];
+    float eig_sum = covariance_matrix.coeff (0) + covariance_matrix.coeff (4) + covariance_matrix.coeff (8);
+    if (eig_sum != 0)
+      curvatures[i] = fabsf (curvatures[i] / eig_sum);
+    else
+      curvatures[i] = 0;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -188,6 +209,8 @@ pcl::Feature<PointInT, PointOutT>::deinitCompute ()
 template <typename PointInT, typename PointOutT> void
 pcl::Feature<PointInT, PointOutT>::compute (PointCloudOut &output)
 {
+  PCL_PROFILE_SCOPE (feature_name_);
+
   if (!initCompute ())
   {
     output.width = output.height = 0;
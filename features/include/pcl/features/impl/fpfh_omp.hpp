@@ -42,6 +42,7 @@
 #define PCL_FEATURES_IMPL_FPFH_OMP_H_
 
 #include <pcl/features/fpfh_omp.h>
+#include <pcl/common/parallel.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
@@ -86,11 +87,12 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
 
   std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
   std::vector<float> nn_dists (k_); 
+  const pcl::parallel::ThreadReservation reservation (threads_);
 
   // Compute SPFH signatures for every point that needs them
 
 #ifdef _OPENMP
-#pragma omp parallel for shared (spfh_hist_lookup) private (nn_indices, nn_dists) num_threads(threads_)
+#pragma omp parallel for shared (spfh_hist_lookup) private (nn_indices, nn_dists) num_threads(reservation.getNumberOfThreads ())
 #endif
   for (int i = 0; i < static_cast<int> (spfh_indices_vec.size ()); ++i)
   {
@@ -116,7 +118,7 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
 
   // Iterate over the entire index vector
 #ifdef _OPENMP
-#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads_)
+#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(reservation.getNumberOfThreads ())
 #endif
   for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
   {
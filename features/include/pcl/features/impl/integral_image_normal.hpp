@@ -40,6 +40,7 @@
 #define PCL_FEATURES_INTEGRALIMAGE_BASED_IMPL_NORMAL_ESTIMATOR_H_
 
 #include <pcl/features/integral_image_normal.h>
+#include <pcl/common/parallel.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT>
@@ -867,6 +868,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
                                                                              const float &bad_point,
                                                                              PointCloudOut &output)
 {
+  const pcl::parallel::ThreadReservation reservation (static_cast<unsigned int> (threads_));
+
   unsigned index = 0;
 
   if (border_policy_ == BORDER_POLICY_IGNORE)
@@ -908,7 +911,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
       unsigned skip = (border << 1);
 
 #ifdef _OPENMP
-      #pragma omp parallel for num_threads(threads_)
+      #pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
 #endif
       for (unsigned ri = border; ri < input_->height - border; ++ri/*, index += skip*/)
       {
@@ -947,7 +950,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
       index = border + input_->width * border;
       unsigned skip = (border << 1);
 #ifdef _OPENMP
-      #pragma omp parallel for num_threads(threads_)
+      #pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
 #endif
       for (unsigned ri = border; ri < input_->height - border; ++ri/*, index += skip*/)
       {
@@ -987,7 +990,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
       //unsigned skip = 0;
       //for (unsigned ri = 0; ri < input_->height; ++ri, index += skip)
 #ifdef _OPENMP
-      #pragma omp parallel for num_threads(threads_)
+      #pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
 #endif
       for (unsigned ri = 0; ri < input_->height; ++ri)
       {
@@ -1026,7 +1029,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeatureFull (con
       //unsigned skip = (border << 1);
       //for (unsigned ri = border; ri < input_->height - border; ++ri, index += skip)
 #ifdef _OPENMP
-      #pragma omp parallel for num_threads(threads_)
+      #pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
 #endif
       for (unsigned ri = 0; ri < input_->height; ++ri)
       {
@@ -1065,6 +1068,8 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeaturePart (con
                                                                              const float &bad_point,
                                                                              PointCloudOut &output)
 {
+  const pcl::parallel::ThreadReservation reservation (static_cast<unsigned int> (threads_));
+
   if (border_policy_ == BORDER_POLICY_IGNORE)
   {
     output.is_dense = false;
@@ -1075,7 +1080,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeaturePart (con
     {
       // Iterating over the entire index vector
 #ifdef _OPENMP
-      #pragma omp parallel for num_threads(threads_)
+      #pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
 #endif
       for (std::size_t idx = 0; idx < indices_->size (); ++idx)
       {
@@ -1121,7 +1126,7 @@ pcl::IntegralImageNormalEstimation<PointInT, PointOutT>::computeFeaturePart (con
       const float smoothing_constant = normal_smoothing_size_;
       // Iterating over the entire index vector
 #ifdef _OPENMP
-      #pragma omp parallel for num_threads(threads_)
+      #pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
 #endif
       for (std::size_t idx = 0; idx < indices_->size (); ++idx)
       {
@@ -42,6 +42,7 @@
 #define PCL_FEATURES_IMPL_INTENSITY_GRADIENT_H_
 
 #include <pcl/features/intensity_gradient.h>
+#include <pcl/common/parallel.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename IntensitySelectorT> void
@@ -148,12 +149,13 @@ pcl::IntensityGradientEstimation<PointInT, PointNT, PointOutT, IntensitySelector
   std::vector<int> nn_indices (k_);
   std::vector<float> nn_dists (k_);
   output.is_dense = true;
+  const pcl::parallel::ThreadReservation reservation (threads_);
 
   // If the data is dense, we don't need to check for NaN
   if (surface_->is_dense)
   {
 #ifdef _OPENMP
-#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads_)
+#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(reservation.getNumberOfThreads ())
 #endif
     // Iterating over the entire index vector
     for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
@@ -191,7 +193,7 @@ pcl::IntensityGradientEstimation<PointInT, PointNT, PointOutT, IntensitySelector
   else
   {
 #ifdef _OPENMP
-#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads_)
+#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(reservation.getNumberOfThreads ())
 #endif
     // Iterating over the entire index vector
     for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
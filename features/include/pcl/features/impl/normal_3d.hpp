@@ -47,56 +47,81 @@
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
+  output.is_dense = computeFeatureRange (0, static_cast<int> (indices_->size ()), output);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::NormalEstimation<PointInT, PointOutT>::computeFeatureRange (int begin, int end, PointCloudOut &output) const
+{
+  // Number of covariance matrices solved together
+  const int batch_size = 64;
+  Eigen::Matrix3f covariance_matrices[batch_size];
+  Eigen::Vector3f normals[batch_size];
+  float curvatures[batch_size];
+  int positions[batch_size];
+
   // Allocate enough space to hold the results
   // \note This resize is irrelevant for a radiusSearch ().
   std::vector<int> nn_indices (k_);
   std::vector<float> nn_dists (k_);
+  Eigen::Vector4f xyz_centroid;
 
-  output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
+  bool is_dense = true;
+  int idx = begin;
+  while (idx < end)
   {
-    // Iterating over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+    // Gather the covariance matrices of the next batch of neighborhoods
+    int nr_matrices = 0;
+    for (; idx < end && nr_matrices < batch_size; ++idx)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      PointOutT &point = output.points[idx];
+      // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+      if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[idx]])) ||
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
       {
-        output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+        point.normal[0] = point.normal[1] = point.normal[2] = point.curvature = std::numeric_limits<float>::quiet_NaN ();
 
-        output.is_dense = false;
+        is_dense = false;
         continue;
       }
 
-      computePointNormal (*surface_, nn_indices,
-                          output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature);
-
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
-
-    }
-  }
-  else
-  {
-    // Iterating over the entire index vector
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      // A neighborhood without any valid point has no covariance matrix, leave it out of the batch
+      bool has_valid_neighbor = nn_indices.size () >= 3;
+      if (has_valid_neighbor && !surface_->is_dense)
       {
-        output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+        has_valid_neighbor = false;
+        for (size_t i = 0; i < nn_indices.size () && !has_valid_neighbor; ++i)
+          has_valid_neighbor = isFinite ((*surface_)[nn_indices[i]]);
+      }
+      if (!has_valid_neighbor)
+      {
+        point.normal[0] = point.normal[1] = point.normal[2] = point.curvature = std::numeric_limits<float>::quiet_NaN ();
 
-        output.is_dense = false;
+        is_dense = false;
         continue;
       }
 
-      computePointNormal (*surface_, nn_indices,
-                          output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature);
+      computeMeanAndCovarianceMatrix (*surface_, nn_indices, covariance_matrices[nr_matrices], xyz_centroid);
+      positions[nr_matrices++] = idx;
+    }
+
+    // Get the plane normals and surface curvatures
+    solvePlaneParameters (covariance_matrices, nr_matrices, normals, curvatures);
 
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
+    for (int i = 0; i < nr_matrices; ++i)
+    {
+      PointOutT &point = output.points[positions[i]];
+      point.normal[0] = normals[i][0];
+      point.normal[1] = normals[i][1];
+      point.normal[2] = normals[i][2];
+      point.curvature = curvatures[i];
 
+      flipNormalTowardsViewpoint (input_->points[(*indices_)[positions[i]]], vpx_, vpy_, vpz_,
+                                  point.normal[0], point.normal[1], point.normal[2]);
     }
   }
+  return (is_dense);
 }
 
 #define PCL_INSTANTIATE_NormalEstimation(T,NT) template class PCL_EXPORTS pcl::NormalEstimation<T,NT>;
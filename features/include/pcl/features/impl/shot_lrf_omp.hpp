@@ -42,6 +42,7 @@
 
 #include <utility>
 #include <pcl/features/shot_lrf_omp.h>
+#include <pcl/common/parallel.h>
 #include <pcl/features/shot_lrf.h>
 
 template<typename PointInT, typename PointOutT>
@@ -59,8 +60,9 @@ pcl::SHOTLocalReferenceFrameEstimationOMP<PointInT, PointOutT>::computeFeature (
   tree_->setSortedResults (true);
 
   int data_size = static_cast<int> (indices_->size ());
+  const pcl::parallel::ThreadReservation reservation (threads_);
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
 #endif
   for (int i = 0; i < data_size; ++i)
   {
@@ -41,6 +41,7 @@
 #define PCL_FEATURES_IMPL_SHOT_OMP_H_
 
 #include <pcl/features/shot_omp.h>
+#include <pcl/common/parallel.h>
 #include <pcl/common/time.h>
 #include <pcl/features/shot_lrf_omp.h>
 
@@ -133,11 +134,12 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
   assert(descLength_ == 352);
 
   int data_size = static_cast<int> (indices_->size ());
+  const pcl::parallel::ThreadReservation reservation (threads_);
 
   output.is_dense = true;
   // Iterating over the entire index vector
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
 #endif
   for (int idx = 0; idx < data_size; ++idx)
   {
@@ -207,11 +209,12 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeat
   radius1_2_ = search_radius_ / 2;
 
   int data_size = static_cast<int> (indices_->size ());
+  const pcl::parallel::ThreadReservation reservation (threads_);
 
   output.is_dense = true;
   // Iterating over the entire index vector
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+#pragma omp parallel for num_threads(reservation.getNumberOfThreads ())
 #endif
   for (int idx = 0; idx < data_size; ++idx)
   {
@@ -355,6 +355,17 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output);
 
+      /** \brief Estimate the normals of the points at positions [begin, end) of the index vector. The covariance
+        * matrices of the neighborhoods are gathered in small batches and solved together with the batched
+        * solvePlaneParameters. Only local buffers are used, so disjoint ranges can be processed in parallel.
+        * \param[in] begin the first position in the index vector
+        * \param[in] end one past the last position in the index vector
+        * \param[out] output the resultant point cloud model dataset that contains surface normals and curvatures
+        * \return false if the neighborhood of at least one point could not be determined
+        */
+      bool
+      computeFeatureRange (int begin, int end, PointCloudOut &output) const;
+
       /** \brief Values describing the viewpoint ("pinhole" camera model assumed). For per point viewpoints, inherit
         * from NormalEstimation and provide your own computeFeature (). By default, the viewpoint is set to 0,0,0. */
       float vpx_, vpy_, vpz_;
@@ -42,8 +42,10 @@
 
 #include <pcl/pcl_base.h>
 #include <pcl/common/io.h>
+#include <pcl/point_cloud_view.h>
 #include <pcl/conversions.h>
 #include <pcl/filters/boost.h>
+#include <pcl/common/profiler.h>
 #include <cfloat>
 #include <pcl/PointIndices.h>
 
@@ -62,6 +64,20 @@ namespace pcl
                            pcl::PointCloud<PointT> &cloud_out, 
                            std::vector<int> &index);
 
+  /** \brief Removes points with x, y, or z equal to NaN, reading them straight from a PointCloudView
+    * \param[in] cloud_in the view of the input points, e.g. over the data blob of a PCLPointCloud2
+    * \param[out] cloud_out the output point cloud
+    * \param[out] index the mapping (ordered): cloud_out.points[i] = cloud_in[index[i]]
+    * \note Only the finite points are copied, so a PCLPointCloud2 with a matching layout does not have to be
+    * converted with fromPCLPointCloud2 first.
+    * \note The density of the point cloud is lost.
+    * \ingroup filters
+    */
+  template<typename PointT> void
+  removeNaNFromPointCloud (const pcl::PointCloudView<PointT> &cloud_in, 
+                           pcl::PointCloud<PointT> &cloud_out, 
+                           std::vector<int> &index);
+
   /** \brief Removes points that have their normals invalid (i.e., equal to NaN)
     * \param[in] cloud_in the input point cloud
     * \param[out] cloud_out the input point cloud
@@ -131,6 +147,8 @@ namespace pcl
       inline void
       filter (PointCloud &output)
       {
+        PCL_PROFILE_SCOPE (filter_name_);
+
         if (!initCompute ())
           return;
 
@@ -92,6 +92,51 @@ pcl::removeNaNFromPointCloud (const pcl::PointCloud<PointT> &cloud_in,
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::removeNaNFromPointCloud (const pcl::PointCloudView<PointT> &cloud_in, 
+                              pcl::PointCloud<PointT> &cloud_out,
+                              std::vector<int> &index)
+{
+  cloud_out.header = cloud_in.header;
+  cloud_out.points.resize (cloud_in.size ());
+  index.resize (cloud_in.size ());
+  size_t j = 0;
+
+  for (size_t i = 0; i < cloud_in.size (); ++i)
+  {
+    if (!cloud_in.is_dense && 
+        (!pcl_isfinite (cloud_in[i].x) || 
+         !pcl_isfinite (cloud_in[i].y) || 
+         !pcl_isfinite (cloud_in[i].z)))
+      continue;
+    cloud_out.points[j] = cloud_in[i];
+    index[j] = static_cast<int>(i);
+    j++;
+  }
+  if (j != cloud_in.size ())
+  {
+    // Resize to the correct size
+    cloud_out.points.resize (j);
+    index.resize (j);
+  }
+
+  if (cloud_in.is_dense)
+  {
+    // Nothing was removed, keep the organization of the input
+    cloud_out.width  = cloud_in.width;
+    cloud_out.height = cloud_in.height;
+  }
+  else
+  {
+    cloud_out.height = 1;
+    cloud_out.width  = static_cast<uint32_t>(j);
+  }
+
+  // Removing bad points => dense (note: 'dense' doesn't mean 'organized')
+  cloud_out.is_dense = true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::removeNaNNormalsFromPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
@@ -131,6 +176,7 @@ pcl::removeNaNNormalsFromPointCloud (const pcl::PointCloud<PointT> &cloud_in,
 
 
 #define PCL_INSTANTIATE_removeNaNFromPointCloud(T) template PCL_EXPORTS void pcl::removeNaNFromPointCloud<T>(const pcl::PointCloud<T>&, pcl::PointCloud<T>&, std::vector<int>&);
+#define PCL_INSTANTIATE_removeNaNFromPointCloudView(T) template PCL_EXPORTS void pcl::removeNaNFromPointCloud<T>(const pcl::PointCloudView<T>&, pcl::PointCloud<T>&, std::vector<int>&);
 #define PCL_INSTANTIATE_removeNaNNormalsFromPointCloud(T) template PCL_EXPORTS void pcl::removeNaNNormalsFromPointCloud<T>(const pcl::PointCloud<T>&, pcl::PointCloud<T>&, std::vector<int>&);
 
 #endif    // PCL_FILTERS_IMPL_FILTER_H_
@@ -42,6 +42,7 @@
 
 #include <pcl/filters/statistical_outlier_removal.h>
 #include <pcl/common/io.h>
+#include <pcl/search/neighbor_graph.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -72,49 +73,63 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilter (PointCloud &output)
 template <typename PointT> void
 pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &indices)
 {
-  // Initialize the search class
-  if (!searcher_)
-  {
-    if (input_->isOrganized ())
-      searcher_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
-    else
-      searcher_.reset (new pcl::search::KdTree<PointT> (false));
-  }
-  searcher_->setInputCloud (input_);
-
   // The arrays to be used
-  std::vector<int> nn_indices (mean_k_);
-  std::vector<float> nn_dists (mean_k_);
   std::vector<float> distances (indices_->size ());
   indices.resize (indices_->size ());
   removed_indices_->resize (indices_->size ());
   int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
 
-  // First pass: Compute the mean distances for all points with respect to their k nearest neighbors
-  int valid_distances = 0;
+  // Search the k nearest neighbors of all the finite points in one batch
+  std::vector<int> queries, query_positions;
+  queries.reserve (indices_->size ());
+  query_positions.reserve (indices_->size ());
   for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
   {
+    distances[iii] = 0.0;
     if (!pcl_isfinite (input_->points[(*indices_)[iii]].x) ||
         !pcl_isfinite (input_->points[(*indices_)[iii]].y) ||
         !pcl_isfinite (input_->points[(*indices_)[iii]].z))
-    {
-      distances[iii] = 0.0;
       continue;
+    queries.push_back ((*indices_)[iii]);
+    query_positions.push_back (iii);
+  }
+  pcl::search::BatchSearchResults neighbors;
+  if (!searcher_ && !input_->isOrganized () && fake_indices_)
+  {
+    // The neighbors are searched among the queries themselves: compute them all in one self-join
+    pcl::search::computeKNearestNeighborGraph (*input_, queries, mean_k_ + 1, neighbors);
+  }
+  else if (!queries.empty ())
+  {
+    // Initialize the search class
+    if (!searcher_)
+    {
+      if (input_->isOrganized ())
+        searcher_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
+      else
+        searcher_.reset (new pcl::search::KdTree<PointT> (false));
     }
+    searcher_->setInputCloud (input_);
+    searcher_->nearestKSearch (*input_, queries, mean_k_ + 1, neighbors);
+  }
 
-    // Perform the nearest k search
-    if (searcher_->nearestKSearch ((*indices_)[iii], mean_k_ + 1, nn_indices, nn_dists) == 0)
+  // First pass: Compute the mean distances for all points with respect to their k nearest neighbors
+  int valid_distances = 0;
+  for (size_t qi = 0; qi < queries.size (); ++qi)  // qi = query iterator
+  {
+    const int nr_neighbors = neighbors.getNumberOfNeighbors (qi);
+    if (nr_neighbors == 0)
     {
-      distances[iii] = 0.0;
       PCL_WARN ("[pcl::%s::applyFilter] Searching for the closest %d neighbors failed.\n", getClassName ().c_str (), mean_k_);
       continue;
     }
 
     // Calculate the mean distance to its neighbors
+    const float *nn_dists = &neighbors.sqr_distances[neighbors.offsets[qi]];
     double dist_sum = 0.0;
-    for (int k = 1; k < mean_k_ + 1; ++k)  // k = 0 is the query point
+    for (int k = 1; k < nr_neighbors; ++k)  // k = 0 is the query point
       dist_sum += sqrt (nn_dists[k]);
-    distances[iii] = static_cast<float> (dist_sum / mean_k_);
+    distances[query_positions[qi]] = static_cast<float> (dist_sum / mean_k_);
     valid_distances++;
   }
 
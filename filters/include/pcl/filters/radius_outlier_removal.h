@@ -75,9 +75,9 @@ namespace pcl
       typedef typename FilterIndices<PointT>::PointCloud PointCloud;
       typedef typename PointCloud::Ptr PointCloudPtr;
       typedef typename PointCloud::ConstPtr PointCloudConstPtr;
-      typedef typename pcl::search::Search<PointT>::Ptr SearcherPtr;
 
     public:
+      typedef typename pcl::search::Search<PointT>::Ptr SearcherPtr;
 
       typedef boost::shared_ptr< RadiusOutlierRemoval<PointT> > Ptr;
       typedef boost::shared_ptr< const RadiusOutlierRemoval<PointT> > ConstPtr;
@@ -139,6 +139,23 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Provide a pointer to the search object used to find the neighbors of the points. By default a
+        * search::OrganizedNeighbor is used for organized clouds and a search::KdTree otherwise.
+        * \param[in] searcher a pointer to the spatial search object
+        */
+      inline void
+      setSearchMethod (const SearcherPtr &searcher)
+      {
+        searcher_ = searcher;
+      }
+
+      /** \brief Get a pointer to the search object used to find the neighbors of the points. */
+      inline SearcherPtr
+      getSearchMethod () const
+      {
+        return (searcher_);
+      }
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
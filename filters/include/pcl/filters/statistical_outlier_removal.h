@@ -184,6 +184,7 @@ namespace pcl
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
+      using PCLBase<PointT>::fake_indices_;
       using Filter<PointT>::filter_name_;
       using Filter<PointT>::getClassName;
       using FilterIndices<PointT>::negative_;
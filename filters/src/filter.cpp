@@ -49,6 +49,8 @@
 void
 pcl::Filter<pcl::PCLPointCloud2>::filter (PCLPointCloud2 &output)
 {
+  PCL_PROFILE_SCOPE (filter_name_);
+
   if (!initCompute ())
     return;
 
@@ -79,6 +81,7 @@ pcl::Filter<pcl::PCLPointCloud2>::filter (PCLPointCloud2 &output)
 
 // Instantiations of specific point types
 PCL_INSTANTIATE(removeNaNFromPointCloud, PCL_XYZ_POINT_TYPES)
+PCL_INSTANTIATE(removeNaNFromPointCloudView, PCL_XYZ_POINT_TYPES)
 PCL_INSTANTIATE(removeNaNNormalsFromPointCloud, PCL_NORMAL_POINT_TYPES)
 
 #endif    // PCL_NO_PRECOMPILE
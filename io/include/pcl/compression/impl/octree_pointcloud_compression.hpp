@@ -40,9 +40,13 @@
 
 #include <pcl/octree/octree_pointcloud.h>
 #include <pcl/compression/entropy_range_coder.h>
+#include <pcl/common/parallel.h>
 
+#include <algorithm>
+#include <functional>
 #include <iterator>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string.h>
 #include <iostream>
@@ -105,21 +109,34 @@ namespace pcl
         // increase frameID
         frame_ID_++;
 
-        // do octree encoding
-        if (!do_voxel_grid_enDecoding_)
+        // subtree coded frames collect the leaves during serialization and code them afterwards
+        subtree_frame_ = (subtree_depth_ > 0);
+        leaf_keys_.clear ();
+        leaf_point_indices_.clear ();
+
+        if (subtree_frame_)
         {
-          point_count_data_vector_.clear ();
-          point_count_data_vector_.reserve (cloud_arg->points.size ());
+          leaf_keys_.reserve (this->leaf_count_);
+          leaf_point_indices_.reserve (this->leaf_count_);
+        }
+        else
+        {
+          // do octree encoding
+          if (!do_voxel_grid_enDecoding_)
+          {
+            point_count_data_vector_.clear ();
+            point_count_data_vector_.reserve (cloud_arg->points.size ());
+          }
+
+          // initialize color encoding
+          color_coder_.initializeEncoding ();
+          color_coder_.setPointCount (static_cast<unsigned int> (cloud_arg->points.size ()));
+          color_coder_.setVoxelCount (static_cast<unsigned int> (this->leaf_count_));
+
+          // initialize point encoding
+          point_coder_.initializeEncoding ();
+          point_coder_.setPointCount (static_cast<unsigned int> (cloud_arg->points.size ()));
         }
-
-        // initialize color encoding
-        color_coder_.initializeEncoding ();
-        color_coder_.setPointCount (static_cast<unsigned int> (cloud_arg->points.size ()));
-        color_coder_.setVoxelCount (static_cast<unsigned int> (this->leaf_count_));
-
-        // initialize point encoding
-        point_coder_.initializeEncoding ();
-        point_coder_.setPointCount (static_cast<unsigned int> (cloud_arg->points.size ()));
 
         // serialize octree
         if (i_frame_)
@@ -130,11 +147,31 @@ namespace pcl
           this->serializeTree (binary_tree_data_vector_, true);
 
 
+        // frames are assembled in memory, so that their position and size can be recorded in the frame index
+        std::ostringstream frame_data;
+
         // write frame header information to stream
-        this->writeFrameHeader (compressed_tree_data_out_arg);
+        this->writeFrameHeader (frame_data);
 
-        // apply entropy coding to the content of all data vectors and send data to output stream
-        this->entropyEncoding (compressed_tree_data_out_arg);
+        if (subtree_frame_)
+          // code the subtrees in parallel and send the frame payload to output stream
+          this->subtreeEncoding (frame_data);
+        else
+          // apply entropy coding to the content of all data vectors and send data to output stream
+          this->entropyEncoding (frame_data);
+
+        const std::string frame_string = frame_data.str ();
+        compressed_tree_data_out_arg.write (frame_string.data (), static_cast<std::streamsize> (frame_string.size ()));
+        compressed_tree_data_out_arg.flush ();
+
+        FrameIndexEntry entry;
+        entry.frame_ID = frame_ID_;
+        entry.i_frame = i_frame_;
+        entry.subtree_coded = subtree_frame_;
+        entry.offset = stream_offset_;
+        entry.size = frame_string.size ();
+        frame_index_.push_back (entry);
+        stream_offset_ += entry.size;
 
         // prepare for next frame
         this->switchBuffers ();
@@ -175,14 +212,42 @@ namespace pcl
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
-    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> bool
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::decodePointCloud (
         std::istream& compressed_tree_data_in_arg,
         PointCloudPtr &cloud_arg)
     {
+      return (decodeFrame (compressed_tree_data_in_arg, cloud_arg, NULL));
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> bool
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::decodePointCloud (
+        std::istream& compressed_tree_data_in_arg,
+        PointCloudPtr &cloud_arg,
+        const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt)
+    {
+      const double region[6] = {min_pt[0], min_pt[1], min_pt[2], max_pt[0], max_pt[1], max_pt[2]};
+      return (decodeFrame (compressed_tree_data_in_arg, cloud_arg, region));
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> bool
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::decodeFrame (
+        std::istream& compressed_tree_data_in_arg,
+        PointCloudPtr &cloud_arg,
+        const double* region_arg)
+    {
 
       // synchronize to frame header
       syncToHeader(compressed_tree_data_in_arg);
+      if (!compressed_tree_data_in_arg.good ())
+      {
+        PCL_ERROR ("[pcl::io::OctreePointCloudCompression::decodePointCloud] No frame found in the input stream!\n");
+        cloud_arg->points.clear ();
+        cloud_arg->width = cloud_arg->height = 0;
+        return (false);
+      }
 
       // initialize octree
       this->switchBuffers ();
@@ -204,23 +269,37 @@ namespace pcl
       // read header from input stream
       this->readFrameHeader (compressed_tree_data_in_arg);
 
-      // decode data vectors from stream
-      this->entropyDecoding (compressed_tree_data_in_arg);
+      bool success = true;
+      if (subtree_frame_)
+      {
+        // decode tree structure and subtrees
+        success = this->subtreeDecoding (compressed_tree_data_in_arg, region_arg);
+        if (!success)
+        {
+          PCL_ERROR ("[pcl::io::OctreePointCloudCompression::decodePointCloud] Corrupted frame %u!\n", frame_ID_);
+          output_->points.clear ();
+        }
+      }
+      else
+      {
+        // decode data vectors from stream
+        this->entropyDecoding (compressed_tree_data_in_arg);
 
-      // initialize color and point encoding
-      color_coder_.initializeDecoding ();
-      point_coder_.initializeDecoding ();
+        // initialize color and point encoding
+        color_coder_.initializeDecoding ();
+        point_coder_.initializeDecoding ();
 
-      // initialize output cloud
-      output_->points.clear ();
-      output_->points.reserve (static_cast<std::size_t> (point_count_));
+        // initialize output cloud
+        output_->points.clear ();
+        output_->points.reserve (static_cast<std::size_t> (point_count_));
 
-      if (i_frame_)
-        // i-frame decoding - decode tree structure without referencing previous buffer
-        this->deserializeTree (binary_tree_data_vector_, false);
-      else
-        // p-frame decoding - decode XOR encoded tree structure
-        this->deserializeTree (binary_tree_data_vector_, true);
+        if (i_frame_)
+          // i-frame decoding - decode tree structure without referencing previous buffer
+          this->deserializeTree (binary_tree_data_vector_, false);
+        else
+          // p-frame decoding - decode XOR encoded tree structure
+          this->deserializeTree (binary_tree_data_vector_, true);
+      }
 
       // assign point cloud properties
       output_->height = 1;
@@ -249,6 +328,7 @@ namespace pcl
         PCL_INFO ("Total compression percentage: %f%%\n", (bytes_per_XYZ + bytes_per_color) / (sizeof (int) + 3.0f * sizeof (float)) * 100.0f);
         PCL_INFO ("Compression ratio: %f\n\n", static_cast<float> (sizeof (int) + 3.0f * sizeof (float)) / static_cast<float> (bytes_per_XYZ + bytes_per_color));
       }
+      return (success);
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
@@ -368,6 +448,502 @@ namespace pcl
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::subtreeEncoding (std::ostream& compressed_tree_data_out_arg)
+    {
+      const unsigned char split_depth = static_cast<unsigned char> (
+          std::min<unsigned int> (subtree_depth_, this->octree_depth_));
+      const unsigned int shift = this->octree_depth_ - split_depth;
+
+      // group the leaves in subtrees, the leaves of a subtree are consecutive in depth first order
+      std::vector<SubtreeChunk> chunks;
+      for (std::size_t i = 0; i < leaf_keys_.size (); ++i)
+      {
+        const OctreeKey key (leaf_keys_[i].x >> shift, leaf_keys_[i].y >> shift, leaf_keys_[i].z >> shift);
+        if (chunks.empty () || !(chunks.back ().key == key))
+        {
+          chunks.push_back (SubtreeChunk ());
+          chunks.back ().key = key;
+          chunks.back ().leaf_begin = static_cast<uint32_t> (i);
+          chunks.back ().leaf_count = 0;
+          chunks.back ().point_count = 0;
+          chunks.back ().point_begin = 0;
+        }
+        ++chunks.back ().leaf_count;
+        chunks.back ().point_count += do_voxel_grid_enDecoding_ ? 1 : static_cast<uint32_t> (leaf_point_indices_[i]->size ());
+      }
+
+      // the tree structure is entropy coded by the first task, concurrently to the subtrees
+      std::ostringstream structure_data;
+      uint64_t structure_len = 0;
+      std::vector<uint64_t> compressed_len (2 * chunks.size (), 0);
+
+      const int task_count = static_cast<int> (chunks.size ()) + 1;
+      const int grain_size = std::max (1, task_count / static_cast<int> (4 * pcl::parallel::getNumberOfThreads (threads_)));
+      pcl::parallel::parallel_for (0, task_count, [&] (int begin, int end)
+      {
+        // coders are shared by the tasks of a range, constructing a range coder is not cheap
+        PointCoding<PointT> point_coder;
+        ColorCoding<PointT> color_coder;
+        StaticRangeCoder entropy_coder;
+        point_coder.setPrecision (point_coder_.getPrecision ());
+        color_coder.setBitDepth (color_coder_.getBitDepth ());
+
+        for (int i = begin; i < end; ++i)
+        {
+          if (i == 0)
+            structure_len = entropy_coder.encodeCharVectorToStream (binary_tree_data_vector_, structure_data);
+          else
+            encodeSubtree (chunks[i - 1], point_coder, color_coder, entropy_coder, &compressed_len[2 * (i - 1)]);
+        }
+      }, grain_size, threads_);
+
+      const std::string structure_string = structure_data.str ();
+      const uint32_t chunk_count = static_cast<uint32_t> (chunks.size ());
+      const uint64_t binary_tree_data_vector_size = binary_tree_data_vector_.size ();
+
+      // statistics
+      point_count_ = 0;
+      compressed_point_data_len_ = structure_len;
+      compressed_color_data_len_ = 0;
+      for (std::size_t i = 0; i < chunks.size (); ++i)
+      {
+        point_count_ += chunks[i].point_count;
+        compressed_point_data_len_ += compressed_len[2 * i];
+        compressed_color_data_len_ += compressed_len[2 * i + 1];
+      }
+
+      // encode the size of the frame payload, so that decoders can skip it
+      uint64_t frame_data_size = sizeof (split_depth) + sizeof (chunk_count) + sizeof (point_count_) +
+                                 sizeof (binary_tree_data_vector_size) + structure_string.size () +
+                                 chunks.size () * (5 * sizeof (uint32_t) + sizeof (uint64_t));
+      for (std::size_t i = 0; i < chunks.size (); ++i)
+        frame_data_size += chunks[i].data.size ();
+      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&frame_data_size), sizeof (frame_data_size));
+
+      // encode subtree configuration and binary octree structure
+      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&split_depth), sizeof (split_depth));
+      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&chunk_count), sizeof (chunk_count));
+      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&point_count_), sizeof (point_count_));
+      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&binary_tree_data_vector_size),
+                                          sizeof (binary_tree_data_vector_size));
+      compressed_tree_data_out_arg.write (structure_string.data (), static_cast<std::streamsize> (structure_string.size ()));
+
+      // encode subtree table
+      for (std::size_t i = 0; i < chunks.size (); ++i)
+      {
+        const uint32_t key[3] = {chunks[i].key.x, chunks[i].key.y, chunks[i].key.z};
+        const uint64_t data_size = chunks[i].data.size ();
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (key), sizeof (key));
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&chunks[i].leaf_count), sizeof (chunks[i].leaf_count));
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&chunks[i].point_count), sizeof (chunks[i].point_count));
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&data_size), sizeof (data_size));
+      }
+
+      // output subtree data
+      for (std::size_t i = 0; i < chunks.size (); ++i)
+        compressed_tree_data_out_arg.write (chunks[i].data.data (), static_cast<std::streamsize> (chunks[i].data.size ()));
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> bool
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::subtreeDecoding (
+        std::istream& compressed_tree_data_in_arg, const double* region_arg)
+    {
+      uint64_t frame_data_size;
+      unsigned char split_depth;
+      uint32_t chunk_count;
+      uint64_t binary_tree_data_vector_size;
+
+      // read subtree configuration
+      compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&frame_data_size), sizeof (frame_data_size));
+      compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&split_depth), sizeof (split_depth));
+      compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&chunk_count), sizeof (chunk_count));
+      compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&point_count_), sizeof (point_count_));
+      compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&binary_tree_data_vector_size),
+                                        sizeof (binary_tree_data_vector_size));
+
+      const uint64_t header_size = sizeof (split_depth) + sizeof (chunk_count) + sizeof (point_count_) +
+                                   sizeof (binary_tree_data_vector_size);
+      const uint64_t entry_size = 5 * sizeof (uint32_t) + sizeof (uint64_t);
+      // The range coder gives each of the 256 symbols a frequency of at least 1 out of a total below 2^16, so even
+      // the most frequent symbol costs at least -log2 (1 - 255 / 2^16), about 0.0056 bits: a coded byte holds at
+      // most about 1430 symbols (runs of a single symbol reach about 1000 in practice). The limit is rounded up to
+      // 4096, almost three times the bound, so that the rounding of the coder can never reject a valid frame, while
+      // a corrupted size is still caught before it is allocated.
+      const uint64_t max_symbols_per_byte = 4096;
+      if (!compressed_tree_data_in_arg.good () || split_depth > this->octree_depth_ || frame_data_size < header_size)
+        return (false);
+
+      // the sizes read from the stream are checked against the bytes left in the frame before allocating anything
+      uint64_t bytes_left = frame_data_size - header_size;
+      if (chunk_count > bytes_left / entry_size)
+        return (false);
+      bytes_left -= chunk_count * entry_size;
+      if (binary_tree_data_vector_size > bytes_left * max_symbols_per_byte)
+        return (false);
+
+      // decode binary octree structure
+      binary_tree_data_vector_.resize (static_cast<std::size_t> (binary_tree_data_vector_size));
+      compressed_point_data_len_ = entropy_coder_.decodeStreamToCharVector (compressed_tree_data_in_arg,
+                                                                            binary_tree_data_vector_);
+      compressed_color_data_len_ = 0;
+      if (!compressed_tree_data_in_arg.good () || compressed_point_data_len_ > bytes_left)
+        return (false);
+      bytes_left -= compressed_point_data_len_;
+
+      // read subtree table
+      std::vector<SubtreeChunk> chunks (chunk_count);
+      std::vector<uint64_t> data_size (chunks.size ());
+      uint64_t leaf_count = 0;
+      uint64_t point_count = 0;
+      for (std::size_t i = 0; i < chunks.size (); ++i)
+      {
+        SubtreeChunk &chunk = chunks[i];
+        uint32_t key[3];
+        compressed_tree_data_in_arg.read (reinterpret_cast<char*> (key), sizeof (key));
+        compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&chunk.leaf_count), sizeof (chunk.leaf_count));
+        compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&chunk.point_count), sizeof (chunk.point_count));
+        compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&data_size[i]), sizeof (data_size[i]));
+        if (!compressed_tree_data_in_arg.good () || data_size[i] > bytes_left)
+          return (false);
+        bytes_left -= data_size[i];
+
+        // a subtree has at least one leaf and one point per leaf, a voxel grid exactly one. Otherwise, its entropy
+        // coded point offsets (three per point) have to fit in its data
+        if (chunk.leaf_count == 0 || chunk.point_count < chunk.leaf_count)
+          return (false);
+        if (do_voxel_grid_enDecoding_ ? chunk.point_count != chunk.leaf_count :
+            3 * static_cast<uint64_t> (chunk.point_count) > data_size[i] * max_symbols_per_byte)
+          return (false);
+
+        chunk.key = OctreeKey (key[0], key[1], key[2]);
+        chunk.leaf_begin = static_cast<uint32_t> (leaf_count);
+        leaf_count += chunk.leaf_count;
+        point_count += chunk.point_count;
+      }
+
+      // the subtrees fill the rest of the frame, and each byte of the tree structure has at most 8 leaves
+      if (bytes_left != 0 || point_count != point_count_ || leaf_count > 8 * binary_tree_data_vector_size)
+        return (false);
+
+      // deserialize the tree, this collects the leaf keys in depth first order
+      leaf_keys_.clear ();
+      leaf_keys_.reserve (static_cast<std::size_t> (leaf_count));
+      if (i_frame_)
+        // i-frame decoding - decode tree structure without referencing previous buffer
+        this->deserializeTree (binary_tree_data_vector_, false);
+      else
+        // p-frame decoding - decode XOR encoded tree structure
+        this->deserializeTree (binary_tree_data_vector_, true);
+
+      if (leaf_keys_.size () != leaf_count)
+        return (false);
+
+      // select the subtrees to decode and read their data, skip the others
+      const unsigned int shift = this->octree_depth_ - split_depth;
+      const double subtree_size = this->resolution_ * static_cast<double> (1u << shift);
+      const double min[3] = {this->min_x_, this->min_y_, this->min_z_};
+      std::vector<std::size_t> selected;
+      uint64_t output_size = 0;
+      for (std::size_t i = 0; i < chunks.size (); ++i)
+      {
+        SubtreeChunk &chunk = chunks[i];
+        const OctreeKey &first_leaf = leaf_keys_[chunk.leaf_begin];
+        if (!(OctreeKey (first_leaf.x >> shift, first_leaf.y >> shift, first_leaf.z >> shift) == chunk.key))
+          return (false);
+
+        bool decode = true;
+        if (region_arg)
+        {
+          const unsigned int key[3] = {chunk.key.x, chunk.key.y, chunk.key.z};
+          for (int d = 0; d < 3; ++d)
+          {
+            const double lower = static_cast<double> (key[d]) * subtree_size + min[d];
+            decode &= (lower <= region_arg[3 + d]) && (lower + subtree_size >= region_arg[d]);
+          }
+        }
+
+        if (decode)
+        {
+          chunk.point_begin = output_size;
+          output_size += chunk.point_count;
+          chunk.data.resize (static_cast<std::size_t> (data_size[i]));
+          compressed_tree_data_in_arg.read (&chunk.data[0], static_cast<std::streamsize> (data_size[i]));
+          selected.push_back (i);
+        }
+        else
+          compressed_tree_data_in_arg.ignore (static_cast<std::streamsize> (data_size[i]));
+      }
+      if (!compressed_tree_data_in_arg.good ())
+        return (false);
+
+      // initialize output cloud
+      output_->points.clear ();
+      output_->points.resize (static_cast<std::size_t> (output_size));
+
+      // decode the subtrees into their ranges of the output cloud
+      const int task_count = static_cast<int> (selected.size ());
+      const int grain_size = std::max (1, task_count / static_cast<int> (4 * pcl::parallel::getNumberOfThreads (threads_)));
+      const int nr_corrupted = pcl::parallel::parallel_reduce (0, task_count, 0, [&] (int begin, int end)
+      {
+        // coders are shared by the tasks of a range, constructing a range coder is not cheap
+        PointCoding<PointT> point_coder;
+        ColorCoding<PointT> color_coder;
+        StaticRangeCoder entropy_coder;
+        point_coder.setPrecision (point_coder_.getPrecision ());
+        color_coder.setBitDepth (color_coder_.getBitDepth ());
+
+        int corrupted = 0;
+        for (int i = begin; i < end; ++i)
+          if (!decodeSubtree (chunks[selected[i]], point_coder, color_coder, entropy_coder))
+            ++corrupted;
+        return (corrupted);
+      }, std::plus<int> (), grain_size, threads_);
+
+      for (std::size_t i = 0; i < selected.size (); ++i)
+        compressed_point_data_len_ += chunks[selected[i]].data.size ();
+
+      return (nr_corrupted == 0);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::encodeSubtree (
+        SubtreeChunk &chunk_arg, PointCoding<PointT> &point_coder_arg,
+        ColorCoding<PointT> &color_coder_arg, StaticRangeCoder &entropy_coder_arg,
+        uint64_t* compressed_len_arg)
+    {
+      std::vector<unsigned int> point_count_data_vector;
+      std::ostringstream chunk_data;
+
+      point_coder_arg.initializeEncoding ();
+      point_coder_arg.setPointCount (chunk_arg.point_count);
+      color_coder_arg.initializeEncoding ();
+      color_coder_arg.setPointCount (chunk_arg.point_count);
+      color_coder_arg.setVoxelCount (chunk_arg.leaf_count);
+      if (!do_voxel_grid_enDecoding_)
+        point_count_data_vector.reserve (chunk_arg.leaf_count);
+
+      // encode the leaves of the subtree
+      for (std::size_t i = chunk_arg.leaf_begin; i < chunk_arg.leaf_begin + chunk_arg.leaf_count; ++i)
+        encodeLeaf (*leaf_point_indices_[i], leaf_keys_[i], point_coder_arg, color_coder_arg, point_count_data_vector);
+
+      // apply entropy coding in the same order as entropyEncoding, without the tree structure
+      compressed_len_arg[0] = compressed_len_arg[1] = 0;
+      if (cloud_with_color_)
+      {
+        // encode averaged voxel color information
+        std::vector<char>& point_avg_color_data_vector = color_coder_arg.getAverageDataVector ();
+        const uint64_t point_avg_color_data_vector_size = point_avg_color_data_vector.size ();
+        chunk_data.write (reinterpret_cast<const char*> (&point_avg_color_data_vector_size),
+                          sizeof (point_avg_color_data_vector_size));
+        compressed_len_arg[1] += entropy_coder_arg.encodeCharVectorToStream (point_avg_color_data_vector, chunk_data);
+      }
+
+      if (!do_voxel_grid_enDecoding_)
+      {
+        // encode amount of points per voxel
+        const uint64_t point_count_data_vector_size = point_count_data_vector.size ();
+        chunk_data.write (reinterpret_cast<const char*> (&point_count_data_vector_size), sizeof (point_count_data_vector_size));
+        compressed_len_arg[0] += entropy_coder_arg.encodeIntVectorToStream (point_count_data_vector, chunk_data);
+
+        // encode differential point information
+        std::vector<char>& point_diff_data_vector = point_coder_arg.getDifferentialDataVector ();
+        const uint64_t point_diff_data_vector_size = point_diff_data_vector.size ();
+        chunk_data.write (reinterpret_cast<const char*> (&point_diff_data_vector_size), sizeof (point_diff_data_vector_size));
+        compressed_len_arg[0] += entropy_coder_arg.encodeCharVectorToStream (point_diff_data_vector, chunk_data);
+
+        if (cloud_with_color_)
+        {
+          // encode differential color information
+          std::vector<char>& point_diff_color_data_vector = color_coder_arg.getDifferentialDataVector ();
+          const uint64_t point_diff_color_data_vector_size = point_diff_color_data_vector.size ();
+          chunk_data.write (reinterpret_cast<const char*> (&point_diff_color_data_vector_size),
+                            sizeof (point_diff_color_data_vector_size));
+          compressed_len_arg[1] += entropy_coder_arg.encodeCharVectorToStream (point_diff_color_data_vector, chunk_data);
+        }
+      }
+
+      chunk_arg.data = chunk_data.str ();
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> bool
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::decodeSubtree (
+        const SubtreeChunk &chunk_arg, PointCoding<PointT> &point_coder_arg,
+        ColorCoding<PointT> &color_coder_arg, StaticRangeCoder &entropy_coder_arg)
+    {
+      std::vector<unsigned int> point_count_data_vector;
+      std::istringstream chunk_data (chunk_arg.data);
+      uint64_t vector_size;
+
+      // the size of each vector is checked against the leaves and points of the subtree before it is allocated, so
+      // that the coders neither allocate a corrupted size nor read past the end of a vector
+      if (data_with_color_)
+      {
+        // decode averaged voxel color information, three channels per leaf
+        std::vector<char>& point_avg_color_data_vector = color_coder_arg.getAverageDataVector ();
+        chunk_data.read (reinterpret_cast<char*> (&vector_size), sizeof (vector_size));
+        if (!chunk_data.good () || vector_size != 3 * static_cast<uint64_t> (chunk_arg.leaf_count))
+          return (false);
+        point_avg_color_data_vector.resize (static_cast<std::size_t> (vector_size));
+        entropy_coder_arg.decodeStreamToCharVector (chunk_data, point_avg_color_data_vector);
+      }
+
+      if (!do_voxel_grid_enDecoding_)
+      {
+        // decode amount of points per voxel
+        chunk_data.read (reinterpret_cast<char*> (&vector_size), sizeof (vector_size));
+        if (!chunk_data.good () || vector_size != chunk_arg.leaf_count)
+          return (false);
+        point_count_data_vector.resize (static_cast<std::size_t> (vector_size));
+        entropy_coder_arg.decodeStreamToIntVector (chunk_data, point_count_data_vector);
+
+        // make sure the points of the leaves stay within the range of the subtree
+        uint64_t point_count = 0;
+        uint64_t color_count = 0;
+        for (std::size_t i = 0; i < point_count_data_vector.size (); ++i)
+        {
+          point_count += point_count_data_vector[i];
+          // the colors of a leaf with a single point are its average color
+          if (point_count_data_vector[i] > 1)
+            color_count += point_count_data_vector[i];
+        }
+        if (point_count != chunk_arg.point_count)
+          return (false);
+
+        // decode differential point information, three offsets per point
+        std::vector<char>& point_diff_data_vector = point_coder_arg.getDifferentialDataVector ();
+        chunk_data.read (reinterpret_cast<char*> (&vector_size), sizeof (vector_size));
+        if (!chunk_data.good () || vector_size != 3 * point_count)
+          return (false);
+        point_diff_data_vector.resize (static_cast<std::size_t> (vector_size));
+        entropy_coder_arg.decodeStreamToCharVector (chunk_data, point_diff_data_vector);
+
+        if (data_with_color_)
+        {
+          // decode differential color information, three channels per point of the leaves with several points
+          std::vector<char>& point_diff_color_data_vector = color_coder_arg.getDifferentialDataVector ();
+          chunk_data.read (reinterpret_cast<char*> (&vector_size), sizeof (vector_size));
+          if (!chunk_data.good () || vector_size != 3 * color_count)
+            return (false);
+          point_diff_color_data_vector.resize (static_cast<std::size_t> (vector_size));
+          entropy_coder_arg.decodeStreamToCharVector (chunk_data, point_diff_color_data_vector);
+        }
+      }
+
+      // the entropy coded data must not extend past the end of the subtree
+      if (chunk_data.fail ())
+        return (false);
+
+      color_coder_arg.initializeDecoding ();
+      point_coder_arg.initializeDecoding ();
+
+      // decode the leaves of the subtree
+      std::size_t point_idx = static_cast<std::size_t> (chunk_arg.point_begin);
+      for (std::size_t i = 0; i < chunk_arg.leaf_count; ++i)
+      {
+        const std::size_t point_count = do_voxel_grid_enDecoding_ ? 1 : point_count_data_vector[i];
+        decodeLeaf (leaf_keys_[chunk_arg.leaf_begin + i], point_idx, point_count, point_coder_arg, color_coder_arg);
+        point_idx += point_count;
+      }
+      return (true);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::writeFrameIndex (
+        std::ostream& compressed_tree_data_out_arg) const
+    {
+      const uint32_t frame_count = static_cast<uint32_t> (frame_index_.size ());
+      const uint64_t index_size = strlen (frame_index_identifier_) + sizeof (frame_count) +
+                                  frame_index_.size () * (sizeof (uint32_t) + 1 + 2 * sizeof (uint64_t)) +
+                                  sizeof (uint64_t);
+
+      // encode index identifier and frame positions
+      compressed_tree_data_out_arg.write (frame_index_identifier_, strlen (frame_index_identifier_));
+      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&frame_count), sizeof (frame_count));
+      for (std::size_t i = 0; i < frame_index_.size (); ++i)
+      {
+        const FrameIndexEntry &entry = frame_index_[i];
+        const unsigned char frame_type = static_cast<unsigned char> ((entry.i_frame ? 1 : 0) | (entry.subtree_coded ? 2 : 0));
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&entry.frame_ID), sizeof (entry.frame_ID));
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&frame_type), sizeof (frame_type));
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&entry.offset), sizeof (entry.offset));
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&entry.size), sizeof (entry.size));
+      }
+
+      // the index ends with its size, so that it can be found from the end of the stream
+      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&index_size), sizeof (index_size));
+      compressed_tree_data_out_arg.flush ();
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> bool
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::readFrameIndex (
+        std::istream& compressed_tree_data_in_arg, std::vector<FrameIndexEntry> &frame_index_arg)
+    {
+      const std::size_t identifier_len = strlen (frame_index_identifier_);
+      const std::size_t entry_size = sizeof (uint32_t) + 1 + 2 * sizeof (uint64_t);
+      const std::size_t min_index_size = identifier_len + sizeof (uint32_t) + sizeof (uint64_t);
+      bool found = false;
+
+      frame_index_arg.clear ();
+      compressed_tree_data_in_arg.clear ();
+      const std::streampos position = compressed_tree_data_in_arg.tellg ();
+      if (position == std::streampos (-1))
+        return (false);
+
+      compressed_tree_data_in_arg.seekg (0, std::ios::end);
+      const std::streamoff stream_size = compressed_tree_data_in_arg.tellg ();
+      if (stream_size >= static_cast<std::streamoff> (min_index_size))
+      {
+        // read index size from the end of the stream
+        uint64_t index_size = 0;
+        compressed_tree_data_in_arg.seekg (stream_size - static_cast<std::streamoff> (sizeof (index_size)));
+        compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&index_size), sizeof (index_size));
+
+        if (compressed_tree_data_in_arg.good () && index_size >= min_index_size &&
+            index_size <= static_cast<uint64_t> (stream_size) && (index_size - min_index_size) % entry_size == 0)
+        {
+          std::vector<char> identifier (identifier_len);
+          uint32_t frame_count = 0;
+          compressed_tree_data_in_arg.seekg (stream_size - static_cast<std::streamoff> (index_size));
+          compressed_tree_data_in_arg.read (&identifier[0], identifier_len);
+          compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&frame_count), sizeof (frame_count));
+
+          if (compressed_tree_data_in_arg.good () &&
+              std::equal (identifier.begin (), identifier.end (), frame_index_identifier_) &&
+              frame_count == (index_size - min_index_size) / entry_size)
+          {
+            frame_index_arg.resize (frame_count);
+            for (std::size_t i = 0; i < frame_index_arg.size (); ++i)
+            {
+              FrameIndexEntry &entry = frame_index_arg[i];
+              unsigned char frame_type = 0;
+              compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&entry.frame_ID), sizeof (entry.frame_ID));
+              compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&frame_type), sizeof (frame_type));
+              compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&entry.offset), sizeof (entry.offset));
+              compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&entry.size), sizeof (entry.size));
+              entry.i_frame = (frame_type & 1) != 0;
+              entry.subtree_coded = (frame_type & 2) != 0;
+            }
+            found = compressed_tree_data_in_arg.good ();
+          }
+        }
+      }
+
+      if (!found)
+        frame_index_arg.clear ();
+
+      // restore read position
+      compressed_tree_data_in_arg.clear ();
+      compressed_tree_data_in_arg.seekg (position);
+      return (found);
+    }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::writeFrameHeader (std::ostream& compressed_tree_data_out_arg)
@@ -376,8 +952,9 @@ namespace pcl
       compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (frame_header_identifier_), strlen (frame_header_identifier_));
       // encode point cloud header id
       compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&frame_ID_), sizeof (frame_ID_));
-      // encode frame type (I/P-frame)
-      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&i_frame_), sizeof (i_frame_));
+      // encode frame type (bit 0: I/P-frame, bit 1: subtree coding)
+      const unsigned char frame_type = static_cast<unsigned char> ((i_frame_ ? 1 : 0) | (subtree_frame_ ? 2 : 0));
+      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&frame_type), sizeof (frame_type));
       if (i_frame_)
       {
         double min_x, min_y, min_z, max_x, max_y, max_z;
@@ -421,7 +998,7 @@ namespace pcl
     {
       // sync to frame header
       unsigned int header_id_pos = 0;
-      while (header_id_pos < strlen (frame_header_identifier_))
+      while (header_id_pos < strlen (frame_header_identifier_) && compressed_tree_data_in_arg.good ())
       {
         char readChar;
         compressed_tree_data_in_arg.read (static_cast<char*> (&readChar), sizeof (readChar));
@@ -436,7 +1013,10 @@ namespace pcl
     {
       // read header
       compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&frame_ID_), sizeof (frame_ID_));
-      compressed_tree_data_in_arg.read (reinterpret_cast<char*>(&i_frame_), sizeof (i_frame_));
+      unsigned char frame_type;
+      compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&frame_type), sizeof (frame_type));
+      i_frame_ = (frame_type & 1) != 0;
+      subtree_frame_ = (frame_type & 2) != 0;
       if (i_frame_)
       {
         double min_x, min_y, min_z, max_x, max_y, max_z;
@@ -479,12 +1059,29 @@ namespace pcl
       // reference to point indices vector stored within octree leaf
       const std::vector<int>& leafIdx = leaf_arg.getPointIndicesVector();
 
+      if (subtree_frame_)
+      {
+        // the points of subtree coded frames are encoded per subtree after the serialization
+        leaf_keys_.push_back (key_arg);
+        leaf_point_indices_.push_back (&leafIdx);
+      }
+      else
+        encodeLeaf (leafIdx, key_arg, point_coder_, color_coder_, point_count_data_vector_);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::encodeLeaf (
+        const std::vector<int> &leaf_idx_arg, const OctreeKey &key_arg,
+        PointCoding<PointT> &point_coder_arg, ColorCoding<PointT> &color_coder_arg,
+        std::vector<unsigned int> &point_count_arg)
+    {
       if (!do_voxel_grid_enDecoding_)
       {
         double lowerVoxelCorner[3];
 
         // encode amount of points within voxel
-        point_count_data_vector_.push_back (static_cast<int> (leafIdx.size ()));
+        point_count_arg.push_back (static_cast<unsigned int> (leaf_idx_arg.size ()));
 
         // calculate lower voxel corner based on octree key
         lowerVoxelCorner[0] = static_cast<double> (key_arg.x) * this->resolution_ + this->min_x_;
@@ -492,17 +1089,17 @@ namespace pcl
         lowerVoxelCorner[2] = static_cast<double> (key_arg.z) * this->resolution_ + this->min_z_;
 
         // differentially encode points to lower voxel corner
-        point_coder_.encodePoints (leafIdx, lowerVoxelCorner, this->input_);
+        point_coder_arg.encodePoints (leaf_idx_arg, lowerVoxelCorner, this->input_);
 
         if (cloud_with_color_)
           // encode color of points
-          color_coder_.encodePoints (leafIdx, point_color_offset_, this->input_);
+          color_coder_arg.encodePoints (leaf_idx_arg, point_color_offset_, this->input_);
       }
       else
       {
         if (cloud_with_color_)
           // encode average color of all points within voxel
-          color_coder_.encodeAverageOfPoints (leafIdx, point_color_offset_, this->input_);
+          color_coder_arg.encodeAverageOfPoints (leaf_idx_arg, point_color_offset_, this->input_);
       }
     }
 
@@ -511,56 +1108,70 @@ namespace pcl
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::deserializeTreeCallback (LeafT&,
         const OctreeKey& key_arg)
     {
-      double lowerVoxelCorner[3];
-      std::size_t pointCount, i, cloudSize;
-      PointT newPoint;
+      std::size_t pointCount, cloudSize;
+
+      if (subtree_frame_)
+      {
+        // the points of subtree coded frames are decoded per subtree after the deserialization
+        leaf_keys_.push_back (key_arg);
+        return;
+      }
 
       pointCount = 1;
 
       if (!do_voxel_grid_enDecoding_)
       {
-        // get current cloud size
-        cloudSize = output_->points.size ();
-
         // get amount of point to be decoded
         pointCount = *point_count_data_vector_iterator_;
         point_count_data_vector_iterator_++;
+      }
 
-        // increase point cloud by amount of voxel points
-        for (i = 0; i < pointCount; i++)
-          output_->points.push_back (newPoint);
+      // increase point cloud by amount of voxel points
+      cloudSize = output_->points.size ();
+      output_->points.resize (cloudSize + pointCount);
 
+      decodeLeaf (key_arg, cloudSize, pointCount, point_coder_, color_coder_);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::decodeLeaf (
+        const OctreeKey &key_arg, std::size_t begin_arg, std::size_t point_count_arg,
+        PointCoding<PointT> &point_coder_arg, ColorCoding<PointT> &color_coder_arg)
+    {
+      double lowerVoxelCorner[3];
+
+      if (!do_voxel_grid_enDecoding_)
+      {
         // calculcate position of lower voxel corner
         lowerVoxelCorner[0] = static_cast<double> (key_arg.x) * this->resolution_ + this->min_x_;
         lowerVoxelCorner[1] = static_cast<double> (key_arg.y) * this->resolution_ + this->min_y_;
         lowerVoxelCorner[2] = static_cast<double> (key_arg.z) * this->resolution_ + this->min_z_;
 
         // decode differentially encoded points
-        point_coder_.decodePoints (output_, lowerVoxelCorner, cloudSize, cloudSize + pointCount);
+        point_coder_arg.decodePoints (output_, lowerVoxelCorner, begin_arg, begin_arg + point_count_arg);
       }
       else
       {
+        PointT &newPoint = output_->points[begin_arg];
+
         // calculate center of lower voxel corner
         newPoint.x = static_cast<float> ((static_cast<double> (key_arg.x) + 0.5) * this->resolution_ + this->min_x_);
         newPoint.y = static_cast<float> ((static_cast<double> (key_arg.y) + 0.5) * this->resolution_ + this->min_y_);
         newPoint.z = static_cast<float> ((static_cast<double> (key_arg.z) + 0.5) * this->resolution_ + this->min_z_);
-
-        // add point to point cloud
-        output_->points.push_back (newPoint);
       }
 
       if (cloud_with_color_)
       {
         if (data_with_color_)
           // decode color information
-          color_coder_.decodePoints (output_, output_->points.size () - pointCount,
-                                    output_->points.size (), point_color_offset_);
+          color_coder_arg.decodePoints (output_, begin_arg, begin_arg + point_count_arg, point_color_offset_);
         else
           // set default color information
-          color_coder_.setDefaultColor (output_, output_->points.size () - pointCount,
-                                       output_->points.size (), point_color_offset_);
+          color_coder_arg.setDefaultColor (output_, begin_arg, begin_arg + point_count_arg, point_color_offset_);
       }
     }
+
   }
 }
 
@@ -50,6 +50,7 @@
 
 #include <iterator>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string.h>
 #include <iostream>
@@ -66,6 +67,11 @@ namespace pcl
      *  \note This class enables compression and decompression of point cloud data based on octree data structures.
      *  \note
      *  \note typename: PointT: type of point used in pointcloud
+     *  \note
+     *  \note With setSubtreeDepth, the point and color data of every frame are split into the subtrees found at
+     *  \note the given depth below the root. The subtrees are entropy coded independently, concurrently to the
+     *  \note octree structure, and can be decoded in parallel or selectively (see decodePointCloud with a region).
+     *  \note Frames are written as a single self-describing stream, writeFrameIndex appends a seekable frame index.
      *  \author Julius Kammerl (julius@kammerl.de)
      */
     template<typename PointT, typename LeafT = OctreeContainerPointIndices,
@@ -90,6 +96,20 @@ namespace pcl
         typedef OctreePointCloudCompression<PointT, LeafT, BranchT, Octree2BufBase<LeafT, BranchT> > RealTimeStreamCompression;
         typedef OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeBase<LeafT, BranchT> > SinglePointCloudCompressionLowMemory;
 
+        /** \brief Position of an encoded frame within the compressed stream, see getFrameIndex. */
+        struct FrameIndexEntry
+        {
+          /** \brief Frame ID as stored in the frame header */
+          uint32_t frame_ID;
+          /** \brief True for intra frames, which can be decoded without the preceding frames */
+          bool i_frame;
+          /** \brief True if the point data of the frame is coded in independent subtrees */
+          bool subtree_coded;
+          /** \brief Offset of the frame header, relative to the first byte written by the encoder */
+          uint64_t offset;
+          /** \brief Size of the frame in bytes */
+          uint64_t size;
+        };
 
         /** \brief Constructor
           * \param compressionProfile_arg:  define compression profile
@@ -125,7 +145,8 @@ namespace pcl
           compressed_point_data_len_ (), compressed_color_data_len_ (), selected_profile_(compressionProfile_arg),
           point_resolution_(pointResolution_arg), octree_resolution_(octreeResolution_arg),
           color_bit_resolution_(colorBitResolution_arg),
-          object_count_(0)
+          object_count_(0), subtree_depth_ (0), threads_ (0), subtree_frame_ (false),
+          leaf_keys_ (), leaf_point_indices_ (), frame_index_ (), stream_offset_ (0)
         {
           initialization();
         }
@@ -177,6 +198,18 @@ namespace pcl
           OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointIdx(pointIdx_arg);
         }
 
+        /** \brief Add point at index from input pointcloud dataset to the container of its leaf, called instead of
+         * addPointIdx when the octree is built in bulk
+         * \param[in] container the container of the leaf the point falls in
+         * \param[in] pointIdx_arg the index representing the point in the dataset given by \a setInputCloud
+         */
+        virtual void
+        addPointToLeafContainer (LeafT& container, const int pointIdx_arg)
+        {
+          ++object_count_;
+          container.addPointIndex (pointIdx_arg);
+        }
+
         /** \brief Provide a pointer to the output data set.
           * \param cloud_arg: the boost shared pointer to a PointCloud message
           */
@@ -208,12 +241,164 @@ namespace pcl
         /** \brief Decode point cloud from input stream
           * \param compressed_tree_data_in_arg: binary input stream containing compressed data
           * \param cloud_arg: reference to decoded point cloud
+          * \return false if no frame is found or the frame is corrupted, the decoded cloud is then empty
           */
-        void
+        bool
         decodePointCloud (std::istream& compressed_tree_data_in_arg, PointCloudPtr &cloud_arg);
 
+        /** \brief Decode the part of a point cloud that lies within an axis aligned box from the input stream.
+          * Only the subtrees intersecting the box are entropy decoded, the output holds all their points and may
+          * therefore contain points slightly outside of the box. The tree structure of the frame is always decoded,
+          * so that the following prediction frames stay decodable. Frames that are not subtree coded are decoded
+          * completely.
+          * \param compressed_tree_data_in_arg: binary input stream containing compressed data
+          * \param cloud_arg: reference to decoded point cloud
+          * \param min_pt: lower corner of the region of interest
+          * \param max_pt: upper corner of the region of interest
+          * \return false if no frame is found or the frame is corrupted, the decoded cloud is then empty
+          */
+        bool
+        decodePointCloud (std::istream& compressed_tree_data_in_arg, PointCloudPtr &cloud_arg,
+                          const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt);
+
+        /** \brief Set the depth below the root at which the point data is split in independently coded subtrees.
+          * \param subtree_depth_arg: depth of the subtree roots, 0 disables the subtree coding (default), which
+          * keeps the stream format of previous versions. Depths larger than the tree depth are clamped to it.
+          */
+        inline void
+        setSubtreeDepth (unsigned char subtree_depth_arg)
+        {
+          subtree_depth_ = subtree_depth_arg;
+        }
+
+        /** \brief Get the depth at which the point data is split in independently coded subtrees. */
+        inline unsigned char
+        getSubtreeDepth () const
+        {
+          return (subtree_depth_);
+        }
+
+        /** \brief Set the number of threads used to code the subtrees.
+          * \param nr_threads: the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
+
+        /** \brief Get the positions of all frames written by encodePointCloud so far. */
+        inline const std::vector<FrameIndexEntry>&
+        getFrameIndex () const
+        {
+          return (frame_index_);
+        }
+
+        /** \brief Append the frame index to the output stream. The index is skipped by decodePointCloud and can be
+          * read back with readFrameIndex from a seekable stream, to seek to the intra frames of a recording.
+          * \param compressed_tree_data_out_arg: binary output stream the frames have been written to
+          */
+        void
+        writeFrameIndex (std::ostream& compressed_tree_data_out_arg) const;
+
+        /** \brief Read the frame index written by writeFrameIndex at the end of a seekable input stream.
+          * The read position of the stream is restored.
+          * \param compressed_tree_data_in_arg: binary input stream
+          * \param frame_index_arg: the frame positions, as recorded by the encoder
+          * \return true if the stream ends with a frame index
+          */
+        static bool
+        readFrameIndex (std::istream& compressed_tree_data_in_arg, std::vector<FrameIndexEntry> &frame_index_arg);
+
       protected:
 
+        /** \brief A subtree of a frame whose point data is coded independently. */
+        struct SubtreeChunk
+        {
+          /** \brief Key of the subtree root, at the subtree depth */
+          OctreeKey key;
+          /** \brief Index of the first leaf of the subtree, in depth first order */
+          uint32_t leaf_begin;
+          /** \brief Number of leaves in the subtree */
+          uint32_t leaf_count;
+          /** \brief Number of points in the subtree */
+          uint32_t point_count;
+          /** \brief Index of the first point of the subtree in the output cloud (decoding only) */
+          uint64_t point_begin;
+          /** \brief Entropy coded point and color data */
+          std::string data;
+        };
+
+        /** \brief Decode a frame from the input stream, optionally restricted to a region
+          * \param compressed_tree_data_in_arg: binary input stream
+          * \param cloud_arg: reference to decoded point cloud
+          * \param region_arg: lower (0..2) and upper (3..5) corner of the region to decode, or NULL
+          * \return false if no frame is found or the frame is corrupted
+          */
+        bool
+        decodeFrame (std::istream& compressed_tree_data_in_arg, PointCloudPtr &cloud_arg, const double* region_arg);
+
+        /** \brief Split the leaves collected during serialization in subtrees, code them in parallel and output
+          * the frame payload to the binary stream
+          * \param compressed_tree_data_out_arg: binary output stream
+          */
+        void
+        subtreeEncoding (std::ostream& compressed_tree_data_out_arg);
+
+        /** \brief Read the frame payload of a subtree coded frame, deserialize the tree and decode the subtrees
+          * \param compressed_tree_data_in_arg: binary input stream
+          * \param region_arg: lower (0..2) and upper (3..5) corner of the region to decode, or NULL
+          * \return false if the stream is corrupted
+          */
+        bool
+        subtreeDecoding (std::istream& compressed_tree_data_in_arg, const double* region_arg);
+
+        /** \brief Encode the point and color data of a subtree
+          * \param chunk_arg: the subtree, receives the coded data
+          * \param point_coder_arg: point coding instance of the calling thread
+          * \param color_coder_arg: color coding instance of the calling thread
+          * \param entropy_coder_arg: range coder of the calling thread
+          * \param compressed_len_arg: receives the coded point (0) and color (1) data size in bytes
+          */
+        void
+        encodeSubtree (SubtreeChunk &chunk_arg, PointCoding<PointT> &point_coder_arg,
+                       ColorCoding<PointT> &color_coder_arg, StaticRangeCoder &entropy_coder_arg,
+                       uint64_t* compressed_len_arg);
+
+        /** \brief Decode the point and color data of a subtree into its range of the output cloud
+          * \param chunk_arg: the subtree
+          * \param point_coder_arg: point coding instance of the calling thread
+          * \param color_coder_arg: color coding instance of the calling thread
+          * \param entropy_coder_arg: range coder of the calling thread
+          * \return false if the data of the subtree is corrupted
+          */
+        bool
+        decodeSubtree (const SubtreeChunk &chunk_arg, PointCoding<PointT> &point_coder_arg,
+                       ColorCoding<PointT> &color_coder_arg, StaticRangeCoder &entropy_coder_arg);
+
+        /** \brief Encode the points of a leaf node
+          * \param leaf_idx_arg: indices of the points within the leaf
+          * \param key_arg: octree key of the leaf node
+          * \param point_coder_arg: point coding instance
+          * \param color_coder_arg: color coding instance
+          * \param point_count_arg: receives the amount of points of the leaf
+          */
+        void
+        encodeLeaf (const std::vector<int> &leaf_idx_arg, const OctreeKey &key_arg,
+                    PointCoding<PointT> &point_coder_arg, ColorCoding<PointT> &color_coder_arg,
+                    std::vector<unsigned int> &point_count_arg);
+
+        /** \brief Decode the points of a leaf node to a range of the output cloud
+          * \param key_arg: octree key of the leaf node
+          * \param begin_arg: index of the first point in the output cloud
+          * \param point_count_arg: amount of points of the leaf
+          * \param point_coder_arg: point coding instance
+          * \param color_coder_arg: color coding instance
+          */
+        void
+        decodeLeaf (const OctreeKey &key_arg, std::size_t begin_arg, std::size_t point_count_arg,
+                    PointCoding<PointT> &point_coder_arg, ColorCoding<PointT> &color_coder_arg);
+
         /** \brief Write frame information to output stream
           * \param compressed_tree_data_out_arg: binary output stream
           */
@@ -303,6 +488,9 @@ namespace pcl
         // frame header identifier
         static const char* frame_header_identifier_;
 
+        // frame index identifier
+        static const char* frame_index_identifier_;
+
         const compression_Profiles_e selected_profile_;
         const double point_resolution_;
         const double octree_resolution_;
@@ -310,11 +498,36 @@ namespace pcl
 
         std::size_t object_count_;
 
+        /** \brief Depth of the independently coded subtrees, 0 disables the subtree coding */
+        unsigned char subtree_depth_;
+
+        /** \brief Number of threads used for the subtree coding (0: automatic) */
+        unsigned int threads_;
+
+        /** \brief True if the current frame is subtree coded */
+        bool subtree_frame_;
+
+        /** \brief Keys of the leaf nodes of a subtree coded frame, in depth first order */
+        std::vector<OctreeKey> leaf_keys_;
+
+        /** \brief Point indices of the leaf nodes of a subtree coded frame (encoding only) */
+        std::vector<const std::vector<int>*> leaf_point_indices_;
+
+        /** \brief Positions of the encoded frames */
+        std::vector<FrameIndexEntry> frame_index_;
+
+        /** \brief Amount of bytes written by the encoder */
+        uint64_t stream_offset_;
+
       };
 
     // define frame identifier
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
       const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::frame_header_identifier_ = "<PCL-OCT-COMPRESSED>";
+
+    // define frame index identifier
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
+      const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::frame_index_identifier_ = "<PCL-OCT-FRAME-INDEX>";
   }
 
 }
@@ -0,0 +1,189 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_KDTREE_FLANN_INDEX_FILE_H_
+#define PCL_KDTREE_FLANN_INDEX_FILE_H_
+
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_representation.h>
+#include <pcl/kdtree/flann.h>
+
+#include <boost/crc.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <string>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief A persistent FLANN search index: the built index together with the points it refers to, which can be
+    * memory mapped and searched read-only, without rebuilding the index.
+    *
+    * The file starts with a versioned header (see \ref Header), followed by the index mapping (the cloud index of
+    * each point of the index, absent for an identity mapping), the points as packed rows of floats (aligned on 64
+    * bytes), and the index as serialized by FLANN. The points are used in place from the memory mapping, only the
+    * FLANN index itself is deserialized. For this, single kd-tree indices have to be built without reordering
+    * (flann::KDTreeSingleIndexParams (leaf_max_size, false)), otherwise FLANN serializes and loads its own copy of
+    * the points: a reordering index (see \ref isReordered) is rebuilt without reordering before it is saved.
+    *
+    * The header records a checksum of the source cloud (see \ref computeChecksum), so that an index is only
+    * loaded for the cloud it was built from. The files are not portable across architectures with a different
+    * endianness or FLANN versions.
+    *
+    * This is used by KdTreeFLANN::saveIndex/loadIndex and search::FlannSearch::saveIndex/loadIndex.
+    * \ingroup kdtree
+    */
+  class PCL_EXPORTS FlannIndexFile
+  {
+    public:
+      typedef boost::shared_ptr<FlannIndexFile> Ptr;
+      typedef boost::shared_ptr<const FlannIndexFile> ConstPtr;
+
+      /** \brief The header of a FLANN index file. */
+      struct Header
+      {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        char flann_version[16];
+        /** \brief The FLANN index type (flann::flann_algorithm_t). */
+        uint32_t algorithm;
+        uint32_t dimension;
+        uint64_t nr_points;
+        uint64_t mapping_size;
+        uint32_t identity_mapping;
+        uint32_t checksum;
+        uint64_t mapping_offset;
+        uint64_t data_offset;
+        uint64_t index_offset;
+        uint64_t file_size;
+      };
+
+      /** \brief Empty constructor. */
+      FlannIndexFile () : file_name_ (), header_ (), mapped_file_ () {}
+
+      /** \brief Compute the checksum identifying the source of an index: the CRC-32 of the index and coordinates
+        * (as vectorized by the point representation) of all the valid points used from the cloud.
+        * \param[in] cloud the input cloud
+        * \param[in] indices the indices of the points used from \a cloud, all of them if NULL or empty
+        * \param[in] point_representation the point representation the index is built with
+        */
+      template <typename PointT> static uint32_t
+      computeChecksum (const PointCloud<PointT> &cloud, const std::vector<int> *indices,
+                       const PointRepresentation<PointT> &point_representation);
+
+      /** \brief Save an index and its points to a file.
+        * \param[in] file_name the name of the file
+        * \param[in] index the built FLANN index
+        * \param[in] points the points of \a index
+        * \param[in] index_mapping the cloud index of each point of \a index, empty for an identity mapping
+        * \param[in] checksum the checksum of the source cloud (see \ref computeChecksum)
+        * \return true if successful
+        */
+      template <typename IndexT> static bool
+      save (const std::string &file_name, IndexT &index, const ::flann::Matrix<float> &points,
+            const std::vector<int> &index_mapping, uint32_t checksum);
+
+      /** \brief Check whether a FLANN index searches its own, reordered copy of the points (a single kd-tree built
+        * with reordering, the FLANN default), which FLANN would serialize with the index.
+        * \param[in] index the FLANN index
+        */
+      template <typename IndexT> static bool
+      isReordered (const IndexT &index);
+
+      /** \brief Open and memory map an index file, and check its header.
+        * \param[in] file_name the name of the file
+        * \param[in] dimension the expected dimension of the points
+        * \param[in] checksum the checksum of the cloud the index is loaded for (see \ref computeChecksum)
+        * \return true if the file is valid and matches \a dimension and \a checksum
+        */
+      bool
+      open (const std::string &file_name, int dimension, uint32_t checksum);
+
+      /** \brief Load the FLANN index from the opened file. The index has to be created (but not built) on the
+        * points returned by \ref getPoints, with the same type as the saved one.
+        * \param[in,out] index the FLANN index
+        * \return true if successful
+        */
+      template <typename IndexT> bool
+      loadIndex (IndexT &index) const;
+
+      /** \brief Get the memory mapped points of the opened file. They stay valid as long as this object exists. */
+      ::flann::Matrix<float>
+      getPoints () const;
+
+      /** \brief Get the index mapping of the opened file, empty for an identity mapping. */
+      void
+      getIndexMapping (std::vector<int> &index_mapping) const;
+
+      /** \brief Get the header of the opened file. */
+      inline const Header&
+      getHeader () const
+      {
+        return (header_);
+      }
+
+    private:
+      /** \brief Write the header, the index mapping and the points of an index file, leaving \a file at the
+        * position of the FLANN index.
+        */
+      static bool
+      writeHeader (FILE *file, Header &header, const ::flann::Matrix<float> &points,
+                   const std::vector<int> &index_mapping);
+
+      /** \brief Complete the header of an index file once the FLANN index is written. */
+      static bool
+      finalizeHeader (FILE *file, Header &header);
+
+      /** \brief Move a completely written index file to its destination, replacing any previous file. */
+      static bool
+      replaceFile (const std::string &temporary_file_name, const std::string &file_name);
+
+      /** \brief The name of the opened file. */
+      std::string file_name_;
+
+      /** \brief The header of the opened file. */
+      Header header_;
+
+      /** \brief The memory mapping of the opened file. */
+      boost::iostreams::mapped_file_source mapped_file_;
+  };
+}
+
+#include <pcl/kdtree/impl/flann_index_file.hpp>
+
+#endif    // PCL_KDTREE_FLANN_INDEX_FILE_H_
@@ -0,0 +1,150 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_KDTREE_IMPL_FLANN_INDEX_FILE_H_
+#define PCL_KDTREE_IMPL_FLANN_INDEX_FILE_H_
+
+#include <pcl/kdtree/flann_index_file.h>
+#include <pcl/console/print.h>
+#include <cstdio>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> pcl::uint32_t
+pcl::FlannIndexFile::computeChecksum (const PointCloud<PointT> &cloud, const std::vector<int> *indices,
+                                      const PointRepresentation<PointT> &point_representation)
+{
+  const bool use_indices = indices && !indices->empty ();
+  const size_t nr_points = use_indices ? indices->size () : cloud.points.size ();
+  std::vector<float> coordinates (point_representation.getNumberOfDimensions ());
+
+  boost::crc_32_type crc;
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+    const int index = use_indices ? (*indices)[i] : static_cast<int> (i);
+    const PointT &point = cloud.points[index];
+    if (!point_representation.isValid (point))
+      continue;
+    point_representation.vectorize (point, coordinates);
+    crc.process_bytes (&index, sizeof (index));
+    if (!coordinates.empty ())
+      crc.process_bytes (&coordinates[0], coordinates.size () * sizeof (float));
+  }
+  return (crc.checksum ());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename IndexT> bool
+pcl::FlannIndexFile::save (const std::string &file_name, IndexT &index, const ::flann::Matrix<float> &points,
+                           const std::vector<int> &index_mapping, uint32_t checksum)
+{
+  // The index is written to a temporary file which then replaces the destination, so that the indices memory
+  // mapped from a previous version of the file stay valid
+  const std::string temporary_file_name = file_name + ".tmp";
+  FILE *file = fopen (temporary_file_name.c_str (), "wb");
+  if (!file)
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::save] Could not open %s for writing!\n", temporary_file_name.c_str ());
+    return (false);
+  }
+
+  Header header;
+  header.algorithm = static_cast<uint32_t> (index.getType ());
+  header.checksum = checksum;
+  bool success = writeHeader (file, header, points, index_mapping);
+  if (success)
+  {
+    index.saveIndex (file);
+    success = finalizeHeader (file, header);
+  }
+  success = (fclose (file) == 0) && success;
+  if (!success)
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::save] Error writing %s!\n", temporary_file_name.c_str ());
+    std::remove (temporary_file_name.c_str ());
+    return (false);
+  }
+  return (replaceFile (temporary_file_name, file_name));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename IndexT> bool
+pcl::FlannIndexFile::isReordered (const IndexT &index)
+{
+  return (index.getType () == ::flann::FLANN_INDEX_KDTREE_SINGLE &&
+          ::flann::get_param<bool> (index.getParameters (), "reorder", true));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename IndexT> bool
+pcl::FlannIndexFile::loadIndex (IndexT &index) const
+{
+  if (!mapped_file_.is_open ())
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::loadIndex] No index file opened!\n");
+    return (false);
+  }
+  if (static_cast<uint32_t> (index.getType ()) != header_.algorithm)
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::loadIndex] The index in %s is of another FLANN index type!\n",
+               file_name_.c_str ());
+    return (false);
+  }
+
+  FILE *file = fopen (file_name_.c_str (), "rb");
+  if (!file || fseek (file, static_cast<long> (header_.index_offset), SEEK_SET) != 0)
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::loadIndex] Could not read %s!\n", file_name_.c_str ());
+    if (file)
+      fclose (file);
+    return (false);
+  }
+
+  bool success = true;
+  try
+  {
+    index.loadIndex (file);
+  }
+  catch (const std::exception &e)
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::loadIndex] Could not load the index of %s: %s\n", file_name_.c_str (), e.what ());
+    success = false;
+  }
+  fclose (file);
+  return (success);
+}
+
+#endif    // PCL_KDTREE_IMPL_FLANN_INDEX_FILE_H_
@@ -43,13 +43,16 @@
 #include <pcl/kdtree/kdtree_flann.h>
 #include <pcl/kdtree/flann.h>
 #include <pcl/console/print.h>
+#include <pcl/common/profiler.h>
+#include <pcl/common/morton.h>
+#include <pcl/common/parallel.h>
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist>
 pcl::KdTreeFLANN<PointT, Dist>::KdTreeFLANN (bool sorted)
   : pcl::KdTree<PointT> (sorted)
-  , flann_index_ (), cloud_ ()
-  , index_mapping_ (), identity_mapping_ (false)
+  , flann_index_ (), cloud_ (), index_file_ ()
+  , index_mapping_ (), identity_mapping_ (false), spatial_reordering_ (false)
   , dim_ (0), total_nr_points_ (0)
   , param_k_ (::flann::SearchParams (-1 , epsilon_))
   , param_radius_ (::flann::SearchParams (-1, epsilon_, sorted))
@@ -60,8 +63,8 @@ pcl::KdTreeFLANN<PointT, Dist>::KdTreeFLANN (bool sorted)
 template <typename PointT, typename Dist>
 pcl::KdTreeFLANN<PointT, Dist>::KdTreeFLANN (const KdTreeFLANN<PointT> &k) 
   : pcl::KdTree<PointT> (false)
-  , flann_index_ (), cloud_ ()
-  , index_mapping_ (), identity_mapping_ (false)
+  , flann_index_ (), cloud_ (), index_file_ ()
+  , index_mapping_ (), identity_mapping_ (false), spatial_reordering_ (false)
   , dim_ (0), total_nr_points_ (0)
   , param_k_ (::flann::SearchParams (-1 , epsilon_))
   , param_radius_ (::flann::SearchParams (-1, epsilon_, false))
@@ -91,6 +94,8 @@ pcl::KdTreeFLANN<PointT, Dist>::setSortedResults (bool sorted)
 template <typename PointT, typename Dist> void 
 pcl::KdTreeFLANN<PointT, Dist>::setInputCloud (const PointCloudConstPtr &cloud, const IndicesConstPtr &indices)
 {
+  PCL_PROFILE_SCOPE ("KdTreeFLANN::setInputCloud");
+
   cleanup ();   // Perform an automatic cleanup of structures
 
   epsilon_ = 0.0f;   // default error bound value
@@ -105,6 +110,25 @@ pcl::KdTreeFLANN<PointT, Dist>::setInputCloud (const PointCloudConstPtr &cloud,
     PCL_ERROR ("[pcl::KdTreeFLANN::setInputCloud] Invalid input!\n");
     return;
   }
+
+  // Build the index directly on the points of the cloud when they already are what the point representation
+  // would copy, saving a full copy of the cloud
+  if (indices == NULL && !spatial_reordering_ && canAliasCloud (*input_))
+  {
+    cloud_.reset ();
+    identity_mapping_ = true;
+    total_nr_points_ = static_cast<int> (input_->points.size ());
+    // The const_cast is harmless, FLANN does not modify the data it indexes. Reordering is switched off,
+    // otherwise FLANN would build the tree on a copy of the points and the alias would save nothing
+    flann_index_.reset (new FLANNIndex (::flann::Matrix<float> (const_cast<float*> (reinterpret_cast<const float*> (&input_->points[0])),
+                                                                input_->points.size (),
+                                                                dim_,
+                                                                sizeof (PointT)),
+                                        ::flann::KDTreeSingleIndexParams (15, false))); // max 15 points/leaf, no copy
+    flann_index_->buildIndex ();
+    return;
+  }
+
   if (indices != NULL)
   {
     convertCloudToArray (*input_, *indices_);
@@ -119,14 +143,109 @@ pcl::KdTreeFLANN<PointT, Dist>::setInputCloud (const PointCloudConstPtr &cloud,
     PCL_ERROR ("[pcl::KdTreeFLANN::setInputCloud] Cannot create a KDTree with an empty input cloud!\n");
     return;
   }
+  if (spatial_reordering_)
+    reorderArray ();
 
+  // FLANN reorders a copy of the array so that the points of a leaf are contiguous in memory, unless the array
+  // already is spatially reordered
   flann_index_.reset (new FLANNIndex (::flann::Matrix<float> (cloud_.get (), 
                                                               index_mapping_.size (), 
                                                               dim_),
-                                      ::flann::KDTreeSingleIndexParams (15))); // max 15 points/leaf
+                                      ::flann::KDTreeSingleIndexParams (15, !spatial_reordering_))); // max 15 points/leaf
   flann_index_->buildIndex ();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> bool
+pcl::KdTreeFLANN<PointT, Dist>::saveIndex (const std::string &file_name) const
+{
+  if (!flann_index_ || !input_)
+  {
+    PCL_ERROR ("[pcl::KdTreeFLANN::saveIndex] No index to save, call setInputCloud first!\n");
+    return (false);
+  }
+
+  // The points the index is built on: either the internal array or the cloud itself
+  ::flann::Matrix<float> points;
+  if (cloud_)
+    points = ::flann::Matrix<float> (cloud_.get (), index_mapping_.size (), dim_);
+  else if (index_file_)
+    points = index_file_->getPoints ();
+  else
+    points = ::flann::Matrix<float> (const_cast<float*> (reinterpret_cast<const float*> (&input_->points[0])),
+                                     input_->points.size (), dim_, sizeof (PointT));
+
+  const uint32_t checksum = FlannIndexFile::computeChecksum (*input_, indices_.get (), *point_representation_);
+  const std::vector<int> index_mapping = identity_mapping_ ? std::vector<int> () : index_mapping_;
+
+  // A reordering index searches FLANN's own copy of the points, which FLANN would also serialize. The saved index
+  // is rebuilt without reordering on the points written to the file instead, so that it is searched in place
+  // once loaded
+  if (FlannIndexFile::isReordered (*flann_index_))
+  {
+    FLANNIndex flann_index (points, ::flann::KDTreeSingleIndexParams (15, false)); // max 15 points/leaf, no copy
+    flann_index.buildIndex ();
+    return (FlannIndexFile::save (file_name, flann_index, points, index_mapping, checksum));
+  }
+  return (FlannIndexFile::save (file_name, *flann_index_, points, index_mapping, checksum));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> bool
+pcl::KdTreeFLANN<PointT, Dist>::loadIndex (const std::string &file_name, const PointCloudConstPtr &cloud,
+                                           const IndicesConstPtr &indices)
+{
+  PCL_PROFILE_SCOPE ("KdTreeFLANN::loadIndex");
+
+  if (!cloud)
+  {
+    PCL_ERROR ("[pcl::KdTreeFLANN::loadIndex] Invalid input!\n");
+    return (false);
+  }
+
+  const int dim = point_representation_->getNumberOfDimensions ();
+  const uint32_t checksum = FlannIndexFile::computeChecksum (*cloud, indices.get (), *point_representation_);
+  boost::shared_ptr<FlannIndexFile> index_file (new FlannIndexFile);
+  if (!index_file->open (file_name, dim, checksum))
+    return (false);
+
+  // The index is created on the memory mapped points, which it searches in place (no reordering copy)
+  boost::shared_ptr<FLANNIndex> flann_index (new FLANNIndex (index_file->getPoints (),
+                                                             ::flann::KDTreeSingleIndexParams (15, false)));
+  if (!index_file->loadIndex (*flann_index))
+    return (false);
+
+  // Only replace the current tree once the file is completely loaded, a failure leaves it untouched
+  cleanup ();
+  cloud_.reset ();
+  epsilon_ = 0.0f;   // default error bound value
+  dim_ = dim;
+  input_ = cloud;
+  indices_ = indices;
+  index_file_ = index_file;
+  flann_index_ = flann_index;
+  index_file_->getIndexMapping (index_mapping_);
+  identity_mapping_ = index_mapping_.empty ();
+  total_nr_points_ = static_cast<int> (index_file_->getHeader ().nr_points);
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> bool
+pcl::KdTreeFLANN<PointT, Dist>::canAliasCloud (const PointCloud &cloud) const
+{
+  // A trivial point representation copies the first dim_ floats of the point
+  if (cloud.points.empty () || !point_representation_->isTrivial () ||
+      static_cast<size_t> (dim_) * sizeof (float) > sizeof (PointT))
+    return (false);
+
+  // Invalid points have to be left out of the index, which needs the copy
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+    if (!point_representation_->isValid (cloud.points[i]))
+      return (false);
+  return (true);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> int 
 pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointT &point, int k, 
@@ -209,12 +328,116 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
   return (neighbors_in_radius);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int
+pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                                                std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                                                unsigned int nr_threads) const
+{
+  PCL_PROFILE_SCOPE ("KdTreeFLANN::nearestKSearch");
+
+  if (k > total_nr_points_)
+    k = total_nr_points_;
+  if (k < 0)
+    k = 0;
+
+  const size_t nr_queries = indices.empty () ? cloud.points.size () : indices.size ();
+  k_indices.resize (nr_queries * k);
+  k_sqr_distances.resize (nr_queries * k);
+  if (k_indices.empty ())
+    return (k);
+
+  std::vector<float> queries;
+  const ::flann::Matrix<float> queries_mat = vectorizeQueries (cloud, indices, queries);
+
+  // FLANN distributes the queries over its threads and writes the results in place
+  ::flann::Matrix<int> k_indices_mat (&k_indices[0], nr_queries, k);
+  ::flann::Matrix<float> k_distances_mat (&k_sqr_distances[0], nr_queries, k);
+  const pcl::parallel::ThreadReservation reservation (nr_threads);
+  ::flann::SearchParams params (param_k_);
+  params.cores = static_cast<int> (reservation.getNumberOfThreads ());
+  flann_index_->knnSearch (queries_mat, k_indices_mat, k_distances_mat, k, params);
+
+  // Do mapping to original point cloud
+  if (!identity_mapping_)
+  {
+    for (size_t i = 0; i < k_indices.size (); ++i)
+    {
+      int& neighbor_index = k_indices[i];
+      neighbor_index = index_mapping_[neighbor_index];
+    }
+  }
+
+  return (k);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> void
+pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                                              std::vector<std::vector<int> > &k_indices,
+                                              std::vector<std::vector<float> > &k_sqr_distances,
+                                              unsigned int max_nn, unsigned int nr_threads) const
+{
+  PCL_PROFILE_SCOPE ("KdTreeFLANN::radiusSearch");
+
+  const size_t nr_queries = indices.empty () ? cloud.points.size () : indices.size ();
+  if (nr_queries == 0 || total_nr_points_ == 0)
+  {
+    k_indices.assign (nr_queries, std::vector<int> ());
+    k_sqr_distances.assign (nr_queries, std::vector<float> ());
+    return;
+  }
+
+  std::vector<float> queries;
+  const ::flann::Matrix<float> queries_mat = vectorizeQueries (cloud, indices, queries);
+
+  const pcl::parallel::ThreadReservation reservation (nr_threads);
+  ::flann::SearchParams params (param_radius_);
+  params.cores = static_cast<int> (reservation.getNumberOfThreads ());
+  if (max_nn == 0 || max_nn >= static_cast<unsigned int> (total_nr_points_))
+    params.max_neighbors = -1;  // return all neighbors in radius
+  else
+    params.max_neighbors = max_nn;
+  flann_index_->radiusSearch (queries_mat, k_indices, k_sqr_distances, static_cast<float> (radius * radius), params);
+
+  // Do mapping to original point cloud
+  if (!identity_mapping_)
+  {
+    for (size_t i = 0; i < k_indices.size (); ++i)
+    {
+      for (size_t j = 0; j < k_indices[i].size (); ++j)
+      {
+        int& neighbor_index = k_indices[i][j];
+        neighbor_index = index_mapping_[neighbor_index];
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> ::flann::Matrix<float>
+pcl::KdTreeFLANN<PointT, Dist>::vectorizeQueries (const PointCloud &cloud, const std::vector<int> &indices,
+                                                  std::vector<float> &queries) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.points.size () : indices.size ();
+  queries.resize (nr_queries * dim_);
+  for (size_t i = 0; i < nr_queries; ++i)
+  {
+    const PointT &point = cloud.points[indices.empty () ? i : indices[i]];
+    assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to a batch search!");
+    float *out = &queries[i * dim_];
+    point_representation_->vectorize (point, out);
+  }
+  return (::flann::Matrix<float> (&queries[0], nr_queries, dim_));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> void 
 pcl::KdTreeFLANN<PointT, Dist>::cleanup ()
 {
   // Data array cleanup
   index_mapping_.clear ();
+  index_file_.reset ();
 
   if (indices_)
     indices_.reset ();
@@ -293,6 +516,25 @@ pcl::KdTreeFLANN<PointT, Dist>::convertCloudToArray (const PointCloud &cloud, co
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> void 
+pcl::KdTreeFLANN<PointT, Dist>::reorderArray ()
+{
+  std::vector<int> order;
+  pcl::computeMortonOrder (cloud_.get (), index_mapping_.size (), dim_, dim_, order);
+
+  boost::shared_array<float> reordered (new float[index_mapping_.size () * dim_]);
+  std::vector<int> reordered_mapping (index_mapping_.size ());
+  for (size_t i = 0; i < order.size (); ++i)
+  {
+    std::copy (&cloud_[order[i] * dim_], &cloud_[(order[i] + 1) * dim_], &reordered[i * dim_]);
+    reordered_mapping[i] = index_mapping_[order[i]];
+  }
+  cloud_ = reordered;
+  index_mapping_.swap (reordered_mapping);
+  identity_mapping_ = false;
+}
+
 #define PCL_INSTANTIATE_KdTreeFLANN(T) template class PCL_EXPORTS pcl::KdTreeFLANN<T>;
 
 #endif  //#ifndef _PCL_KDTREE_KDTREE_IMPL_FLANN_H_
@@ -43,6 +43,7 @@
 
 #include <pcl/kdtree/kdtree.h>
 #include <pcl/kdtree/flann.h>
+#include <pcl/kdtree/flann_index_file.h>
 
 #include <boost/shared_array.hpp>
 
@@ -110,8 +111,10 @@ namespace pcl
         KdTree<PointT>::operator=(k);
         flann_index_ = k.flann_index_;
         cloud_ = k.cloud_;
+        index_file_ = k.index_file_;
         index_mapping_ = k.index_mapping_;
         identity_mapping_ = k.identity_mapping_;
+        spatial_reordering_ = k.spatial_reordering_;
         dim_ = k.dim_;
         total_nr_points_ = k.total_nr_points_;
         param_k_ = k.param_k_;
@@ -127,6 +130,18 @@ namespace pcl
 
       void 
       setSortedResults (bool sorted);
+
+      /** \brief Store the points of the tree along a Morton curve (see pcl::computeMortonOrder), so that points
+        * close in space are close in memory. The search results still refer to the input cloud. Takes effect at the
+        * next call to setInputCloud ().
+        * \param[in] reordering true to reorder the points (default: false)
+        */
+      inline void
+      setSpatialReordering (bool reordering) { spatial_reordering_ = reordering; }
+
+      /** \brief Get whether the points of the tree are stored along a Morton curve. */
+      inline bool
+      getSpatialReordering () const { return (spatial_reordering_); }
       
       inline Ptr makeShared () { return Ptr (new KdTreeFLANN<PointT> (*this)); } 
 
@@ -141,10 +156,40 @@ namespace pcl
       /** \brief Provide a pointer to the input dataset.
         * \param[in] cloud the const boost shared pointer to a PointCloud message
         * \param[in] indices the point indices subset that is to be used from \a cloud - if NULL the whole cloud is used
+        *
+        * \note When no indices are given, all the points are valid and the point representation is trivial (e.g.
+        * xyz), the index is built directly on the memory of \a cloud instead of a converted copy of it.
+        * \attention The points of \a cloud must not be modified or reallocated while the tree uses them: the tree
+        * structure does not follow the changes, so the search results would silently be wrong. Call setInputCloud
+        * again after any change to the cloud.
         */
       void 
       setInputCloud (const PointCloudConstPtr &cloud, const IndicesConstPtr &indices = IndicesConstPtr ());
 
+      /** \brief Save the built index together with its points to a file (see pcl::FlannIndexFile), to be reloaded
+        * with \ref loadIndex instead of rebuilding it.
+        * \note A tree built on a reordered copy of the points (the default when the cloud is not searched in
+        * place) is rebuilt without reordering on the saved points, since the loaded tree searches them in place.
+        * \param[in] file_name the name of the file
+        * \return true if successful
+        */
+      bool
+      saveIndex (const std::string &file_name) const;
+
+      /** \brief Load an index saved by \ref saveIndex, instead of building it with \ref setInputCloud. The points
+        * of the index are memory mapped read-only from the file and searched in place, only the tree is deserialized.
+        *
+        * The file is only loaded if it was built from the same points, as checked with the checksum saved in it
+        * (see pcl::FlannIndexFile::computeChecksum), and with the same point representation dimension.
+        * \param[in] file_name the name of the file
+        * \param[in] cloud the cloud the index was built from
+        * \param[in] indices the point indices subset the index was built from - if NULL the whole cloud is used
+        * \return true if successful. Otherwise the current tree is kept unchanged.
+        */
+      bool
+      loadIndex (const std::string &file_name, const PointCloudConstPtr &cloud,
+                 const IndicesConstPtr &indices = IndicesConstPtr ());
+
       /** \brief Search for k-nearest neighbors for the given query point.
         * 
         * \attention This method does not do any bounds checking for the input index
@@ -183,6 +228,40 @@ namespace pcl
       radiusSearch (const PointT &point, double radius, std::vector<int> &k_indices,
                     std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
 
+      /** \brief Search for the k-nearest neighbors of a batch of query points, with a single FLANN query.
+        *
+        * The neighbors of query i are stored at [i * n, (i + 1) * n) of \a k_indices and \a k_sqr_distances, with n
+        * the returned number of neighbors per query.
+        * \attention All the query points are assumed to be valid (i.e., finite).
+        * \param[in] cloud the point cloud data
+        * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are queried.
+        * \param[in] k the number of neighbors to search for
+        * \param[out] k_indices the resultant indices of the neighboring points of all the queries
+        * \param[out] k_sqr_distances the resultant squared distances to the neighboring points of all the queries
+        * \param[in] nr_threads the number of threads FLANN uses (0: automatic, see pcl::parallel::getNumberOfThreads)
+        * \return number of neighbors found for each query point, \a k or less if the tree has fewer points
+        */
+      int
+      nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                      std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                      unsigned int nr_threads = 0) const;
+
+      /** \brief Search for all the nearest neighbors of a batch of query points in a given radius, with a single
+        * FLANN query.
+        * \attention All the query points are assumed to be valid (i.e., finite).
+        * \param[in] cloud the point cloud data
+        * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are queried.
+        * \param[in] radius the radius of the sphere bounding all of the neighbors
+        * \param[out] k_indices the resultant indices of the neighboring points, k_indices[i] corresponds to query i
+        * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+        * \param[in] max_nn if given, bounds the maximum returned neighbors of each query point to this value
+        * \param[in] nr_threads the number of threads FLANN uses (0: automatic, see pcl::parallel::getNumberOfThreads)
+        */
+      void
+      radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                    std::vector<std::vector<int> > &k_indices, std::vector<std::vector<float> > &k_sqr_distances,
+                    unsigned int max_nn = 0, unsigned int nr_threads = 0) const;
+
     private:
       /** \brief Internal cleanup method. */
       void 
@@ -203,6 +282,26 @@ namespace pcl
       void 
       convertCloudToArray (const PointCloud &cloud, const std::vector<int> &indices);
 
+      /** \brief Check whether the FLANN index can be built directly on the points of a cloud, without
+        * converting them to the internal point array: the point representation has to be trivial and all the
+        * points valid.
+        * \param[in] cloud the PointCloud data
+        */
+      bool
+      canAliasCloud (const PointCloud &cloud) const;
+
+      /** \brief Sort the internal FLANN point array along a Morton curve, updating the index mapping. */
+      void
+      reorderArray ();
+
+      /** \brief Convert query points to a FLANN matrix.
+        * \param[in] cloud the point cloud data
+        * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used.
+        * \param[out] queries the storage of the matrix, the query points as packed rows of dim_ floats
+        */
+      ::flann::Matrix<float>
+      vectorizeQueries (const PointCloud &cloud, const std::vector<int> &indices, std::vector<float> &queries) const;
+
     private:
       /** \brief Class getName method. */
       virtual std::string 
@@ -211,8 +310,11 @@ namespace pcl
       /** \brief A FLANN index object. */
       boost::shared_ptr<FLANNIndex> flann_index_;
 
-      /** \brief Internal pointer to data. */
+      /** \brief Internal pointer to data, empty when the index is built directly on the input cloud. */
       boost::shared_array<float> cloud_;
+
+      /** \brief The memory mapped file holding the points of an index loaded with \ref loadIndex. */
+      boost::shared_ptr<FlannIndexFile> index_file_;
       
       /** \brief mapping between internal and external indices. */
       std::vector<int> index_mapping_;
@@ -220,6 +322,9 @@ namespace pcl
       /** \brief whether the mapping bwwteen internal and external indices is identity */
       bool identity_mapping_;
 
+      /** \brief Whether the internal point array is sorted along a Morton curve. */
+      bool spatial_reordering_;
+
       /** \brief Tree dimensionality (i.e. the number of dimensions per point). */
       int dim_;
 
@@ -0,0 +1,212 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/kdtree/flann_index_file.h>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+  const char flann_index_file_magic[8] = { 'P', 'C', 'L', 'F', 'L', 'A', 'N', 'N' };
+  const pcl::uint32_t flann_index_file_version = 1;
+
+  /** \brief The FLANN version the library is built with, as recorded in the index files. */
+  const char*
+  getFlannVersion ()
+  {
+#ifdef FLANN_VERSION_
+    return (FLANN_VERSION_);
+#else
+    return ("unknown");
+#endif
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::FlannIndexFile::writeHeader (FILE *file, Header &header, const ::flann::Matrix<float> &points,
+                                  const std::vector<int> &index_mapping)
+{
+  std::memcpy (header.magic, flann_index_file_magic, sizeof (header.magic));
+  header.version = flann_index_file_version;
+  header.header_size = static_cast<uint32_t> (sizeof (Header));
+  std::memset (header.flann_version, 0, sizeof (header.flann_version));
+  std::strncpy (header.flann_version, getFlannVersion (), sizeof (header.flann_version) - 1);
+  header.dimension = static_cast<uint32_t> (points.cols);
+  header.nr_points = points.rows;
+  header.mapping_size = index_mapping.size ();
+  header.identity_mapping = index_mapping.empty ();
+  header.mapping_offset = sizeof (Header);
+  // The points are aligned for the vectorized distance computations of FLANN
+  header.data_offset = (header.mapping_offset + header.mapping_size * sizeof (int) + 63) & ~static_cast<uint64_t> (63);
+  header.index_offset = header.data_offset + header.nr_points * header.dimension * sizeof (float);
+  header.file_size = 0;
+
+  fwrite (&header, sizeof (Header), 1, file);
+  if (!index_mapping.empty ())
+    fwrite (&index_mapping[0], sizeof (int), index_mapping.size (), file);
+  const char padding[64] = { 0 };
+  fwrite (padding, 1, header.data_offset - header.mapping_offset - header.mapping_size * sizeof (int), file);
+
+  if (points.stride == points.cols * sizeof (float))
+    fwrite (points.ptr (), sizeof (float), points.rows * points.cols, file);
+  else
+    for (size_t i = 0; i < points.rows; ++i)
+      fwrite (points[i], sizeof (float), points.cols, file);
+  return (ferror (file) == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::FlannIndexFile::finalizeHeader (FILE *file, Header &header)
+{
+  const long file_size = ftell (file);
+  if (file_size < 0 || static_cast<uint64_t> (file_size) < header.index_offset)
+    return (false);
+  header.file_size = static_cast<uint64_t> (file_size);
+  if (fseek (file, 0, SEEK_SET) != 0)
+    return (false);
+  fwrite (&header, sizeof (Header), 1, file);
+  return (ferror (file) == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::FlannIndexFile::replaceFile (const std::string &temporary_file_name, const std::string &file_name)
+{
+  // A rename replaces an existing file atomically on POSIX systems. Elsewhere, the file has to be removed first
+  // (which fails while it is mapped).
+  if (std::rename (temporary_file_name.c_str (), file_name.c_str ()) != 0 &&
+      (std::remove (file_name.c_str ()) != 0 || std::rename (temporary_file_name.c_str (), file_name.c_str ()) != 0))
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::save] Could not replace %s!\n", file_name.c_str ());
+    std::remove (temporary_file_name.c_str ());
+    return (false);
+  }
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::FlannIndexFile::open (const std::string &file_name, int dimension, uint32_t checksum)
+{
+  if (mapped_file_.is_open ())
+    mapped_file_.close ();
+  file_name_ = file_name;
+
+  try
+  {
+    mapped_file_.open (file_name);
+  }
+  catch (const std::exception &e)
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::open] Could not open %s: %s\n", file_name.c_str (), e.what ());
+    return (false);
+  }
+
+  bool valid = mapped_file_.size () >= sizeof (Header);
+  if (valid)
+    std::memcpy (&header_, mapped_file_.data (), sizeof (Header));
+  if (!valid || std::memcmp (header_.magic, flann_index_file_magic, sizeof (header_.magic)) != 0)
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::open] %s is not a FLANN index file!\n", file_name.c_str ());
+    mapped_file_.close ();
+    return (false);
+  }
+  if (header_.version != flann_index_file_version || header_.header_size != sizeof (Header))
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::open] Unsupported version %u of %s!\n", header_.version, file_name.c_str ());
+    mapped_file_.close ();
+    return (false);
+  }
+  if (std::strncmp (header_.flann_version, getFlannVersion (), sizeof (header_.flann_version)) != 0)
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::open] %s was written with FLANN %.16s, but FLANN %s is used!\n",
+               file_name.c_str (), header_.flann_version, getFlannVersion ());
+    mapped_file_.close ();
+    return (false);
+  }
+
+  // The sections have to be in order and within the file, which detects most truncated or corrupted files
+  const uint64_t mapping_end = header_.mapping_offset + header_.mapping_size * sizeof (int);
+  const uint64_t data_end = header_.data_offset + header_.nr_points * header_.dimension * sizeof (float);
+  if (header_.file_size != mapped_file_.size () || header_.mapping_offset != sizeof (Header) ||
+      mapping_end > header_.data_offset || header_.data_offset % 64 != 0 || data_end > header_.index_offset ||
+      header_.index_offset > header_.file_size || (header_.identity_mapping != 0) != (header_.mapping_size == 0))
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::open] Corrupted index file %s!\n", file_name.c_str ());
+    mapped_file_.close ();
+    return (false);
+  }
+
+  if (header_.dimension != static_cast<uint32_t> (dimension))
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::open] The index in %s has %u dimensions instead of %d!\n",
+               file_name.c_str (), header_.dimension, dimension);
+    mapped_file_.close ();
+    return (false);
+  }
+  if (header_.checksum != checksum)
+  {
+    PCL_ERROR ("[pcl::FlannIndexFile::open] The index in %s was not built from the given cloud!\n", file_name.c_str ());
+    mapped_file_.close ();
+    return (false);
+  }
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+::flann::Matrix<float>
+pcl::FlannIndexFile::getPoints () const
+{
+  if (!mapped_file_.is_open ())
+    return (::flann::Matrix<float> ());
+  // FLANN never modifies the points it indexes, the read-only mapping is safe
+  float *points = const_cast<float*> (reinterpret_cast<const float*> (mapped_file_.data () + header_.data_offset));
+  return (::flann::Matrix<float> (points, header_.nr_points, header_.dimension));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::FlannIndexFile::getIndexMapping (std::vector<int> &index_mapping) const
+{
+  index_mapping.clear ();
+  if (!mapped_file_.is_open () || header_.mapping_size == 0)
+    return;
+  const int *mapping = reinterpret_cast<const int*> (mapped_file_.data () + header_.mapping_offset);
+  index_mapping.assign (mapping, mapping + header_.mapping_size);
+}
@@ -43,6 +43,7 @@
 
 #include <pcl/impl/instantiate.hpp>
 #include <pcl/point_types.h>
+#include <pcl/console/print.h>
 #include <pcl/octree/octree.h>
 
 namespace pcl
@@ -58,7 +59,10 @@ namespace pcl
           depth_mask_ (0),
           octree_depth_ (0),
           dynamic_depth_enabled_ (false),
-          max_key_ ()
+          max_key_ (),
+          use_node_arena_ (false),
+          branch_arena_ (),
+          leaf_arena_ ()
       {
       }
 
@@ -66,11 +70,40 @@ namespace pcl
     template<typename LeafContainerT, typename BranchContainerT>
       OctreeBase<LeafContainerT, BranchContainerT>::~OctreeBase ()
       {
+        // arena nodes are destroyed with their arenas
+        if (use_node_arena_)
+          return;
+
         // deallocate tree structure
         deleteTree ();
         delete (root_node_);
       }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename LeafContainerT, typename BranchContainerT>
+      void
+      OctreeBase<LeafContainerT, BranchContainerT>::setUseNodeArena (bool use_node_arena_arg)
+      {
+        if (use_node_arena_arg == use_node_arena_)
+          return;
+
+        // nodes can not move between heap and arena
+        if (leaf_count_ != 0)
+        {
+          PCL_ERROR ("[pcl::octree::OctreeBase::setUseNodeArena] The node allocation can only be changed while the "
+                     "octree is empty!\n");
+          return;
+        }
+
+        deleteTree ();
+        deallocateBranchNode (root_node_);
+        branch_arena_.clear ();
+        leaf_arena_.clear ();
+
+        use_node_arena_ = use_node_arena_arg;
+        root_node_ = allocateBranchNode ();
+      }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename LeafContainerT, typename BranchContainerT>
       void
@@ -169,7 +202,15 @@ namespace pcl
         if (root_node_)
         {
           // reset octree
-          deleteBranch (*root_node_);
+          if (use_node_arena_)
+          {
+            // destroy all nodes at once
+            branch_arena_.clear ();
+            leaf_arena_.clear ();
+            root_node_ = allocateBranchNode ();
+          }
+          else
+            deleteBranch (*root_node_);
           leaf_count_ = 0;
           branch_count_ = 1;
         }
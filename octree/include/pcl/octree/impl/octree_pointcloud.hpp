@@ -43,6 +43,10 @@
 #include <assert.h>
 
 #include <pcl/common/common.h>
+#include <pcl/common/morton.h>
+#include <pcl/common/parallel.h>
+
+#include <boost/type_traits/is_same.hpp>
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -50,7 +54,8 @@ template<typename PointT, typename LeafContainerT, typename BranchContainerT, ty
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::OctreePointCloud (const double resolution) :
     OctreeT (), input_ (PointCloudConstPtr ()), indices_ (IndicesConstPtr ()),
     epsilon_ (0), resolution_ (resolution), min_x_ (0.0f), max_x_ (resolution), min_y_ (0.0f),
-    max_y_ (resolution), min_z_ (0.0f), max_z_ (resolution), bounding_box_defined_ (false), max_objs_per_leaf_(0)
+    max_y_ (resolution), min_z_ (0.0f), max_z_ (resolution), bounding_box_defined_ (false), max_objs_per_leaf_(0),
+    bulk_build_ (true)
 {
   assert (resolution > 0.0f);
 }
@@ -65,34 +70,143 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
 template<typename PointT, typename LeafContainerT, typename BranchContainerT, typename OctreeT> void
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::addPointsFromInputCloud ()
 {
-  size_t i;
+  std::vector<int> point_indices;
 
   if (indices_)
   {
+    point_indices.reserve (indices_->size ());
     for (std::vector<int>::const_iterator current = indices_->begin (); current != indices_->end (); ++current)
     {
       assert( (*current>=0) && (*current < static_cast<int> (input_->points.size ())));
       
       if (isFinite (input_->points[*current]))
-      {
-        // add points to octree
-        this->addPointIdx (*current);
-      }
+        point_indices.push_back (*current);
     }
   }
   else
   {
-    for (i = 0; i < input_->points.size (); i++)
+    point_indices.reserve (input_->points.size ());
+    for (size_t i = 0; i < input_->points.size (); i++)
     {
       if (isFinite (input_->points[i]))
+        point_indices.push_back (static_cast<int> (i));
+    }
+  }
+
+  if (isBulkBuildSupported ())
+  {
+    // grow the bounding box in the order of the points, as addPointIdx does, so that both build the same octree
+    for (std::vector<int>::const_iterator current = point_indices.begin (); current != point_indices.end (); ++current)
+    {
+      const PointT& point = input_->points[*current];
+      if (!bounding_box_defined_ || !isPointWithinBoundingBox (point))
+        adoptBoundingBoxToPoint (point);
+    }
+  }
+
+  // add points to octree
+  addPointIndicesBulk (point_indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT, typename OctreeT> void
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::addPointIndicesBulk (
+    const std::vector<int>& point_indices)
+{
+  if (!isBulkBuildSupported ())
+  {
+    for (std::vector<int>::const_iterator current = point_indices.begin (); current != point_indices.end (); ++current)
+      this->addPointIdx (*current);
+    return;
+  }
+
+  const int nr_points = static_cast<int> (point_indices.size ());
+  if (nr_points == 0)
+    return;
+
+  // generate the keys and their Morton codes in parallel
+  std::vector<OctreeKey> keys (nr_points);
+  std::vector<uint64_t> codes (nr_points);
+  pcl::parallel::parallel_for (0, nr_points, [&] (int begin, int end)
+  {
+    for (int i = begin; i < end; ++i)
+    {
+      this->genOctreeKeyForDataT (point_indices[i], keys[i]);
+      codes[i] = pcl::encodeMorton3D (keys[i].x, keys[i].y, keys[i].z);
+    }
+  }, 4096);
+
+  // the sort is stable, the points of a voxel stay in the order of point_indices
+  std::vector<int> order;
+  pcl::sortMortonCodes (codes, order);
+
+  // branches along the path to the current leaf, path[depth] is the branch at that depth
+  const unsigned int tree_depth = this->octree_depth_;
+  std::vector<BranchNode*> path (tree_depth);
+  path[0] = this->root_node_;
+
+  unsigned int depth = 0;
+  int run_begin = 0;
+  while (run_begin < nr_points)
+  {
+    int run_end = run_begin + 1;
+    while (run_end < nr_points && codes[run_end] == codes[run_begin])
+      ++run_end;
+
+    if (run_begin > 0)
+    {
+      // the Morton codes interleave the key bits level by level: the highest differing triplet gives the deepest
+      // branch shared with the previous voxel
+      unsigned int level = 0;
+      for (uint64_t diff = (codes[run_begin] ^ codes[run_begin - 1]) >> 3; diff; diff >>= 3)
+        ++level;
+      depth = tree_depth - 1 - level;
+    }
+
+    const OctreeKey& key = keys[order[run_begin]];
+    LeafNode* leaf_node = 0;
+    for (; depth < tree_depth; ++depth)
+    {
+      BranchNode& branch = *path[depth];
+      const unsigned char child_idx = key.getChildIdxWithDepthMask (1u << (tree_depth - 1 - depth));
+
+      if (depth + 1 < tree_depth)
       {
-        // add points to octree
-        this->addPointIdx (static_cast<unsigned int> (i));
+        if (!this->branchHasChild (branch, child_idx))
+        {
+          this->createBranchChild (branch, child_idx);
+          this->branch_count_++;
+        }
+        path[depth + 1] = static_cast<BranchNode*> (this->getBranchChildPtr (branch, child_idx));
+      }
+      else
+      {
+        if (!this->branchHasChild (branch, child_idx))
+        {
+          this->createLeafChild (branch, child_idx);
+          this->leaf_count_++;
+        }
+        leaf_node = static_cast<LeafNode*> (this->getBranchChildPtr (branch, child_idx));
       }
     }
+
+    for (int i = run_begin; i < run_end; ++i)
+      addPointToLeafContainer (leaf_node->getContainer (), point_indices[order[i]]);
+
+    run_begin = run_end;
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT, typename OctreeT> bool
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::isBulkBuildSupported () const
+{
+  // the double buffered octree reuses the nodes of its previous buffer, which only createLeafRecursive handles.
+  // The Morton codes hold 21 bits per key coordinate.
+  return (bulk_build_ && boost::is_same<OctreeT, OctreeBase<LeafContainerT, BranchContainerT> >::value
+          && !this->dynamic_depth_enabled_ && this->octree_depth_ <= 21);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafContainerT, typename BranchContainerT, typename OctreeT> void
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::addPointFromCloud (const int point_idx_arg, IndicesPtr indices_arg)
@@ -448,7 +562,7 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
 
         BranchNode* newRootBranch;
 
-        newRootBranch = new BranchNode();
+        newRootBranch = this->allocateBranchNode ();
         this->branch_count_++;
 
         this->setBranchChildPtr (*newRootBranch, child_idx, this->root_node_);
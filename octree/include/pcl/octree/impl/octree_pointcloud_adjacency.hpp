@@ -79,7 +79,23 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   }
   this->defineBoundingBox (minX, minY, minZ, maxX, maxY, maxZ);
 
-  OctreePointCloud<PointT, LeafContainerT, BranchContainerT>::addPointsFromInputCloud ();
+  // the bounding box contains the transformed points already, add them without growing it
+  std::vector<int> point_indices;
+  if (this->indices_)
+  {
+    point_indices.reserve (this->indices_->size ());
+    for (size_t i = 0; i < this->indices_->size (); ++i)
+      if (pcl::isFinite (input_->points[(*this->indices_)[i]]))
+        point_indices.push_back ((*this->indices_)[i]);
+  }
+  else
+  {
+    point_indices.reserve (input_->size ());
+    for (size_t i = 0; i < input_->size (); ++i)
+      if (pcl::isFinite (input_->points[i]))
+        point_indices.push_back (static_cast<int> (i));
+  }
+  this->addPointIndicesBulk (point_indices);
   
   LeafContainerT *leaf_container;
   typename OctreeAdjacencyT::LeafNodeIterator leaf_itr;
@@ -0,0 +1,489 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_POINTCLOUD_OCCUPANCY_MAP_HPP
+#define PCL_OCTREE_POINTCLOUD_OCCUPANCY_MAP_HPP
+
+#include <pcl/octree/octree_pointcloud_occupancy_map.h>
+#include <pcl/common/morton.h>
+#include <pcl/common/parallel.h>
+
+#include <algorithm>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT>
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::OctreePointCloudOccupancyMap (
+    const double resolution_arg) :
+    OctreePointCloudT (resolution_arg),
+    log_odds_hit_ (probabilityToLogOdds (0.7)),
+    log_odds_miss_ (probabilityToLogOdds (0.4)),
+    clamping_min_ (probabilityToLogOdds (0.1192)),
+    clamping_max_ (probabilityToLogOdds (0.971)),
+    occupancy_threshold_ (0.0f),
+    pruning_ (true)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::insertScan (
+    const PointCloud &scan_arg, const Eigen::Vector3f &sensor_origin_arg, double max_range_arg,
+    unsigned int nr_threads_arg)
+{
+  if (!pcl_isfinite (sensor_origin_arg (0)) || !pcl_isfinite (sensor_origin_arg (1))
+      || !pcl_isfinite (sensor_origin_arg (2)))
+  {
+    PCL_ERROR ("[pcl::octree::OctreePointCloudOccupancyMap::insertScan] Sensor origin is not finite!\n");
+    return;
+  }
+
+  // end point of a beam, shortened to the maximum range
+  const float max_range = static_cast<float> (max_range_arg);
+  const bool limit_range = max_range_arg > 0.0;
+  auto beamEnd = [&] (const PointT &point, bool &truncated) -> Eigen::Vector3f
+  {
+    Eigen::Vector3f end = point.getVector3fMap ();
+    const float range = (end - sensor_origin_arg).norm ();
+    truncated = limit_range && range > max_range;
+    if (truncated)
+      end = sensor_origin_arg + (end - sensor_origin_arg) * (max_range / range);
+    return (end);
+  };
+
+  // grow the bounding box once, so that the beams can be cast concurrently
+  PointT point;
+  point.getVector3fMap () = sensor_origin_arg;
+  if (!this->bounding_box_defined_ || !this->isPointWithinBoundingBox (point))
+    this->adoptBoundingBoxToPoint (point);
+
+  std::vector<int> beams;
+  beams.reserve (scan_arg.points.size ());
+  for (int i = 0; i < static_cast<int> (scan_arg.points.size ()); ++i)
+  {
+    if (!isFinite (scan_arg.points[i]))
+      continue;
+
+    bool truncated;
+    point.getVector3fMap () = beamEnd (scan_arg.points[i], truncated);
+    if (!this->isPointWithinBoundingBox (point))
+      this->adoptBoundingBoxToPoint (point);
+    beams.push_back (i);
+  }
+
+  if (this->octree_depth_ > 21)
+  {
+    PCL_ERROR ("[pcl::octree::OctreePointCloudOccupancyMap::insertScan] Octree depth %u exceeds the 21 levels of "
+               "the Morton codes!\n", this->octree_depth_);
+    return;
+  }
+
+  // cast the beams in fixed chunks, each deduplicating its own keys
+  const int chunk_size = 256;
+  const int nr_beams = static_cast<int> (beams.size ());
+  const int nr_chunks = (nr_beams + chunk_size - 1) / chunk_size;
+  std::vector<std::vector<uint64_t> > free_chunks (nr_chunks);
+  std::vector<std::vector<uint64_t> > occupied_chunks (nr_chunks);
+
+  const Eigen::Vector3d min_pt (this->min_x_, this->min_y_, this->min_z_);
+  const Eigen::Vector3d origin = (sensor_origin_arg.cast<double> () - min_pt) / this->resolution_;
+
+  pcl::parallel::parallel_for (0, nr_chunks, [&] (int chunk_begin, int chunk_end)
+  {
+    for (int chunk = chunk_begin; chunk < chunk_end; ++chunk)
+    {
+      std::vector<uint64_t> &free_codes = free_chunks[chunk];
+      std::vector<uint64_t> &occupied_codes = occupied_chunks[chunk];
+
+      const int end = std::min (nr_beams, (chunk + 1) * chunk_size);
+      for (int i = chunk * chunk_size; i < end; ++i)
+      {
+        bool truncated;
+        const Eigen::Vector3d beam_end = (beamEnd (scan_arg.points[beams[i]], truncated).template cast<double> ()
+                                         - min_pt) / this->resolution_;
+        castRay (origin, beam_end, free_codes);
+
+        OctreeKey key;
+        key.x = static_cast<unsigned int> (beam_end (0));
+        key.y = static_cast<unsigned int> (beam_end (1));
+        key.z = static_cast<unsigned int> (beam_end (2));
+        (truncated ? free_codes : occupied_codes).push_back (pcl::encodeMorton3D (key.x, key.y, key.z));
+      }
+
+      std::sort (free_codes.begin (), free_codes.end ());
+      free_codes.erase (std::unique (free_codes.begin (), free_codes.end ()), free_codes.end ());
+      std::sort (occupied_codes.begin (), occupied_codes.end ());
+      occupied_codes.erase (std::unique (occupied_codes.begin (), occupied_codes.end ()), occupied_codes.end ());
+    }
+  }, 1, nr_threads_arg);
+
+  // gather the chunks and deduplicate the keys of the whole scan
+  std::vector<uint64_t> free_codes, occupied_codes;
+  std::vector<int> order;
+  for (int phase = 0; phase < 2; ++phase)
+  {
+    std::vector<std::vector<uint64_t> > &chunks = phase ? occupied_chunks : free_chunks;
+    std::vector<uint64_t> &codes = phase ? occupied_codes : free_codes;
+
+    std::size_t nr_codes = 0;
+    for (std::size_t chunk = 0; chunk < chunks.size (); ++chunk)
+      nr_codes += chunks[chunk].size ();
+    codes.reserve (nr_codes);
+    for (std::size_t chunk = 0; chunk < chunks.size (); ++chunk)
+    {
+      codes.insert (codes.end (), chunks[chunk].begin (), chunks[chunk].end ());
+      std::vector<uint64_t> ().swap (chunks[chunk]);
+    }
+
+    pcl::sortMortonCodes (codes, order, nr_threads_arg);
+    codes.erase (std::unique (codes.begin (), codes.end ()), codes.end ());
+  }
+
+  updateVoxels (free_codes, occupied_codes);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::updateVoxelAtPoint (
+    const PointT& point_arg, bool occupied_arg)
+{
+  if (!isFinite (point_arg))
+    return;
+
+  if (!this->bounding_box_defined_ || !this->isPointWithinBoundingBox (point_arg))
+    this->adoptBoundingBoxToPoint (point_arg);
+
+  if (this->octree_depth_ > 21)
+  {
+    PCL_ERROR ("[pcl::octree::OctreePointCloudOccupancyMap::updateVoxelAtPoint] Octree depth %u exceeds the 21 "
+               "levels of the Morton codes!\n", this->octree_depth_);
+    return;
+  }
+
+  OctreeKey key;
+  this->genOctreeKeyforPoint (point_arg, key);
+
+  const std::vector<uint64_t> codes (1, pcl::encodeMorton3D (key.x, key.y, key.z));
+  const std::vector<uint64_t> no_codes;
+  if (occupied_arg)
+    updateVoxels (no_codes, codes);
+  else
+    updateVoxels (codes, no_codes);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> bool
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::getOccupancyAtPoint (
+    const PointT& point_arg, float& occupancy_arg) const
+{
+  if (!this->bounding_box_defined_ || !isFinite (point_arg) || !this->isPointWithinBoundingBox (point_arg))
+    return (false);
+
+  OctreeKey key;
+  this->genOctreeKeyforPoint (point_arg, key);
+
+  // leaves of pruned subtrees are found above the maximum depth
+  const LeafContainerT* leaf = this->findLeaf (key);
+  if (!leaf)
+    return (false);
+
+  occupancy_arg = leaf->getOccupancy ();
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> int
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::getOccupiedVoxelCenters (
+    AlignedPointTVector &voxel_center_list_arg) const
+{
+  voxel_center_list_arg.clear ();
+
+  OctreeKey key;
+  getVoxelCentersRecursive (this->root_node_, key, 0, true, voxel_center_list_arg);
+  return (static_cast<int> (voxel_center_list_arg.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> int
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::getFreeVoxelCenters (
+    AlignedPointTVector &voxel_center_list_arg) const
+{
+  voxel_center_list_arg.clear ();
+
+  OctreeKey key;
+  getVoxelCentersRecursive (this->root_node_, key, 0, false, voxel_center_list_arg);
+  return (static_cast<int> (voxel_center_list_arg.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::castRay (
+    const Eigen::Vector3d &origin_arg, const Eigen::Vector3d &end_arg, std::vector<uint64_t> &codes_arg) const
+{
+  const int max_key = (1 << this->octree_depth_) - 1;
+
+  int key[3];
+  int step[3];
+  int remaining[3];
+  double t_max[3];
+  double t_delta[3];
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    // clamp against rounding at the faces of the bounding box
+    key[axis] = std::min (std::max (static_cast<int> (std::floor (origin_arg (axis))), 0), max_key);
+    const int end_key = std::min (std::max (static_cast<int> (std::floor (end_arg (axis))), 0), max_key);
+    const double direction = end_arg (axis) - origin_arg (axis);
+
+    step[axis] = (end_key > key[axis]) ? 1 : -1;
+    remaining[axis] = std::abs (end_key - key[axis]);
+    if (remaining[axis] == 0 || direction == 0.0)
+    {
+      t_max[axis] = t_delta[axis] = std::numeric_limits<double>::max ();
+      continue;
+    }
+
+    // ray parameter at the first voxel boundary and between two boundaries of this axis
+    const double boundary = static_cast<double> (step[axis] > 0 ? key[axis] + 1 : key[axis]);
+    t_max[axis] = (boundary - origin_arg (axis)) / direction;
+    t_delta[axis] = 1.0 / std::abs (direction);
+  }
+
+  // step into the neighbour whose boundary is crossed first, only along axes which have not reached the end voxel,
+  // so that the traversal ends on the end voxel despite rounding
+  const int nr_steps = remaining[0] + remaining[1] + remaining[2];
+  for (int i = 0; i < nr_steps; ++i)
+  {
+    codes_arg.push_back (pcl::encodeMorton3D (key[0], key[1], key[2]));
+
+    int axis = -1;
+    for (int a = 0; a < 3; ++a)
+      if (remaining[a] > 0 && (axis < 0 || t_max[a] < t_max[axis]))
+        axis = a;
+
+    key[axis] += step[axis];
+    t_max[axis] += t_delta[axis];
+    --remaining[axis];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::updateVoxels (
+    const std::vector<uint64_t> &free_codes_arg, const std::vector<uint64_t> &occupied_codes_arg)
+{
+  // merge both lists into one sorted list of updates, occupied wins over free
+  std::vector<uint64_t> codes;
+  std::vector<float> log_odds;
+  codes.reserve (free_codes_arg.size () + occupied_codes_arg.size ());
+  log_odds.reserve (free_codes_arg.size () + occupied_codes_arg.size ());
+
+  std::size_t free_idx = 0;
+  std::size_t occupied_idx = 0;
+  while (free_idx < free_codes_arg.size () || occupied_idx < occupied_codes_arg.size ())
+  {
+    if (occupied_idx == occupied_codes_arg.size ()
+        || (free_idx < free_codes_arg.size () && free_codes_arg[free_idx] < occupied_codes_arg[occupied_idx]))
+    {
+      codes.push_back (free_codes_arg[free_idx++]);
+      log_odds.push_back (log_odds_miss_);
+    }
+    else
+    {
+      if (free_idx < free_codes_arg.size () && free_codes_arg[free_idx] == occupied_codes_arg[occupied_idx])
+        ++free_idx;
+      codes.push_back (occupied_codes_arg[occupied_idx++]);
+      log_odds.push_back (log_odds_hit_);
+    }
+  }
+
+  if (!codes.empty ())
+    updateRecursive (*this->root_node_, 0, codes, log_odds, 0, codes.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::updateRecursive (
+    BranchNode& branch_arg, unsigned int depth_arg, const std::vector<uint64_t> &codes_arg,
+    const std::vector<float> &log_odds_arg, std::size_t begin_arg, std::size_t end_arg)
+{
+  // Morton triplet of the children of this branch
+  const unsigned int shift = 3 * (this->octree_depth_ - 1 - depth_arg);
+  const bool children_are_leaves = (depth_arg + 1 == this->octree_depth_);
+
+  std::size_t group_begin = begin_arg;
+  while (group_begin < end_arg)
+  {
+    const unsigned int triplet = static_cast<unsigned int> (codes_arg[group_begin] >> shift) & 7;
+    std::size_t group_end = group_begin + 1;
+    while (group_end < end_arg && (static_cast<unsigned int> (codes_arg[group_end] >> shift) & 7) == triplet)
+      ++group_end;
+
+    // Morton codes interleave x into the lowest bit of a triplet, child indices into the highest
+    const unsigned char child_idx = static_cast<unsigned char> (((triplet & 1) << 2) | (triplet & 2) | (triplet >> 2));
+    OctreeNode* child_node = this->getBranchChildPtr (branch_arg, child_idx);
+
+    if (children_are_leaves)
+    {
+      // the codes are unique, the group holds a single update
+      LeafNode* leaf_node;
+      if (child_node)
+      {
+        leaf_node = static_cast<LeafNode*> (child_node);
+      }
+      else
+      {
+        leaf_node = this->createLeafChild (branch_arg, child_idx);
+        ++this->leaf_count_;
+      }
+      leaf_node->getContainer ().updateLogOdds (log_odds_arg[group_begin], clamping_min_, clamping_max_);
+    }
+    else
+    {
+      BranchNode* child_branch;
+      if (!child_node)
+      {
+        child_branch = this->createBranchChild (branch_arg, child_idx);
+        ++this->branch_count_;
+      }
+      else if (child_node->getNodeType () == LEAF_NODE)
+      {
+        child_branch = expandLeaf (branch_arg, child_idx);
+      }
+      else
+      {
+        child_branch = static_cast<BranchNode*> (child_node);
+      }
+
+      updateRecursive (*child_branch, depth_arg + 1, codes_arg, log_odds_arg, group_begin, group_end);
+
+      if (pruning_)
+        pruneBranchChild (branch_arg, child_idx);
+    }
+
+    group_begin = group_end;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT>
+typename pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::BranchNode*
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::expandLeaf (
+    BranchNode& branch_arg, unsigned char child_idx_arg)
+{
+  const float log_odds =
+      static_cast<LeafNode*> (this->getBranchChildPtr (branch_arg, child_idx_arg))->getContainer ().getLogOdds ();
+
+  this->deleteBranchChild (branch_arg, child_idx_arg);
+  BranchNode* new_branch = this->createBranchChild (branch_arg, child_idx_arg);
+  for (unsigned char child_idx = 0; child_idx < 8; ++child_idx)
+    this->createLeafChild (*new_branch, child_idx)->getContainer ().setLogOdds (log_odds);
+
+  this->leaf_count_ += 7;
+  ++this->branch_count_;
+
+  return (new_branch);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::pruneBranchChild (
+    BranchNode& branch_arg, unsigned char child_idx_arg)
+{
+  const OctreeNode* child_node = this->getBranchChildPtr (branch_arg, child_idx_arg);
+  if (!child_node || child_node->getNodeType () != BRANCH_NODE)
+    return;
+
+  const BranchNode* child_branch = static_cast<const BranchNode*> (child_node);
+  float log_odds = 0.0f;
+  for (unsigned char child_idx = 0; child_idx < 8; ++child_idx)
+  {
+    const OctreeNode* grand_child = this->getBranchChildPtr (*child_branch, child_idx);
+    if (!grand_child || grand_child->getNodeType () != LEAF_NODE)
+      return;
+
+    const float child_log_odds = static_cast<const LeafNode*> (grand_child)->getContainer ().getLogOdds ();
+    if (child_idx == 0)
+      log_odds = child_log_odds;
+    else if (child_log_odds != log_odds)
+      return;
+  }
+
+  this->deleteBranchChild (branch_arg, child_idx_arg);
+  this->createLeafChild (branch_arg, child_idx_arg)->getContainer ().setLogOdds (log_odds);
+
+  this->leaf_count_ -= 7;
+  --this->branch_count_;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT>::getVoxelCentersRecursive (
+    const BranchNode* branch_arg, OctreeKey& key_arg, unsigned int depth_arg, bool occupied_arg,
+    AlignedPointTVector &voxel_center_list_arg) const
+{
+  for (unsigned char child_idx = 0; child_idx < 8; ++child_idx)
+  {
+    const OctreeNode* child_node = this->getBranchChildPtr (*branch_arg, child_idx);
+    if (!child_node)
+      continue;
+
+    key_arg.pushBranch (child_idx);
+
+    if (child_node->getNodeType () == BRANCH_NODE)
+    {
+      getVoxelCentersRecursive (static_cast<const BranchNode*> (child_node), key_arg, depth_arg + 1, occupied_arg,
+                                voxel_center_list_arg);
+    }
+    else
+    {
+      const float log_odds = static_cast<const LeafNode*> (child_node)->getContainer ().getLogOdds ();
+      if ((log_odds > occupancy_threshold_) == occupied_arg)
+      {
+        PointT center;
+        this->genVoxelCenterFromOctreeKey (key_arg, depth_arg + 1, center);
+        voxel_center_list_arg.push_back (center);
+      }
+    }
+
+    key_arg.popBranch ();
+  }
+}
+
+#define PCL_INSTANTIATE_OctreePointCloudOccupancyMap(T) template class PCL_EXPORTS pcl::octree::OctreePointCloudOccupancyMap<T>;
+
+#endif // PCL_OCTREE_POINTCLOUD_OCCUPANCY_MAP_HPP
@@ -43,6 +43,8 @@
 #include <pcl/point_types.h>
 
 #include <pcl/common/common.h>
+#include <pcl/common/morton.h>
+#include <pcl/common/parallel.h>
 #include <assert.h>
 
 
@@ -864,4 +866,241 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::g
   return (voxel_count);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::getIntersectedVoxelCenters (
+    const std::vector<Eigen::Vector3f> &origins, const std::vector<Eigen::Vector3f> &directions,
+    std::vector<AlignedPointTVector> &voxel_center_lists, int max_voxel_count, float max_range,
+    unsigned int nr_threads) const
+{
+  voxel_center_lists.clear ();
+  if (origins.size () != directions.size ())
+  {
+    PCL_ERROR ("[pcl::octree::OctreePointCloudSearch::getIntersectedVoxelCenters] Number of origins (%lu) differs "
+               "from number of directions (%lu)!\n", origins.size (), directions.size ());
+    return;
+  }
+  voxel_center_lists.resize (origins.size ());
+
+  castRayPackets (origins, directions, max_voxel_count, max_range, nr_threads,
+                  [&] (int ray, const LeafNode&, const OctreeKey& key, unsigned int depth)
+  {
+    PointT center;
+    this->genVoxelCenterFromOctreeKey (key, depth, center);
+    voxel_center_lists[ray].push_back (center);
+  });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::getIntersectedVoxelIndices (
+    const std::vector<Eigen::Vector3f> &origins, const std::vector<Eigen::Vector3f> &directions,
+    std::vector<std::vector<int> > &k_indices, int max_voxel_count, float max_range, unsigned int nr_threads) const
+{
+  k_indices.clear ();
+  if (origins.size () != directions.size ())
+  {
+    PCL_ERROR ("[pcl::octree::OctreePointCloudSearch::getIntersectedVoxelIndices] Number of origins (%lu) differs "
+               "from number of directions (%lu)!\n", origins.size (), directions.size ());
+    return;
+  }
+  k_indices.resize (origins.size ());
+
+  castRayPackets (origins, directions, max_voxel_count, max_range, nr_threads,
+                  [&] (int ray, const LeafNode& leaf, const OctreeKey&, unsigned int)
+  {
+    leaf.getContainer ().getPointIndices (k_indices[ray]);
+  });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> template <typename LeafFunctor> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::castRayPackets (
+    const std::vector<Eigen::Vector3f> &origins, const std::vector<Eigen::Vector3f> &directions,
+    int max_voxel_count, float max_range, unsigned int nr_threads, const LeafFunctor &leaf_functor) const
+{
+  // sort the rays by direction octant, then by coarse origin and direction, so that the rays of a packet share the
+  // order in which they visit the children of a node and mostly visit the same nodes
+  const Eigen::Vector3f min_pt (static_cast<float> (this->min_x_), static_cast<float> (this->min_y_),
+                                static_cast<float> (this->min_z_));
+  const Eigen::Vector3f extent = Eigen::Vector3f (static_cast<float> (this->max_x_), static_cast<float> (this->max_y_),
+                                                  static_cast<float> (this->max_z_)) - min_pt;
+
+  std::vector<int> rays;
+  std::vector<uint64_t> codes;
+  rays.reserve (origins.size ());
+  codes.reserve (origins.size ());
+  for (int i = 0; i < static_cast<int> (origins.size ()); ++i)
+  {
+    const Eigen::Vector3f &origin = origins[i];
+    const Eigen::Vector3f &direction = directions[i];
+    if (!origin.allFinite () || !direction.allFinite () || direction.isZero (0.0f))
+      continue;
+
+    const uint64_t octant = ((direction.x () < 0.0f) << 2) | ((direction.y () < 0.0f) << 1) | (direction.z () < 0.0f);
+    const Eigen::Vector3f cell = ((origin - min_pt).cwiseQuotient (extent) * 31.0f).cwiseMax (0.0f).cwiseMin (31.0f);
+    const Eigen::Vector3f bin = ((direction.normalized ().array () + 1.0f) * 511.5f).matrix ().cwiseMin (1023.0f);
+    codes.push_back ((octant << 45)
+                     | (pcl::encodeMorton3D (static_cast<uint32_t> (cell.x ()), static_cast<uint32_t> (cell.y ()),
+                                             static_cast<uint32_t> (cell.z ())) << 30)
+                     | pcl::encodeMorton3D (static_cast<uint32_t> (bin.x ()), static_cast<uint32_t> (bin.y ()),
+                                            static_cast<uint32_t> (bin.z ())));
+    rays.push_back (i);
+  }
+
+  std::vector<int> order;
+  pcl::sortMortonCodes (codes, order, nr_threads);
+
+  // split the sorted rays into packets of a single octant
+  std::vector<int> packet_begin;
+  for (int i = 0; i < static_cast<int> (codes.size ()); ++i)
+    if (packet_begin.empty () || i - packet_begin.back () == RAY_PACKET_SIZE
+        || (codes[i] >> 45) != (codes[i - 1] >> 45))
+      packet_begin.push_back (i);
+  const int nr_packets = static_cast<int> (packet_begin.size ());
+  packet_begin.push_back (static_cast<int> (codes.size ()));
+
+  const unsigned int tree_depth = this->octree_depth_;
+  pcl::parallel::parallel_for (0, nr_packets, [&] (int begin, int end)
+  {
+    std::vector<RaySlabs> slabs ((tree_depth + 1) * RAY_PACKET_SIZE);
+    int packet_rays[RAY_PACKET_SIZE];
+    double t_limits[RAY_PACKET_SIZE];
+    int voxel_counts[RAY_PACKET_SIZE];
+
+    for (int packet = begin; packet < end; ++packet)
+    {
+      int nr_rays = 0;
+      unsigned char a = 0;
+      for (int i = packet_begin[packet]; i < packet_begin[packet + 1]; ++i)
+      {
+        const int ray = rays[order[i]];
+        Eigen::Vector3f origin = origins[ray];
+        Eigen::Vector3f direction = directions[ray];
+
+        RaySlabs &root_slabs = slabs[nr_rays];
+        initIntersectedVoxel (origin, direction, root_slabs.t0[0], root_slabs.t0[1], root_slabs.t0[2],
+                              root_slabs.t1[0], root_slabs.t1[1], root_slabs.t1[2], a);
+
+        const double entry = std::max (std::max (root_slabs.t0[0], root_slabs.t0[1]), root_slabs.t0[2]);
+        const double exit = std::min (std::min (root_slabs.t1[0], root_slabs.t1[1]), root_slabs.t1[2]);
+        if (entry >= exit || root_slabs.t1[0] < 0.0 || root_slabs.t1[1] < 0.0 || root_slabs.t1[2] < 0.0)
+          continue;
+
+        // t is measured in multiples of the direction vector
+        packet_rays[nr_rays] = ray;
+        t_limits[nr_rays] = (max_range > 0.0f) ? max_range / direction.norm () : std::numeric_limits<double>::max ();
+        voxel_counts[nr_rays] = 0;
+        root_slabs.ray = nr_rays;
+        ++nr_rays;
+      }
+
+      if (nr_rays > 0)
+        castRayPacketRecursive (this->root_node_, OctreeKey (), 0, a, nr_rays, slabs, t_limits, voxel_counts,
+                                max_voxel_count, [&] (int packet_ray, const LeafNode& leaf,
+                                                      const OctreeKey& key, unsigned int depth)
+        {
+          leaf_functor (packet_rays[packet_ray], leaf, key, depth);
+        });
+    }
+  }, 4, nr_threads);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> template <typename LeafFunctor> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::castRayPacketRecursive (
+    const OctreeNode* node, const OctreeKey& key, unsigned int depth, unsigned char a, int nr_rays,
+    std::vector<RaySlabs> &slabs, const double* t_limits, int* voxel_counts, int max_voxel_count,
+    const LeafFunctor &leaf_functor) const
+{
+  RaySlabs* node_slabs = &slabs[depth * RAY_PACKET_SIZE];
+
+  if (node->getNodeType () == LEAF_NODE)
+  {
+    for (int i = 0; i < nr_rays; ++i)
+    {
+      leaf_functor (node_slabs[i].ray, static_cast<const LeafNode&> (*node), key, depth);
+      ++voxel_counts[node_slabs[i].ray];
+    }
+    return;
+  }
+
+  // children entered by each ray, in the same way as getIntersectedVoxelIndicesRecursive
+  for (int i = 0; i < nr_rays; ++i)
+  {
+    RaySlabs &ray_slabs = node_slabs[i];
+    double* t0 = ray_slabs.t0;
+    double* t1 = ray_slabs.t1;
+    double* mid = ray_slabs.mid;
+    mid[0] = 0.5 * (t0[0] + t1[0]);
+    mid[1] = 0.5 * (t0[1] + t1[1]);
+    mid[2] = 0.5 * (t0[2] + t1[2]);
+
+    ray_slabs.children = 0;
+    int curr_node = getFirstIntersectedNode (t0[0], t0[1], t0[2], mid[0], mid[1], mid[2]);
+    while (curr_node < 8)
+    {
+      ray_slabs.children = static_cast<unsigned char> (ray_slabs.children | (1 << curr_node));
+      const double exit_x = (curr_node & 4) ? t1[0] : mid[0];
+      const double exit_y = (curr_node & 2) ? t1[1] : mid[1];
+      const double exit_z = (curr_node & 1) ? t1[2] : mid[2];
+      curr_node = getNextIntersectedNode (exit_x, exit_y, exit_z,
+                                          (curr_node & 4) ? 8 : curr_node | 4,
+                                          (curr_node & 2) ? 8 : curr_node | 2,
+                                          (curr_node & 1) ? 8 : curr_node | 1);
+    }
+  }
+
+  // a ray crosses the mid planes of a node in increasing order of its mirrored coordinates, so the children it visits
+  // only gain bits: visiting them by increasing bit count is front to back for all rays of the octant
+  static const unsigned char child_order[8] = {0, 1, 2, 4, 3, 5, 6, 7};
+
+  RaySlabs* child_slabs = &slabs[(depth + 1) * RAY_PACKET_SIZE];
+  for (int i = 0; i < 8; ++i)
+  {
+    const unsigned char mirrored_idx = child_order[i];
+    const unsigned char child_idx = static_cast<unsigned char> (mirrored_idx ^ a);
+
+    const OctreeNode* child_node = this->getBranchChildPtr (static_cast<const BranchNode&> (*node), child_idx);
+    if (!child_node)
+      continue;
+
+    // rays of the packet which enter the child within their range and voxel count
+    int nr_child_rays = 0;
+    for (int j = 0; j < nr_rays; ++j)
+    {
+      const RaySlabs &parent = node_slabs[j];
+      if (!(parent.children & (1 << mirrored_idx))
+          || (max_voxel_count > 0 && voxel_counts[parent.ray] >= max_voxel_count))
+        continue;
+
+      RaySlabs &child = child_slabs[nr_child_rays];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        const bool upper = (mirrored_idx & (4 >> axis)) != 0;
+        child.t0[axis] = upper ? parent.mid[axis] : parent.t0[axis];
+        child.t1[axis] = upper ? parent.t1[axis] : parent.mid[axis];
+      }
+
+      if (child.t1[0] < 0.0 || child.t1[1] < 0.0 || child.t1[2] < 0.0
+          || std::max (std::max (child.t0[0], child.t0[1]), child.t0[2]) > t_limits[parent.ray])
+        continue;
+
+      child.ray = parent.ray;
+      ++nr_child_rays;
+    }
+
+    if (nr_child_rays == 0)
+      continue;
+
+    OctreeKey child_key;
+    child_key.x = (key.x << 1) | (!!(child_idx & (1 << 2)));
+    child_key.y = (key.y << 1) | (!!(child_idx & (1 << 1)));
+    child_key.z = (key.z << 1) | (!!(child_idx & (1 << 0)));
+
+    castRayPacketRecursive (child_node, child_key, depth + 1, a, nr_child_rays, slabs, t_limits, voxel_counts,
+                            max_voxel_count, leaf_functor);
+  }
+}
+
 #endif    // PCL_OCTREE_SEARCH_IMPL_H_
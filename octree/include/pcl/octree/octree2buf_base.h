@@ -706,6 +706,15 @@ namespace pcl
           }
         }
 
+        /** \brief Allocate a branch node, used by OctreePointCloud to grow the octree above its root
+         *  \return pointer to the new branch node
+         * */
+        inline BranchNode*
+        allocateBranchNode ()
+        {
+          return (new BranchNode ());
+        }
+
         /** \brief Fetch and add a new branch child to a branch class in current buffer
          *  \param branch_arg: reference to octree branch class
          *  \param child_idx_arg: index to child node
@@ -43,6 +43,7 @@
 #include <vector>
 
 #include "octree_nodes.h"
+#include "octree_node_arena.h"
 #include "octree_container.h"
 #include "octree_key.h"
 #include "octree_iterator.h"
@@ -119,7 +120,10 @@ namespace pcl
           depth_mask_ (source.depth_mask_),
           octree_depth_ (source.octree_depth_),
           dynamic_depth_enabled_(source.dynamic_depth_enabled_),
-          max_key_ (source.max_key_)
+          max_key_ (source.max_key_),
+          use_node_arena_ (false),
+          branch_arena_ (),
+          leaf_arena_ ()
         {
         }
 
@@ -127,6 +131,16 @@ namespace pcl
         OctreeBase&
         operator = (const OctreeBase &source)
         {
+          if (this == &source)
+            return (*this);
+
+          // the copied nodes are heap allocated
+          deleteTree ();
+          deallocateBranchNode (root_node_);
+          branch_arena_.clear ();
+          leaf_arena_.clear ();
+          use_node_arena_ = false;
+
           leaf_count_ = source.leaf_count_;
           branch_count_ = source.branch_count_;
           root_node_ = new (BranchNode) (*(source.root_node_));
@@ -148,6 +162,26 @@ namespace pcl
         void
         setTreeDepth (unsigned int max_depth_arg);
 
+        /** \brief Allocate the nodes of the octree in arenas owned by the octree instead of one by one on the heap.
+         *  \note Nodes are packed in large blocks in creation order, depth-first when the octree is built by
+         *  OctreePointCloud::addPointsFromInputCloud. deleteTree then destroys all nodes with a linear sweep and frees
+         *  a few blocks instead of every node. The allocation can only be changed while the octree is empty,
+         *  otherwise an error is printed and the octree is left unchanged.
+         *  \note This only changes how the nodes are allocated and freed. The nodes, their child pointers and the
+         *  traversal are the same as with heap allocation, so searches are not faster: there are no 32 bit child
+         *  offsets and no breadth-first or depth-first repacking of an existing tree.
+         *  \param use_node_arena_arg "true" to allocate the nodes in arenas
+         * */
+        void
+        setUseNodeArena (bool use_node_arena_arg);
+
+        /** \brief Check whether the nodes are allocated in arenas owned by the octree. */
+        bool
+        getUseNodeArena () const
+        {
+          return (use_node_arena_);
+        }
+
         /** \brief Get the maximum depth of the octree.
          *  \return depth_arg: maximum depth of octree
          * */
@@ -391,14 +425,14 @@ namespace pcl
                 // free child branch recursively
                 deleteBranch (*static_cast<BranchNode*> (branch_child));
                 // delete branch node
-                delete branch_child;
+                deallocateBranchNode (static_cast<BranchNode*> (branch_child));
               }
                 break;
 
               case LEAF_NODE:
               {
                 // delete leaf node
-                delete branch_child;
+                deallocateLeafNode (static_cast<LeafNode*> (branch_child));
                 break;
               }
               default:
@@ -423,6 +457,48 @@ namespace pcl
             deleteBranchChild (branch_arg, i);
         }
 
+        /** \brief Allocate a branch node, from the node arena if it is enabled
+         *  \return pointer to the new branch node
+         * */
+        BranchNode*
+        allocateBranchNode ()
+        {
+          return (use_node_arena_ ? branch_arena_.allocate () : new BranchNode ());
+        }
+
+        /** \brief Allocate a leaf node, from the node arena if it is enabled
+         *  \return pointer to the new leaf node
+         * */
+        LeafNode*
+        allocateLeafNode ()
+        {
+          return (use_node_arena_ ? leaf_arena_.allocate () : new LeafNode ());
+        }
+
+        /** \brief Free a branch node allocated by allocateBranchNode, without its children
+         *  \param branch_arg: pointer to the branch node
+         * */
+        void
+        deallocateBranchNode (BranchNode* branch_arg)
+        {
+          if (use_node_arena_)
+            branch_arena_.release (branch_arg);
+          else
+            delete branch_arg;
+        }
+
+        /** \brief Free a leaf node allocated by allocateLeafNode
+         *  \param leaf_arg: pointer to the leaf node
+         * */
+        void
+        deallocateLeafNode (LeafNode* leaf_arg)
+        {
+          if (use_node_arena_)
+            leaf_arena_.release (leaf_arg);
+          else
+            delete leaf_arg;
+        }
+
         /** \brief Create and add a new branch child to a branch class
          *  \param branch_arg: reference to octree branch class
          *  \param child_idx_arg: index to child node
@@ -431,7 +507,7 @@ namespace pcl
         BranchNode* createBranchChild (BranchNode& branch_arg,
                                        unsigned char child_idx_arg)
         {
-          BranchNode* new_branch_child = new BranchNode();
+          BranchNode* new_branch_child = allocateBranchNode ();
           branch_arg[child_idx_arg] = static_cast<OctreeNode*> (new_branch_child);
 
           return new_branch_child;
@@ -445,7 +521,7 @@ namespace pcl
         LeafNode*
         createLeafChild (BranchNode& branch_arg, unsigned char child_idx_arg)
         {
-          LeafNode* new_leaf_child = new LeafNode();
+          LeafNode* new_leaf_child = allocateLeafNode ();
           branch_arg[child_idx_arg] = static_cast<OctreeNode*> (new_leaf_child);
 
           return new_leaf_child;
@@ -590,6 +666,15 @@ namespace pcl
 
         /** \brief key range */
         OctreeKey max_key_;
+
+        /** \brief Allocate the nodes in branch_arena_ and leaf_arena_ **/
+        bool use_node_arena_;
+
+        /** \brief Storage of the branch nodes when use_node_arena_ is set **/
+        OctreeNodeArena<BranchNode> branch_arena_;
+
+        /** \brief Storage of the leaf nodes when use_node_arena_ is set **/
+        OctreeNodeArena<LeafNode> leaf_arena_;
     };
   }
 }
@@ -0,0 +1,177 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_NODE_ARENA_H
+#define PCL_OCTREE_NODE_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace pcl
+{
+  namespace octree
+  {
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Octree node arena
+     * \note Constructs the nodes of an octree in large contiguous blocks, in creation order. Released nodes are
+     * \note recycled by the next allocations and all the nodes are destroyed at once by clear, with a linear sweep
+     * \note over the blocks instead of one deallocation per node.
+     */
+    template<typename NodeT>
+      class OctreeNodeArena
+      {
+      public:
+        /** \brief Empty constructor. */
+        OctreeNodeArena () :
+            blocks_ (), free_nodes_ (), block_used_ (0)
+        {
+        }
+
+        /** \brief Destructor, destroys all nodes. */
+        ~OctreeNodeArena ()
+        {
+          clear ();
+        }
+
+        /** \brief Construct a node in the arena, reusing a released node if there is one.
+         *  \return pointer to the new node
+         */
+        NodeT*
+        allocate ()
+        {
+          if (!free_nodes_.empty ())
+          {
+            NodeT* node = free_nodes_.back ();
+            free_nodes_.pop_back ();
+            return (node);
+          }
+
+          if (blocks_.empty () || block_used_ == blocks_.back ().second)
+          {
+            // blocks double in size, small octrees stay small
+            const std::size_t block_size =
+                blocks_.empty () ? static_cast<std::size_t> (min_block_size_)
+                                 : std::min (2 * blocks_.back ().second, static_cast<std::size_t> (max_block_size_));
+            blocks_.push_back (Block (allocator_.allocate (block_size), block_size));
+            block_used_ = 0;
+          }
+
+          NodeT* node = blocks_.back ().first + block_used_;
+          new (node) NodeT ();
+          ++block_used_;
+          return (node);
+        }
+
+        /** \brief Give a node back to the arena. The node is reset to a default constructed one, which the next
+         *  call to allocate returns.
+         *  \param node_arg node allocated by this arena
+         */
+        void
+        release (NodeT* node_arg)
+        {
+          node_arg->~NodeT ();
+          new (node_arg) NodeT ();
+          free_nodes_.push_back (node_arg);
+        }
+
+        /** \brief Destroy all nodes and free the memory of the arena. */
+        void
+        clear ()
+        {
+          for (std::size_t b = 0; b < blocks_.size (); ++b)
+          {
+            const std::size_t used = (b + 1 == blocks_.size ()) ? block_used_ : blocks_[b].second;
+            for (std::size_t i = 0; i < used; ++i)
+              blocks_[b].first[i].~NodeT ();
+            allocator_.deallocate (blocks_[b].first, blocks_[b].second);
+          }
+          blocks_.clear ();
+          free_nodes_.clear ();
+          block_used_ = 0;
+        }
+
+        /** \brief Get the number of nodes in use. */
+        std::size_t
+        getNodeCount () const
+        {
+          std::size_t count = block_used_;
+          for (std::size_t b = 0; b + 1 < blocks_.size (); ++b)
+            count += blocks_[b].second;
+          return (count - free_nodes_.size ());
+        }
+
+        /** \brief Get the number of bytes reserved by the arena. */
+        std::size_t
+        getMemoryUsage () const
+        {
+          std::size_t bytes = free_nodes_.capacity () * sizeof (NodeT*);
+          for (std::size_t b = 0; b < blocks_.size (); ++b)
+            bytes += blocks_[b].second * sizeof (NodeT);
+          return (bytes);
+        }
+
+      private:
+        /** \brief Not copyable, the octree owning the arena links its nodes by address. */
+        OctreeNodeArena (const OctreeNodeArena&);
+        OctreeNodeArena& operator = (const OctreeNodeArena&);
+
+        /** \brief Memory block and its capacity in nodes. */
+        typedef std::pair<NodeT*, std::size_t> Block;
+
+        /** \brief Capacity in nodes of the first and of the largest blocks. */
+        enum { min_block_size_ = 64, max_block_size_ = 65536 };
+
+        /** \brief Aligned allocator, nodes may hold fixed size Eigen types. */
+        Eigen::aligned_allocator<NodeT> allocator_;
+
+        std::vector<Block> blocks_;
+        std::vector<NodeT*> free_nodes_;
+
+        /** \brief Number of nodes constructed in the last block. */
+        std::size_t block_used_;
+      };
+
+  }
+}
+
+#endif
@@ -203,7 +203,10 @@ namespace pcl
           return this->octree_depth_;
         }
 
-        /** \brief Add points from input point cloud to octree. */
+        /** \brief Add points from input point cloud to octree.
+         * \note Unless dynamic depth is enabled, the octree is double buffered or the bulk build is disabled with
+         * setBulkBuild, the octree is built in bulk, see addPointIndicesBulk. addPointIdx is then not called.
+         */
         void
         addPointsFromInputCloud ();
 
@@ -405,15 +408,65 @@ namespace pcl
           this->dynamic_depth_enabled_ = static_cast<bool> (max_objs_per_leaf_>0);
         }
 
+        /** \brief Enable or disable the bulk build of addPointsFromInputCloud (enabled by default).
+         *  \note The bulk build stores the points through addPointToLeafContainer and never calls addPointIdx.
+         *  Octrees deriving from this class that override addPointIdx, but not addPointToLeafContainer, have to
+         *  disable it to keep their point by point insertion.
+         *  \param bulk_build_arg "false" to add the points one by one with addPointIdx
+         * */
+        inline void
+        setBulkBuild (bool bulk_build_arg)
+        {
+          bulk_build_ = bulk_build_arg;
+        }
+
+        /** \brief Check whether addPointsFromInputCloud may build the octree in bulk. */
+        inline bool
+        getBulkBuild () const
+        {
+          return (bulk_build_);
+        }
+
 
       protected:
 
         /** \brief Add point at index from input pointcloud dataset to octree
+         * \note addPointsFromInputCloud bypasses this method when it builds the octree in bulk. Overrides have to
+         * override addPointToLeafContainer too, or disable the bulk build with setBulkBuild.
          * \param[in] point_idx_arg the index representing the point in the dataset given by \a setInputCloud to be added
          */
         virtual void
         addPointIdx (const int point_idx_arg);
 
+        /** \brief Add the points at the given indices of the input pointcloud dataset to the octree in bulk.
+         *
+         * The octree keys of the points are computed in parallel and sorted along a Morton curve. The leaves are then
+         * created in depth-first order, with one descent per occupied voxel starting from the deepest branch shared
+         * with the previous voxel. The points of a voxel are added in the order of \a point_indices, so the octree is
+         * the same as the one built by calling addPointIdx on every point.
+         * \note The bounding box has to contain all the points already. The method falls back to addPointIdx when
+         * dynamic depth is enabled, when the bulk build is disabled with setBulkBuild, for double buffered octrees
+         * and for octrees deeper than 21 levels.
+         * \param[in] point_indices the indices of the finite points to add
+         */
+        void
+        addPointIndicesBulk (const std::vector<int>& point_indices);
+
+        /** \brief Check whether addPointIndicesBulk can build this octree in bulk. */
+        bool
+        isBulkBuildSupported () const;
+
+        /** \brief Add point at index from input pointcloud dataset to the container of its leaf, called by
+         * addPointIndicesBulk. Octrees overriding addPointIdx to store more than the point index override it too.
+         * \param[in] container the container of the leaf the point falls in
+         * \param[in] point_idx_arg the index representing the point in the dataset given by \a setInputCloud
+         */
+        virtual void
+        addPointToLeafContainer (LeafContainerT& container, const int point_idx_arg)
+        {
+          container.addPointIndex (point_idx_arg);
+        }
+
         /** \brief Add point at index from input pointcloud dataset to octree
          * \param[in] leaf_node to be expanded
          * \param[in] parent_branch parent of leaf node to be expanded
@@ -568,6 +621,9 @@ namespace pcl
          *  \note zero indicates a fixed/maximum depth octree structure
          * **/
         std::size_t max_objs_per_leaf_;
+
+        /** \brief Flag indicating if addPointsFromInputCloud may build the octree in bulk. */
+        bool bulk_build_;
     };
 
   }
@@ -201,6 +201,28 @@ namespace pcl
          virtual void
          addPointIdx (const int point_idx_arg);
 
+        /** \brief Add the point at index to the container of its leaf, during bulk insertion.
+          *
+          * \param[in] container The container of the leaf the point falls in
+          * \param[in] point_idx_arg The index of the point in the dataset given by setInputCloud() */
+        virtual void
+        addPointToLeafContainer (LeafContainerT& container, const int point_idx_arg)
+        {
+          container.addPoint (this->input_->points[point_idx_arg]);
+        }
+
+        /** \brief Generates octree key for the point at index (uses transform if provided).
+          *
+          * \param[in] data_arg The index of the point in the dataset given by setInputCloud()
+          * \param[out] key_arg Resulting octree key
+          * \returns Always true */
+        virtual bool
+        genOctreeKeyForDataT (const int& data_arg, OctreeKey & key_arg) const
+        {
+          genOctreeKeyforPoint (this->input_->points[data_arg], key_arg);
+          return (true);
+        }
+
         /** \brief Fills in the neighbors fields for new voxels.
           *
           * \param[in] key_arg Key of the voxel to check neighbors for
@@ -0,0 +1,431 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_POINTCLOUD_OCCUPANCY_MAP_H
+#define PCL_OCTREE_POINTCLOUD_OCCUPANCY_MAP_H
+
+#include <pcl/console/print.h>
+#include <pcl/octree/octree_pointcloud.h>
+
+#include <cmath>
+#include <vector>
+
+namespace pcl
+{
+  namespace octree
+  {
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Octree leaf container storing the occupancy probability of its voxel as log-odds
+     *  \note A voxel starts at 0 log-odds, an occupancy probability of 0.5.
+     */
+    class OctreeLogOddsContainer : public OctreeContainerBase
+    {
+      public:
+        /** \brief Empty constructor. */
+        OctreeLogOddsContainer () :
+            OctreeContainerBase (), log_odds_ (0.0f)
+        {
+        }
+
+        /** \brief Copy constructor. */
+        OctreeLogOddsContainer (const OctreeLogOddsContainer& source) :
+            OctreeContainerBase (), log_odds_ (source.log_odds_)
+        {
+        }
+
+        /** \brief Empty deconstructor. */
+        virtual
+        ~OctreeLogOddsContainer ()
+        {
+        }
+
+        /** \brief Copy operator. */
+        OctreeLogOddsContainer&
+        operator = (const OctreeLogOddsContainer& source)
+        {
+          log_odds_ = source.log_odds_;
+          return (*this);
+        }
+
+        /** \brief Octree deep copy method */
+        virtual OctreeLogOddsContainer*
+        deepCopy () const
+        {
+          return (new OctreeLogOddsContainer (*this));
+        }
+
+        /** \brief Equal comparison operator
+         * \param[in] other OctreeLogOddsContainer to compare with
+         */
+        virtual bool
+        operator== (const OctreeContainerBase& other) const
+        {
+          const OctreeLogOddsContainer* other_container = dynamic_cast<const OctreeLogOddsContainer*> (&other);
+          return (other_container && log_odds_ == other_container->log_odds_);
+        }
+
+        /** \brief Get the log-odds of the occupancy probability. */
+        float
+        getLogOdds () const
+        {
+          return (log_odds_);
+        }
+
+        /** \brief Set the log-odds of the occupancy probability.
+         * \param[in] log_odds_arg the new log-odds
+         */
+        void
+        setLogOdds (float log_odds_arg)
+        {
+          log_odds_ = log_odds_arg;
+        }
+
+        /** \brief Add a measurement to the log-odds, clamped to [min_arg, max_arg].
+         * \param[in] log_odds_arg the log-odds of the measurement
+         * \param[in] min_arg the lower clamping threshold
+         * \param[in] max_arg the upper clamping threshold
+         */
+        void
+        updateLogOdds (float log_odds_arg, float min_arg, float max_arg)
+        {
+          log_odds_ = std::min (std::max (log_odds_ + log_odds_arg, min_arg), max_arg);
+        }
+
+        /** \brief Get the occupancy probability. */
+        float
+        getOccupancy () const
+        {
+          return (1.0f - 1.0f / (1.0f + std::exp (log_odds_)));
+        }
+
+        /** \brief Reset leaf node to an occupancy probability of 0.5. */
+        virtual void
+        reset ()
+        {
+          log_odds_ = 0.0f;
+        }
+
+        /** \brief Empty addPointIndex implementation. This leaf node does not store any point indices. */
+        void
+        addPointIndex (int)
+        {
+        }
+
+        /** \brief Empty getPointIndices implementation as this leaf node does not store any point indices. */
+        void
+        getPointIndices (std::vector<int>&) const
+        {
+        }
+
+      protected:
+        /** \brief Log-odds of the occupancy probability */
+        float log_odds_;
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /** \brief @b Octree pointcloud probabilistic occupancy map
+     *  \note Every voxel holds the log-odds of its occupancy probability. Range scans update the voxels crossed by
+     *  \note the beams as free and the voxels of the end points as occupied. Log-odds are clamped, which lets voxels
+     *  \note whose eight children share the same value be pruned into a single coarser leaf.
+     *  \note Leaves can therefore sit above the maximum depth, use the leaf iterators' depth to get their size.
+     *  \note
+     *  \note typename: PointT: type of point used in pointcloud
+     *  \ingroup octree
+     */
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT,
+             typename LeafContainerT = OctreeLogOddsContainer,
+             typename BranchContainerT = OctreeContainerEmpty >
+    class OctreePointCloudOccupancyMap : public OctreePointCloud<PointT, LeafContainerT,
+        BranchContainerT, OctreeBase<LeafContainerT, BranchContainerT> >
+    {
+      public:
+        typedef OctreePointCloud<PointT, LeafContainerT, BranchContainerT,
+                                 OctreeBase<LeafContainerT, BranchContainerT> > OctreePointCloudT;
+
+        typedef typename OctreePointCloudT::PointCloud PointCloud;
+        typedef typename OctreePointCloudT::AlignedPointTVector AlignedPointTVector;
+        typedef typename OctreePointCloudT::BranchNode BranchNode;
+        typedef typename OctreePointCloudT::LeafNode LeafNode;
+
+        typedef boost::shared_ptr<OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT> > Ptr;
+        typedef boost::shared_ptr<const OctreePointCloudOccupancyMap<PointT, LeafContainerT, BranchContainerT> >
+            ConstPtr;
+
+        /** \brief Constructor.
+         *  \param resolution_arg:  octree resolution at lowest octree level
+         * */
+        OctreePointCloudOccupancyMap (const double resolution_arg);
+
+        /** \brief Empty class deconstructor. */
+        virtual
+        ~OctreePointCloudOccupancyMap ()
+        {
+        }
+
+        /** \brief Set the probability that a voxel is occupied when a beam ends in it (default: 0.7).
+         *  \param probability_arg: probability in ]0.5, 1[
+         * */
+        void
+        setHitProbability (double probability_arg)
+        {
+          log_odds_hit_ = probabilityToLogOdds (probability_arg);
+        }
+
+        /** \brief Get the probability that a voxel is occupied when a beam ends in it. */
+        double
+        getHitProbability () const
+        {
+          return (logOddsToProbability (log_odds_hit_));
+        }
+
+        /** \brief Set the probability that a voxel is occupied when a beam crosses it (default: 0.4).
+         *  \param probability_arg: probability in ]0, 0.5[
+         * */
+        void
+        setMissProbability (double probability_arg)
+        {
+          log_odds_miss_ = probabilityToLogOdds (probability_arg);
+        }
+
+        /** \brief Get the probability that a voxel is occupied when a beam crosses it. */
+        double
+        getMissProbability () const
+        {
+          return (logOddsToProbability (log_odds_miss_));
+        }
+
+        /** \brief Set the bounds of the occupancy probability of a voxel (default: 0.1192 and 0.971). Voxels stop
+         *  changing once they reach a bound, which lets uniform regions be pruned.
+         *  \param min_probability_arg: lower bound
+         *  \param max_probability_arg: upper bound
+         * */
+        void
+        setClampingThresholds (double min_probability_arg, double max_probability_arg)
+        {
+          clamping_min_ = probabilityToLogOdds (min_probability_arg);
+          clamping_max_ = probabilityToLogOdds (max_probability_arg);
+        }
+
+        /** \brief Get the lower bound of the occupancy probability of a voxel. */
+        double
+        getClampingThresholdMin () const
+        {
+          return (logOddsToProbability (clamping_min_));
+        }
+
+        /** \brief Get the upper bound of the occupancy probability of a voxel. */
+        double
+        getClampingThresholdMax () const
+        {
+          return (logOddsToProbability (clamping_max_));
+        }
+
+        /** \brief Set the probability above which a voxel is considered occupied (default: 0.5).
+         *  \param probability_arg: occupancy threshold
+         * */
+        void
+        setOccupancyThreshold (double probability_arg)
+        {
+          occupancy_threshold_ = probabilityToLogOdds (probability_arg);
+        }
+
+        /** \brief Get the probability above which a voxel is considered occupied. */
+        double
+        getOccupancyThreshold () const
+        {
+          return (logOddsToProbability (occupancy_threshold_));
+        }
+
+        /** \brief Enable or disable the pruning of uniform subtrees after each update (default: enabled).
+         *  \param pruning_arg: "true" to prune
+         * */
+        void
+        setPruning (bool pruning_arg)
+        {
+          pruning_ = pruning_arg;
+        }
+
+        /** \brief Check whether uniform subtrees are pruned after each update. */
+        bool
+        getPruning () const
+        {
+          return (pruning_);
+        }
+
+        /** \brief Integrate a range scan into the map.
+         *
+         *  The beams are ray cast from the sensor origin in parallel. The voxels crossed by a beam are updated as
+         *  free, the voxel of its end point as occupied. Every voxel is updated at most once per scan and occupied
+         *  wins over free. The octree bounding box grows to fit the scan.
+         *  \param scan_arg: end points of the beams, in the octree frame. Non finite points are skipped.
+         *  \param sensor_origin_arg: origin of the beams, in the octree frame
+         *  \param max_range_arg: beams longer than max_range_arg are shortened to it and do not mark their end point
+         *  as occupied (non positive: no limit)
+         *  \param nr_threads_arg: the number of threads to use (0: automatic)
+         * */
+        void
+        insertScan (const PointCloud &scan_arg, const Eigen::Vector3f &sensor_origin_arg,
+                    double max_range_arg = -1.0, unsigned int nr_threads_arg = 0);
+
+        /** \brief Update a single voxel with a measurement.
+         *  \param point_arg: point in the voxel to update
+         *  \param occupied_arg: "true" for a hit, "false" for a miss
+         * */
+        void
+        updateVoxelAtPoint (const PointT& point_arg, bool occupied_arg);
+
+        /** \brief Get the occupancy probability of the voxel containing a point.
+         *  \param point_arg: query point
+         *  \param occupancy_arg: occupancy probability of the voxel
+         *  \return "false" if the voxel was never observed
+         * */
+        bool
+        getOccupancyAtPoint (const PointT& point_arg, float& occupancy_arg) const;
+
+        /** \brief Get the centers of the voxels whose occupancy probability is above the occupancy threshold. A
+         *  pruned voxel gives a single center.
+         *  \param voxel_center_list_arg: results are written to this vector of PointT elements
+         *  \return number of occupied voxels
+         * */
+        int
+        getOccupiedVoxelCenters (AlignedPointTVector &voxel_center_list_arg) const;
+
+        /** \brief Get the centers of the observed voxels whose occupancy probability is at or below the occupancy
+         *  threshold. A pruned voxel gives a single center.
+         *  \param voxel_center_list_arg: results are written to this vector of PointT elements
+         *  \return number of free voxels
+         * */
+        int
+        getFreeVoxelCenters (AlignedPointTVector &voxel_center_list_arg) const;
+
+        /** \brief Convert a probability to log-odds. */
+        static float
+        probabilityToLogOdds (double probability_arg)
+        {
+          return (static_cast<float> (std::log (probability_arg / (1.0 - probability_arg))));
+        }
+
+        /** \brief Convert log-odds to a probability. */
+        static double
+        logOddsToProbability (float log_odds_arg)
+        {
+          return (1.0 - 1.0 / (1.0 + std::exp (static_cast<double> (log_odds_arg))));
+        }
+
+      protected:
+        /** \brief Append the Morton codes of the voxels crossed by a segment, except the voxel of its end, with a 3D
+         *  digital differential analyzer.
+         *  \param origin_arg: start of the segment, in voxel units relative to the bounding box minimum
+         *  \param end_arg: end of the segment, in voxel units relative to the bounding box minimum
+         *  \param codes_arg: the codes are appended to this vector
+         * */
+        void
+        castRay (const Eigen::Vector3d &origin_arg, const Eigen::Vector3d &end_arg,
+                 std::vector<uint64_t> &codes_arg) const;
+
+        /** \brief Update the voxels of a scan, then prune the updated subtrees.
+         *  \param free_codes_arg: sorted, unique Morton codes of the voxels to update as free
+         *  \param occupied_codes_arg: sorted, unique Morton codes of the voxels to update as occupied
+         * */
+        void
+        updateVoxels (const std::vector<uint64_t> &free_codes_arg, const std::vector<uint64_t> &occupied_codes_arg);
+
+        /** \brief Recursively apply sorted updates to the subtree of a branch.
+         *  \param branch_arg: branch to update
+         *  \param depth_arg: depth of the branch
+         *  \param codes_arg: Morton codes of the updated voxels
+         *  \param log_odds_arg: log-odds of the measurements
+         *  \param begin_arg: first update of the subtree
+         *  \param end_arg: one past the last update of the subtree
+         * */
+        void
+        updateRecursive (BranchNode& branch_arg, unsigned int depth_arg, const std::vector<uint64_t> &codes_arg,
+                         const std::vector<float> &log_odds_arg, std::size_t begin_arg, std::size_t end_arg);
+
+        /** \brief Replace a pruned leaf by a branch with eight leaves of the same log-odds.
+         *  \param branch_arg: parent of the leaf
+         *  \param child_idx_arg: index of the leaf in its parent
+         *  \return the new branch
+         * */
+        BranchNode*
+        expandLeaf (BranchNode& branch_arg, unsigned char child_idx_arg);
+
+        /** \brief Replace a branch child by a leaf if it has eight leaves with the same log-odds.
+         *  \param branch_arg: parent of the branch
+         *  \param child_idx_arg: index of the branch in its parent
+         * */
+        void
+        pruneBranchChild (BranchNode& branch_arg, unsigned char child_idx_arg);
+
+        /** \brief Recursively collect the centers of the occupied or free voxels.
+         *  \param branch_arg: current branch
+         *  \param key_arg: key of the current branch
+         *  \param depth_arg: depth of the current branch
+         *  \param occupied_arg: "true" for the occupied voxels, "false" for the free ones
+         *  \param voxel_center_list_arg: results are appended to this vector
+         * */
+        void
+        getVoxelCentersRecursive (const BranchNode* branch_arg, OctreeKey& key_arg, unsigned int depth_arg,
+                                  bool occupied_arg, AlignedPointTVector &voxel_center_list_arg) const;
+
+        /** \brief Log-odds of a hit */
+        float log_odds_hit_;
+
+        /** \brief Log-odds of a miss */
+        float log_odds_miss_;
+
+        /** \brief Lower clamping threshold, in log-odds */
+        float clamping_min_;
+
+        /** \brief Upper clamping threshold, in log-odds */
+        float clamping_max_;
+
+        /** \brief Occupancy threshold, in log-odds */
+        float occupancy_threshold_;
+
+        /** \brief Prune uniform subtrees after each update */
+        bool pruning_;
+    };
+  }
+}
+
+//#ifdef PCL_NO_PRECOMPILE
+#include <pcl/octree/impl/octree_pointcloud_occupancy_map.hpp>
+//#endif
+
+#endif // PCL_OCTREE_POINTCLOUD_OCCUPANCY_MAP_H
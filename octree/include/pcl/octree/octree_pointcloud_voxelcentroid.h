@@ -191,6 +191,16 @@ namespace pcl
 
         }
 
+        /** \brief Add the point at index to the centroid of its leaf, during bulk insertion.
+          * \param[in] container the container of the leaf the point falls in
+          * \param[in] point_idx_arg index of the point in the input cloud
+          */
+        virtual void
+        addPointToLeafContainer (LeafContainerT& container, const int point_idx_arg)
+        {
+          container.addPoint (this->input_->points[point_idx_arg]);
+        }
+
         /** \brief Get centroid for a single voxel addressed by a PointT point.
           * \param[in] point_arg point addressing a voxel in octree
           * \param[out] voxel_centroid_arg centroid is written to this PointT reference
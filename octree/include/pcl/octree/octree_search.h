@@ -241,6 +241,38 @@ namespace pcl
                                     std::vector<int> &k_indices,
                                     int max_voxel_count = 0) const;
 
+        /** \brief Get the centers of the voxels intersected by each ray of a batch, ordered along each ray.
+          * The rays are sorted by direction octant and spatial coherence and traversed in packets, in parallel.
+          * \param[in] origins ray origins
+          * \param[in] directions ray direction vectors
+          * \param[out] voxel_center_lists voxel centers of each ray
+          * \param[in] max_voxel_count stop raycasting a ray when this many voxels intersected, 1 gives the first hit
+          * (0: disable)
+          * \param[in] max_range skip the voxels a ray enters beyond this distance from its origin (0: disable)
+          * \param[in] nr_threads the number of threads to use (0: automatic)
+          */
+        void
+        getIntersectedVoxelCenters (const std::vector<Eigen::Vector3f> &origins,
+                                    const std::vector<Eigen::Vector3f> &directions,
+                                    std::vector<AlignedPointTVector> &voxel_center_lists, int max_voxel_count = 0,
+                                    float max_range = 0.0f, unsigned int nr_threads = 0) const;
+
+        /** \brief Get the point indices of the voxels intersected by each ray of a batch, ordered along each ray.
+          * The rays are sorted by direction octant and spatial coherence and traversed in packets, in parallel.
+          * \param[in] origins ray origins
+          * \param[in] directions ray direction vectors
+          * \param[out] k_indices point indices of the intersected voxels of each ray
+          * \param[in] max_voxel_count stop raycasting a ray when this many voxels intersected, 1 gives the first hit
+          * (0: disable)
+          * \param[in] max_range skip the voxels a ray enters beyond this distance from its origin (0: disable)
+          * \param[in] nr_threads the number of threads to use (0: automatic)
+          */
+        void
+        getIntersectedVoxelIndices (const std::vector<Eigen::Vector3f> &origins,
+                                    const std::vector<Eigen::Vector3f> &directions,
+                                    std::vector<std::vector<int> > &k_indices, int max_voxel_count = 0,
+                                    float max_range = 0.0f, unsigned int nr_threads = 0) const;
+
 
         /** \brief Search for points within rectangular search area
          * \param[in] min_pt lower corner of search area
@@ -451,6 +483,54 @@ namespace pcl
                                              std::vector<int> &k_indices,
                                              int max_voxel_count) const;
 
+        /** \brief Number of rays traversed together by the batched raycasting methods. */
+        enum { RAY_PACKET_SIZE = 64 };
+
+        /** \brief Ray parameters at which a ray of a packet enters (t0) and exits (t1) the slabs of the current node,
+          * in the mirrored frame of initIntersectedVoxel, and the mirrored children it enters.
+          */
+        struct RaySlabs
+        {
+          double t0[3];
+          double t1[3];
+          double mid[3];
+          int ray;
+          unsigned char children;
+        };
+
+        /** \brief Traverse a batch of rays in packets of rays sharing the same direction octant.
+          * \param[in] origins ray origins
+          * \param[in] directions ray direction vectors
+          * \param[in] max_voxel_count stop raycasting a ray when this many voxels intersected (0: disable)
+          * \param[in] max_range skip the voxels a ray enters beyond this distance from its origin (0: disable)
+          * \param[in] nr_threads the number of threads to use
+          * \param[in] leaf_functor called as leaf_functor (ray, leaf, key, depth) for every intersected leaf, in ray
+          * order. Different rays may be processed concurrently.
+          */
+        template <typename LeafFunctor> void
+        castRayPackets (const std::vector<Eigen::Vector3f> &origins, const std::vector<Eigen::Vector3f> &directions,
+                        int max_voxel_count, float max_range, unsigned int nr_threads,
+                        const LeafFunctor &leaf_functor) const;
+
+        /** \brief Recursively traverse a packet of rays. All the children are visited in one order which is front to
+          * back for every ray of the octant, each child with the rays which intersect it.
+          * \param[in] node current octree node to be explored
+          * \param[in] key octree key addressing the node
+          * \param[in] depth depth of the node
+          * \param[in] a child index remapping of the octant of the packet
+          * \param[in] nr_rays number of rays intersecting the node
+          * \param[in,out] slabs per depth ray parameters, the rays of the node are at depth * RAY_PACKET_SIZE
+          * \param[in] t_limits per ray parameter of the maximum range
+          * \param[in,out] voxel_counts per ray number of intersected voxels
+          * \param[in] max_voxel_count stop raycasting a ray when this many voxels intersected (0: disable)
+          * \param[in] leaf_functor called as leaf_functor (packet_ray, leaf, key, depth) for every intersected leaf,
+          * packet_ray indexes the rays of the packet
+          */
+        template <typename LeafFunctor> void
+        castRayPacketRecursive (const OctreeNode* node, const OctreeKey& key, unsigned int depth, unsigned char a,
+                                int nr_rays, std::vector<RaySlabs> &slabs, const double* t_limits, int* voxel_counts,
+                                int max_voxel_count, const LeafFunctor &leaf_functor) const;
+
         /** \brief Initialize raytracing algorithm
           * \param origin
           * \param direction
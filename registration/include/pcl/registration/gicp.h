@@ -280,12 +280,12 @@ namespace pcl
       /** \brief compute points covariances matrices according to the K nearest 
         * neighbors. K is set via setCorrespondenceRandomness() methode.
         * \param cloud pointer to point cloud
-        * \param tree KD tree performer for nearest neighbors search
+        * \param tree search method for nearest neighbors search
         * \param[out] cloud_covariances covariances matrices for each point in the cloud
         */
       template<typename PointT>
       void computeCovariances(typename pcl::PointCloud<PointT>::ConstPtr cloud, 
-                              const typename pcl::search::KdTree<PointT>::Ptr tree,
+                              const typename pcl::search::Search<PointT>::Ptr tree,
                               std::vector<Eigen::Matrix3d, Eigen::aligned_allocator<Eigen::Matrix3d> >& cloud_covariances);
 
       /** \return trace of mat1^t . mat2 
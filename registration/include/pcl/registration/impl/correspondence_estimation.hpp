@@ -69,9 +69,10 @@ pcl::registration::CorrespondenceEstimationBase<PointSource, PointTarget, Scalar
   }
   target_ = cloud;
 
-  // Set the internal point representation of choice
-  if (point_representation_)
-    tree_->setPointRepresentation (point_representation_);
+  // Set the internal point representation of choice, only a kd-tree uses one
+  const KdTreePtr kdtree = boost::dynamic_pointer_cast<KdTree> (tree_);
+  if (point_representation_ && kdtree)
+    kdtree->setPointRepresentation (point_representation_);
 
   target_cloud_updated_ = true;
 }
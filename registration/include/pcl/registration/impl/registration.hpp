@@ -175,6 +175,8 @@ pcl::Registration<PointSource, PointTarget, Scalar>::align (PointCloudSource &ou
 template <typename PointSource, typename PointTarget, typename Scalar> inline void
 pcl::Registration<PointSource, PointTarget, Scalar>::align (PointCloudSource &output, const Matrix4& guess)
 {
+  PCL_PROFILE_SCOPE (reg_name_);
+
   if (!initCompute ()) 
     return;
 
@@ -200,9 +202,10 @@ pcl::Registration<PointSource, PointTarget, Scalar>::align (PointCloudSource &ou
   for (size_t i = 0; i < indices_->size (); ++i)
     output.points[i] = input_->points[(*indices_)[i]];
 
-  // Set the internal point representation of choice unless otherwise noted
-  if (point_representation_ && !force_no_recompute_) 
-    tree_->setPointRepresentation (point_representation_);
+  // Set the internal point representation of choice unless otherwise noted, only a kd-tree uses one
+  const KdTreePtr kdtree = boost::dynamic_pointer_cast<KdTree> (tree_);
+  if (point_representation_ && !force_no_recompute_ && kdtree) 
+    kdtree->setPointRepresentation (point_representation_);
 
   // Perform the actual transformation computation
   converged_ = false;
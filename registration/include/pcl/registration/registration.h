@@ -51,6 +51,7 @@
 #include <pcl/registration/transformation_estimation.h>
 #include <pcl/registration/correspondence_estimation.h>
 #include <pcl/registration/correspondence_rejection.h>
+#include <pcl/common/profiler.h>
 
 namespace pcl
 {
@@ -76,6 +77,9 @@ namespace pcl
       typedef pcl::search::KdTree<PointTarget> KdTree;
       typedef typename pcl::search::KdTree<PointTarget>::Ptr KdTreePtr;
 
+      typedef pcl::search::Search<PointTarget> SearchTarget;
+      typedef typename SearchTarget::Ptr SearchTargetPtr;
+
       typedef pcl::search::KdTree<PointSource> KdTreeReciprocal;
       typedef typename KdTree::Ptr KdTreeReciprocalPtr;
      
@@ -215,14 +219,16 @@ namespace pcl
 
 
       /** \brief Provide a pointer to the search object used to find correspondences in
-        * the target cloud.
+        * the target cloud. Any pcl::search::Search works, e.g. a search::IncrementalKdTree. It is also
+        * handed to the correspondence estimation.
         * \param[in] tree a pointer to the spatial search object.
         * \param[in] force_no_recompute If set to true, this tree will NEVER be 
         * recomputed, regardless of calls to setInputTarget. Only use if you are 
         * confident that the tree will be set correctly.
+        * \note The point representation (see setPointRepresentation) is only used by a search::KdTree.
         */
       inline void
-      setSearchMethodTarget (const KdTreePtr &tree, 
+      setSearchMethodTarget (const SearchTargetPtr &tree, 
                              bool force_no_recompute = false) 
       { 
         tree_ = tree; 
@@ -235,11 +241,11 @@ namespace pcl
       }
 
       /** \brief Get a pointer to the search method used to find correspondences in the
-        * target cloud. */
+        * target cloud, NULL if it is not a search::KdTree. */
       inline KdTreePtr
       getSearchMethodTarget () const
       {
-        return (tree_);
+        return (boost::dynamic_pointer_cast<KdTree> (tree_));
       }
 
       /** \brief Provide a pointer to the search object used to find correspondences in
@@ -482,7 +488,7 @@ namespace pcl
       std::string reg_name_;
 
       /** \brief A pointer to the spatial search object. */
-      KdTreePtr tree_;
+      SearchTargetPtr tree_;
       
       /** \brief A pointer to the spatial search object of the source. */
       KdTreeReciprocalPtr tree_reciprocal_;
@@ -118,6 +118,41 @@ pcl::SampleConsensusModelLine<PointT>::getDistancesToModel (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelLine<PointT>::getDistancesToModelSoA (
+      const Eigen::VectorXf &model_coefficients, const pcl::PointCloudSoA &cloud, std::vector<double> &distances)
+{
+  // Needs a valid set of model coefficients
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return;
+  }
+
+  const size_t n = cloud.size ();
+  distances.resize (n);
+  if (n == 0)
+    return;
+
+  // Obtain the line point and direction
+  Eigen::Vector3f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5]);
+  line_dir.normalize ();
+  const float px = model_coefficients[0], py = model_coefficients[1], pz = model_coefficients[2];
+  const float dx = line_dir[0], dy = line_dir[1], dz = line_dir[2];
+  const float *x = &cloud.x[0], *y = &cloud.y[0], *z = &cloud.z[0];
+  double *dist = &distances[0];
+  // D = ||(P1-P0) x dir|| for a unit direction vector
+  for (size_t i = 0; i < n; ++i)
+  {
+    const float vx = px - x[i], vy = py - y[i], vz = pz - z[i];
+    const float cx = vy * dz - vz * dy;
+    const float cy = vz * dx - vx * dz;
+    const float cz = vx * dy - vy * dx;
+    dist[i] = sqrtf (cx * cx + cy * cy + cz * cz);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelLine<PointT>::selectWithinDistance (
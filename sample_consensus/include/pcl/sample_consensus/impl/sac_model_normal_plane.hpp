@@ -192,6 +192,16 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::getDistancesToModel (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> void
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::getDistancesToModelSoA (
+      const Eigen::VectorXf &, const pcl::PointCloudSoA &, std::vector<double> &distances)
+{
+  // The normal distance is weighted with the point curvature, which a PointCloudSoA does not store
+  PCL_ERROR ("[pcl::%s::getDistancesToModelSoA] Structure of arrays input is not supported by this model!\n", this->getClassName ().c_str ());
+  distances.clear ();
+}
+
 #define PCL_INSTANTIATE_SampleConsensusModelNormalPlane(PointT, PointNT) template class PCL_EXPORTS pcl::SampleConsensusModelNormalPlane<PointT, PointNT>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_NORMAL_PLANE_H_
@@ -205,6 +205,50 @@ pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::getDistancesToModel (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> void
+pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::getDistancesToModelSoA (
+      const Eigen::VectorXf &model_coefficients, const pcl::PointCloudSoA &cloud, std::vector<double> &distances)
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return;
+  }
+
+  const size_t nr_points = cloud.size ();
+  if (nr_points > 0 && !cloud.hasNormals ())
+  {
+    PCL_ERROR ("[pcl::SampleConsensusModelNormalSphere::getDistancesToModelSoA] The structure of arrays input has no normals!\n");
+    distances.clear ();
+    return;
+  }
+
+  distances.resize (nr_points);
+
+  // Obtain the sphere centroid
+  Eigen::Vector4f center = model_coefficients;
+  center[3] = 0;
+
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+    // Calculate the distance from the point to the sphere as the difference between
+    // dist(point,sphere_origin) and sphere_radius
+    Eigen::Vector4f p (cloud.x[i], cloud.y[i], cloud.z[i], 0);
+    Eigen::Vector4f n (cloud.normal_x[i], cloud.normal_y[i], cloud.normal_z[i], 0);
+
+    Eigen::Vector4f n_dir = (p-center);
+    double d_euclid = fabs (n_dir.norm () - model_coefficients[3]);
+
+    // Calculate the angular distance between the point normal and the direction to the sphere center
+    double d_normal = fabs (getAngle3D (n, n_dir));
+    d_normal = (std::min) (d_normal, M_PI - d_normal);
+
+    distances[i] = fabs (normal_distance_weight_ * d_normal + (1 - normal_distance_weight_) * d_euclid);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> bool 
 pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::isModelValid (const Eigen::VectorXf &model_coefficients)
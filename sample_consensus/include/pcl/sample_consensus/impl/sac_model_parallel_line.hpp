@@ -86,6 +86,21 @@ pcl::SampleConsensusModelParallelLine<PointT>::getDistancesToModel (
   SampleConsensusModelLine<PointT>::getDistancesToModel (model_coefficients, distances);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelParallelLine<PointT>::getDistancesToModelSoA (
+      const Eigen::VectorXf &model_coefficients, const pcl::PointCloudSoA &cloud, std::vector<double> &distances)
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return;
+  }
+
+  pcl::SampleConsensusModelLine<PointT>::getDistancesToModelSoA (model_coefficients, cloud, distances);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::SampleConsensusModelParallelLine<PointT>::isModelValid (const Eigen::VectorXf &model_coefficients)
@@ -85,6 +85,21 @@ pcl::SampleConsensusModelPerpendicularPlane<PointT>::getDistancesToModel (
   SampleConsensusModelPlane<PointT>::getDistancesToModel (model_coefficients, distances);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelPerpendicularPlane<PointT>::getDistancesToModelSoA (
+      const Eigen::VectorXf &model_coefficients, const pcl::PointCloudSoA &cloud, std::vector<double> &distances)
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return;
+  }
+
+  pcl::SampleConsensusModelPlane<PointT>::getDistancesToModelSoA (model_coefficients, cloud, distances);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::SampleConsensusModelPerpendicularPlane<PointT>::isModelValid (const Eigen::VectorXf &model_coefficients)
@@ -138,6 +138,32 @@ pcl::SampleConsensusModelPlane<PointT>::getDistancesToModel (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelPlane<PointT>::getDistancesToModelSoA (
+      const Eigen::VectorXf &model_coefficients, const pcl::PointCloudSoA &cloud, std::vector<double> &distances)
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return;
+  }
+
+  const size_t n = cloud.size ();
+  distances.resize (n);
+  if (n == 0)
+    return;
+
+  const float a = model_coefficients[0], b = model_coefficients[1],
+              c = model_coefficients[2], d = model_coefficients[3];
+  const float *x = &cloud.x[0], *y = &cloud.y[0], *z = &cloud.z[0];
+  double *dist = &distances[0];
+  // D = |a*x + b*y + c*z + d|, streamed over the SoA coordinates
+  for (size_t i = 0; i < n; ++i)
+    dist[i] = fabsf (a * x[i] + b * y[i] + c * z[i] + d);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelPlane<PointT>::selectWithinDistance (
@@ -147,6 +147,35 @@ pcl::SampleConsensusModelSphere<PointT>::getDistancesToModel (
                                ) - model_coefficients[3]);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelSphere<PointT>::getDistancesToModelSoA (
+      const Eigen::VectorXf &model_coefficients, const pcl::PointCloudSoA &cloud, std::vector<double> &distances)
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+  {
+    distances.clear ();
+    return;
+  }
+
+  const size_t n = cloud.size ();
+  distances.resize (n);
+  if (n == 0)
+    return;
+
+  const float cx = model_coefficients[0], cy = model_coefficients[1],
+              cz = model_coefficients[2], r = model_coefficients[3];
+  const float *x = &cloud.x[0], *y = &cloud.y[0], *z = &cloud.z[0];
+  double *dist = &distances[0];
+  // Difference between dist(point,sphere_origin) and sphere_radius
+  for (size_t i = 0; i < n; ++i)
+  {
+    const float dx = x[i] - cx, dy = y[i] - cy, dz = z[i] - cz;
+    dist[i] = fabsf (sqrtf (dx * dx + dy * dy + dz * dz) - r);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelSphere<PointT>::selectWithinDistance (
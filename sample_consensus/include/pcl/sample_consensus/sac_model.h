@@ -48,6 +48,7 @@
 
 #include <pcl/console/print.h>
 #include <pcl/point_cloud.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/sample_consensus/boost.h>
 #include <pcl/sample_consensus/model_types.h>
 
@@ -557,6 +558,25 @@ namespace pcl
         return ((*rng_gen_) ());
       }
     public:
+      /** \brief Compute the distances from all the points of a structure of arrays cloud to a
+        * given model. Unlike getDistancesToModel, the distances are computed for every point of
+        * \a cloud and not for the input cloud of the model, so that a hypothesis can be scored
+        * against data that is kept in SoA form. Models that do not provide a native
+        * implementation report an error and return an empty vector. Declared last, so that
+        * the virtual table layout of the existing methods is unchanged.
+        * \param[in] model_coefficients the coefficients of a model that we need to compute distances to
+        * \param[in] cloud the points to compute the distances for
+        * \param[out] distances the resultant estimated distances
+        */
+      virtual void
+      getDistancesToModelSoA (const Eigen::VectorXf &,
+                              const pcl::PointCloudSoA &,
+                              std::vector<double> &distances)
+      {
+        PCL_ERROR ("[pcl::%s::getDistancesToModelSoA] Structure of arrays input is not supported by this model!\n", getClassName ().c_str ());
+        distances.clear ();
+      }
+
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
  };
 
@@ -118,6 +118,16 @@ namespace pcl
       getDistancesToModel (const Eigen::VectorXf &model_coefficients, 
                            std::vector<double> &distances);
 
+      /** \brief Compute the distances from all the points of a structure of arrays cloud to a given line model.
+        * \param[in] model_coefficients the coefficients of a line model that we need to compute distances to
+        * \param[in] cloud the points to compute the distances for
+        * \param[out] distances the resultant estimated distances
+        */
+      void
+      getDistancesToModelSoA (const Eigen::VectorXf &model_coefficients,
+                              const pcl::PointCloudSoA &cloud,
+                              std::vector<double> &distances);
+
       /** \brief Select all the points which respect the given model coefficients as inliers.
         * \param[in] model_coefficients the coefficients of a line model that we need to compute distances to
         * \param[in] threshold a maximum admissible distance threshold for determining the inliers from the outliers
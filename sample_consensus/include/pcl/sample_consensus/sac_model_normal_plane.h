@@ -150,6 +150,18 @@ namespace pcl
       getDistancesToModel (const Eigen::VectorXf &model_coefficients, 
                            std::vector<double> &distances);
 
+      /** \brief Compute the distances from all the points of a structure of arrays cloud to a given plane model.
+        * The normal distance is weighted with the point curvature, which is not stored in a
+        * PointCloudSoA, so this model reports an error and returns an empty vector.
+        * \param[in] model_coefficients the coefficients of a plane model that we need to compute distances to
+        * \param[in] cloud the points to compute the distances for
+        * \param[out] distances the resultant estimated distances
+        */
+      void
+      getDistancesToModelSoA (const Eigen::VectorXf &model_coefficients,
+                              const pcl::PointCloudSoA &cloud,
+                              std::vector<double> &distances);
+
       /** \brief Return an unique id for this model (SACMODEL_NORMAL_PLANE). */
       inline pcl::SacModel 
       getModelType () const { return (SACMODEL_NORMAL_PLANE); }
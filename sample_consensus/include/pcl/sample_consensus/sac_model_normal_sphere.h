@@ -143,6 +143,17 @@ namespace pcl
       getDistancesToModel (const Eigen::VectorXf &model_coefficients, 
                            std::vector<double> &distances);
 
+      /** \brief Compute the distances from all the points of a structure of arrays cloud to a given sphere model.
+        * The normal streams of \a cloud are required.
+        * \param[in] model_coefficients the coefficients of a sphere model that we need to compute distances to
+        * \param[in] cloud the points to compute the distances for
+        * \param[out] distances the resultant estimated distances
+        */
+      void
+      getDistancesToModelSoA (const Eigen::VectorXf &model_coefficients,
+                              const pcl::PointCloudSoA &cloud,
+                              std::vector<double> &distances);
+
       /** \brief Return an unique id for this model (SACMODEL_NORMAL_SPHERE). */
       inline pcl::SacModel 
       getModelType () const { return (SACMODEL_NORMAL_SPHERE); }
@@ -39,12 +39,83 @@
 #define PCL_SEARCH_BRUTE_FORCE_H_
 
 #include <pcl/search/search.h>
+#include <pcl/point_types.h>
 
 namespace pcl
 {
   namespace search
   {
+    namespace detail
+    {
+      /** \brief Access to the coordinates compared by BruteForce. The default handles the point types with x, y and
+        * z fields; specialize it to search other descriptor types.
+        */
+      template <typename PointT>
+      struct BruteForceCoordinates
+      {
+        enum { dimension = 3 };
+
+        static inline bool
+        isValid (const PointT &point)
+        {
+          return (pcl_isfinite (point.x) && pcl_isfinite (point.y) && pcl_isfinite (point.z));
+        }
+
+        static inline float
+        squaredDistance (const PointT &point1, const PointT &point2)
+        {
+          return ((point1.getVector3fMap () - point2.getVector3fMap ()).squaredNorm ());
+        }
+
+        static inline void
+        copy (const PointT &point, float *out)
+        {
+          out[0] = point.x;
+          out[1] = point.y;
+          out[2] = point.z;
+        }
+      };
+
+      /** \brief Coordinates of generic N-dimensional histogram descriptors. */
+      template <int N>
+      struct BruteForceCoordinates<pcl::Histogram<N> >
+      {
+        enum { dimension = N };
+
+        static inline bool
+        isValid (const pcl::Histogram<N> &point)
+        {
+          for (int i = 0; i < N; ++i)
+            if (!pcl_isfinite (point.histogram[i]))
+              return (false);
+          return (true);
+        }
+
+        static inline float
+        squaredDistance (const pcl::Histogram<N> &point1, const pcl::Histogram<N> &point2)
+        {
+          typedef Eigen::Map<const Eigen::Matrix<float, N, 1> > ConstVectorMap;
+          return ((ConstVectorMap (point1.histogram) - ConstVectorMap (point2.histogram)).squaredNorm ());
+        }
+
+        static inline void
+        copy (const pcl::Histogram<N> &point, float *out)
+        {
+          std::copy (point.histogram, point.histogram + N, out);
+        }
+      };
+    }
+
     /** \brief Implementation of a simple brute force search algorithm.
+      *
+      * Besides 3D points, the search also works on pcl::Histogram<N> descriptors (include
+      * pcl/search/impl/brute_force.hpp for those, they are not precompiled).
+      *
+      * In tiled mode (see \ref setTiledSearch), the valid target points are packed by setInputCloud in cache sized
+      * tiles, stored coordinate by coordinate. The distances are computed for blocks of queries against each tile
+      * with vectorized code, keeping a partial top-k selection per query. For small clouds and descriptor sets (up to a
+      * few ten thousand entries), this is faster than building and traversing a tree. The batch searches also run
+      * in parallel.
       * \author Suat Gedikli
       * \ingroup search
       */
@@ -57,6 +128,9 @@ namespace pcl
       typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
       typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
 
+      typedef detail::BruteForceCoordinates<PointT> Coordinates;
+      typedef std::vector<float, Eigen::aligned_allocator<float> > AlignedFloatVector;
+
       using pcl::search::Search<PointT>::input_;
       using pcl::search::Search<PointT>::indices_;
       using pcl::search::Search<PointT>::sorted_results_;
@@ -85,8 +159,15 @@ namespace pcl
       // replace by some metric functor
       float getDistSqr (const PointT& point1, const PointT& point2) const;
       public:
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+
         BruteForce (bool sorted_results = false)
         : Search<PointT> ("BruteForce", sorted_results)
+        , tiled_ (false)
+        , tile_size_ (0)
+        , data_ ()
+        , data_indices_ ()
         {
         }
 
@@ -96,6 +177,29 @@ namespace pcl
         {
         }
 
+        /** \brief Enable or disable the tiled search mode (disabled by default).
+          * If a cloud is already set, its points are (un)packed right away.
+          * \param[in] tiled true to enable the tiled search
+          */
+        void
+        setTiledSearch (bool tiled);
+
+        /** \brief Get whether the tiled search mode is enabled. */
+        inline bool
+        getTiledSearch () const
+        {
+          return (tiled_);
+        }
+
+        /** \brief Pass the input dataset that the search will be performed on. In tiled mode, the valid points are
+          * packed in the search buffer.
+          * \param[in] cloud a const pointer to the PointCloud data
+          * \param[in] indices the point indices subset that is to be used from the cloud
+          */
+        virtual void
+        setInputCloud (const PointCloudConstPtr& cloud,
+                       const IndicesConstPtr &indices = IndicesConstPtr ());
+
         /** \brief Search for the k-nearest neighbors for the given query point.
           * \param[in] point the given query point
           * \param[in] k the number of neighbors to search for
@@ -122,7 +226,67 @@ namespace pcl
                       std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
                       unsigned int max_nn = 0) const;
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, in parallel. In tiled mode,
+          * the queries are processed in blocks against the tiles of the packed targets.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points (all the points of \a cloud if empty)
+          * \param[in] k the number of neighbors to search for
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] nr_threads the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        virtual void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        BatchSearchResults &results, unsigned int nr_threads = 0) const;
+
+        /** \brief Search for all the neighbors of a batch of query points in a given radius, in parallel. In tiled
+          * mode, the queries are processed in blocks against the tiles of the packed targets.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points (all the points of \a cloud if empty)
+          * \param[in] radius the radius of the sphere bounding all of the neighbors
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query point to this value
+          * \param[in] nr_threads the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        virtual void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      BatchSearchResults &results, unsigned int max_nn = 0, unsigned int nr_threads = 0) const;
+
       private:
+        /** \brief Pack the valid points of the input cloud in \a data_, or release the buffer if not in tiled mode. */
+        void
+        packTargets ();
+
+        /** \brief Copy the coordinates of a point in \a out, and return whether they are all finite. */
+        static inline bool
+        packPoint (const PointT &point, float *out)
+        {
+          Coordinates::copy (point, out);
+          return (Coordinates::isValid (point));
+        }
+
+        /** \brief Compute the squared distances between a packed query and all the targets of a tile. */
+        void
+        computeDistances (const float *query, int tile, float *sqr_distances) const;
+
+        /** \brief Tiled search of a block of packed queries. With \a k > 0, the k nearest neighbors of each query are
+          * kept, sorted by distance. Otherwise the neighbors within \a sqr_radius are kept in index order, up to
+          * \a max_nn of them (0: no limit).
+          * \param[in] queries the packed queries, one after the other
+          * \param[in] nr_queries the number of queries in the block
+          * \param[in,out] done the queries that need no further processing (invalid ones must be set on input)
+          * \param[out] rows the packed target rows found for each query
+          * \param[out] sqr_distances the matching squared distances
+          */
+        void
+        searchBlock (const float *queries, int nr_queries, int k, float sqr_radius, unsigned int max_nn,
+                     std::vector<char> &done, std::vector<int> *rows, std::vector<float> *sqr_distances) const;
+
+        /** \brief Tiled batch search, see \ref searchBlock for the parameters. */
+        void
+        tiledBatchSearch (const PointCloud &cloud, const std::vector<int> &indices, int k, float sqr_radius,
+                          unsigned int max_nn, BatchSearchResults &results, unsigned int nr_threads) const;
+
+
         int
         denseKSearch (const PointT &point, int k, std::vector<int> &k_indices, std::vector<float> &k_distances) const;
 
@@ -138,6 +302,23 @@ namespace pcl
         sparseRadiusSearch (const PointT& point, double radius,
                             std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
                             unsigned int max_nn = 0) const;
+
+        /** \brief Whether the tiled search mode is enabled. */
+        bool tiled_;
+
+        /** \brief The number of points per tile, a multiple of 16. */
+        int tile_size_;
+
+        /** \brief The packed coordinates of the valid points of the input cloud, in index order. Each tile holds
+          * the first coordinate of its tile_size_ points, then the second one, and so on.
+          */
+        AlignedFloatVector data_;
+
+        /** \brief The cloud index of each packed point. */
+        std::vector<int> data_indices_;
+
+        /** \brief The number of queries processed together against each tile of targets. */
+        static const int query_block_size_ = 8;
     };
   }
 }
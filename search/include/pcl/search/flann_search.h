@@ -53,6 +53,9 @@ namespace flann
 
 namespace pcl
 {
+  // Forward declarations
+  class FlannIndexFile;
+
   namespace search
   {
 
@@ -105,6 +108,9 @@ namespace pcl
       using Search<PointT>::sorted_results_;
 
       public:
+        using Search<PointT>::nearestKSearch;
+        using Search<PointT>::radiusSearch;
+
         typedef boost::shared_ptr<FlannSearch<PointT, FlannDistance> > Ptr;
         typedef boost::shared_ptr<const FlannSearch<PointT, FlannDistance> > ConstPtr;
         
@@ -261,6 +267,31 @@ namespace pcl
         virtual void
         setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr& indices = IndicesConstPtr ());
 
+        /** \brief Save the built index together with its points to a file (see pcl::FlannIndexFile), to be reloaded
+          * with \ref loadIndex instead of rebuilding it.
+          * \note A single kd-tree built on a reordered copy of the points (the default) is rebuilt without
+          * reordering on the saved points, since the loaded index searches them in place.
+          * \param[in] file_name the name of the file
+          * \return true if successful
+          */
+        bool
+        saveIndex (const std::string &file_name) const;
+
+        /** \brief Load an index saved by \ref saveIndex, instead of building it with \ref setInputCloud. The points
+          * of the index are memory mapped read-only from the file and searched in place, only the index is
+          * deserialized. The index creator has to create the same type of FLANN index as the saved one.
+          *
+          * The file is only loaded if it was built from the same points, as checked with the checksum saved in it
+          * (see pcl::FlannIndexFile::computeChecksum), and with the same point representation dimension.
+          * \param[in] file_name the name of the file
+          * \param[in] cloud the cloud the index was built from
+          * \param[in] indices the point indices subset the index was built from
+          * \return true if successful. Otherwise the current index is kept unchanged.
+          */
+        bool
+        loadIndex (const std::string &file_name, const PointCloudConstPtr& cloud,
+                   const IndicesConstPtr& indices = IndicesConstPtr ());
+
         /** \brief Search for the k-nearest neighbors for the given query point.
           * \param[in] point the given query point
           * \param[in] k the number of neighbors to search for
@@ -311,6 +342,31 @@ namespace pcl
         radiusSearch (const PointCloud& cloud, const std::vector<int>& indices, double radius, std::vector< std::vector<int> >& k_indices,
                 std::vector< std::vector<float> >& k_sqr_distances, unsigned int max_nn=0) const;
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, with a single query of the FLANN
+          * index, whose results are written directly into \a results.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are queried.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] nr_threads the number of threads FLANN uses (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        virtual void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        BatchSearchResults &results, unsigned int nr_threads = 0) const;
+
+        /** \brief Search for all the nearest neighbors of a batch of query points in a given radius, with a single
+          * query of the FLANN index.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are queried.
+          * \param[in] radius the radius of the sphere bounding all of the neighbors
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] max_nn if given, bounds the maximum number of neighbors returned for each query point
+          * \param[in] nr_threads the number of threads FLANN uses (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        virtual void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      BatchSearchResults &results, unsigned int max_nn = 0, unsigned int nr_threads = 0) const;
+
         /** \brief Provide a pointer to the point representation to use to convert points into k-D vectors.
           * \param[in] point_representation the const boost shared pointer to a PointRepresentation
           */
@@ -336,6 +392,11 @@ namespace pcl
           */
         void convertInputToFlannMatrix();
 
+        /** \brief converts query points to a FLANN matrix, stored in \a queries as packed rows of dim_ floats
+          */
+        flann::Matrix<float>
+        vectorizeQueries (const PointCloud &cloud, const std::vector<int> &indices, std::vector<float> &queries) const;
+
         /** The FLANN index.
           */
         IndexPtr index_;
@@ -358,6 +419,10 @@ namespace pcl
         
         bool input_copied_for_flann_;
 
+        /** The memory mapped file holding the points of an index loaded with \ref loadIndex.
+          */
+        boost::shared_ptr<FlannIndexFile> index_file_;
+
         PointRepresentationConstPtr point_representation_;
 
         int dim_;
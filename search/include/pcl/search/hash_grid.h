@@ -0,0 +1,253 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_HASH_GRID_H_
+#define PCL_SEARCH_HASH_GRID_H_
+
+#include <pcl/search/search.h>
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+#include <algorithm>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief @b search::HashGrid is a search on a uniform grid of cubic cells, made for the many fixed radius
+      * searches of algorithms such as EuclideanClusterExtraction, RadiusOutlierRemoval or MovingLeastSquares.
+      *
+      * The points are sorted by cell, and the cells hold the range of their points in a hash table. A radius
+      * search no larger than the cell size only visits the 3x3x3 cells around the query, that is nine
+      * contiguous ranges of points since the cells of a row are consecutive. Larger radii and the k nearest
+      * neighbor searches visit growing shells of cells around the query. Best performance is reached with a
+      * cell size equal to the search radius.
+      *
+      * \code
+      * pcl::search::HashGrid<pcl::PointXYZ>::Ptr grid (new pcl::search::HashGrid<pcl::PointXYZ> (0.02));
+      * pcl::EuclideanClusterExtraction<pcl::PointXYZ> ec;
+      * ec.setClusterTolerance (0.02);
+      * ec.setSearchMethod (grid);
+      * \endcode
+      *
+      * \note Only the x, y and z coordinates of the points are used.
+      * \ingroup search
+      */
+    template<typename PointT>
+    class HashGrid: public Search<PointT>
+    {
+      public:
+        typedef typename Search<PointT>::PointCloud PointCloud;
+        typedef typename Search<PointT>::PointCloudPtr PointCloudPtr;
+        typedef typename Search<PointT>::PointCloudConstPtr PointCloudConstPtr;
+
+        typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
+        typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
+
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+        using pcl::search::Search<PointT>::sorted_results_;
+
+        typedef boost::shared_ptr<HashGrid<PointT> > Ptr;
+        typedef boost::shared_ptr<const HashGrid<PointT> > ConstPtr;
+
+        /** \brief Constructor for HashGrid.
+          * \param[in] resolution the size of the cells, usually the radius of the searches
+          * \param[in] sorted set to true if the radius search results need to be sorted in ascending order
+          * based on their distance to the query point
+          */
+        HashGrid (double resolution = 0.0, bool sorted = true);
+
+        /** \brief Destructor for HashGrid. */
+        virtual
+        ~HashGrid ()
+        {
+        }
+
+        /** \brief Set the size of the cells. Takes effect at the next call to setInputCloud.
+          * \param[in] resolution the size of the cells, usually the radius of the searches
+          */
+        inline void
+        setResolution (double resolution) { resolution_ = resolution; }
+
+        /** \brief Get the size of the cells. */
+        inline double
+        getResolution () const { return (resolution_); }
+
+        /** \brief Get the number of non empty cells of the grid. */
+        inline int
+        getNumberOfCells () const { return (static_cast<int> (cells_.size ())); }
+
+        /** \brief Sort the points into the grid.
+          * \param[in] cloud the const boost shared pointer to a PointCloud message
+          * \param[in] indices the point indices subset that is to be used from \a cloud
+          */
+        void
+        setInputCloud (const PointCloudConstPtr& cloud,
+                       const IndicesConstPtr& indices = IndicesConstPtr ());
+
+        /** \brief Search for the k-nearest neighbors for the given query point.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k,
+                        std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius,
+                      std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const;
+
+      protected:
+        /** \brief A non empty cell of the grid and the range of its points in the sorted arrays. */
+        struct Cell
+        {
+          Eigen::Vector3i key;
+          int begin;
+          int end;
+        };
+
+        /** \brief Get the coordinates of the cell containing a point. */
+        inline Eigen::Vector3i
+        getCellKey (const float *p) const
+        {
+          return (Eigen::Vector3i (static_cast<int> (std::floor (p[0] * inverse_resolution_)),
+                                   static_cast<int> (std::floor (p[1] * inverse_resolution_)),
+                                   static_cast<int> (std::floor (p[2] * inverse_resolution_))));
+        }
+
+        /** \brief Hash the coordinates of a cell into the table. */
+        inline size_t
+        hash (const Eigen::Vector3i &key) const
+        {
+          return ((static_cast<size_t> (key[0]) * 73856093u ^ static_cast<size_t> (key[1]) * 19349663u ^
+                   static_cast<size_t> (key[2]) * 83492791u) & table_mask_);
+        }
+
+        typedef std::pair<float, int> Neighbor;
+
+        /** \brief Insert a point in a max-heap of the \a k closest neighbors found so far. */
+        static inline void
+        pushNeighbor (float sqr_distance, int index, int k, std::vector<Neighbor> &neighbors)
+        {
+          if (static_cast<int> (neighbors.size ()) < k)
+          {
+            neighbors.push_back (Neighbor (sqr_distance, index));
+            std::push_heap (neighbors.begin (), neighbors.end ());
+          }
+          else if (sqr_distance < neighbors.front ().first)
+          {
+            std::pop_heap (neighbors.begin (), neighbors.end ());
+            neighbors.back () = Neighbor (sqr_distance, index);
+            std::push_heap (neighbors.begin (), neighbors.end ());
+          }
+        }
+
+        /** \brief Get the number of cells of the box of cells [min_key, max_key]. */
+        static inline size_t
+        countCells (const Eigen::Vector3i &min_key, const Eigen::Vector3i &max_key)
+        {
+          return (static_cast<size_t> (max_key[0] - min_key[0] + 1) * static_cast<size_t> (max_key[1] - min_key[1] + 1) *
+                  static_cast<size_t> (max_key[2] - min_key[2] + 1));
+        }
+
+        /** \brief Get the cell at the given coordinates, or 0 if it is empty. */
+        const Cell*
+        findCell (const Eigen::Vector3i &key) const;
+
+        /** \brief Get the range of the sorted points of the cells [x_min, x_max] of a row of the grid.
+          * \return false if all the cells of the range are empty
+          */
+        bool
+        getRowRange (int x_min, int x_max, int y, int z, int &begin, int &end) const;
+
+        /** \brief Append the points of a range closer than \a sqr_radius to the query to the results. */
+        void
+        filterRange (const Eigen::Array4f &query, int begin, int end, float sqr_radius,
+                     std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief The size of the cells. */
+        double resolution_;
+
+        /** \brief The inverse of the size of the cells the grid was built with. */
+        float inverse_resolution_;
+
+        /** \brief The points, sorted by cell, as x, y, z, 0 for vectorized distances. */
+        std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > points_;
+
+        /** \brief The indices in the input cloud of the sorted points. */
+        std::vector<int> point_indices_;
+
+        /** \brief The non empty cells, in the order of the sorted points. */
+        std::vector<Cell> cells_;
+
+        /** \brief Open addressing hash table of the cells, -1 for an empty slot. */
+        std::vector<int> table_;
+
+        /** \brief The size of the hash table minus one, the size being a power of two. */
+        size_t table_mask_;
+
+        /** \brief The coordinates of the smallest and largest cells of the grid. */
+        Eigen::Vector3i min_key_, max_key_;
+    };
+  }
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/search/impl/hash_grid.hpp>
+#else
+#define PCL_INSTANTIATE_HashGrid(T) template class PCL_EXPORTS pcl::search::HashGrid<T>;
+#endif
+
+#endif    // PCL_SEARCH_HASH_GRID_H_
@@ -0,0 +1,427 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_HNSW_H_
+#define PCL_SEARCH_HNSW_H_
+
+#include <pcl/search/search.h>
+#include <pcl/point_representation.h>
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+#include <boost/thread/mutex.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+namespace pcl
+{
+  namespace search
+  {
+    namespace detail
+    {
+      /** \brief Pool of the visited node tables used by the graph searches of search::HNSW. A table marks the
+        * visited nodes with the tag of the current search, so that it does not need to be cleared between two
+        * searches.
+        */
+      class HNSWVisitedPool
+      {
+        public:
+          struct Table
+          {
+            Table () : marks (), tag (0) {}
+            std::vector<unsigned int> marks;
+            unsigned int tag;
+          };
+
+          typedef boost::shared_ptr<Table> TablePtr;
+
+          /** \brief Get a table for \a nr_nodes nodes, ready for a new search. */
+          TablePtr
+          acquire (size_t nr_nodes)
+          {
+            TablePtr table;
+            {
+              boost::mutex::scoped_lock lock (mutex_);
+              if (!tables_.empty ())
+              {
+                table = tables_.back ();
+                tables_.pop_back ();
+              }
+            }
+            if (!table)
+              table.reset (new Table);
+            if (table->marks.size () < nr_nodes)
+              table->marks.resize (nr_nodes, 0);
+            if (++table->tag == 0)
+            {
+              std::fill (table->marks.begin (), table->marks.end (), 0);
+              table->tag = 1;
+            }
+            return (table);
+          }
+
+          /** \brief Give a table back to the pool. */
+          void
+          release (const TablePtr &table)
+          {
+            boost::mutex::scoped_lock lock (mutex_);
+            tables_.push_back (table);
+          }
+
+        private:
+          std::vector<boost::shared_ptr<Table> > tables_;
+          boost::mutex mutex_;
+      };
+    }
+
+    /** \brief @b search::HNSW is an approximate nearest neighbor search on a hierarchical navigable small world
+      * graph (Malkov and Yashunin, 2016), suited to high dimensional descriptors such as FPFH, SHOT or VFH, where
+      * kd-trees lose most of their efficiency.
+      *
+      * Every point is a node of a layered proximity graph; a search walks greedily from the entry point down the
+      * layers and ends with a best first search of \a ef candidates in the bottom layer. Larger values of
+      * \a ef give a higher recall at a higher cost. Points can be added to the graph at any time with addPoints,
+      * and the graph can be saved to and loaded from a file.
+      *
+      * \code
+      * pcl::search::HNSW<pcl::SHOT352> search;
+      * search.setSearchSize (64);
+      * search.setInputCloud (model_descriptors);
+      * search.nearestKSearch (scene_descriptors->points[i], 1, k_indices, k_sqr_distances);
+      * search.saveIndex ("model.hnsw");
+      * \endcode
+      *
+      * The points are converted to vectors by the point representation (DefaultPointRepresentation by default)
+      * and compared with the squared euclidean distance, vectorized with Eigen.
+      *
+      * \note The searches are thread safe, but must not run while points are added.
+      * \ingroup search
+      */
+    template<typename PointT>
+    class HNSW: public Search<PointT>
+    {
+      public:
+        typedef typename Search<PointT>::PointCloud PointCloud;
+        typedef typename Search<PointT>::PointCloudPtr PointCloudPtr;
+        typedef typename Search<PointT>::PointCloudConstPtr PointCloudConstPtr;
+
+        typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
+        typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
+
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+        using pcl::search::Search<PointT>::sorted_results_;
+
+        typedef boost::shared_ptr<HNSW<PointT> > Ptr;
+        typedef boost::shared_ptr<const HNSW<PointT> > ConstPtr;
+
+        typedef pcl::PointRepresentation<PointT> PointRepresentation;
+        typedef boost::shared_ptr<PointRepresentation> PointRepresentationPtr;
+        typedef boost::shared_ptr<const PointRepresentation> PointRepresentationConstPtr;
+
+        /** \brief Constructor for HNSW.
+          * \param[in] max_connections the number of links of a node in the upper layers of the graph, twice as
+          * many in the bottom layer
+          * \param[in] construction_search_size the number of candidates searched when a node is linked
+          */
+        HNSW (int max_connections = 16, int construction_search_size = 200);
+
+        /** \brief Destructor for HNSW. */
+        virtual
+        ~HNSW ()
+        {
+        }
+
+        /** \brief Set the number of links of a node in the upper layers of the graph. Takes effect at the next
+          * call to setInputCloud.
+          */
+        inline void
+        setMaxConnections (int max_connections) { max_connections_ = max_connections; }
+
+        /** \brief Get the number of links of a node in the upper layers of the graph. */
+        inline int
+        getMaxConnections () const { return (max_connections_); }
+
+        /** \brief Set the number of candidates searched when a node is linked. */
+        inline void
+        setConstructionSearchSize (int size) { construction_search_size_ = size; }
+
+        /** \brief Get the number of candidates searched when a node is linked. */
+        inline int
+        getConstructionSearchSize () const { return (construction_search_size_); }
+
+        /** \brief Set the number of candidates searched by the queries. The k nearest neighbor searches use at
+          * least k candidates.
+          * \param[in] size the number of candidates (default: 32)
+          */
+        inline void
+        setSearchSize (int size) { search_size_ = size; }
+
+        /** \brief Get the number of candidates searched by the queries. */
+        inline int
+        getSearchSize () const { return (search_size_); }
+
+        /** \brief Set the seed of the random generator drawing the layers of the nodes. */
+        inline void
+        setSeed (unsigned int seed) { seed_ = seed; }
+
+        /** \brief Set the number of threads used to build the graph. With more than one thread the graph, and
+          * therefore the approximate results, depend on the scheduling of the threads.
+          * \param[in] nr_threads the number of threads (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads) { threads_ = nr_threads; }
+
+        /** \brief Provide a pointer to the point representation to use to convert points into vectors.
+          * Takes effect at the next call to setInputCloud.
+          */
+        inline void
+        setPointRepresentation (const PointRepresentationConstPtr &point_representation)
+        {
+          point_representation_ = point_representation;
+        }
+
+        /** \brief Get a pointer to the point representation used to convert points into vectors. */
+        inline PointRepresentationConstPtr
+        getPointRepresentation () const { return (point_representation_); }
+
+        /** \brief Build the graph on a new set of points.
+          * \param[in] cloud the const boost shared pointer to a PointCloud message
+          * \param[in] indices the point indices subset that is to be used from \a cloud
+          */
+        void
+        setInputCloud (const PointCloudConstPtr& cloud,
+                       const IndicesConstPtr& indices = IndicesConstPtr ());
+
+        /** \brief Insert new points in the graph. They are appended to a copy of the input cloud, point i of
+          * \a cloud gets the index getInputCloud ()->size () + i.
+          * \param[in] cloud the points to add
+          */
+        void
+        addPoints (const PointCloud &cloud);
+
+        /** \brief Get the number of points in the graph. */
+        inline int
+        size () const { return (static_cast<int> (index_mapping_.size ())); }
+
+        /** \brief Save the graph to a binary file.
+          * \param[in] file_name the name of the file
+          * \return true on success
+          */
+        bool
+        saveIndex (const std::string &file_name) const;
+
+        /** \brief Load a graph saved by saveIndex, replacing the current one.
+          * \param[in] file_name the name of the file
+          * \param[in] cloud the points the graph was built on, which the indices of the results refer to
+          * \param[in] indices the point indices subset the graph was built on
+          * \return true on success
+          */
+        bool
+        loadIndex (const std::string &file_name, const PointCloudConstPtr &cloud,
+                   const IndicesConstPtr &indices = IndicesConstPtr ());
+
+        /** \brief Search for the approximate k-nearest neighbors for the given query point.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k,
+                        std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for the neighbors of the query point in a given radius. The graph is searched for
+          * nearest neighbors with a growing number of candidates until one is out of the radius, the results
+          * are therefore approximate too.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius,
+                      std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const;
+
+      protected:
+        typedef std::pair<float, int> Candidate;
+
+        /** \brief Convert the points of \a cloud to vectors and insert them in the graph. */
+        void
+        insertPoints (const PointCloud &cloud, const std::vector<int> &indices, int label_offset);
+
+        /** \brief Link a node whose vector and layer are set into the graph. */
+        void
+        insertNode (int node, bool parallel);
+
+        /** \brief Best first search of the \a ef nodes closest to \a query in a layer, starting from
+          * \a entry_points. The result is a max-heap.
+          */
+        void
+        searchLayer (const float *query, const std::vector<Candidate> &entry_points, int ef, int layer,
+                     bool parallel, std::vector<Candidate> &results) const;
+
+        /** \brief Greedy search of the node closest to \a query in a layer. */
+        void
+        searchClosest (const float *query, int layer, bool parallel, Candidate &closest) const;
+
+        /** \brief Select the neighbors of a node among candidates sorted by distance, keeping the candidates
+          * that are closer to the node than to the neighbors already selected.
+          */
+        void
+        selectNeighbors (const std::vector<Candidate> &candidates, int max_neighbors,
+                         std::vector<Candidate> &neighbors) const;
+
+        /** \brief Copy the links of a node in a layer. */
+        void
+        getLinks (int node, int layer, bool parallel, std::vector<int> &links) const;
+
+        /** \brief Replace the links of a node in a layer. The caller holds the lock of the node. */
+        void
+        setLinks (int node, int layer, const std::vector<Candidate> &links);
+
+        /** \brief Get the links of a node in a layer: the number of links followed by their nodes. */
+        inline int*
+        linkList (int node, int layer)
+        {
+          return (layer == 0 ? &links0_[node * (2 * max_connections_ + 1)]
+                             : &upper_links_[node][(layer - 1) * (max_connections_ + 1)]);
+        }
+
+        /** \brief Get the links of a node in a layer: the number of links followed by their nodes. */
+        inline const int*
+        linkList (int node, int layer) const
+        {
+          return (layer == 0 ? &links0_[node * (2 * max_connections_ + 1)]
+                             : &upper_links_[node][(layer - 1) * (max_connections_ + 1)]);
+        }
+
+        /** \brief Get the vector of a node. */
+        inline const float*
+        nodeVector (int node) const { return (&data_[node * stride_]); }
+
+        /** \brief Squared euclidean distance between two vectors of the graph layout. */
+        inline float
+        distance (const float *a, const float *b) const
+        {
+          typedef Eigen::Map<const Eigen::VectorXf, Eigen::Aligned> Vector;
+          return ((Vector (a, stride_) - Vector (b, stride_)).squaredNorm ());
+        }
+
+        /** \brief Convert a query point to a vector of the graph layout. */
+        void
+        vectorizeQuery (const PointT &point, std::vector<float, Eigen::aligned_allocator<float> > &query) const;
+
+        /** \brief The point representation used to convert the points into vectors. */
+        PointRepresentationConstPtr point_representation_;
+
+        /** \brief The vectors of the nodes, each padded to \a stride_ floats for aligned vectorized distances. */
+        std::vector<float, Eigen::aligned_allocator<float> > data_;
+
+        /** \brief The number of dimensions of the vectors. */
+        int dim_;
+
+        /** \brief The number of floats between two vectors in \a data_. */
+        int stride_;
+
+        /** \brief The index of the point of each node. */
+        std::vector<int> index_mapping_;
+
+        /** \brief The top layer of each node. */
+        std::vector<int> layers_;
+
+        /** \brief The links of the nodes in the bottom layer, 2 * max_connections_ + 1 values per node. */
+        std::vector<int> links0_;
+
+        /** \brief The links of each node in the upper layers, max_connections_ + 1 values per layer. */
+        std::vector<std::vector<int> > upper_links_;
+
+        /** \brief The node the searches start from, -1 for an empty graph. */
+        int entry_point_;
+
+        /** \brief The top layer of the graph. */
+        int max_layer_;
+
+        /** \brief The number of links of a node in the upper layers. */
+        int max_connections_;
+
+        /** \brief The number of candidates searched when a node is linked. */
+        int construction_search_size_;
+
+        /** \brief The number of candidates searched by the queries. */
+        int search_size_;
+
+        /** \brief The seed of the random generator drawing the layers of the nodes. */
+        unsigned int seed_;
+
+        /** \brief The number of threads used to build the graph. */
+        unsigned int threads_;
+
+        /** \brief The random generator drawing the layers of the nodes. */
+        boost::mt19937 rng_;
+
+        /** \brief Locks protecting the links of the nodes and the entry point while the graph is built. */
+        struct Locks
+        {
+          enum { NR_LOCKS = 4096 };
+          boost::mutex links[NR_LOCKS];
+          boost::mutex entry;
+        };
+        boost::shared_ptr<Locks> locks_;
+
+        /** \brief Visited node tables for the searches. */
+        boost::shared_ptr<detail::HNSWVisitedPool> visited_pool_;
+
+        /** \brief The points added with addPoints, along with the input cloud. */
+        PointCloudPtr owned_cloud_;
+    };
+  }
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/search/impl/hnsw.hpp>
+#else
+#define PCL_INSTANTIATE_HNSW(T) template class PCL_EXPORTS pcl::search::HNSW<T>;
+#endif
+
+#endif    // PCL_SEARCH_HNSW_H_
@@ -39,6 +39,8 @@
 #define PCL_SEARCH_IMPL_BRUTE_FORCE_SEARCH_H_
 
 #include <pcl/search/brute_force.h>
+#include <pcl/common/parallel.h>
+#include <algorithm>
 #include <queue>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -46,7 +48,292 @@ template <typename PointT> float
 pcl::search::BruteForce<PointT>::getDistSqr (
     const PointT& point1, const PointT& point2) const
 {
-  return (point1.getVector3fMap () - point2.getVector3fMap ()).squaredNorm ();
+  return (Coordinates::squaredDistance (point1, point2));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::setTiledSearch (bool tiled)
+{
+  if (tiled == tiled_)
+    return;
+  tiled_ = tiled;
+  packTargets ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::setInputCloud (
+    const PointCloudConstPtr& cloud, const IndicesConstPtr &indices)
+{
+  Search<PointT>::setInputCloud (cloud, indices);
+  packTargets ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::packTargets ()
+{
+  data_.clear ();
+  data_indices_.clear ();
+  if (!tiled_ || !input_)
+  {
+    AlignedFloatVector ().swap (data_);
+    std::vector<int> ().swap (data_indices_);
+    return;
+  }
+
+  // Tiles of about 32KB, which stay in the cache while all the queries of a block are processed
+  const int dimension = Coordinates::dimension;
+  tile_size_ = std::max (64, (8192 / dimension) & ~15);
+
+  const size_t nr_points = indices_ ? indices_->size () : input_->size ();
+  data_indices_.reserve (nr_points);
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+    const int index = indices_ ? (*indices_)[i] : static_cast<int> (i);
+    if (Coordinates::isValid (input_->points[index]))
+      data_indices_.push_back (index);
+  }
+
+  const int nr_tiles = (static_cast<int> (data_indices_.size ()) + tile_size_ - 1) / tile_size_;
+  data_.assign (static_cast<size_t> (nr_tiles) * tile_size_ * dimension, 0.0f);
+  std::vector<float> coordinates (dimension);
+  for (size_t row = 0; row < data_indices_.size (); ++row)
+  {
+    Coordinates::copy (input_->points[data_indices_[row]], &coordinates[0]);
+    float *tile = &data_[(row / tile_size_) * tile_size_ * dimension + row % tile_size_];
+    for (int d = 0; d < dimension; ++d)
+      tile[d * tile_size_] = coordinates[d];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::computeDistances (
+    const float *query, int tile, float *sqr_distances) const
+{
+  // The tile is a column major matrix with one point per row: the distances are accumulated one coordinate at a
+  // time, and Eigen vectorizes over the points.
+  const int dimension = Coordinates::dimension;
+  const Eigen::Map<const Eigen::ArrayXXf, Eigen::Aligned> points (&data_[tile * tile_size_ * dimension],
+                                                                  tile_size_, dimension);
+  Eigen::Map<Eigen::ArrayXf, Eigen::Aligned> distances (sqr_distances, tile_size_);
+  if (dimension == 3)
+    distances = (points.col (0) - query[0]).square () + (points.col (1) - query[1]).square () +
+                (points.col (2) - query[2]).square ();
+  else
+  {
+    // Four coordinates per pass over the distances
+    int d = dimension % 4;
+    if (d == 0)
+    {
+      distances = (points.col (0) - query[0]).square () + (points.col (1) - query[1]).square () +
+                  (points.col (2) - query[2]).square () + (points.col (3) - query[3]).square ();
+      d = 4;
+    }
+    else
+    {
+      distances = (points.col (0) - query[0]).square ();
+      for (int i = 1; i < d; ++i)
+        distances += (points.col (i) - query[i]).square ();
+    }
+    for (; d < dimension; d += 4)
+      distances += (points.col (d) - query[d]).square () + (points.col (d + 1) - query[d + 1]).square () +
+                   (points.col (d + 2) - query[d + 2]).square () + (points.col (d + 3) - query[d + 3]).square ();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::searchBlock (
+    const float *queries, int nr_queries, int k, float sqr_radius, unsigned int max_nn,
+    std::vector<char> &done, std::vector<int> *rows, std::vector<float> *sqr_distances) const
+{
+  // The distances of a tile are split in groups of 16 interleaved rows: group g holds the rows g, g + nr_groups,
+  // g + 2 * nr_groups... The minimum distance of all the groups is computed with vertical (vectorized) minimums,
+  // and only the groups whose minimum passes the current threshold are scanned.
+  const int dimension = Coordinates::dimension;
+  const int nr_rows = static_cast<int> (data_indices_.size ());
+  const int nr_groups = tile_size_ / 16;
+  AlignedFloatVector tile_distances (tile_size_);
+  AlignedFloatVector group_min (nr_groups);
+  std::vector<int> candidates;
+
+  for (int q = 0; q < nr_queries; ++q)
+  {
+    rows[q].clear ();
+    sqr_distances[q].clear ();
+  }
+
+  for (int tile_begin = 0; tile_begin < nr_rows; tile_begin += tile_size_)
+  {
+    const int tile_rows = std::min (tile_size_, nr_rows - tile_begin);
+    for (int q = 0; q < nr_queries; ++q)
+    {
+      if (done[q])
+        continue;
+      computeDistances (queries + q * dimension, tile_begin / tile_size_, &tile_distances[0]);
+      // Column c of the groups starts at tile_distances[c * nr_groups], the loops vectorize over the groups
+      std::copy (&tile_distances[0], &tile_distances[0] + nr_groups, &group_min[0]);
+      for (int column = 1; column < 16; ++column)
+      {
+        const float *column_distances = &tile_distances[column * nr_groups];
+        for (int group = 0; group < nr_groups; ++group)
+          group_min[group] = std::min (group_min[group], column_distances[group]);
+      }
+
+      std::vector<int> &q_rows = rows[q];
+      std::vector<float> &q_distances = sqr_distances[q];
+      if (k > 0)
+      {
+        // Partial top-k selection by sorted insertion
+        for (int group = 0; group < nr_groups; ++group)
+        {
+          if (static_cast<int> (q_rows.size ()) == k && !(group_min[group] < q_distances.back ()))
+            continue;
+          for (int row = group; row < tile_rows; row += nr_groups)
+          {
+            const float distance = tile_distances[row];
+            if (static_cast<int> (q_rows.size ()) == k)
+            {
+              if (!(distance < q_distances.back ()))
+                continue;
+              q_rows.pop_back ();
+              q_distances.pop_back ();
+            }
+            const size_t pos = std::upper_bound (q_distances.begin (), q_distances.end (), distance) -
+                               q_distances.begin ();
+            q_rows.insert (q_rows.begin () + pos, tile_begin + row);
+            q_distances.insert (q_distances.begin () + pos, distance);
+          }
+        }
+      }
+      else
+      {
+        // The neighbors are kept in index order, so that max_nn selects the same ones as the default search
+        candidates.clear ();
+        for (int group = 0; group < nr_groups; ++group)
+        {
+          if (group_min[group] > sqr_radius)
+            continue;
+          for (int row = group; row < tile_rows; row += nr_groups)
+            if (tile_distances[row] <= sqr_radius)
+              candidates.push_back (row);
+        }
+        std::sort (candidates.begin (), candidates.end ());
+        for (size_t i = 0; i < candidates.size (); ++i)
+        {
+          q_rows.push_back (tile_begin + candidates[i]);
+          q_distances.push_back (tile_distances[candidates[i]]);
+          if (q_rows.size () == max_nn) // never true if max_nn = 0
+          {
+            done[q] = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::tiledBatchSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, int k, float sqr_radius,
+    unsigned int max_nn, BatchSearchResults &results, unsigned int nr_threads) const
+{
+  const int nr_queries = static_cast<int> (indices.empty () ? cloud.size () : indices.size ());
+  const int block_size = query_block_size_;
+  const int nr_blocks = (nr_queries + block_size - 1) / block_size;
+  std::vector<std::vector<int> > block_indices (nr_blocks);
+  std::vector<std::vector<float> > block_sqr_distances (nr_blocks);
+
+  results.offsets.resize (nr_queries + 1);
+  results.offsets[0] = 0;
+  pcl::parallel::parallel_for (0, nr_blocks, [&] (int begin, int end)
+  {
+    std::vector<float> queries (block_size * static_cast<int> (Coordinates::dimension));
+    std::vector<char> done (block_size);
+    std::vector<int> rows[query_block_size_];
+    std::vector<float> sqr_distances[query_block_size_];
+    for (int block = begin; block < end; ++block)
+    {
+      const int first = block * block_size;
+      const int nr_block_queries = std::min (block_size, nr_queries - first);
+      for (int q = 0; q < nr_block_queries; ++q)
+      {
+        const int index = indices.empty () ? first + q : indices[first + q];
+        done[q] = !packPoint (cloud.points[index], &queries[q * static_cast<int> (Coordinates::dimension)]);
+      }
+      searchBlock (&queries[0], nr_block_queries, k, sqr_radius, max_nn, done, rows, sqr_distances);
+
+      for (int q = 0; q < nr_block_queries; ++q)
+      {
+        std::vector<int> q_indices (rows[q].size ());
+        for (size_t i = 0; i < rows[q].size (); ++i)
+          q_indices[i] = data_indices_[rows[q][i]];
+        if (k <= 0 && sorted_results_)
+          this->sortResults (q_indices, sqr_distances[q]);
+        results.offsets[first + q + 1] = static_cast<int> (q_indices.size ());
+        block_indices[block].insert (block_indices[block].end (), q_indices.begin (), q_indices.end ());
+        block_sqr_distances[block].insert (block_sqr_distances[block].end (),
+                                           sqr_distances[q].begin (), sqr_distances[q].end ());
+      }
+    }
+  }, 1, nr_threads);
+
+  for (int query = 0; query < nr_queries; ++query)
+    results.offsets[query + 1] += results.offsets[query];
+
+  results.indices.resize (results.offsets[nr_queries]);
+  results.sqr_distances.resize (results.offsets[nr_queries]);
+  pcl::parallel::parallel_for (0, nr_blocks, [&] (int begin, int end)
+  {
+    for (int block = begin; block < end; ++block)
+    {
+      const int offset = results.offsets[block * block_size];
+      std::copy (block_indices[block].begin (), block_indices[block].end (), results.indices.begin () + offset);
+      std::copy (block_sqr_distances[block].begin (), block_sqr_distances[block].end (),
+                 results.sqr_distances.begin () + offset);
+    }
+  }, 16, nr_threads);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::nearestKSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, int k,
+    BatchSearchResults &results, unsigned int nr_threads) const
+{
+  if (!tiled_)
+  {
+    Search<PointT>::nearestKSearch (cloud, indices, k, results, nr_threads);
+    return;
+  }
+  if (k < 1)
+  {
+    results.clear ();
+    results.offsets.assign ((indices.empty () ? cloud.size () : indices.size ()) + 1, 0);
+    return;
+  }
+  tiledBatchSearch (cloud, indices, k, 0.0f, 0, results, nr_threads);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::radiusSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, double radius,
+    BatchSearchResults &results, unsigned int max_nn, unsigned int nr_threads) const
+{
+  if (!tiled_)
+  {
+    Search<PointT>::radiusSearch (cloud, indices, radius, results, max_nn, nr_threads);
+    return;
+  }
+  // A negative squared radius matches nothing, as radius <= 0 in the single query search
+  const float sqr_radius = radius > 0 ? static_cast<float> (radius * radius) : -1.0f;
+  tiledBatchSearch (cloud, indices, 0, sqr_radius, max_nn, results, nr_threads);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -54,13 +341,25 @@ template <typename PointT> int
 pcl::search::BruteForce<PointT>::nearestKSearch (
     const PointT& point, int k, std::vector<int>& k_indices, std::vector<float>& k_distances) const
 {
-  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+  assert (Coordinates::isValid (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
   
   k_indices.clear ();
   k_distances.clear ();
   if (k < 1)
     return 0;
 
+  if (tiled_)
+  {
+    std::vector<float> query (static_cast<int> (Coordinates::dimension));
+    std::vector<char> done (1, !packPoint (point, &query[0]));
+    std::vector<int> rows;
+    searchBlock (&query[0], 1, k, 0.0f, 0, done, &rows, &k_distances);
+    k_indices.resize (rows.size ());
+    for (size_t i = 0; i < rows.size (); ++i)
+      k_indices[i] = data_indices_[rows[i]];
+    return (static_cast<int> (k_indices.size ()));
+  }
+
   if (input_->is_dense)
     return denseKSearch (point, k, k_indices, k_distances);
   else
@@ -150,7 +449,7 @@ pcl::search::BruteForce<PointT>::sparseKSearch (
     std::vector<int>::const_iterator iIt =indices_->begin ();
     for (; iIt != indices_->end () && result.size () < static_cast<unsigned> (k); ++iIt)
     {
-      if (pcl_isfinite (input_->points[*iIt].x))
+      if (Coordinates::isValid (input_->points[*iIt]))
         result.push_back (Entry (*iIt, getDistSqr (input_->points[*iIt], point)));
     }
     
@@ -161,7 +460,7 @@ pcl::search::BruteForce<PointT>::sparseKSearch (
     Entry entry;
     for (; iIt != indices_->end (); ++iIt)
     {
-      if (!pcl_isfinite (input_->points[*iIt].x))
+      if (!Coordinates::isValid (input_->points[*iIt]))
         continue;
 
       entry.distance = getDistSqr (input_->points[*iIt], point);
@@ -178,7 +477,7 @@ pcl::search::BruteForce<PointT>::sparseKSearch (
     Entry entry;
     for (entry.index = 0; entry.index < input_->size () && result.size () < static_cast<unsigned> (k); ++entry.index)
     {
-      if (pcl_isfinite (input_->points[entry.index].x))
+      if (Coordinates::isValid (input_->points[entry.index]))
       {
         entry.distance = getDistSqr (input_->points[entry.index], point);
         result.push_back (entry);
@@ -189,7 +488,7 @@ pcl::search::BruteForce<PointT>::sparseKSearch (
     // add the rest
     for (; entry.index < input_->size (); ++entry.index)
     {
-      if (!pcl_isfinite (input_->points[entry.index].x))
+      if (!Coordinates::isValid (input_->points[entry.index]))
         continue;
 
       entry.distance = getDistSqr (input_->points[entry.index], point);
@@ -294,7 +593,7 @@ pcl::search::BruteForce<PointT>::sparseRadiusSearch (
   {
     for (std::vector<int>::const_iterator iIt =indices_->begin (); iIt != indices_->end (); ++iIt)
     {
-      if (!pcl_isfinite (input_->points[*iIt].x))
+      if (!Coordinates::isValid (input_->points[*iIt]))
         continue;
 
       distance = getDistSqr (input_->points[*iIt], point);
@@ -311,7 +610,7 @@ pcl::search::BruteForce<PointT>::sparseRadiusSearch (
   {
     for (unsigned index = 0; index < input_->size (); ++index)
     {
-      if (!pcl_isfinite (input_->points[index].x))
+      if (!Coordinates::isValid (input_->points[index]))
         continue;
       distance = getDistSqr (input_->points[index], point);
       if (distance <= radius)
@@ -336,13 +635,27 @@ pcl::search::BruteForce<PointT>::radiusSearch (
     const PointT& point, double radius, std::vector<int> &k_indices,
     std::vector<float> &k_sqr_distances, unsigned int max_nn) const
 {
-  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+  assert (Coordinates::isValid (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
   
   k_indices.clear ();
   k_sqr_distances.clear ();
   if (radius <= 0)
     return 0;
 
+  if (tiled_)
+  {
+    std::vector<float> query (static_cast<int> (Coordinates::dimension));
+    std::vector<char> done (1, !packPoint (point, &query[0]));
+    std::vector<int> rows;
+    searchBlock (&query[0], 1, 0, static_cast<float> (radius * radius), max_nn, done, &rows, &k_sqr_distances);
+    k_indices.resize (rows.size ());
+    for (size_t i = 0; i < rows.size (); ++i)
+      k_indices[i] = data_indices_[rows[i]];
+    if (sorted_results_)
+      this->sortResults (k_indices, k_sqr_distances);
+    return (static_cast<int> (k_indices.size ()));
+  }
+
   if (input_->is_dense)
     return denseRadiusSearch (point, radius, k_indices, k_sqr_distances, max_nn);
   else
@@ -41,7 +41,11 @@
 #define PCL_SEARCH_IMPL_FLANN_SEARCH_H_
 
 #include <pcl/search/flann_search.h>
+#include <pcl/search/impl/search.hpp> // for Search::flattenResults
 #include <pcl/kdtree/flann.h>
+#include <pcl/kdtree/flann_index_file.h>
+#include <pcl/common/parallel.h>
+#include <pcl/common/profiler.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename FlannDistance>
@@ -70,7 +74,8 @@ pcl::search::FlannSearch<PointT, FlannDistance>::KdTreeMultiIndexCreator::create
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename FlannDistance>
 pcl::search::FlannSearch<PointT, FlannDistance>::FlannSearch(bool sorted, FlannIndexCreatorPtr creator) : pcl::search::Search<PointT> ("FlannSearch",sorted),
-  index_(), creator_ (creator), input_flann_(), eps_ (0), checks_ (32), input_copied_for_flann_ (false), point_representation_ (new DefaultPointRepresentation<PointT>),
+  index_(), creator_ (creator), input_flann_(), eps_ (0), checks_ (32), input_copied_for_flann_ (false), index_file_ (),
+  point_representation_ (new DefaultPointRepresentation<PointT>),
   dim_ (0), index_mapping_(), identity_mapping_()
 {
   dim_ = point_representation_->getNumberOfDimensions ();
@@ -93,6 +98,68 @@ pcl::search::FlannSearch<PointT, FlannDistance>::setInputCloud (const PointCloud
   convertInputToFlannMatrix ();
   index_ = creator_->createIndex (input_flann_);
   index_->buildIndex ();
+  index_file_.reset ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename FlannDistance> bool
+pcl::search::FlannSearch<PointT, FlannDistance>::saveIndex (const std::string &file_name) const
+{
+  if (!index_ || !input_)
+  {
+    PCL_ERROR ("[pcl::search::FlannSearch::saveIndex] No index to save, call setInputCloud first!\n");
+    return (false);
+  }
+  const uint32_t checksum = FlannIndexFile::computeChecksum (*input_, indices_.get (), *point_representation_);
+  const std::vector<int> index_mapping = identity_mapping_ ? std::vector<int> () : index_mapping_;
+
+  // A reordering kd-tree searches FLANN's own copy of the points, which FLANN would also serialize. It is rebuilt
+  // without reordering on the points written to the file instead, so that it is searched in place once loaded
+  if (FlannIndexFile::isReordered (*index_))
+  {
+    const int max_leaf_size = flann::get_param<int> (index_->getParameters (), "leaf_max_size", 10);
+    flann::KDTreeSingleIndex<FlannDistance> index (*input_flann_, flann::KDTreeSingleIndexParams (max_leaf_size, false));
+    index.buildIndex ();
+    return (FlannIndexFile::save (file_name, index, *input_flann_, index_mapping, checksum));
+  }
+  return (FlannIndexFile::save (file_name, *index_, *input_flann_, index_mapping, checksum));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename FlannDistance> bool
+pcl::search::FlannSearch<PointT, FlannDistance>::loadIndex (
+    const std::string &file_name, const PointCloudConstPtr& cloud, const IndicesConstPtr& indices)
+{
+  if (!cloud)
+  {
+    PCL_ERROR ("[pcl::search::FlannSearch::loadIndex] Invalid input!\n");
+    return (false);
+  }
+
+  const uint32_t checksum = FlannIndexFile::computeChecksum (*cloud, indices.get (), *point_representation_);
+  boost::shared_ptr<FlannIndexFile> index_file (new FlannIndexFile);
+  if (!index_file->open (file_name, dim_, checksum))
+    return (false);
+
+  MatrixPtr points (new flann::Matrix<float> (index_file->getPoints ()));
+  IndexPtr index = creator_->createIndex (points);
+  if (!index_file->loadIndex (*index))
+    return (false);
+
+  // Only replace the current index once the file is completely loaded, a failure leaves it untouched
+  index_.reset ();
+  if (input_copied_for_flann_)
+    delete [] input_flann_->ptr ();
+  input_copied_for_flann_ = false;
+
+  input_ = cloud;
+  indices_ = indices;
+  index_file_ = index_file;
+  input_flann_ = points;
+  index_ = index;
+  index_file_->getIndexMapping (index_mapping_);
+  identity_mapping_ = index_mapping_.empty ();
+  return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -357,6 +424,106 @@ pcl::search::FlannSearch<PointT, FlannDistance>::radiusSearch (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename FlannDistance> void
+pcl::search::FlannSearch<PointT, FlannDistance>::nearestKSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, int k,
+    BatchSearchResults &results, unsigned int nr_threads) const
+{
+  PCL_PROFILE_SCOPE ("FlannSearch::nearestKSearch");
+
+  const size_t nr_queries = indices.empty () ? cloud.size () : indices.size ();
+  k = std::max (0, std::min (k, static_cast<int> (index_->size ())));
+  results.offsets.resize (nr_queries + 1);
+  for (size_t query = 0; query <= nr_queries; ++query)
+    results.offsets[query] = static_cast<int> (query) * k;
+  results.indices.resize (nr_queries * k);
+  results.sqr_distances.resize (nr_queries * k);
+  if (results.indices.empty ())
+    return;
+
+  std::vector<float> queries;
+  const flann::Matrix<float> m = vectorizeQueries (cloud, indices, queries);
+
+  // every query gets k neighbors, FLANN writes them directly into the flat buffers of the results
+  flann::Matrix<int> i (&results.indices[0], nr_queries, k);
+  flann::Matrix<float> d (&results.sqr_distances[0], nr_queries, k);
+  const pcl::parallel::ThreadReservation reservation (nr_threads);
+  flann::SearchParams p;
+  p.sorted = sorted_results_;
+  p.eps = eps_;
+  p.checks = checks_;
+  p.cores = static_cast<int> (reservation.getNumberOfThreads ());
+  index_->knnSearch (m, i, d, k, p);
+
+  if (!identity_mapping_)
+  {
+    for (size_t j = 0; j < results.indices.size (); ++j)
+    {
+      int& neighbor_index = results.indices[j];
+      neighbor_index = index_mapping_[neighbor_index];
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename FlannDistance> void
+pcl::search::FlannSearch<PointT, FlannDistance>::radiusSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, double radius,
+    BatchSearchResults &results, unsigned int max_nn, unsigned int nr_threads) const
+{
+  PCL_PROFILE_SCOPE ("FlannSearch::radiusSearch");
+
+  std::vector<std::vector<int> > k_indices;
+  std::vector<std::vector<float> > k_sqr_distances;
+  const size_t nr_queries = indices.empty () ? cloud.size () : indices.size ();
+  if (nr_queries > 0)
+  {
+    std::vector<float> queries;
+    const flann::Matrix<float> m = vectorizeQueries (cloud, indices, queries);
+
+    const pcl::parallel::ThreadReservation reservation (nr_threads);
+    flann::SearchParams p;
+    p.sorted = sorted_results_;
+    p.eps = eps_;
+    p.checks = checks_;
+    p.cores = static_cast<int> (reservation.getNumberOfThreads ());
+    // here: max_nn==0: take all neighbors. flann: max_nn==0: return no neighbors, only count them. max_nn==-1: return all neighbors
+    p.max_neighbors = max_nn != 0 ? max_nn : -1;
+    index_->radiusSearch (m, k_indices, k_sqr_distances, static_cast<float> (radius * radius), p);
+
+    if (!identity_mapping_)
+    {
+      for (size_t j = 0; j < k_indices.size (); ++j)
+      {
+        for (size_t i = 0; i < k_indices[j].size (); ++i)
+        {
+          int& neighbor_index = k_indices[j][i];
+          neighbor_index = index_mapping_[neighbor_index];
+        }
+      }
+    }
+  }
+  this->flattenResults (k_indices, k_sqr_distances, results);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename FlannDistance> flann::Matrix<float>
+pcl::search::FlannSearch<PointT, FlannDistance>::vectorizeQueries (
+    const PointCloud &cloud, const std::vector<int> &indices, std::vector<float> &queries) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.size () : indices.size ();
+  queries.resize (nr_queries * dim_);
+  for (size_t i = 0; i < nr_queries; ++i)
+  {
+    const PointT &point = cloud[indices.empty () ? i : indices[i]];
+    assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to a batch search!"); // remove this check as soon as FLANN does NaN checks internally
+    float* out = &queries[i * dim_];
+    point_representation_->vectorize (point, out);
+  }
+  return (flann::Matrix<float> (&queries[0], nr_queries, dim_));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename FlannDistance> void
 pcl::search::FlannSearch<PointT, FlannDistance>::convertInputToFlannMatrix ()
@@ -0,0 +1,347 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_IMPL_HASH_GRID_HPP_
+#define PCL_SEARCH_IMPL_HASH_GRID_HPP_
+
+#include <pcl/search/hash_grid.h>
+#include <pcl/search/impl/search.hpp>
+#include <pcl/common/point_tests.h>
+#include <pcl/console/print.h>
+#include <algorithm>
+#include <cmath>
+
+namespace pcl
+{
+  namespace search
+  {
+    namespace detail
+    {
+      /** \brief A point of search::HashGrid with the coordinates of its cell. */
+      struct HashGridEntry
+      {
+        int x, y, z;
+        int index;
+
+        /** \brief Order by z, y then x, which makes the cells of a row of the grid consecutive. */
+        inline bool
+        operator< (const HashGridEntry &other) const
+        {
+          if (z != other.z)
+            return (z < other.z);
+          if (y != other.y)
+            return (y < other.y);
+          if (x != other.x)
+            return (x < other.x);
+          return (index < other.index);
+        }
+      };
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::search::HashGrid<PointT>::HashGrid (double resolution, bool sorted)
+  : pcl::search::Search<PointT> ("HashGrid", sorted)
+  , resolution_ (resolution)
+  , inverse_resolution_ (0.0f)
+  , points_ ()
+  , point_indices_ ()
+  , cells_ ()
+  , table_ ()
+  , table_mask_ (0)
+  , min_key_ (Eigen::Vector3i::Zero ())
+  , max_key_ (Eigen::Vector3i::Zero ())
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HashGrid<PointT>::setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr& indices)
+{
+  input_ = cloud;
+  indices_ = indices;
+  points_.clear ();
+  point_indices_.clear ();
+  cells_.clear ();
+  table_.clear ();
+  table_mask_ = 0;
+
+  if (resolution_ <= 0.0)
+  {
+    PCL_ERROR ("[pcl::search::HashGrid::setInputCloud] Invalid resolution %f, set it before the input cloud!\n",
+               resolution_);
+    return;
+  }
+  inverse_resolution_ = static_cast<float> (1.0 / resolution_);
+
+  std::vector<detail::HashGridEntry> entries;
+  const size_t nr_points = indices ? indices->size () : cloud->points.size ();
+  entries.reserve (nr_points);
+  for (size_t i = 0; i < nr_points; ++i)
+  {
+    const int index = indices ? (*indices)[i] : static_cast<int> (i);
+    const PointT &point = cloud->points[index];
+    if (!pcl::isFinite (point))
+      continue;
+    const Eigen::Vector3i key = getCellKey (point.data);
+    const detail::HashGridEntry entry = { key[0], key[1], key[2], index };
+    entries.push_back (entry);
+  }
+  if (entries.empty ())
+    return;
+  std::sort (entries.begin (), entries.end ());
+
+  // Store the points by cell
+  points_.resize (entries.size ());
+  point_indices_.resize (entries.size ());
+  min_key_ = max_key_ = Eigen::Vector3i (entries[0].x, entries[0].y, entries[0].z);
+  for (size_t i = 0; i < entries.size (); ++i)
+  {
+    const PointT &point = cloud->points[entries[i].index];
+    points_[i] = Eigen::Vector4f (point.x, point.y, point.z, 0.0f);
+    point_indices_[i] = entries[i].index;
+
+    const Eigen::Vector3i key (entries[i].x, entries[i].y, entries[i].z);
+    if (cells_.empty () || cells_.back ().key != key)
+    {
+      if (!cells_.empty ())
+        cells_.back ().end = static_cast<int> (i);
+      const Cell cell = { key, static_cast<int> (i), static_cast<int> (i) };
+      cells_.push_back (cell);
+      min_key_ = min_key_.cwiseMin (key);
+      max_key_ = max_key_.cwiseMax (key);
+    }
+  }
+  cells_.back ().end = static_cast<int> (entries.size ());
+
+  // Hash the cells, keeping the load factor of the table under one half
+  size_t table_size = 16;
+  while (table_size < 2 * cells_.size ())
+    table_size *= 2;
+  table_.assign (table_size, -1);
+  table_mask_ = table_size - 1;
+  for (size_t i = 0; i < cells_.size (); ++i)
+  {
+    size_t slot = hash (cells_[i].key);
+    while (table_[slot] != -1)
+      slot = (slot + 1) & table_mask_;
+    table_[slot] = static_cast<int> (i);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> const typename pcl::search::HashGrid<PointT>::Cell*
+pcl::search::HashGrid<PointT>::findCell (const Eigen::Vector3i &key) const
+{
+  for (size_t slot = hash (key); table_[slot] != -1; slot = (slot + 1) & table_mask_)
+    if (cells_[table_[slot]].key == key)
+      return (&cells_[table_[slot]]);
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::search::HashGrid<PointT>::getRowRange (int x_min, int x_max, int y, int z, int &begin, int &end) const
+{
+  begin = -1;
+  for (int x = x_min; x <= x_max; ++x)
+  {
+    const Cell *cell = findCell (Eigen::Vector3i (x, y, z));
+    if (!cell)
+      continue;
+    if (begin < 0)
+      begin = cell->begin;
+    end = cell->end;
+  }
+  return (begin >= 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HashGrid<PointT>::filterRange (const Eigen::Array4f &query, int begin, int end, float sqr_radius,
+                                            std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  for (int i = begin; i < end; ++i)
+  {
+    const float sqr_distance = (points_[i].array () - query).square ().sum ();
+    if (sqr_distance <= sqr_radius)
+    {
+      k_indices.push_back (point_indices_[i]);
+      k_sqr_distances.push_back (sqr_distance);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::HashGrid<PointT>::radiusSearch (const PointT& point, double radius,
+                                             std::vector<int> &k_indices,
+                                             std::vector<float> &k_sqr_distances,
+                                             unsigned int max_nn) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (cells_.empty ())
+    return (0);
+
+  const float r = static_cast<float> (radius);
+  const float lower[3] = { point.x - r, point.y - r, point.z - r };
+  const float upper[3] = { point.x + r, point.y + r, point.z + r };
+  const Eigen::Vector3i min_key = getCellKey (lower).cwiseMax (min_key_);
+  const Eigen::Vector3i max_key = getCellKey (upper).cwiseMin (max_key_);
+
+  const Eigen::Array4f query (point.x, point.y, point.z, 0.0f);
+  const float sqr_radius = r * r;
+  if ((max_key - min_key).minCoeff () < 0)
+    return (0);
+  if (countCells (min_key, max_key) > cells_.size ())
+  {
+    // The query box covers more cells than the grid holds, go through the non empty cells instead
+    for (size_t i = 0; i < cells_.size (); ++i)
+      if ((cells_[i].key.array () >= min_key.array ()).all () && (cells_[i].key.array () <= max_key.array ()).all ())
+        filterRange (query, cells_[i].begin, cells_[i].end, sqr_radius, k_indices, k_sqr_distances);
+  }
+  else
+  {
+    int begin, end;
+    for (int z = min_key[2]; z <= max_key[2]; ++z)
+      for (int y = min_key[1]; y <= max_key[1]; ++y)
+        if (getRowRange (min_key[0], max_key[0], y, z, begin, end))
+          filterRange (query, begin, end, sqr_radius, k_indices, k_sqr_distances);
+  }
+
+  // Sort the results if requested, or to keep the max_nn closest ones
+  const bool truncate = max_nn > 0 && k_indices.size () > max_nn;
+  if (sorted_results_ || truncate)
+    this->sortResults (k_indices, k_sqr_distances);
+  if (truncate)
+  {
+    k_indices.resize (max_nn);
+    k_sqr_distances.resize (max_nn);
+  }
+  return (static_cast<int> (k_indices.size ()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::HashGrid<PointT>::nearestKSearch (const PointT &point, int k,
+                                               std::vector<int> &k_indices,
+                                               std::vector<float> &k_sqr_distances) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (cells_.empty () || k <= 0)
+    return (0);
+
+  const Eigen::Vector3i center = getCellKey (point.data);
+  const Eigen::Array4f query (point.x, point.y, point.z, 0.0f);
+
+  // Visit the shells of cells around the query, from the first one reaching the grid to the last one
+  const int first_ring = std::max ((min_key_ - center).maxCoeff (), (center - max_key_).maxCoeff ());
+  const int last_ring = std::max ((center - min_key_).maxCoeff (), (max_key_ - center).maxCoeff ());
+
+  std::vector<Neighbor> neighbors;
+  neighbors.reserve (k);
+  int ranges[2][2];
+  for (int ring = std::max (first_ring, 0); ring <= last_ring; ++ring)
+  {
+    const int z_min = std::max (center[2] - ring, min_key_[2]), z_max = std::min (center[2] + ring, max_key_[2]);
+    const int y_min = std::max (center[1] - ring, min_key_[1]), y_max = std::min (center[1] + ring, max_key_[1]);
+    const int x_min = std::max (center[0] - ring, min_key_[0]), x_max = std::min (center[0] + ring, max_key_[0]);
+
+    // With cells much smaller than the spacing of the points, the shells hold more cells than the grid: finish
+    // with a scan of all the points, which costs at most as much as the shells visited so far
+    if (countCells (Eigen::Vector3i (x_min, y_min, z_min), Eigen::Vector3i (x_max, y_max, z_max)) >
+        4 * cells_.size ())
+    {
+      neighbors.clear ();
+      for (size_t i = 0; i < points_.size (); ++i)
+        pushNeighbor ((points_[i].array () - query).square ().sum (), point_indices_[i], k, neighbors);
+      break;
+    }
+
+    for (int z = z_min; z <= z_max; ++z)
+    {
+      for (int y = y_min; y <= y_max; ++y)
+      {
+        // The rows on the faces of the shell are entirely in it, the other rows only by their end cells
+        int nr_ranges = 0;
+        if (std::abs (z - center[2]) == ring || std::abs (y - center[1]) == ring)
+        {
+          if (getRowRange (x_min, x_max, y, z, ranges[0][0], ranges[0][1]))
+            ++nr_ranges;
+        }
+        else
+        {
+          if (center[0] - ring == x_min &&
+              getRowRange (x_min, x_min, y, z, ranges[nr_ranges][0], ranges[nr_ranges][1]))
+            ++nr_ranges;
+          if (center[0] + ring == x_max &&
+              getRowRange (x_max, x_max, y, z, ranges[nr_ranges][0], ranges[nr_ranges][1]))
+            ++nr_ranges;
+        }
+
+        for (int r = 0; r < nr_ranges; ++r)
+        {
+          for (int i = ranges[r][0]; i < ranges[r][1]; ++i)
+            pushNeighbor ((points_[i].array () - query).square ().sum (), point_indices_[i], k, neighbors);
+        }
+      }
+    }
+
+    // The points of the next shells are at least ring cells away from the query
+    const float bound = static_cast<float> (ring) / inverse_resolution_;
+    if (static_cast<int> (neighbors.size ()) == k && neighbors.front ().first <= bound * bound)
+      break;
+  }
+
+  std::sort_heap (neighbors.begin (), neighbors.end ());
+  k_indices.resize (neighbors.size ());
+  k_sqr_distances.resize (neighbors.size ());
+  for (size_t i = 0; i < neighbors.size (); ++i)
+  {
+    k_sqr_distances[i] = neighbors[i].first;
+    k_indices[i] = neighbors[i].second;
+  }
+  return (static_cast<int> (neighbors.size ()));
+}
+
+#define PCL_INSTANTIATE_HashGrid(T) template class PCL_EXPORTS pcl::search::HashGrid<T>;
+
+#endif    // PCL_SEARCH_IMPL_HASH_GRID_HPP_
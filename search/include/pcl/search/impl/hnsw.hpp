@@ -0,0 +1,692 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_IMPL_HNSW_HPP_
+#define PCL_SEARCH_IMPL_HNSW_HPP_
+
+#include <pcl/search/hnsw.h>
+#include <pcl/search/impl/search.hpp>
+#include <pcl/common/parallel.h>
+#include <pcl/console/print.h>
+#include <boost/thread/locks.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+
+namespace pcl
+{
+  namespace search
+  {
+    namespace detail
+    {
+      /** \brief The header of the files written by search::HNSW::saveIndex. */
+      struct HNSWFileHeader
+      {
+        char magic[8];
+        uint32_t version;
+        int32_t dim;
+        int32_t stride;
+        int32_t max_connections;
+        int32_t construction_search_size;
+        int32_t nr_nodes;
+        int32_t entry_point;
+        int32_t max_layer;
+      };
+
+      static const char hnsw_file_magic[8] = { 'P', 'C', 'L', 'H', 'N', 'S', 'W', '\0' };
+      static const uint32_t hnsw_file_version = 1;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::search::HNSW<PointT>::HNSW (int max_connections, int construction_search_size)
+  : pcl::search::Search<PointT> ("HNSW", true)
+  , point_representation_ (new DefaultPointRepresentation<PointT>)
+  , data_ ()
+  , dim_ (0)
+  , stride_ (0)
+  , index_mapping_ ()
+  , layers_ ()
+  , links0_ ()
+  , upper_links_ ()
+  , entry_point_ (-1)
+  , max_layer_ (-1)
+  , max_connections_ (max_connections)
+  , construction_search_size_ (construction_search_size)
+  , search_size_ (32)
+  , seed_ (12345)
+  , threads_ (0)
+  , rng_ ()
+  , locks_ (new Locks)
+  , visited_pool_ (new detail::HNSWVisitedPool)
+  , owned_cloud_ ()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr& indices)
+{
+  input_ = cloud;
+  indices_ = indices;
+  owned_cloud_.reset ();
+
+  dim_ = point_representation_->getNumberOfDimensions ();
+  stride_ = (dim_ + 3) / 4 * 4;
+  data_.clear ();
+  index_mapping_.clear ();
+  layers_.clear ();
+  links0_.clear ();
+  upper_links_.clear ();
+  entry_point_ = -1;
+  max_layer_ = -1;
+  rng_.seed (seed_);
+
+  std::vector<int> points;
+  if (indices)
+    points = *indices;
+  else
+  {
+    points.resize (cloud->points.size ());
+    for (size_t i = 0; i < points.size (); ++i)
+      points[i] = static_cast<int> (i);
+  }
+  insertPoints (*cloud, points, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::addPoints (const PointCloud &cloud)
+{
+  if (!input_)
+  {
+    setInputCloud (PointCloudConstPtr (new PointCloud (cloud)));
+    return;
+  }
+
+  // The new points are appended to a cloud of our own, so that the results keep indexing the input cloud
+  if (owned_cloud_ != input_)
+    owned_cloud_.reset (new PointCloud (*input_));
+  const int offset = static_cast<int> (owned_cloud_->points.size ());
+  owned_cloud_->points.insert (owned_cloud_->points.end (), cloud.points.begin (), cloud.points.end ());
+  owned_cloud_->width = static_cast<uint32_t> (owned_cloud_->points.size ());
+  owned_cloud_->height = 1;
+  owned_cloud_->is_dense = owned_cloud_->is_dense && cloud.is_dense;
+  input_ = owned_cloud_;
+
+  std::vector<int> points (cloud.points.size ());
+  for (size_t i = 0; i < points.size (); ++i)
+    points[i] = static_cast<int> (i);
+  if (indices_)
+  {
+    IndicesPtr indices (new std::vector<int> (*indices_));
+    for (size_t i = 0; i < points.size (); ++i)
+      indices->push_back (offset + points[i]);
+    indices_ = indices;
+  }
+  insertPoints (cloud, points, offset);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::insertPoints (const PointCloud &cloud, const std::vector<int> &indices, int label_offset)
+{
+  std::vector<int> points;
+  points.reserve (indices.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+    if (point_representation_->isValid (cloud.points[indices[i]]))
+      points.push_back (indices[i]);
+  if (points.empty ())
+    return;
+
+  // Allocate the new nodes up front, the parallel insertion only writes into them
+  const int first = size ();
+  const int nr_nodes = first + static_cast<int> (points.size ());
+  data_.resize (static_cast<size_t> (nr_nodes) * stride_, 0.0f);
+  index_mapping_.resize (nr_nodes);
+  layers_.resize (nr_nodes);
+  links0_.resize (static_cast<size_t> (nr_nodes) * (2 * max_connections_ + 1), 0);
+  upper_links_.resize (nr_nodes);
+
+  const double layer_factor = 1.0 / std::log (static_cast<double> (std::max (max_connections_, 2)));
+  for (int node = first; node < nr_nodes; ++node)
+  {
+    const int point = points[node - first];
+    float *out = &data_[static_cast<size_t> (node) * stride_];
+    point_representation_->vectorize (cloud.points[point], out);
+    index_mapping_[node] = label_offset + point;
+
+    const double u = (static_cast<double> (rng_ ()) + 0.5) / 4294967296.0;
+    layers_[node] = std::min (static_cast<int> (-std::log (u) * layer_factor), 31);
+    upper_links_[node].assign (layers_[node] * (max_connections_ + 1), 0);
+  }
+
+  int begin = first;
+  if (entry_point_ < 0)
+    insertNode (begin++, false);
+
+  const unsigned int nr_threads = pcl::parallel::getNumberOfThreads (threads_);
+  if (nr_threads > 1)
+  {
+    pcl::parallel::parallel_for (begin, nr_nodes, [this] (int chunk_begin, int chunk_end)
+    {
+      for (int node = chunk_begin; node < chunk_end; ++node)
+        insertNode (node, true);
+    }, 16, nr_threads);
+  }
+  else
+  {
+    for (int node = begin; node < nr_nodes; ++node)
+      insertNode (node, false);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::insertNode (int node, bool parallel)
+{
+  const float *query = nodeVector (node);
+  const int layer = layers_[node];
+
+  // A node raising the top layer keeps the entry lock until it has become the entry point
+  boost::unique_lock<boost::mutex> entry_lock;
+  if (parallel)
+    entry_lock = boost::unique_lock<boost::mutex> (locks_->entry);
+  const int entry_point = entry_point_;
+  const int max_layer = max_layer_;
+  if (entry_point < 0)
+  {
+    entry_point_ = node;
+    max_layer_ = layer;
+    return;
+  }
+  if (parallel && layer <= max_layer)
+    entry_lock.unlock ();
+
+  Candidate closest (distance (query, nodeVector (entry_point)), entry_point);
+  for (int l = max_layer; l > layer; --l)
+    searchClosest (query, l, parallel, closest);
+
+  std::vector<Candidate> entry_points (1, closest), candidates, neighbors, shrunk;
+  std::vector<int> links;
+  for (int l = std::min (layer, max_layer); l >= 0; --l)
+  {
+    searchLayer (query, entry_points, construction_search_size_, l, parallel, candidates);
+    std::sort_heap (candidates.begin (), candidates.end ());
+    selectNeighbors (candidates, max_connections_, neighbors);
+    const int max_links = l == 0 ? 2 * max_connections_ : max_connections_;
+    {
+      boost::unique_lock<boost::mutex> lock;
+      if (parallel)
+        lock = boost::unique_lock<boost::mutex> (locks_->links[node % Locks::NR_LOCKS]);
+      // Nodes inserted concurrently can reach this one through its upper layers and link back to it before it is
+      // linked on this layer: their links are merged with the new neighbors instead of being overwritten
+      const int *list = linkList (node, l);
+      if (list[0] == 0)
+        setLinks (node, l, neighbors);
+      else
+      {
+        std::vector<Candidate> merged (neighbors);
+        for (int j = 1; j <= list[0]; ++j)
+        {
+          bool found = false;
+          for (size_t i = 0; i < neighbors.size () && !found; ++i)
+            found = neighbors[i].second == list[j];
+          if (!found)
+            merged.push_back (Candidate (distance (query, nodeVector (list[j])), list[j]));
+        }
+        std::sort (merged.begin (), merged.end ());
+        if (static_cast<int> (merged.size ()) > max_links)
+        {
+          selectNeighbors (merged, max_links, shrunk);
+          merged.swap (shrunk);
+        }
+        setLinks (node, l, merged);
+      }
+    }
+
+    // Link the neighbors back, shrinking their full link lists with the same heuristic
+    for (size_t i = 0; i < neighbors.size (); ++i)
+    {
+      const int neighbor = neighbors[i].second;
+      boost::unique_lock<boost::mutex> lock;
+      if (parallel)
+        lock = boost::unique_lock<boost::mutex> (locks_->links[neighbor % Locks::NR_LOCKS]);
+      int *list = linkList (neighbor, l);
+      if (list[0] < max_links)
+      {
+        list[++list[0]] = node;
+        continue;
+      }
+      const float *neighbor_vector = nodeVector (neighbor);
+      std::vector<Candidate> neighbor_candidates (1, Candidate (neighbors[i].first, node));
+      for (int j = 1; j <= list[0]; ++j)
+        neighbor_candidates.push_back (Candidate (distance (neighbor_vector, nodeVector (list[j])), list[j]));
+      std::sort (neighbor_candidates.begin (), neighbor_candidates.end ());
+      selectNeighbors (neighbor_candidates, max_links, shrunk);
+      setLinks (neighbor, l, shrunk);
+    }
+    entry_points.swap (candidates);
+  }
+
+  if (layer > max_layer)
+  {
+    entry_point_ = node;
+    max_layer_ = layer;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::searchLayer (const float *query, const std::vector<Candidate> &entry_points,
+                                        int ef, int layer, bool parallel, std::vector<Candidate> &results) const
+{
+  typedef std::greater<Candidate> Closer;
+
+  detail::HNSWVisitedPool::TablePtr visited = visited_pool_->acquire (index_mapping_.size ());
+  unsigned int *marks = &visited->marks[0];
+  const unsigned int tag = visited->tag;
+
+  // candidates is a min-heap of the nodes to expand, results a max-heap of the ef closest nodes
+  std::vector<Candidate> candidates;
+  results.clear ();
+  for (size_t i = 0; i < entry_points.size (); ++i)
+  {
+    marks[entry_points[i].second] = tag;
+    candidates.push_back (entry_points[i]);
+    std::push_heap (candidates.begin (), candidates.end (), Closer ());
+    results.push_back (entry_points[i]);
+    std::push_heap (results.begin (), results.end ());
+    if (static_cast<int> (results.size ()) > ef)
+    {
+      std::pop_heap (results.begin (), results.end ());
+      results.pop_back ();
+    }
+  }
+
+  std::vector<int> links;
+  while (!candidates.empty ())
+  {
+    const Candidate current = candidates.front ();
+    if (current.first > results.front ().first && static_cast<int> (results.size ()) >= ef)
+      break;
+    std::pop_heap (candidates.begin (), candidates.end (), Closer ());
+    candidates.pop_back ();
+
+    getLinks (current.second, layer, parallel, links);
+    for (size_t i = 0; i < links.size (); ++i)
+    {
+      const int node = links[i];
+      if (marks[node] == tag)
+        continue;
+      marks[node] = tag;
+
+      const float sqr_distance = distance (query, nodeVector (node));
+      if (static_cast<int> (results.size ()) < ef || sqr_distance < results.front ().first)
+      {
+        candidates.push_back (Candidate (sqr_distance, node));
+        std::push_heap (candidates.begin (), candidates.end (), Closer ());
+        results.push_back (Candidate (sqr_distance, node));
+        std::push_heap (results.begin (), results.end ());
+        if (static_cast<int> (results.size ()) > ef)
+        {
+          std::pop_heap (results.begin (), results.end ());
+          results.pop_back ();
+        }
+      }
+    }
+  }
+  visited_pool_->release (visited);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::searchClosest (const float *query, int layer, bool parallel, Candidate &closest) const
+{
+  std::vector<int> links;
+  bool changed = true;
+  while (changed)
+  {
+    changed = false;
+    getLinks (closest.second, layer, parallel, links);
+    for (size_t i = 0; i < links.size (); ++i)
+    {
+      const float sqr_distance = distance (query, nodeVector (links[i]));
+      if (sqr_distance < closest.first)
+      {
+        closest = Candidate (sqr_distance, links[i]);
+        changed = true;
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::selectNeighbors (const std::vector<Candidate> &candidates, int max_neighbors,
+                                            std::vector<Candidate> &neighbors) const
+{
+  neighbors.clear ();
+  for (size_t i = 0; i < candidates.size () && static_cast<int> (neighbors.size ()) < max_neighbors; ++i)
+  {
+    const float *candidate = nodeVector (candidates[i].second);
+    bool keep = true;
+    for (size_t j = 0; j < neighbors.size () && keep; ++j)
+      keep = distance (candidate, nodeVector (neighbors[j].second)) >= candidates[i].first;
+    if (keep)
+      neighbors.push_back (candidates[i]);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::getLinks (int node, int layer, bool parallel, std::vector<int> &links) const
+{
+  boost::unique_lock<boost::mutex> lock;
+  if (parallel)
+    lock = boost::unique_lock<boost::mutex> (locks_->links[node % Locks::NR_LOCKS]);
+  const int *list = linkList (node, layer);
+  links.assign (list + 1, list + 1 + list[0]);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::setLinks (int node, int layer, const std::vector<Candidate> &links)
+{
+  int *list = linkList (node, layer);
+  list[0] = static_cast<int> (links.size ());
+  for (size_t i = 0; i < links.size (); ++i)
+    list[i + 1] = links[i].second;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::HNSW<PointT>::vectorizeQuery (const PointT &point,
+                                           std::vector<float, Eigen::aligned_allocator<float> > &query) const
+{
+  query.assign (stride_, 0.0f);
+  float *out = &query[0];
+  point_representation_->vectorize (point, out);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::HNSW<PointT>::nearestKSearch (const PointT &point, int k,
+                                           std::vector<int> &k_indices,
+                                           std::vector<float> &k_sqr_distances) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (entry_point_ < 0 || k <= 0)
+    return (0);
+
+  std::vector<float, Eigen::aligned_allocator<float> > query;
+  vectorizeQuery (point, query);
+
+  Candidate closest (distance (&query[0], nodeVector (entry_point_)), entry_point_);
+  for (int l = max_layer_; l > 0; --l)
+    searchClosest (&query[0], l, false, closest);
+
+  std::vector<Candidate> results;
+  searchLayer (&query[0], std::vector<Candidate> (1, closest), std::max (search_size_, k), 0, false, results);
+  std::sort_heap (results.begin (), results.end ());
+
+  const size_t nr_results = std::min (results.size (), static_cast<size_t> (k));
+  k_indices.resize (nr_results);
+  k_sqr_distances.resize (nr_results);
+  for (size_t i = 0; i < nr_results; ++i)
+  {
+    k_indices[i] = index_mapping_[results[i].second];
+    k_sqr_distances[i] = results[i].first;
+  }
+  return (static_cast<int> (nr_results));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::HNSW<PointT>::radiusSearch (const PointT& point, double radius,
+                                         std::vector<int> &k_indices,
+                                         std::vector<float> &k_sqr_distances,
+                                         unsigned int max_nn) const
+{
+  const float sqr_radius = static_cast<float> (radius * radius);
+  const int nr_nodes = size ();
+  int k = std::min (max_nn > 0 ? static_cast<int> (max_nn) : std::max (search_size_, 1), nr_nodes);
+
+  // Grow the number of neighbors until one of them is out of the radius
+  int nr_found = 0;
+  while (true)
+  {
+    const int nr_results = nearestKSearch (point, k, k_indices, k_sqr_distances);
+    nr_found = static_cast<int> (std::upper_bound (k_sqr_distances.begin (), k_sqr_distances.end (), sqr_radius) -
+                                 k_sqr_distances.begin ());
+    if (nr_found < nr_results || k >= nr_nodes || (max_nn > 0 && nr_found >= static_cast<int> (max_nn)))
+      break;
+    k = std::min (2 * k, nr_nodes);
+  }
+  if (max_nn > 0)
+    nr_found = std::min (nr_found, static_cast<int> (max_nn));
+  k_indices.resize (nr_found);
+  k_sqr_distances.resize (nr_found);
+  return (nr_found);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::search::HNSW<PointT>::saveIndex (const std::string &file_name) const
+{
+  std::ofstream file (file_name.c_str (), std::ios::binary);
+  if (!file)
+  {
+    PCL_ERROR ("[pcl::search::HNSW::saveIndex] Could not open %s for writing!\n", file_name.c_str ());
+    return (false);
+  }
+
+  detail::HNSWFileHeader header;
+  std::memcpy (header.magic, detail::hnsw_file_magic, sizeof (header.magic));
+  header.version = detail::hnsw_file_version;
+  header.dim = dim_;
+  header.stride = stride_;
+  header.max_connections = max_connections_;
+  header.construction_search_size = construction_search_size_;
+  header.nr_nodes = size ();
+  header.entry_point = entry_point_;
+  header.max_layer = max_layer_;
+  file.write (reinterpret_cast<const char*> (&header), sizeof (header));
+
+  if (header.nr_nodes > 0)
+  {
+    file.write (reinterpret_cast<const char*> (&index_mapping_[0]), index_mapping_.size () * sizeof (int));
+    file.write (reinterpret_cast<const char*> (&layers_[0]), layers_.size () * sizeof (int));
+    file.write (reinterpret_cast<const char*> (&data_[0]), data_.size () * sizeof (float));
+    file.write (reinterpret_cast<const char*> (&links0_[0]), links0_.size () * sizeof (int));
+    for (size_t i = 0; i < upper_links_.size (); ++i)
+      if (!upper_links_[i].empty ())
+        file.write (reinterpret_cast<const char*> (&upper_links_[i][0]), upper_links_[i].size () * sizeof (int));
+  }
+
+  if (!file)
+  {
+    PCL_ERROR ("[pcl::search::HNSW::saveIndex] Error writing %s!\n", file_name.c_str ());
+    return (false);
+  }
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::search::HNSW<PointT>::loadIndex (const std::string &file_name, const PointCloudConstPtr &cloud,
+                                      const IndicesConstPtr &indices)
+{
+  std::ifstream file (file_name.c_str (), std::ios::binary);
+  if (!file)
+  {
+    PCL_ERROR ("[pcl::search::HNSW::loadIndex] Could not open %s for reading!\n", file_name.c_str ());
+    return (false);
+  }
+
+  detail::HNSWFileHeader header;
+  file.read (reinterpret_cast<char*> (&header), sizeof (header));
+  if (!file || std::memcmp (header.magic, detail::hnsw_file_magic, sizeof (header.magic)) != 0)
+  {
+    PCL_ERROR ("[pcl::search::HNSW::loadIndex] %s is not a HNSW index file!\n", file_name.c_str ());
+    return (false);
+  }
+  if (header.version != detail::hnsw_file_version)
+  {
+    PCL_ERROR ("[pcl::search::HNSW::loadIndex] Unsupported version %u of %s!\n", header.version, file_name.c_str ());
+    return (false);
+  }
+  if (header.dim != point_representation_->getNumberOfDimensions () || header.stride != (header.dim + 3) / 4 * 4 ||
+      header.max_connections < 1 || header.nr_nodes < 0 || header.entry_point >= header.nr_nodes ||
+      (header.nr_nodes > 0 && (header.entry_point < 0 || header.max_layer < 0)))
+  {
+    PCL_ERROR ("[pcl::search::HNSW::loadIndex] The index in %s does not match the point representation!\n",
+               file_name.c_str ());
+    return (false);
+  }
+
+  // The sizes below come from the file, so check them against its length before allocating anything:
+  // each node takes its mapping, its layer, its coordinates and its layer 0 links
+  const std::streamoff payload_begin = file.tellg ();
+  file.seekg (0, std::ios::end);
+  const std::streamoff file_end = file.tellg ();
+  file.seekg (payload_begin);
+  const uint64_t max_connections = static_cast<uint64_t> (header.max_connections);
+  const uint64_t node_size = (2 + static_cast<uint64_t> (header.stride) + 2 * max_connections + 1) * sizeof (int);
+  uint64_t remaining = 0;
+  if (payload_begin >= 0 && file_end >= payload_begin)
+    remaining = static_cast<uint64_t> (file_end - payload_begin);
+  if (!file || header.max_connections > (std::numeric_limits<int>::max () - 1) / 2 ||
+      static_cast<uint64_t> (header.nr_nodes) > remaining / node_size)
+  {
+    PCL_ERROR ("[pcl::search::HNSW::loadIndex] Corrupted index file %s!\n", file_name.c_str ());
+    return (false);
+  }
+  remaining -= header.nr_nodes * node_size;
+
+  const size_t nr_nodes = header.nr_nodes;
+  std::vector<int> index_mapping (nr_nodes), layers (nr_nodes);
+  std::vector<float, Eigen::aligned_allocator<float> > data (nr_nodes * header.stride);
+  std::vector<int> links0 (nr_nodes * (2 * header.max_connections + 1));
+  std::vector<std::vector<int> > upper_links (nr_nodes);
+  if (nr_nodes > 0)
+  {
+    file.read (reinterpret_cast<char*> (&index_mapping[0]), nr_nodes * sizeof (int));
+    file.read (reinterpret_cast<char*> (&layers[0]), nr_nodes * sizeof (int));
+    file.read (reinterpret_cast<char*> (&data[0]), data.size () * sizeof (float));
+    file.read (reinterpret_cast<char*> (&links0[0]), links0.size () * sizeof (int));
+    for (size_t i = 0; i < nr_nodes && file; ++i)
+    {
+      // The upper layer links follow the fixed size part and must fit in what is left of the file
+      const uint64_t links_size = static_cast<uint64_t> (std::max (layers[i], 0)) * (max_connections + 1) * sizeof (int);
+      if (layers[i] < 0 || layers[i] > header.max_layer || links_size > remaining)
+      {
+        PCL_ERROR ("[pcl::search::HNSW::loadIndex] Corrupted index file %s!\n", file_name.c_str ());
+        return (false);
+      }
+      remaining -= links_size;
+      upper_links[i].resize (static_cast<size_t> (layers[i]) * (header.max_connections + 1));
+      if (!upper_links[i].empty ())
+        file.read (reinterpret_cast<char*> (&upper_links[i][0]), upper_links[i].size () * sizeof (int));
+    }
+  }
+  if (!file)
+  {
+    PCL_ERROR ("[pcl::search::HNSW::loadIndex] Unexpected end of file %s!\n", file_name.c_str ());
+    return (false);
+  }
+  // The searches start at the top layer of the entry point
+  if (nr_nodes > 0 && layers[header.entry_point] != header.max_layer)
+  {
+    PCL_ERROR ("[pcl::search::HNSW::loadIndex] Corrupted index file %s!\n", file_name.c_str ());
+    return (false);
+  }
+  for (size_t i = 0; i < nr_nodes; ++i)
+  {
+    if (index_mapping[i] < 0 || index_mapping[i] >= static_cast<int> (cloud->points.size ()))
+    {
+      PCL_ERROR ("[pcl::search::HNSW::loadIndex] The index in %s refers to points out of the cloud!\n",
+                 file_name.c_str ());
+      return (false);
+    }
+  }
+
+  // Check the links, so that a corrupted file cannot make the searches read out of the graph
+  for (size_t i = 0; i < nr_nodes; ++i)
+  {
+    for (int l = 0; l <= layers[i]; ++l)
+    {
+      const int max_links = l == 0 ? 2 * header.max_connections : header.max_connections;
+      const int *list = l == 0 ? &links0[i * (max_links + 1)] : &upper_links[i][(l - 1) * (max_links + 1)];
+      bool valid = list[0] >= 0 && list[0] <= max_links;
+      for (int j = 1; j <= list[0] && valid; ++j)
+        valid = list[j] >= 0 && list[j] < header.nr_nodes && layers[list[j]] >= l;
+      if (!valid)
+      {
+        PCL_ERROR ("[pcl::search::HNSW::loadIndex] Corrupted index file %s!\n", file_name.c_str ());
+        return (false);
+      }
+    }
+  }
+
+  input_ = cloud;
+  indices_ = indices;
+  owned_cloud_.reset ();
+  dim_ = header.dim;
+  stride_ = header.stride;
+  max_connections_ = header.max_connections;
+  construction_search_size_ = header.construction_search_size;
+  entry_point_ = header.entry_point;
+  max_layer_ = nr_nodes > 0 ? header.max_layer : -1;
+  index_mapping_.swap (index_mapping);
+  layers_.swap (layers);
+  data_.swap (data);
+  links0_.swap (links0);
+  upper_links_.swap (upper_links);
+  rng_.seed (seed_ + header.nr_nodes);
+  return (true);
+}
+
+#define PCL_INSTANTIATE_HNSW(T) template class PCL_EXPORTS pcl::search::HNSW<T>;
+
+#endif    // PCL_SEARCH_IMPL_HNSW_HPP_
@@ -0,0 +1,617 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_IMPL_INCREMENTAL_KDTREE_HPP_
+#define PCL_SEARCH_IMPL_INCREMENTAL_KDTREE_HPP_
+
+#include <pcl/search/incremental_kdtree.h>
+#include <pcl/search/impl/search.hpp>
+#include <pcl/common/point_tests.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace pcl
+{
+  namespace search
+  {
+    namespace detail
+    {
+      /** \brief Squared distance between two 3D points. */
+      inline float
+      sqrDistance3 (const float *a, const float *b)
+      {
+        const float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+        return (dx * dx + dy * dy + dz * dz);
+      }
+
+      /** \brief Squared distance from a 3D point to an axis aligned box, 0 inside the box. */
+      inline float
+      sqrDistanceToBox (const float *min_pt, const float *max_pt, const float *p)
+      {
+        float sqr_distance = 0.0f;
+        for (int d = 0; d < 3; ++d)
+        {
+          const float delta = std::max (std::max (min_pt[d] - p[d], p[d] - max_pt[d]), 0.0f);
+          sqr_distance += delta * delta;
+        }
+        return (sqr_distance);
+      }
+
+      /** \brief Whether two axis aligned boxes overlap. */
+      inline bool
+      boxesOverlap (const float *min_a, const float *max_a, const float *min_b, const float *max_b)
+      {
+        return (min_a[0] <= max_b[0] && min_b[0] <= max_a[0] &&
+                min_a[1] <= max_b[1] && min_b[1] <= max_a[1] &&
+                min_a[2] <= max_b[2] && min_b[2] <= max_a[2]);
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::search::IncrementalKdTree<PointT>::IncrementalKdTree (bool sorted)
+  : pcl::search::Search<PointT> ("IncrementalKdTree", sorted)
+  , added_points_ ()
+  , input_size_ (0)
+  , nodes_ ()
+  , free_nodes_ ()
+  , point_node_ ()
+  , root_ (-1)
+  , balance_factor_ (0.7f)
+  , delete_factor_ (0.5f)
+  , downsample_resolution_ (0.0f)
+{
+  input_.reset (new PointCloud);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::setInputCloud (
+    const PointCloudConstPtr& cloud,
+    const IndicesConstPtr& indices)
+{
+  if (!cloud)
+  {
+    PCL_ERROR ("[pcl::search::IncrementalKdTree::setInputCloud] Invalid input cloud!\n");
+    return;
+  }
+
+  input_ = cloud;
+  indices_ = indices;
+  input_size_ = static_cast<int> (cloud->points.size ());
+  added_points_.clear ();
+  nodes_.clear ();
+  free_nodes_.clear ();
+  point_node_.assign (cloud->points.size (), -1);
+
+  std::vector<int> points;
+  if (indices)
+  {
+    points.reserve (indices->size ());
+    for (size_t i = 0; i < indices->size (); ++i)
+      if (pcl::isFinite (cloud->points[(*indices)[i]]))
+        points.push_back ((*indices)[i]);
+  }
+  else
+  {
+    points.reserve (cloud->points.size ());
+    for (int i = 0; i < input_size_; ++i)
+      if (pcl::isFinite (cloud->points[i]))
+        points.push_back (i);
+  }
+  root_ = build (points, 0, static_cast<int> (points.size ()), -1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::addPoints (const PointCloud &cloud)
+{
+  const int offset = input_size_ + static_cast<int> (added_points_.points.size ());
+  added_points_.points.insert (added_points_.points.end (), cloud.points.begin (), cloud.points.end ());
+  added_points_.width = static_cast<uint32_t> (added_points_.points.size ());
+  added_points_.height = 1;
+  added_points_.is_dense = added_points_.is_dense && cloud.is_dense;
+  const int end = input_size_ + static_cast<int> (added_points_.points.size ());
+  point_node_.resize (end, -1);
+
+  int nr_inserted = 0;
+  std::vector<int> voxel_nodes;
+  for (int i = offset; i < end; ++i)
+  {
+    if (!pcl::isFinite (getPoint (i)))
+      continue;
+
+    if (downsample_resolution_ > 0.0f)
+    {
+      // Keep the point of the voxel closest to its center
+      const float *p = getPoint (i).data;
+      float voxel_min[3], voxel_max[3], center[3];
+      for (int d = 0; d < 3; ++d)
+      {
+        voxel_min[d] = std::floor (p[d] / downsample_resolution_) * downsample_resolution_;
+        voxel_max[d] = voxel_min[d] + downsample_resolution_;
+        center[d] = voxel_min[d] + 0.5f * downsample_resolution_;
+      }
+      voxel_nodes.clear ();
+      collectInBox (root_, voxel_min, voxel_max, voxel_nodes);
+
+      const float sqr_distance = detail::sqrDistance3 (p, center);
+      bool keep = true;
+      std::vector<int> replaced;
+      for (size_t j = 0; j < voxel_nodes.size () && keep; ++j)
+      {
+        const float *q = nodes_[voxel_nodes[j]].xyz;
+        // The box is closed, leave out the points on the far faces, which belong to the next voxels
+        if (q[0] >= voxel_max[0] || q[1] >= voxel_max[1] || q[2] >= voxel_max[2])
+          continue;
+        if (detail::sqrDistance3 (q, center) <= sqr_distance)
+          keep = false;
+        replaced.push_back (nodes_[voxel_nodes[j]].point);
+      }
+      if (!keep)
+        continue;
+      for (size_t j = 0; j < replaced.size (); ++j)
+        markDeleted (point_node_[replaced[j]]);
+    }
+
+    insert (i);
+    ++nr_inserted;
+  }
+  return (nr_inserted);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::search::IncrementalKdTree<PointT>::removePoint (int index)
+{
+  if (index < 0 || index >= static_cast<int> (point_node_.size ()))
+    return (false);
+  const int node = point_node_[index];
+  if (node < 0 || nodes_[node].is_deleted)
+    return (false);
+
+  markDeleted (node);
+  rebalancePath (node);
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::removePoints (const std::vector<int> &indices)
+{
+  std::vector<int> removed;
+  removed.reserve (indices.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    const int index = indices[i];
+    if (index < 0 || index >= static_cast<int> (point_node_.size ()))
+      continue;
+    const int node = point_node_[index];
+    if (node < 0 || nodes_[node].is_deleted)
+      continue;
+    markDeleted (node);
+    removed.push_back (index);
+  }
+
+  // The points dropped by an earlier rebuild have no node anymore
+  for (size_t i = 0; i < removed.size (); ++i)
+    if (point_node_[removed[i]] >= 0)
+      rebalancePath (point_node_[removed[i]]);
+  return (static_cast<int> (removed.size ()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::removePointsInBox (const Eigen::Vector3f &min_pt,
+                                                           const Eigen::Vector3f &max_pt)
+{
+  std::vector<int> nodes;
+  collectInBox (root_, min_pt.data (), max_pt.data (), nodes);
+  for (size_t i = 0; i < nodes.size (); ++i)
+    markDeleted (nodes[i]);
+  if (!nodes.empty ())
+    rebalanceBox (root_, min_pt.data (), max_pt.data ());
+  return (static_cast<int> (nodes.size ()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::boxSearch (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt,
+                                                   std::vector<int> &k_indices) const
+{
+  std::vector<int> nodes;
+  collectInBox (root_, min_pt.data (), max_pt.data (), nodes);
+  k_indices.resize (nodes.size ());
+  for (size_t i = 0; i < nodes.size (); ++i)
+    k_indices[i] = nodes_[nodes[i]].point;
+  return (static_cast<int> (k_indices.size ()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::nearestKSearch (
+    const PointT &point, int k, std::vector<int> &k_indices,
+    std::vector<float> &k_sqr_distances) const
+{
+  assert (pcl::isFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  std::vector<std::pair<float, int> > heap;
+  if (root_ >= 0 && k > 0)
+  {
+    heap.reserve (k);
+    searchKNN (root_, point.data, k, heap);
+  }
+  std::sort_heap (heap.begin (), heap.end ());
+
+  k_indices.resize (heap.size ());
+  k_sqr_distances.resize (heap.size ());
+  for (size_t i = 0; i < heap.size (); ++i)
+  {
+    k_sqr_distances[i] = heap[i].first;
+    k_indices[i] = heap[i].second;
+  }
+  return (static_cast<int> (heap.size ()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::radiusSearch (
+    const PointT& point, double radius, std::vector<int> &k_indices,
+    std::vector<float> &k_sqr_distances, unsigned int max_nn) const
+{
+  assert (pcl::isFinite (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (root_ >= 0)
+    searchRadius (root_, point.data, static_cast<float> (radius * radius), max_nn, k_indices, k_sqr_distances);
+  if (sorted_results_)
+    this->sortResults (k_indices, k_sqr_distances);
+  return (static_cast<int> (k_indices.size ()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::build (std::vector<int> &points, int begin, int end, int parent)
+{
+  if (begin >= end)
+    return (-1);
+
+  float min_pt[3] = { std::numeric_limits<float>::max (), std::numeric_limits<float>::max (),
+                      std::numeric_limits<float>::max () };
+  float max_pt[3] = { -std::numeric_limits<float>::max (), -std::numeric_limits<float>::max (),
+                      -std::numeric_limits<float>::max () };
+  for (int i = begin; i < end; ++i)
+  {
+    const float *p = getPoint (points[i]).data;
+    for (int d = 0; d < 3; ++d)
+    {
+      min_pt[d] = std::min (min_pt[d], p[d]);
+      max_pt[d] = std::max (max_pt[d], p[d]);
+    }
+  }
+
+  // Split at the median of the axis of largest extent
+  int axis = 0;
+  for (int d = 1; d < 3; ++d)
+    if (max_pt[d] - min_pt[d] > max_pt[axis] - min_pt[axis])
+      axis = d;
+  const int middle = begin + (end - begin) / 2;
+  std::nth_element (points.begin () + begin, points.begin () + middle, points.begin () + end,
+                    [this, axis] (int a, int b) { return (getPoint (a).data[axis] < getPoint (b).data[axis]); });
+
+  const int node = allocateNode ();
+  {
+    Node &n = nodes_[node];
+    n.point = points[middle];
+    std::copy (getPoint (n.point).data, getPoint (n.point).data + 3, n.xyz);
+    n.parent = parent;
+    n.size = end - begin;
+    n.deleted = 0;
+    n.axis = axis;
+    n.is_deleted = false;
+    std::copy (min_pt, min_pt + 3, n.min);
+    std::copy (max_pt, max_pt + 3, n.max);
+  }
+  point_node_[points[middle]] = node;
+
+  // The recursive calls may reallocate nodes_
+  const int left = build (points, begin, middle, node);
+  const int right = build (points, middle + 1, end, node);
+  nodes_[node].left = left;
+  nodes_[node].right = right;
+  return (node);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::insert (int point)
+{
+  const float *p = getPoint (point).data;
+
+  // Walk down to the leaf, accounting for the new point in the subtrees on the way
+  int parent = -1;
+  bool is_left = false;
+  for (int node = root_; node >= 0; )
+  {
+    Node &n = nodes_[node];
+    ++n.size;
+    for (int d = 0; d < 3; ++d)
+    {
+      n.min[d] = std::min (n.min[d], p[d]);
+      n.max[d] = std::max (n.max[d], p[d]);
+    }
+    parent = node;
+    is_left = p[n.axis] < n.xyz[n.axis];
+    node = is_left ? n.left : n.right;
+  }
+
+  const int leaf = allocateNode ();
+  {
+    Node &n = nodes_[leaf];
+    n.point = point;
+    std::copy (p, p + 3, n.xyz);
+    n.left = n.right = -1;
+    n.parent = parent;
+    n.size = 1;
+    n.deleted = 0;
+    n.axis = parent < 0 ? 0 : (nodes_[parent].axis + 1) % 3;
+    n.is_deleted = false;
+    std::copy (p, p + 3, n.min);
+    std::copy (p, p + 3, n.max);
+  }
+  point_node_[point] = leaf;
+
+  if (parent < 0)
+    root_ = leaf;
+  else if (is_left)
+    nodes_[parent].left = leaf;
+  else
+    nodes_[parent].right = leaf;
+
+  rebalancePath (leaf);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::markDeleted (int node)
+{
+  nodes_[node].is_deleted = true;
+  for (int i = node; i >= 0; i = nodes_[i].parent)
+    ++nodes_[i].deleted;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::rebalancePath (int node)
+{
+  std::vector<int> path;
+  for (int i = node; i >= 0; i = nodes_[i].parent)
+    path.push_back (i);
+
+  // Rebuilding the topmost violating subtree also fixes the ones below it
+  for (int i = static_cast<int> (path.size ()) - 1; i >= 0; --i)
+    if (needsRebuild (path[i]))
+    {
+      rebuild (path[i]);
+      return;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::rebalanceBox (int node, const float *min_pt, const float *max_pt)
+{
+  if (node < 0 || !detail::boxesOverlap (nodes_[node].min, nodes_[node].max, min_pt, max_pt))
+    return;
+  if (needsRebuild (node))
+  {
+    rebuild (node);
+    return;
+  }
+  const int left = nodes_[node].left, right = nodes_[node].right;
+  rebalanceBox (left, min_pt, max_pt);
+  rebalanceBox (right, min_pt, max_pt);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::search::IncrementalKdTree<PointT>::needsRebuild (int node) const
+{
+  // Small subtrees are cheap to search even when unbalanced
+  const int min_size = 16;
+
+  const Node &n = nodes_[node];
+  if (n.size < min_size)
+    return (false);
+  if (static_cast<float> (n.deleted) > delete_factor_ * static_cast<float> (n.size))
+    return (true);
+  const int left_size = n.left >= 0 ? nodes_[n.left].size : 0;
+  const int right_size = n.right >= 0 ? nodes_[n.right].size : 0;
+  return (static_cast<float> (std::max (left_size, right_size)) > balance_factor_ * static_cast<float> (n.size));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::rebuild (int node)
+{
+  const int parent = nodes_[node].parent;
+  const int nr_deleted = nodes_[node].deleted;
+  const bool is_left = parent >= 0 && nodes_[parent].left == node;
+
+  // Release the nodes of the subtree, keeping its valid points
+  std::vector<int> points;
+  points.reserve (nodes_[node].size - nr_deleted);
+  std::vector<int> stack (1, node);
+  while (!stack.empty ())
+  {
+    const Node &n = nodes_[stack.back ()];
+    free_nodes_.push_back (stack.back ());
+    stack.pop_back ();
+    if (n.is_deleted)
+      point_node_[n.point] = -1;
+    else
+      points.push_back (n.point);
+    if (n.left >= 0)
+      stack.push_back (n.left);
+    if (n.right >= 0)
+      stack.push_back (n.right);
+  }
+
+  const int subtree = build (points, 0, static_cast<int> (points.size ()), parent);
+  if (parent < 0)
+    root_ = subtree;
+  else if (is_left)
+    nodes_[parent].left = subtree;
+  else
+    nodes_[parent].right = subtree;
+
+  // The deleted points are gone from the subtrees of the ancestors
+  for (int i = parent; i >= 0; i = nodes_[i].parent)
+  {
+    nodes_[i].size -= nr_deleted;
+    nodes_[i].deleted -= nr_deleted;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::collectInBox (int node, const float *min_pt, const float *max_pt,
+                                                      std::vector<int> &nodes) const
+{
+  if (node < 0)
+    return;
+  const Node &n = nodes_[node];
+  if (n.deleted == n.size || !detail::boxesOverlap (n.min, n.max, min_pt, max_pt))
+    return;
+
+  if (!n.is_deleted)
+  {
+    const float *p = n.xyz;
+    if (p[0] >= min_pt[0] && p[0] <= max_pt[0] &&
+        p[1] >= min_pt[1] && p[1] <= max_pt[1] &&
+        p[2] >= min_pt[2] && p[2] <= max_pt[2])
+      nodes.push_back (node);
+  }
+  collectInBox (n.left, min_pt, max_pt, nodes);
+  collectInBox (n.right, min_pt, max_pt, nodes);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::searchKNN (int node, const float *query, int k,
+                                                   std::vector<std::pair<float, int> > &heap) const
+{
+  const Node &n = nodes_[node];
+  if (n.deleted == n.size)
+    return;
+  if (static_cast<int> (heap.size ()) == k && detail::sqrDistanceToBox (n.min, n.max, query) > heap.front ().first)
+    return;
+
+  const float *p = n.xyz;
+  if (!n.is_deleted)
+  {
+    const std::pair<float, int> candidate (detail::sqrDistance3 (p, query), n.point);
+    if (static_cast<int> (heap.size ()) < k)
+    {
+      heap.push_back (candidate);
+      std::push_heap (heap.begin (), heap.end ());
+    }
+    else if (candidate < heap.front ())
+    {
+      std::pop_heap (heap.begin (), heap.end ());
+      heap.back () = candidate;
+      std::push_heap (heap.begin (), heap.end ());
+    }
+  }
+
+  // Visit the side of the query first
+  const bool query_left = query[n.axis] < p[n.axis];
+  const int first = query_left ? n.left : n.right;
+  const int second = query_left ? n.right : n.left;
+  if (first >= 0)
+    searchKNN (first, query, k, heap);
+  if (second >= 0)
+    searchKNN (second, query, k, heap);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::searchRadius (int node, const float *query, float sqr_radius,
+                                                      unsigned int max_nn, std::vector<int> &k_indices,
+                                                      std::vector<float> &k_sqr_distances) const
+{
+  const Node &n = nodes_[node];
+  if (n.deleted == n.size || (max_nn > 0 && k_indices.size () >= max_nn) ||
+      detail::sqrDistanceToBox (n.min, n.max, query) > sqr_radius)
+    return;
+
+  if (!n.is_deleted)
+  {
+    const float sqr_distance = detail::sqrDistance3 (n.xyz, query);
+    if (sqr_distance <= sqr_radius)
+    {
+      k_indices.push_back (n.point);
+      k_sqr_distances.push_back (sqr_distance);
+    }
+  }
+  if (n.left >= 0)
+    searchRadius (n.left, query, sqr_radius, max_nn, k_indices, k_sqr_distances);
+  if (n.right >= 0)
+    searchRadius (n.right, query, sqr_radius, max_nn, k_indices, k_sqr_distances);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::allocateNode ()
+{
+  if (!free_nodes_.empty ())
+  {
+    const int node = free_nodes_.back ();
+    free_nodes_.pop_back ();
+    return (node);
+  }
+  nodes_.push_back (Node ());
+  return (static_cast<int> (nodes_.size ()) - 1);
+}
+
+#define PCL_INSTANTIATE_IncrementalKdTree(T) template class PCL_EXPORTS pcl::search::IncrementalKdTree<T>;
+
+#endif  //#ifndef PCL_SEARCH_IMPL_INCREMENTAL_KDTREE_HPP_
@@ -83,6 +83,23 @@ pcl::search::KdTree<PointT,Tree>::setInputCloud (
   indices_ = indices;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> bool
+pcl::search::KdTree<PointT,Tree>::saveIndex (const std::string &file_name) const
+{
+  return (tree_->saveIndex (file_name));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> bool
+pcl::search::KdTree<PointT,Tree>::loadIndex (
+    const std::string &file_name, const PointCloudConstPtr& cloud, const IndicesConstPtr& indices)
+{
+  input_ = cloud;
+  indices_ = indices;
+  return (tree_->loadIndex (file_name, cloud, indices));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, class Tree> int
 pcl::search::KdTree<PointT,Tree>::nearestKSearch (
@@ -102,6 +119,36 @@ pcl::search::KdTree<PointT,Tree>::radiusSearch (
   return (tree_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> void
+pcl::search::KdTree<PointT,Tree>::nearestKSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, int k,
+    BatchSearchResults &results, unsigned int nr_threads) const
+{
+  PCL_PROFILE_SCOPE ("search::KdTree::nearestKSearch");
+
+  // Every query gets the same number of neighbors, stored contiguously by the tree
+  const int nr_neighbors = tree_->nearestKSearch (cloud, indices, k, results.indices, results.sqr_distances, nr_threads);
+  const int nr_queries = static_cast<int> (indices.empty () ? cloud.size () : indices.size ());
+  results.offsets.resize (nr_queries + 1);
+  for (int query = 0; query <= nr_queries; ++query)
+    results.offsets[query] = query * nr_neighbors;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> void
+pcl::search::KdTree<PointT,Tree>::radiusSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, double radius,
+    BatchSearchResults &results, unsigned int max_nn, unsigned int nr_threads) const
+{
+  PCL_PROFILE_SCOPE ("search::KdTree::radiusSearch");
+
+  std::vector<std::vector<int> > k_indices;
+  std::vector<std::vector<float> > k_sqr_distances;
+  tree_->radiusSearch (cloud, indices, radius, k_indices, k_sqr_distances, max_nn, nr_threads);
+  this->flattenResults (k_indices, k_sqr_distances, results);
+}
+
 #define PCL_INSTANTIATE_KdTree(T) template class PCL_EXPORTS pcl::search::KdTree<T>;
 
 #endif  //#ifndef _PCL_SEARCH_KDTREE_IMPL_HPP_
@@ -40,6 +40,7 @@
 #pragma once
 
 #include <pcl/search/organized.h>
+#include <pcl/search/impl/search.hpp> // for Search::batchSearch
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/common/projection_matrix.h> // for getCameraMatrixFromProjectionMatrix, ...
 #include <pcl/common/time.h>
@@ -58,9 +59,7 @@ pcl::search::OrganizedNeighbor<PointT>::radiusSearch (const               PointT
 
   // search window
   unsigned left, right, top, bottom;
-  //unsigned x, y, idx;
-  float squared_distance;
-  const float squared_radius = radius * radius;
+  const float squared_radius = static_cast<float> (radius * radius);
 
   k_indices.clear ();
   k_sqr_distances.clear ();
@@ -71,30 +70,26 @@ pcl::search::OrganizedNeighbor<PointT>::radiusSearch (const               PointT
   if (max_nn == 0 || max_nn >= static_cast<unsigned int> (input_->size ()))
     max_nn = static_cast<unsigned int> (input_->size ());
 
-  k_indices.reserve (max_nn);
-  k_sqr_distances.reserve (max_nn);
+  k_indices.reserve (std::min (max_nn, (right - left + 1) * (bottom - top + 1)));
+  k_sqr_distances.reserve (k_indices.capacity ());
 
-  unsigned yEnd  = (bottom + 1) * input_->width + right + 1;
-  unsigned idx  = top * input_->width + left;
-  unsigned skip = input_->width - right + left - 1;
-  unsigned xEnd = idx - left + right + 1;
-
-  for (; xEnd != yEnd; idx += skip, xEnd += input_->width)
+  // the rows of the box are scanned in blocks of consecutive points. The distances of invalid points are NaN and
+  // fail the radius test.
+  float sqr_distances[scan_block_size_];
+  for (unsigned y = top; y <= bottom; ++y)
   {
-    for (; idx < xEnd; ++idx)
+    const index_t row_end = y * input_->width + right + 1;
+    for (index_t block = y * input_->width + left; block < row_end; block += scan_block_size_)
     {
-      if (!mask_[idx] || !isFinite ((*input_)[idx]))
-        continue;
-
-      float dist_x = (*input_)[idx].x - query.x;
-      float dist_y = (*input_)[idx].y - query.y;
-      float dist_z = (*input_)[idx].z - query.z;
-      squared_distance = dist_x * dist_x + dist_y * dist_y + dist_z * dist_z;
-      //squared_distance = ((*input_)[idx].getVector3fMap () - query.getVector3fMap ()).squaredNorm ();
-      if (squared_distance <= squared_radius)
+      const int count = std::min (static_cast<int> (scan_block_size_), row_end - block);
+      computeSquaredDistances (query, block, count, sqr_distances);
+      for (int i = 0; i < count; ++i)
       {
-        k_indices.push_back (idx);
-        k_sqr_distances.push_back (squared_distance);
+        if (!(sqr_distances[i] <= squared_radius) || (!mask_.empty () && !mask_[block + i]))
+          continue;
+
+        k_indices.push_back (block + i);
+        k_sqr_distances.push_back (sqr_distances[i]);
         // already done ?
         if (k_indices.size () == max_nn)
         {
@@ -125,144 +120,172 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
     return (0);
   }
 
-  Eigen::Vector3f queryvec (query.x, query.y, query.z);
-  // project query point on the image plane
-  //Eigen::Vector3f q = KR_ * query.getVector3fMap () + projection_matrix_.block <3, 1> (0, 3);
-  Eigen::Vector3f q (KR_ * queryvec + projection_matrix_.block <3, 1> (0, 3));
-  int xBegin = int(q [0] / q [2] + 0.5f);
-  int yBegin = int(q [1] / q [2] + 0.5f);
-  int xEnd   = xBegin + 1; // end is the pixel that is not used anymore, like in iterators
-  int yEnd   = yBegin + 1;
-
-  // the search window. This is supposed to shrink within the iterations
-  unsigned left = 0;
-  unsigned right = input_->width - 1;
-  unsigned top = 0;
-  unsigned bottom = input_->height - 1;
-
-  std::vector <Entry> results; // sorted from smallest to largest distance
-  results.reserve (k);
-  // add point laying on the projection of the query point.
-  if (xBegin >= 0 && 
-      xBegin < static_cast<int> (input_->width) && 
-      yBegin >= 0 && 
-      yBegin < static_cast<int> (input_->height))
-    testPoint (query, k, results, yBegin * input_->width + xBegin);
-  else // point lys
-  {
-    // find the box that touches the image border -> don't waste time evaluating boxes that are completely outside the image!
-    int dist = std::numeric_limits<int>::max ();
-
-    if (xBegin < 0)
-      dist = -xBegin;
-    else if (xBegin >= static_cast<int> (input_->width))
-      dist = xBegin - static_cast<int> (input_->width);
+  int x, y;
+  getProjectedPixel (query, x, y);
+  return (searchNearestK (query, x, y, k, k_indices, k_sqr_distances));
+}
 
-    if (yBegin < 0)
-      dist = std::min (dist, -yBegin);
-    else if (yBegin >= static_cast<int> (input_->height))
-      dist = std::min (dist, yBegin - static_cast<int> (input_->height));
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices,
+                                                        int k, BatchSearchResults &results,
+                                                        unsigned int nr_threads) const
+{
+  // the pixel of a point of the input cloud is known, no need to project it
+  const bool query_input = (&cloud == input_.get ());
+  this->batchSearch (cloud, indices,
+                     [&] (int index, int, Indices &k_indices, std::vector<float> &k_sqr_distances)
+                     {
+                       if (k < 1 || !isFinite (cloud[index]))
+                       {
+                         k_indices.clear ();
+                         k_sqr_distances.clear ();
+                         return (0);
+                       }
+                       int x, y;
+                       if (query_input)
+                       {
+                         x = index % static_cast<int> (input_->width);
+                         y = index / static_cast<int> (input_->width);
+                       }
+                       else
+                         getProjectedPixel (cloud[index], x, y);
+                       return (searchNearestK (cloud[index], x, y, k, k_indices, k_sqr_distances));
+                     },
+                     results, nr_threads);
+}
 
-    xBegin -= dist;
-    xEnd   += dist;
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::search::OrganizedNeighbor<PointT>::scanRange (const PointT &query, unsigned k, index_t begin, index_t end,
+                                                   Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  bool changed = false;
+  float max_sqr_distance = (k_indices.size () < k) ? std::numeric_limits<float>::max () : k_sqr_distances.back ();
+  float sqr_distances[scan_block_size_];
+  for (index_t block = begin; block < end; block += scan_block_size_)
+  {
+    const int count = std::min (static_cast<int> (scan_block_size_), end - block);
+    computeSquaredDistances (query, block, count, sqr_distances);
+    for (int i = 0; i < count; ++i)
+    {
+      // NaN distances of invalid points fail this test as well
+      if (!(sqr_distances[i] < max_sqr_distance) || (!mask_.empty () && !mask_[block + i]))
+        continue;
 
-    yBegin -= dist;
-    yEnd   += dist;
+      if (k_indices.size () == k)
+      {
+        k_indices.pop_back ();
+        k_sqr_distances.pop_back ();
+      }
+      const std::size_t position = std::upper_bound (k_sqr_distances.begin (), k_sqr_distances.end (),
+                                                     sqr_distances[i]) - k_sqr_distances.begin ();
+      k_indices.insert (k_indices.begin () + position, block + i);
+      k_sqr_distances.insert (k_sqr_distances.begin () + position, sqr_distances[i]);
+      if (k_indices.size () == k)
+        max_sqr_distance = k_sqr_distances.back ();
+      changed = true;
+    }
   }
+  return (changed);
+}
 
-  
-  // stop used as isChanged as well as stop.
-  bool stop = false;
-  do
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::search::OrganizedNeighbor<PointT>::searchNearestK (const PointT &query, int x, int y, unsigned k,
+                                                        Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  const int width = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  k_indices.reserve (k + 1);
+  k_sqr_distances.reserve (k + 1);
+
+  // scan a window around the pixel of the query, doubling its size until it holds k neighbors. The scanned
+  // window is [left, right) x [top, bottom).
+  int left = 0, right = 0, top = 0, bottom = 0;
+  int half_size = std::max (1, static_cast<int> (std::ceil (0.5f * std::sqrt (static_cast<float> (k)))));
+  while (k_indices.size () < k && !(left == 0 && right == width && top == 0 && bottom == height))
   {
-    // increment box size
-    --xBegin;
-    ++xEnd;
-    --yBegin;
-    ++yEnd;
-
-    // the range in x-direction which intersects with the image width
-    int xFrom = xBegin;
-    int xTo   = xEnd;
-    clipRange (xFrom, xTo, 0, input_->width);
-    
-    // if x-extend is not 0
-    if (xTo > xFrom)
+    int window_left = x - half_size, window_right = x + half_size + 1;
+    int window_top = y - half_size, window_bottom = y + half_size + 1;
+    clipRange (window_left, window_right, 0, width);
+    clipRange (window_top, window_bottom, 0, height);
+
+    // the new window contains the scanned one, only its new pixels are scanned
+    for (int row = window_top; row < window_bottom; ++row)
     {
-      // if upper line of the rectangle is visible and x-extend is not 0
-      if (yBegin >= 0 && yBegin < static_cast<int> (input_->height))
+      const index_t row_begin = row * width;
+      if (row >= top && row < bottom)
       {
-        index_t idx   = yBegin * input_->width + xFrom;
-        index_t idxTo = idx + xTo - xFrom;
-        for (; idx < idxTo; ++idx)
-          stop = testPoint (query, k, results, idx) || stop;
+        scanRange (query, k, row_begin + window_left, row_begin + left, k_indices, k_sqr_distances);
+        scanRange (query, k, row_begin + right, row_begin + window_right, k_indices, k_sqr_distances);
       }
-      
-
-      // the row yEnd does NOT belong to the box -> last row = yEnd - 1
-      // if lower line of the rectangle is visible
-      if (yEnd > 0 && yEnd <= static_cast<int> (input_->height))
-      {
-        index_t idx   = (yEnd - 1) * input_->width + xFrom;
-        index_t idxTo = idx + xTo - xFrom;
+      else
+        scanRange (query, k, row_begin + window_left, row_begin + window_right, k_indices, k_sqr_distances);
+    }
+    left = window_left;
+    right = window_right;
+    top = window_top;
+    bottom = window_bottom;
+    half_size *= 2;
+  }
 
-        for (; idx < idxTo; ++idx)
-          stop = testPoint (query, k, results, idx) || stop;
-      }
-      
-      // skip first row and last row (already handled above)
-      int yFrom = yBegin + 1;
-      int yTo   = yEnd - 1;
-      clipRange (yFrom, yTo, 0, input_->height);
-      
-      // if we have lines in between that are also visible
-      if (yFrom < yTo)
+  // all the closer points are within the projection of the sphere through the k-th neighbor. Its rows are scanned
+  // from the row of the query outwards, since the closest points shrink the box the most.
+  if (k_indices.size () == k)
+  {
+    unsigned box_left, box_right, box_top, box_bottom;
+    getProjectedRadiusSearchBox (query, k_sqr_distances.back (), box_left, box_right, box_top, box_bottom);
+    const int center = std::min (std::max (y, 0), height - 1);
+    for (int offset = 0; center - offset >= static_cast<int> (box_top) ||
+                         center + offset <= static_cast<int> (box_bottom); ++offset)
+    {
+      for (int side = 0; side < (offset == 0 ? 1 : 2); ++side)
       {
-        if (xBegin >= 0 && xBegin < static_cast<int> (input_->width))
+        const int row = (side == 0) ? center - offset : center + offset;
+        if (row < static_cast<int> (box_top) || row > static_cast<int> (box_bottom))
+          continue;
+
+        const index_t row_begin = row * width;
+        const int from = static_cast<int> (box_left);
+        const int to = static_cast<int> (box_right) + 1;
+        bool changed;
+        if (row >= top && row < bottom)
         {
-          index_t idx   = yFrom * input_->width + xBegin;
-          index_t idxTo = yTo * input_->width + xBegin;
-
-          for (; idx < idxTo; idx += input_->width)
-            stop = testPoint (query, k, results, idx) || stop;
+          changed = scanRange (query, k, row_begin + from, row_begin + std::min (to, left),
+                               k_indices, k_sqr_distances);
+          changed = scanRange (query, k, row_begin + std::max (from, right), row_begin + to,
+                               k_indices, k_sqr_distances) || changed;
         }
-        
-        if (xEnd > 0 && xEnd <= static_cast<int> (input_->width))
-        {
-          index_t idx   = yFrom * input_->width + xEnd - 1;
-          index_t idxTo = yTo * input_->width + xEnd - 1;
+        else
+          changed = scanRange (query, k, row_begin + from, row_begin + to, k_indices, k_sqr_distances);
 
-          for (; idx < idxTo; idx += input_->width)
-            stop = testPoint (query, k, results, idx) || stop;
-        }
-        
+        if (changed)
+          getProjectedRadiusSearchBox (query, k_sqr_distances.back (), box_left, box_right, box_top, box_bottom);
       }
-      // stop here means that the k-nearest neighbor changed -> recalculate bounding box of ellipse.
-      if (stop)
-        getProjectedRadiusSearchBox (query, results.back ().distance, left, right, top, bottom);
-      
     }
-    // now we use it as stop flag -> if bounding box is completely within the already examined search box were done!
-    stop = (static_cast<int> (left)   >= xBegin && static_cast<int> (left)   < xEnd && 
-            static_cast<int> (right)  >= xBegin && static_cast<int> (right)  < xEnd &&
-            static_cast<int> (top)    >= yBegin && static_cast<int> (top)    < yEnd && 
-            static_cast<int> (bottom) >= yBegin && static_cast<int> (bottom) < yEnd);
-    
-  } while (!stop);
+  }
+  return (static_cast<int> (k_indices.size ()));
+}
 
-  
-  const auto results_size = results.size ();
-  k_indices.resize (results_size);
-  k_sqr_distances.resize (results_size);
-  std::size_t idx = 0;
-  for(const auto& result : results)
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::search::OrganizedNeighbor<PointT>::getProjectedPixel (const PointT &point, int &x, int &y) const
+{
+  const Eigen::Vector3f q (KR_ * point.getVector3fMap () + projection_matrix_.block <3, 1> (0, 3));
+  const float width = static_cast<float> (input_->width);
+  const float height = static_cast<float> (input_->height);
+  if (!(q [2] > 0.0f))
   {
-    k_indices [idx] = result.index;
-    k_sqr_distances [idx] = result.distance;
-    ++idx;
+    x = static_cast<int> (input_->width / 2);
+    y = static_cast<int> (input_->height / 2);
+    return;
   }
-  
-  return (static_cast<int> (results_size));
+  // pixels further than the image size away from the image are clamped, to stay in range of int
+  x = static_cast<int> (std::floor (std::min (std::max (q [0] / q [2] + 0.5f, -width), 2.0f * width)));
+  y = static_cast<int> (std::floor (std::min (std::max (q [1] / q [2] + 0.5f, -height), 2.0f * height)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -284,6 +307,10 @@ pcl::search::OrganizedNeighbor<PointT>::getProjectedRadiusSearchBox (const Point
   int min, max;
   // a and c are multiplied by two already => - 4ac -> - ac
   float det = b * b - a * c;
+  // a sphere in front of the camera (a < 0) projects to an ellipse, so a negative determinant is a rounding error
+  // of a tiny radius
+  if (det < 0 && a < 0)
+    det = 0;
   if (det < 0)
   {
     minY = 0;
@@ -304,6 +331,8 @@ pcl::search::OrganizedNeighbor<PointT>::getProjectedRadiusSearchBox (const Point
   c = squared_radius * KR_KRT_.coeff (0) - q [0] * q [0];
 
   det = b * b - a * c;
+  if (det < 0 && a < 0)
+    det = 0;
   if (det < 0)
   {
     minX = 0;
@@ -329,12 +358,59 @@ pcl::search::OrganizedNeighbor<PointT>::computeCameraMatrix (Eigen::Matrix3f& ca
   pcl::getCameraMatrixFromProjectionMatrix (projection_matrix_, camera_matrix);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::search::OrganizedNeighbor<PointT>::setProjectionMatrix (
+    const Eigen::Matrix<float, 3, 4, Eigen::RowMajor> &projection_matrix)
+{
+  projection_matrix_ = projection_matrix;
+  KR_ = projection_matrix_.topLeftCorner <3, 3> ();
+  KR_KRT_ = KR_ * KR_.transpose ();
+  user_projection_ = !projection_matrix.isZero ();
+  projection_width_ = projection_height_ = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::search::OrganizedNeighbor<PointT>::isProjectionMatrixConsistent () const
+{
+  if (projection_width_ != input_->width || projection_height_ != input_->height || projection_width_ == 0)
+    return (false);
+
+  // the same pixels as for the estimation
+  const unsigned ySkip = (std::max) (input_->height >> pyramid_level_, unsigned (1));
+  const unsigned xSkip = (std::max) (input_->width >> pyramid_level_, unsigned (1));
+  double sqr_error = 0.0;
+  std::size_t nr_points = 0;
+  for (unsigned yIdx = 0; yIdx < input_->height; yIdx += ySkip)
+  {
+    for (unsigned xIdx = 0, idx = yIdx * input_->width; xIdx < input_->width; xIdx += xSkip, idx += xSkip)
+    {
+      const PointT &point = (*input_)[idx];
+      if ((!mask_.empty () && !mask_[idx]) || !std::isfinite (point.x))
+        continue;
+
+      const Eigen::Vector3f q (KR_ * point.getVector3fMap () + projection_matrix_.block <3, 1> (0, 3));
+      if (!(q [2] > 0.0f))
+        return (false);
+      const float error_x = q [0] / q [2] - static_cast<float> (xIdx);
+      const float error_y = q [1] / q [2] - static_cast<float> (yIdx);
+      sqr_error += error_x * error_x + error_y * error_y;
+      ++nr_points;
+    }
+  }
+  return (nr_points > 0 && sqr_error <= 0.25 * static_cast<double> (nr_points));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
 pcl::search::OrganizedNeighbor<PointT>::estimateProjectionMatrix ()
 {
   // internally we calculate with double but store the result into float matrices.
   projection_matrix_.setZero ();
+  KR_.setZero ();
+  KR_KRT_.setZero ();
+  projection_width_ = projection_height_ = 0;
   if (input_->height == 1 || input_->width == 1)
   {
     PCL_ERROR ("[pcl::%s::estimateProjectionMatrix] Input dataset is not organized!\n", this->getName ().c_str ());
@@ -351,7 +427,7 @@ pcl::search::OrganizedNeighbor<PointT>::estimateProjectionMatrix ()
   {
     for (unsigned xIdx = 0, idx2 = idx; xIdx < input_->width; xIdx += xSkip, idx2 += xSkip)
     {
-      if (!mask_ [idx2])
+      if (!mask_.empty () && !mask_ [idx2])
         continue;
 
       indices.push_back (idx2);
@@ -372,6 +448,9 @@ pcl::search::OrganizedNeighbor<PointT>::estimateProjectionMatrix ()
 
   // precalculate KR * KR^T needed by calculations during nn-search
   KR_KRT_ = KR_ * KR_.transpose ();
+
+  projection_width_ = input_->width;
+  projection_height_ = input_->height;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -39,6 +39,9 @@
 #define PCL_SEARCH_SEARCH_IMPL_HPP_
 
 #include <pcl/search/search.h>
+#include <pcl/common/profiler.h>
+#include <pcl/common/parallel.h>
+#include <algorithm>
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
@@ -119,6 +122,8 @@ pcl::search::Search<PointT>::nearestKSearch (
     int k, std::vector< std::vector<int> >& k_indices,
     std::vector< std::vector<float> >& k_sqr_distances) const
 {
+  PCL_PROFILE_SCOPE ("Search::nearestKSearch");
+
   if (indices.empty ())
   {
     k_indices.resize (cloud.size ());
@@ -135,6 +140,22 @@ pcl::search::Search<PointT>::nearestKSearch (
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::nearestKSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, int k,
+    BatchSearchResults &results, unsigned int nr_threads) const
+{
+  PCL_PROFILE_SCOPE ("Search::nearestKSearch");
+
+  batchSearch (cloud, indices,
+               [&] (int index, int, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances)
+               {
+                 return (nearestKSearch (cloud, index, k, k_indices, k_sqr_distances));
+               },
+               results, nr_threads);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::search::Search<PointT>::radiusSearch (
@@ -174,6 +195,8 @@ pcl::search::Search<PointT>::radiusSearch (
     std::vector< std::vector<float> > &k_sqr_distances,
     unsigned int max_nn) const
 {
+  PCL_PROFILE_SCOPE ("Search::radiusSearch");
+
   if (indices.empty ())
   {
     k_indices.resize (cloud.size ());
@@ -190,6 +213,115 @@ pcl::search::Search<PointT>::radiusSearch (
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::radiusSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, double radius,
+    BatchSearchResults &results, unsigned int max_nn, unsigned int nr_threads) const
+{
+  PCL_PROFILE_SCOPE ("Search::radiusSearch");
+
+  batchSearch (cloud, indices,
+               [&] (int index, int, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances)
+               {
+                 return (radiusSearch (cloud, index, radius, k_indices, k_sqr_distances, max_nn));
+               },
+               results, nr_threads);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::radiusSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, double radius,
+    const std::vector<unsigned int> &max_nn, BatchSearchResults &results,
+    unsigned int nr_threads) const
+{
+  PCL_PROFILE_SCOPE ("Search::radiusSearch");
+
+  assert (max_nn.size () == (indices.empty () ? cloud.size () : indices.size ()) && "Wrong number of max_nn values in radiusSearch!");
+  batchSearch (cloud, indices,
+               [&] (int index, int query, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances)
+               {
+                 return (radiusSearch (cloud, index, radius, k_indices, k_sqr_distances, max_nn[query]));
+               },
+               results, nr_threads);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename SearchFunctor> void
+pcl::search::Search<PointT>::batchSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, const SearchFunctor &search,
+    BatchSearchResults &results, unsigned int nr_threads) const
+{
+  const int nr_queries = static_cast<int> (indices.empty () ? cloud.size () : indices.size ());
+  // The queries are split in fixed chunks, whose results are gathered in order once all are done. This keeps the
+  // output independent of the scheduling of the threads.
+  const int chunk_size = 64;
+  const int nr_chunks = (nr_queries + chunk_size - 1) / chunk_size;
+  std::vector<std::vector<int> > chunk_indices (nr_chunks);
+  std::vector<std::vector<float> > chunk_sqr_distances (nr_chunks);
+
+  results.offsets.resize (nr_queries + 1);
+  results.offsets[0] = 0;
+  pcl::parallel::parallel_for (0, nr_chunks, [&] (int chunk_begin, int chunk_end)
+  {
+    std::vector<int> k_indices;
+    std::vector<float> k_sqr_distances;
+    for (int chunk = chunk_begin; chunk < chunk_end; ++chunk)
+    {
+      const int query_end = std::min ((chunk + 1) * chunk_size, nr_queries);
+      for (int query = chunk * chunk_size; query < query_end; ++query)
+      {
+        const int index = indices.empty () ? query : indices[query];
+        int nr_neighbors = search (index, query, k_indices, k_sqr_distances);
+        nr_neighbors = std::max (0, std::min (nr_neighbors, static_cast<int> (k_indices.size ())));
+        results.offsets[query + 1] = nr_neighbors;
+        chunk_indices[chunk].insert (chunk_indices[chunk].end (), k_indices.begin (), k_indices.begin () + nr_neighbors);
+        chunk_sqr_distances[chunk].insert (chunk_sqr_distances[chunk].end (),
+                                           k_sqr_distances.begin (), k_sqr_distances.begin () + nr_neighbors);
+      }
+    }
+  }, 1, nr_threads);
+
+  for (int query = 0; query < nr_queries; ++query)
+    results.offsets[query + 1] += results.offsets[query];
+
+  results.indices.resize (results.offsets[nr_queries]);
+  results.sqr_distances.resize (results.offsets[nr_queries]);
+  pcl::parallel::parallel_for (0, nr_chunks, [&] (int chunk_begin, int chunk_end)
+  {
+    for (int chunk = chunk_begin; chunk < chunk_end; ++chunk)
+    {
+      const int offset = results.offsets[chunk * chunk_size];
+      std::copy (chunk_indices[chunk].begin (), chunk_indices[chunk].end (), results.indices.begin () + offset);
+      std::copy (chunk_sqr_distances[chunk].begin (), chunk_sqr_distances[chunk].end (),
+                 results.sqr_distances.begin () + offset);
+    }
+  }, 16, nr_threads);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::flattenResults (
+    const std::vector<std::vector<int> > &k_indices, const std::vector<std::vector<float> > &k_sqr_distances,
+    BatchSearchResults &results)
+{
+  const size_t nr_queries = k_indices.size ();
+  results.offsets.resize (nr_queries + 1);
+  results.offsets[0] = 0;
+  for (size_t query = 0; query < nr_queries; ++query)
+    results.offsets[query + 1] = results.offsets[query] + static_cast<int> (k_indices[query].size ());
+
+  results.indices.resize (results.offsets[nr_queries]);
+  results.sqr_distances.resize (results.offsets[nr_queries]);
+  for (size_t query = 0; query < nr_queries; ++query)
+  {
+    std::copy (k_indices[query].begin (), k_indices[query].end (), results.indices.begin () + results.offsets[query]);
+    std::copy (k_sqr_distances[query].begin (), k_sqr_distances[query].end (),
+               results.sqr_distances.begin () + results.offsets[query]);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::search::Search<PointT>::sortResults (
@@ -0,0 +1,350 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_INCREMENTAL_KDTREE_H_
+#define PCL_SEARCH_INCREMENTAL_KDTREE_H_
+
+#include <pcl/search/search.h>
+#include <Eigen/Core>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief @b search::IncrementalKdTree is a dynamic 3D kd-tree: points can be added and removed without
+      * rebuilding the whole tree, which makes it suited to maps that change a little with every new frame.
+      *
+      * Each node of the tree holds one point and the bounding box of its subtree, which is used to prune the
+      * searches. Removed points are only marked as deleted. A subtree is rebuilt when it becomes unbalanced
+      * (one child holds more than \a balance_factor of its points) or when more than \a delete_factor of its
+      * points are deleted. Only the topmost such subtree on the modified path is rebuilt, so the cost of the
+      * rebalancing is amortized over the updates.
+      *
+      * The cloud given to setInputCloud is not copied, getInputCloud () returns it unchanged. The points
+      * added later are kept by the tree and numbered after the points of the input cloud: point i of
+      * getAddedPoints () has the index getInputCloud ()->size () + i, and getPoint () returns the point of
+      * any index. The indices of removed points are not reused.
+      *
+      * \code
+      * pcl::search::IncrementalKdTree<pcl::PointXYZ> map;
+      * map.setDownsampleResolution (0.1f);
+      * map.setInputCloud (first_scan);
+      * ...
+      * map.addPoints (*registered_scan);
+      * map.removePointsInBox (old_min, old_max);
+      * map.nearestKSearch (query, 5, k_indices, k_sqr_distances);
+      * \endcode
+      *
+      * \note Only the x, y and z coordinates of the points are used.
+      * \ingroup search
+      */
+    template<typename PointT>
+    class IncrementalKdTree: public Search<PointT>
+    {
+      public:
+        typedef typename Search<PointT>::PointCloud PointCloud;
+        typedef typename Search<PointT>::PointCloudPtr PointCloudPtr;
+        typedef typename Search<PointT>::PointCloudConstPtr PointCloudConstPtr;
+
+        typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
+        typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
+
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+        using pcl::search::Search<PointT>::sorted_results_;
+
+        typedef boost::shared_ptr<IncrementalKdTree<PointT> > Ptr;
+        typedef boost::shared_ptr<const IncrementalKdTree<PointT> > ConstPtr;
+
+        /** \brief Constructor for IncrementalKdTree.
+          * \param[in] sorted set to true if the radius search results need to be sorted in ascending order
+          * based on their distance to the query point
+          */
+        IncrementalKdTree (bool sorted = true);
+
+        /** \brief Destructor for IncrementalKdTree. */
+        virtual
+        ~IncrementalKdTree ()
+        {
+        }
+
+        /** \brief Set the maximum fraction of the points of a subtree its largest child may hold before the
+          * subtree is rebuilt.
+          * \param[in] balance_factor a value in ]0.5, 1[ (default: 0.7)
+          */
+        inline void
+        setBalanceFactor (float balance_factor) { balance_factor_ = balance_factor; }
+
+        /** \brief Get the maximum fraction of the points of a subtree its largest child may hold. */
+        inline float
+        getBalanceFactor () const { return (balance_factor_); }
+
+        /** \brief Set the maximum fraction of deleted points of a subtree before it is rebuilt.
+          * \param[in] delete_factor a value in ]0, 1[ (default: 0.5)
+          */
+        inline void
+        setDeleteFactor (float delete_factor) { delete_factor_ = delete_factor; }
+
+        /** \brief Get the maximum fraction of deleted points of a subtree before it is rebuilt. */
+        inline float
+        getDeleteFactor () const { return (delete_factor_); }
+
+        /** \brief Set the resolution of the voxel grid used to downsample the added points.
+          *
+          * When set, a voxel of the grid keeps at most one of the points added with addPoints, the one closest to
+          * its center: a new point replaces the points of its voxel if it is closer to the center than all of
+          * them, otherwise it is not inserted in the tree.
+          * \param[in] resolution the size of the voxels, 0 to disable the downsampling (default)
+          */
+        inline void
+        setDownsampleResolution (float resolution) { downsample_resolution_ = resolution; }
+
+        /** \brief Get the resolution of the voxel grid used to downsample the added points. */
+        inline float
+        getDownsampleResolution () const { return (downsample_resolution_); }
+
+        /** \brief Build the tree on a new set of points, discarding the previous ones and the added points.
+          * \param[in] cloud the const boost shared pointer to a PointCloud message
+          * \param[in] indices the point indices subset that is to be used from \a cloud
+          */
+        void
+        setInputCloud (const PointCloudConstPtr& cloud,
+                       const IndicesConstPtr& indices = IndicesConstPtr ());
+
+        /** \brief Add points to the tree. Point i of \a cloud gets the index
+          * getInputCloud ()->size () + getAddedPoints ().size () + i, even if it is invalid or removed by the
+          * downsampling.
+          * \param[in] cloud the points to add
+          * \return the number of points inserted in the tree
+          */
+        int
+        addPoints (const PointCloud &cloud);
+
+        /** \brief Get the points added with addPoints since the last call to setInputCloud. */
+        inline const PointCloud&
+        getAddedPoints () const
+        {
+          return (added_points_);
+        }
+
+        /** \brief Get the point of an index returned by the searches.
+          * \param[in] index the index of the point, in the input cloud or past its end for the added points
+          */
+        inline const PointT&
+        getPoint (int index) const
+        {
+          return (index < input_size_ ? input_->points[index] : added_points_.points[index - input_size_]);
+        }
+
+        /** \brief Remove a point from the tree.
+          * \param[in] index the index of the point in getInputCloud ()
+          * \return true if the point was in the tree
+          */
+        bool
+        removePoint (int index);
+
+        /** \brief Remove a set of points from the tree.
+          * \param[in] indices the indices of the points in getInputCloud ()
+          * \return the number of points removed
+          */
+        int
+        removePoints (const std::vector<int> &indices);
+
+        /** \brief Remove all the points inside an axis aligned box from the tree.
+          * \param[in] min_pt the minimum corner of the box
+          * \param[in] max_pt the maximum corner of the box
+          * \return the number of points removed
+          */
+        int
+        removePointsInBox (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt);
+
+        /** \brief Get the indices of the points of the tree inside an axis aligned box.
+          * \param[in] min_pt the minimum corner of the box
+          * \param[in] max_pt the maximum corner of the box
+          * \param[out] k_indices the indices of the points inside the box
+          * \return the number of points found
+          */
+        int
+        boxSearch (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, std::vector<int> &k_indices) const;
+
+        /** \brief Get the number of points in the tree, not counting the removed ones. */
+        inline int
+        size () const
+        {
+          return (root_ < 0 ? 0 : nodes_[root_].size - nodes_[root_].deleted);
+        }
+
+        /** \brief Search for the k-nearest neighbors for the given query point.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k,
+                        std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius,
+                      std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const;
+
+      protected:
+        /** \brief A node of the tree, holding one point. */
+        struct Node
+        {
+          /** \brief The index of the point, see getPoint. */
+          int point;
+          /** \brief The coordinates of the point, kept in the node for locality. */
+          float xyz[3];
+          /** \brief The children and parent nodes, -1 if none. */
+          int left, right, parent;
+          /** \brief The number of points in the subtree, including the deleted ones. */
+          int size;
+          /** \brief The number of deleted points in the subtree. */
+          int deleted;
+          /** \brief The splitting axis. */
+          int axis;
+          /** \brief Whether the point of the node is deleted. */
+          bool is_deleted;
+          /** \brief The bounding box of the points of the subtree. */
+          float min[3], max[3];
+        };
+
+        /** \brief Build a balanced subtree on a set of points.
+          * \param[in,out] points the indices of the points, reordered by the call
+          * \param[in] begin the first point of the subtree in \a points
+          * \param[in] end one past the last point of the subtree in \a points
+          * \param[in] parent the parent node of the subtree
+          * \return the root node of the subtree, -1 if empty
+          */
+        int
+        build (std::vector<int> &points, int begin, int end, int parent);
+
+        /** \brief Insert a valid point in the tree and rebalance it. */
+        void
+        insert (int point);
+
+        /** \brief Mark a node as deleted, updating the counts of its ancestors. */
+        void
+        markDeleted (int node);
+
+        /** \brief Rebuild the topmost subtree violating the balance criteria on the path from the root to a node. */
+        void
+        rebalancePath (int node);
+
+        /** \brief Rebuild the subtrees violating the balance criteria among the subtrees overlapping a box. */
+        void
+        rebalanceBox (int node, const float *min_pt, const float *max_pt);
+
+        /** \brief Check whether a subtree has to be rebuilt. */
+        bool
+        needsRebuild (int node) const;
+
+        /** \brief Rebuild a subtree, dropping its deleted points. */
+        void
+        rebuild (int node);
+
+        /** \brief Collect the nodes holding valid points of a subtree inside a box. */
+        void
+        collectInBox (int node, const float *min_pt, const float *max_pt, std::vector<int> &nodes) const;
+
+        /** \brief Recursive part of nearestKSearch, keeping the k best candidates in a max-heap. */
+        void
+        searchKNN (int node, const float *query, int k, std::vector<std::pair<float, int> > &heap) const;
+
+        /** \brief Recursive part of radiusSearch. */
+        void
+        searchRadius (int node, const float *query, float sqr_radius, unsigned int max_nn,
+                      std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Get a free node, reusing the released ones. */
+        int
+        allocateNode ();
+
+        /** \brief The points added with addPoints, numbered after the points of the input cloud. */
+        PointCloud added_points_;
+
+        /** \brief The number of points of the input cloud when the tree was built. */
+        int input_size_;
+
+        /** \brief The nodes of the tree. */
+        std::vector<Node> nodes_;
+
+        /** \brief The released nodes, reused by allocateNode. */
+        std::vector<int> free_nodes_;
+
+        /** \brief The node holding each point, -1 if the point is not in the tree. */
+        std::vector<int> point_node_;
+
+        /** \brief The root node, -1 for an empty tree. */
+        int root_;
+
+        /** \brief Maximum fraction of the points of a subtree in one of its children. */
+        float balance_factor_;
+
+        /** \brief Maximum fraction of deleted points in a subtree. */
+        float delete_factor_;
+
+        /** \brief Resolution of the voxel grid used to downsample the added points, 0 if disabled. */
+        float downsample_resolution_;
+    };
+  }
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/search/impl/incremental_kdtree.hpp>
+#else
+#define PCL_INSTANTIATE_IncrementalKdTree(T) template class PCL_EXPORTS pcl::search::IncrementalKdTree<T>;
+#endif
+
+#endif    // PCL_SEARCH_INCREMENTAL_KDTREE_H_
@@ -138,6 +138,23 @@ namespace pcl
         setInputCloud (const PointCloudConstPtr& cloud, 
                        const IndicesConstPtr& indices = IndicesConstPtr ());
 
+        /** \brief Save the built tree together with its points to a file, see pcl::KdTreeFLANN::saveIndex.
+          * \param[in] file_name the name of the file
+          * \return true if successful
+          */
+        bool
+        saveIndex (const std::string &file_name) const;
+
+        /** \brief Load a tree saved by \ref saveIndex instead of building it, see pcl::KdTreeFLANN::loadIndex.
+          * \param[in] file_name the name of the file
+          * \param[in] cloud the cloud the tree was built from
+          * \param[in] indices the point indices subset the tree was built from
+          * \return true if successful
+          */
+        bool
+        loadIndex (const std::string &file_name, const PointCloudConstPtr& cloud,
+                   const IndicesConstPtr& indices = IndicesConstPtr ());
+
         /** \brief Search for the k-nearest neighbors for the given query point.
           * \param[in] point the given query point
           * \param[in] k the number of neighbors to search for
@@ -166,6 +183,31 @@ namespace pcl
                       std::vector<int> &k_indices, 
                       std::vector<float> &k_sqr_distances,
                       unsigned int max_nn = 0) const;
+
+        /** \brief Search for the k-nearest neighbors of a batch of query points, with a single query of the
+          * tree (see pcl::KdTreeFLANN::nearestKSearch), whose results are written directly into \a results.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are queried.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] nr_threads the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        BatchSearchResults &results, unsigned int nr_threads = 0) const;
+
+        /** \brief Search for all the nearest neighbors of a batch of query points in a given radius, with a single
+          * query of the tree (see pcl::KdTreeFLANN::radiusSearch).
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are queried.
+          * \param[in] radius the radius of the sphere bounding all of the neighbors
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] max_nn if given, bounds the maximum number of neighbors returned for each query point
+          * \param[in] nr_threads the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      BatchSearchResults &results, unsigned int max_nn = 0, unsigned int nr_threads = 0) const;
       protected:
         /** \brief A pointer to the internal KdTree object. */
         KdTreePtr tree_;
@@ -0,0 +1,161 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_NEIGHBOR_GRAPH_H_
+#define PCL_SEARCH_NEIGHBOR_GRAPH_H_
+
+#include <pcl/search/search.h>
+#include <pcl/pcl_macros.h>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief Compute the k nearest neighbors of every point of a set among the points of the same set.
+      *
+      * Instead of one independent tree search per point, the points are sorted in the leaves of a kd-tree and
+      * the queries of a leaf traverse the tree together: the subtrees too far from all the queries of the leaf
+      * are pruned once for the whole batch, and the distances between the queries and the points of a visited
+      * leaf are computed as a block. The leaves are processed in parallel.
+      *
+      * The neighbors of each query are sorted by distance and include the query point itself. The result is a
+      * neighbor graph in compressed sparse row layout, which can be kept and shared by the stages of a
+      * pipeline that work on the same neighborhoods.
+      *
+      * \param[in] points the x, y and z coordinates of the points, point i starting at points[i * stride]
+      * \param[in] stride the number of floats between two consecutive points
+      * \param[in] indices the indices of the points of the set; the non finite points get no neighbors and are
+      * nobody's neighbor
+      * \param[in] k the number of neighbors to search for
+      * \param[out] graph the neighbors of each point of \a indices, as indices of \a points
+      * \param[in] nr_threads the number of threads to use (0: automatic)
+      * \ingroup search
+      */
+    PCL_EXPORTS void
+    computeKNearestNeighborGraph (const float *points, size_t stride, const std::vector<int> &indices, int k,
+                                  BatchSearchResults &graph, unsigned int nr_threads = 0);
+
+    /** \brief Compute the neighbors in a radius of every point of a set among the points of the same set.
+      *
+      * See computeKNearestNeighborGraph for the traversal. The neighbors of each query are sorted by distance
+      * and include the query point itself.
+      *
+      * \param[in] points the x, y and z coordinates of the points, point i starting at points[i * stride]
+      * \param[in] stride the number of floats between two consecutive points
+      * \param[in] indices the indices of the points of the set; the non finite points get no neighbors and are
+      * nobody's neighbor
+      * \param[in] radius the radius of the neighborhoods
+      * \param[out] graph the neighbors of each point of \a indices, as indices of \a points
+      * \param[in] max_nn if not 0, only the max_nn closest neighbors of each point are kept
+      * \param[in] nr_threads the number of threads to use (0: automatic)
+      * \ingroup search
+      */
+    PCL_EXPORTS void
+    computeRadiusNeighborGraph (const float *points, size_t stride, const std::vector<int> &indices, double radius,
+                                BatchSearchResults &graph, unsigned int max_nn = 0, unsigned int nr_threads = 0);
+
+    /** \brief Compute the k nearest neighbors of every point of \a indices among the points of \a indices.
+      * \param[in] cloud the point cloud
+      * \param[in] indices the indices of the points of the set
+      * \param[in] k the number of neighbors to search for
+      * \param[out] graph the neighbors of each point of \a indices, as indices of \a cloud
+      * \param[in] nr_threads the number of threads to use (0: automatic)
+      * \ingroup search
+      */
+    template <typename PointT> inline void
+    computeKNearestNeighborGraph (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices, int k,
+                                  BatchSearchResults &graph, unsigned int nr_threads = 0)
+    {
+      computeKNearestNeighborGraph (cloud.points.empty () ? NULL : cloud.points[0].data,
+                                    sizeof (PointT) / sizeof (float), indices, k, graph, nr_threads);
+    }
+
+    /** \brief Compute the k nearest neighbors of every point of a cloud among the points of the cloud.
+      * \param[in] cloud the point cloud
+      * \param[in] k the number of neighbors to search for
+      * \param[out] graph the neighbors of each point of \a cloud
+      * \param[in] nr_threads the number of threads to use (0: automatic)
+      * \ingroup search
+      */
+    template <typename PointT> inline void
+    computeKNearestNeighborGraph (const pcl::PointCloud<PointT> &cloud, int k,
+                                  BatchSearchResults &graph, unsigned int nr_threads = 0)
+    {
+      std::vector<int> indices (cloud.points.size ());
+      for (size_t i = 0; i < indices.size (); ++i)
+        indices[i] = static_cast<int> (i);
+      computeKNearestNeighborGraph (cloud, indices, k, graph, nr_threads);
+    }
+
+    /** \brief Compute the neighbors in a radius of every point of \a indices among the points of \a indices.
+      * \param[in] cloud the point cloud
+      * \param[in] indices the indices of the points of the set
+      * \param[in] radius the radius of the neighborhoods
+      * \param[out] graph the neighbors of each point of \a indices, as indices of \a cloud
+      * \param[in] max_nn if not 0, only the max_nn closest neighbors of each point are kept
+      * \param[in] nr_threads the number of threads to use (0: automatic)
+      * \ingroup search
+      */
+    template <typename PointT> inline void
+    computeRadiusNeighborGraph (const pcl::PointCloud<PointT> &cloud, const std::vector<int> &indices, double radius,
+                                BatchSearchResults &graph, unsigned int max_nn = 0, unsigned int nr_threads = 0)
+    {
+      computeRadiusNeighborGraph (cloud.points.empty () ? NULL : cloud.points[0].data,
+                                  sizeof (PointT) / sizeof (float), indices, radius, graph, max_nn, nr_threads);
+    }
+
+    /** \brief Compute the neighbors in a radius of every point of a cloud among the points of the cloud.
+      * \param[in] cloud the point cloud
+      * \param[in] radius the radius of the neighborhoods
+      * \param[out] graph the neighbors of each point of \a cloud
+      * \param[in] max_nn if not 0, only the max_nn closest neighbors of each point are kept
+      * \param[in] nr_threads the number of threads to use (0: automatic)
+      * \ingroup search
+      */
+    template <typename PointT> inline void
+    computeRadiusNeighborGraph (const pcl::PointCloud<PointT> &cloud, double radius,
+                                BatchSearchResults &graph, unsigned int max_nn = 0, unsigned int nr_threads = 0)
+    {
+      std::vector<int> indices (cloud.points.size ());
+      for (size_t i = 0; i < indices.size (); ++i)
+        indices[i] = static_cast<int> (i);
+      computeRadiusNeighborGraph (cloud, indices, radius, graph, max_nn, nr_threads);
+    }
+  }
+}
+
+#endif    // PCL_SEARCH_NEIGHBOR_GRAPH_H_
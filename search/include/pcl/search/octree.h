@@ -41,6 +41,8 @@
 
 #include <pcl/search/search.h>
 #include <pcl/octree/octree_search.h>
+#include <pcl/common/io.h>
+#include <pcl/common/morton.h>
 
 namespace pcl
 {
@@ -88,6 +90,8 @@ namespace pcl
         using pcl::search::Search<PointT>::input_;
         using pcl::search::Search<PointT>::indices_;
         using pcl::search::Search<PointT>::sorted_results_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
 
         /** \brief Octree constructor.
           * \param[in] resolution octree resolution at lowest octree level
@@ -95,6 +99,8 @@ namespace pcl
         Octree (const double resolution)
           : Search<PointT> ("Octree")
           , tree_ (new pcl::octree::OctreePointCloudSearch<PointT, LeafTWrap, BranchTWrap> (resolution))
+          , spatial_reordering_ (false)
+          , reordered_indices_ ()
         {
         }
 
@@ -110,9 +116,7 @@ namespace pcl
         inline void
         setInputCloud (const PointCloudConstPtr &cloud)
         {
-          tree_->deleteTree ();
-          tree_->setInputCloud (cloud);
-          tree_->addPointsFromInputCloud ();
+          buildTree (cloud, IndicesConstPtr ());
           input_ = cloud;
         }
 
@@ -123,13 +127,23 @@ namespace pcl
         inline void
         setInputCloud (const PointCloudConstPtr &cloud, const IndicesConstPtr& indices)
         {
-          tree_->deleteTree ();
-          tree_->setInputCloud (cloud, indices);
-          tree_->addPointsFromInputCloud ();
+          buildTree (cloud, indices);
           input_ = cloud;
           indices_ = indices;
         }
 
+        /** \brief Build the octree on a copy of the input points sorted along a Morton curve (see
+          * pcl::reorderPointCloud), so that the points of a leaf are close in memory. The search results still
+          * refer to the input cloud. Takes effect at the next call to setInputCloud ().
+          * \param[in] reordering true to reorder the points (default: false)
+          */
+        inline void
+        setSpatialReordering (bool reordering) { spatial_reordering_ = reordering; }
+
+        /** \brief Get whether the octree is built on a spatially reordered copy of the input points. */
+        inline bool
+        getSpatialReordering () const { return (spatial_reordering_); }
+
         /** \brief Search for the k-nearest neighbors for the given query point.
           * \param[in] cloud the point cloud data
           * \param[in] index the index in \a cloud representing the query point
@@ -143,7 +157,7 @@ namespace pcl
         nearestKSearch (const PointCloud &cloud, int index, int k, std::vector<int> &k_indices,
                         std::vector<float> &k_sqr_distances) const
         {
-          return (tree_->nearestKSearch (cloud, index, k, k_indices, k_sqr_distances));
+          return (nearestKSearch (cloud.points[index], k, k_indices, k_sqr_distances));
         }
 
         /** \brief Search for the k-nearest neighbors for the given query point.
@@ -158,7 +172,9 @@ namespace pcl
         nearestKSearch (const PointT &point, int k, std::vector<int> &k_indices,
                         std::vector<float> &k_sqr_distances) const
         {
-          return (tree_->nearestKSearch (point, k, k_indices, k_sqr_distances));
+          const int nr_neighbors = tree_->nearestKSearch (point, k, k_indices, k_sqr_distances);
+          mapToInputIndices (k_indices);
+          return (nr_neighbors);
         }
 
         /** \brief Search for the k-nearest neighbors for the given query point (zero-copy).
@@ -175,7 +191,7 @@ namespace pcl
         inline int
         nearestKSearch (int index, int k, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
         {
-          return (tree_->nearestKSearch (index, k, k_indices, k_sqr_distances));
+          return (nearestKSearch (input_->points[index], k, k_indices, k_sqr_distances));
         }
 
         /** \brief search for all neighbors of query point that are within a given radius.
@@ -195,10 +211,7 @@ namespace pcl
                       std::vector<float> &k_sqr_distances, 
                       unsigned int max_nn = 0) const
         {
-          tree_->radiusSearch (cloud, index, radius, k_indices, k_sqr_distances, max_nn);
-          if (sorted_results_)
-            this->sortResults (k_indices, k_sqr_distances);
-          return (static_cast<int> (k_indices.size ()));
+          return (radiusSearch (cloud.points[index], radius, k_indices, k_sqr_distances, max_nn));
         }
 
         /** \brief search for all neighbors of query point that are within a given radius.
@@ -217,6 +230,7 @@ namespace pcl
                       unsigned int max_nn = 0) const
         {
           tree_->radiusSearch (p_q, radius, k_indices, k_sqr_distances, max_nn);
+          mapToInputIndices (k_indices);
           if (sorted_results_)
             this->sortResults (k_indices, k_sqr_distances);
           return (static_cast<int> (k_indices.size ()));
@@ -235,10 +249,7 @@ namespace pcl
         radiusSearch (int index, double radius, std::vector<int> &k_indices,
                       std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
         {
-          tree_->radiusSearch (index, radius, k_indices, k_sqr_distances, max_nn);
-          if (sorted_results_)
-            this->sortResults (k_indices, k_sqr_distances);
-          return (static_cast<int> (k_indices.size ()));
+          return (radiusSearch (input_->points[index], radius, k_indices, k_sqr_distances, max_nn));
         }
 
 
@@ -253,7 +264,7 @@ namespace pcl
         approxNearestSearch (const PointCloudConstPtr &cloud, int query_index, int &result_index,
                              float &sqr_distance)
         {
-          return (tree_->approxNearestSearch (cloud->points[query_index], result_index, sqr_distance));
+          approxNearestSearch (cloud->points[query_index], result_index, sqr_distance);
         }
 
         /** \brief Search for approximate nearest neighbor at the query point.
@@ -264,7 +275,9 @@ namespace pcl
         inline void
         approxNearestSearch (const PointT &p_q, int &result_index, float &sqr_distance)
         {
-          return (tree_->approxNearestSearch (p_q, result_index, sqr_distance));
+          tree_->approxNearestSearch (p_q, result_index, sqr_distance);
+          if (!reordered_indices_.empty ())
+            result_index = reordered_indices_[result_index];
         }
 
         /** \brief Search for approximate nearest neighbor at the query point.
@@ -277,9 +290,54 @@ namespace pcl
         inline void
         approxNearestSearch (int query_index, int &result_index, float &sqr_distance)
         {
-          return (tree_->approxNearestSearch (query_index, result_index, sqr_distance));
+          approxNearestSearch (input_->points[query_index], result_index, sqr_distance);
+        }
+
+      private:
+        /** \brief Build the octree on \a cloud, or on its spatially reordered copy. */
+        void
+        buildTree (const PointCloudConstPtr &cloud, const IndicesConstPtr &indices)
+        {
+          tree_->deleteTree ();
+          reordered_indices_.clear ();
+          if (!spatial_reordering_)
+          {
+            tree_->setInputCloud (cloud, indices);
+            tree_->addPointsFromInputCloud ();
+            return;
+          }
+
+          PointCloudPtr reordered (new PointCloud);
+          if (indices)
+          {
+            PointCloud subset;
+            pcl::copyPointCloud (*cloud, *indices, subset);
+            pcl::reorderPointCloud (subset, *reordered, reordered_indices_);
+            for (size_t i = 0; i < reordered_indices_.size (); ++i)
+              reordered_indices_[i] = (*indices)[reordered_indices_[i]];
+          }
+          else
+            pcl::reorderPointCloud (*cloud, *reordered, reordered_indices_);
+          tree_->setInputCloud (reordered);
+          tree_->addPointsFromInputCloud ();
         }
 
+        /** \brief Map the indices of the reordered copy back to the input cloud. */
+        inline void
+        mapToInputIndices (std::vector<int> &k_indices) const
+        {
+          if (reordered_indices_.empty ())
+            return;
+          for (size_t i = 0; i < k_indices.size (); ++i)
+            k_indices[i] = reordered_indices_[k_indices[i]];
+        }
+
+        /** \brief Whether the octree is built on a spatially reordered copy of the input points. */
+        bool spatial_reordering_;
+
+        /** \brief The index in the input cloud of each point of the reordered copy, empty if not reordered. */
+        std::vector<int> reordered_indices_;
+
     };
   }
 }
@@ -78,6 +78,8 @@ namespace pcl
         using pcl::search::Search<PointT>::indices_;
         using pcl::search::Search<PointT>::sorted_results_;
         using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
 
         /** \brief Constructor
           * \param[in] sorted_results whether the results should be return sorted in ascending order on the distances or not.
@@ -94,6 +96,10 @@ namespace pcl
           , KR_KRT_ (Eigen::Matrix<float, 3, 3, Eigen::RowMajor>::Zero ())
           , eps_ (eps)
           , pyramid_level_ (pyramid_level)
+          , user_projection_ (false)
+          , reuse_projection_ (true)
+          , projection_width_ (0)
+          , projection_height_ (0)
         {
         }
 
@@ -122,7 +128,9 @@ namespace pcl
         void 
         computeCameraMatrix (Eigen::Matrix3f& camera_matrix) const;
         
-        /** \brief Provide a pointer to the input data set, if user has focal length he must set it before calling this
+        /** \brief Provide a pointer to the input data set. The projection matrix is the one given by
+          * \ref setProjectionMatrix, else the one of the previous cloud if it still fits (see
+          * \ref setReuseProjectionMatrix), else it is estimated from the cloud.
           * \param[in] cloud the const boost shared pointer to a PointCloud message
           * \param[in] indices the const boost shared pointer to PointIndices
           */
@@ -130,11 +138,9 @@ namespace pcl
         setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr &indices = IndicesConstPtr ()) override
         {
           input_ = cloud;
-          
-          mask_.resize (input_->size ());
-          input_ = cloud;
           indices_ = indices;
 
+          // Without indices, all the points are searched and no mask is needed
           if (indices_ && !indices_->empty())
           {
             mask_.assign (input_->size (), 0);
@@ -142,9 +148,42 @@ namespace pcl
               mask_[idx] = 1;
           }
           else
-            mask_.assign (input_->size (), 1);
+            mask_.clear ();
+
+          if (!user_projection_ && !(reuse_projection_ && isProjectionMatrixConsistent ()))
+            estimateProjectionMatrix ();
+        }
+
+        /** \brief Provide the projection matrix of the sensor, which is then used for all the input clouds instead
+          * of being estimated from them. A zero matrix restores the estimation.
+          * \param[in] projection_matrix the 3x4 projection matrix P = K * [R|t] from the cloud to pixel coordinates
+          */
+        void
+        setProjectionMatrix (const Eigen::Matrix<float, 3, 4, Eigen::RowMajor> &projection_matrix);
 
-          estimateProjectionMatrix ();
+        /** \brief Get the projection matrix, given by the user or estimated from the input cloud. */
+        inline const Eigen::Matrix<float, 3, 4, Eigen::RowMajor>&
+        getProjectionMatrix () const
+        {
+          return (projection_matrix_);
+        }
+
+        /** \brief Set whether \ref setInputCloud may reuse the projection matrix estimated for the previous cloud.
+          * It is reused if the new cloud has the same size and a subsample of its points still projects to its
+          * pixels, which saves the estimation for the frames of a sensor with fixed intrinsics (default: true).
+          * \param[in] reuse whether to reuse the projection matrix
+          */
+        inline void
+        setReuseProjectionMatrix (bool reuse)
+        {
+          reuse_projection_ = reuse;
+        }
+
+        /** \brief Get whether the projection matrix of the previous cloud may be reused. */
+        inline bool
+        getReuseProjectionMatrix () const
+        {
+          return (reuse_projection_);
         }
 
         /** \brief Search for all neighbors of query point that are within a given radius.
@@ -169,13 +208,15 @@ namespace pcl
         estimateProjectionMatrix ();
 
          /** \brief Search for the k-nearest neighbors for a given query point.
-           * \note limiting the maximum search radius (with setMaxDistance) can lead to a significant improvement in search speed
+           *
+           * The pixels of a window around the projection of the query are scanned until it holds k neighbors, then
+           * the rest of the projection of the sphere through the k-th neighbor, which shrinks as closer neighbors
+           * are found.
            * \param[in] p_q the given query point (\ref setInputCloud must be given a-priori!)
-           * \param[in] k the number of neighbors to search for (used only if horizontal and vertical window not given already!)
-           * \param[out] k_indices the resultant point indices (must be resized to \a k beforehand!)
-           * \param[out] k_sqr_distances \note this function does not return distances
+           * \param[in] k the number of neighbors to search for
+           * \param[out] k_indices the resultant point indices, sorted by distance
+           * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
            * \return number of neighbors found
-           * @todo still need to implements this functionality
           */
         int
         nearestKSearch (const PointT &p_q,
@@ -183,6 +224,22 @@ namespace pcl
                         Indices &k_indices,
                         std::vector<float> &k_sqr_distances) const override;
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, in parallel.
+          *
+          * If \a cloud is the input cloud, the search of each query starts at its own pixel instead of its
+          * projection, so querying all the points of a frame is the fastest way to build its neighborhoods. Invalid
+          * (NaN) query points get no neighbors.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud
+          * are queried.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] nr_threads the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        BatchSearchResults &results, unsigned int nr_threads = 0) const override;
+
         /** \brief projects a point into the image
           * \param[in] p point in 3D World Coordinate Frame to be projected onto the image plane
           * \param[out] q the 2D projected point in pixel coordinates (u,v)
@@ -192,58 +249,70 @@ namespace pcl
         
       protected:
 
-        struct Entry
-        {
-          Entry (index_t idx, float dist) : index (idx), distance (dist) {}
-          Entry () : index (0), distance (0) {}
-          index_t index;
-          float distance;
-          
-          inline bool 
-          operator < (const Entry& other) const
-          {
-            return (distance < other.distance);
-          }
-        };
-
-        /** \brief test if point given by index is among the k NN in results to the query point.
-          * \param[in] query query point
-          * \param[in] k number of maximum nn interested in
-          * \param[in,out] queue priority queue with k NN
-          * \param[in] index index on point to be tested
-          * \return whether the top element changed or not.
+        /** \brief Number of points whose distances to the query are computed at once. */
+        static const int scan_block_size_ = 64;
+
+        /** \brief Compute the squared distances from the query to a range of consecutive points.
+          * \param[in] query the query point
+          * \param[in] begin the index of the first point
+          * \param[in] count the number of points
+          * \param[out] sqr_distances the resultant squared distances, NaN for invalid points
           */
-        inline bool 
-        testPoint (const PointT& query, unsigned k, std::vector<Entry>& queue, index_t index) const
+        inline void
+        computeSquaredDistances (const PointT &query, index_t begin, int count, float *sqr_distances) const
         {
-          const PointT& point = input_->points [index];
-          if (mask_ [index] && std::isfinite (point.x))
+          // The coordinates are read with a constant stride in a loop without branches, which the compiler
+          // vectorizes
+          const int stride = sizeof (PointT) / sizeof (float);
+          const float *points = reinterpret_cast<const float*> (&input_->points[begin]);
+          for (int i = 0; i < count; ++i)
           {
-            //float squared_distance = (point.getVector3fMap () - query.getVector3fMap ()).squaredNorm ();
-            float dist_x = point.x - query.x;
-            float dist_y = point.y - query.y;
-            float dist_z = point.z - query.z;
-            float squared_distance = dist_x * dist_x + dist_y * dist_y + dist_z * dist_z;
-            const auto queue_size = queue.size ();
-            const auto insert_into_queue = [&]{ queue.emplace (
-                                                std::upper_bound (queue.begin(), queue.end(), squared_distance,
-                                                [](float dist, const Entry& ent){ return dist<ent.distance; }),
-                                                               index, squared_distance); };
-            if (queue_size < k)
-            {
-              insert_into_queue ();
-              return (queue_size + 1) == k;
-            }
-            if (queue.back ().distance > squared_distance)
-            {
-              queue.pop_back ();
-              insert_into_queue ();
-              return true; // top element has changed!
-            }
+            const float dist_x = points[i * stride] - query.x;
+            const float dist_y = points[i * stride + 1] - query.y;
+            const float dist_z = points[i * stride + 2] - query.z;
+            sqr_distances[i] = dist_x * dist_x + dist_y * dist_y + dist_z * dist_z;
           }
-          return false;
         }
 
+        /** \brief Insert the points of a range of consecutive points that are closer than the k-th neighbor found
+          * so far in the sorted neighbors.
+          * \param[in] query the query point
+          * \param[in] k the number of neighbors to search for
+          * \param[in] begin the index of the first point
+          * \param[in] end the index after the last point
+          * \param[in,out] k_indices the neighbors found so far, sorted by distance
+          * \param[in,out] k_sqr_distances the squared distances of the neighbors found so far
+          * \return whether the neighbors changed
+          */
+        bool
+        scanRange (const PointT &query, unsigned k, index_t begin, index_t end,
+                   Indices &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for the k-nearest neighbors of a query point, starting at the given pixel.
+          * \param[in] query the query point
+          * \param[in] x the column of the pixel the query point projects to
+          * \param[in] y the row of the pixel the query point projects to
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        searchNearestK (const PointT &query, int x, int y, unsigned k,
+                        Indices &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Get the pixel a point projects to, or the center of the image if it is behind the sensor.
+          * The pixel may be outside of the image.
+          */
+        void
+        getProjectedPixel (const PointT &point, int &x, int &y) const;
+
+        /** \brief Check whether the projection matrix, estimated for the previous input cloud, fits the current one.
+          * The pixels sampled for the estimation must be reprojected with an RMS error below half a pixel.
+          */
+        bool
+        isProjectionMatrixConsistent () const;
+
         inline void
         clipRange (int& begin, int &end, int min, int max) const
         {
@@ -279,7 +348,17 @@ namespace pcl
         /** \brief using only a subsample of points to calculate the projection matrix. pyramid_level_ = use down sampled cloud given by pyramid_level_*/
         const unsigned pyramid_level_;
         
-        /** \brief mask, indicating whether the point was in the indices list or not.*/
+        /** \brief whether the projection matrix was given by the user */
+        bool user_projection_;
+
+        /** \brief whether the projection matrix estimated for the previous cloud may be reused */
+        bool reuse_projection_;
+
+        /** \brief size of the cloud the projection matrix was estimated for, 0 if the estimation failed */
+        unsigned projection_width_;
+        unsigned projection_height_;
+
+        /** \brief mask, indicating whether the point was in the indices list or not. Empty without indices. */
         std::vector<unsigned char> mask_;
       public:
         PCL_MAKE_ALIGNED_OPERATOR_NEW
@@ -48,6 +48,50 @@ namespace pcl
 {
   namespace search
   {
+    /** \brief The neighbors of a batch of query points, stored contiguously in compressed sparse row layout.
+      *
+      * The neighbors of query i are indices[offsets[i]] ... indices[offsets[i + 1] - 1], with the squared
+      * distances at the same positions of sqr_distances. Reusing the same object for the next batch reuses
+      * its memory.
+      * \ingroup search
+      */
+    struct BatchSearchResults
+    {
+      /** \brief The start of the neighbors of each query in \a indices, followed by the total number of neighbors. */
+      std::vector<int> offsets;
+
+      /** \brief The indices of the neighbors of all the queries. */
+      std::vector<int> indices;
+
+      /** \brief The squared distances to the neighbors of all the queries. */
+      std::vector<float> sqr_distances;
+
+      /** \brief Get the number of query points. */
+      inline size_t
+      getNumberOfQueries () const
+      {
+        return (offsets.empty () ? 0 : offsets.size () - 1);
+      }
+
+      /** \brief Get the number of neighbors found for a query point.
+        * \param[in] query the position of the query point in the batch
+        */
+      inline int
+      getNumberOfNeighbors (size_t query) const
+      {
+        return (offsets[query + 1] - offsets[query]);
+      }
+
+      /** \brief Remove all the results, keeping the allocated memory. */
+      inline void
+      clear ()
+      {
+        offsets.clear ();
+        indices.clear ();
+        sqr_distances.clear ();
+      }
+    };
+
     /** \brief Generic search class. All search wrappers must inherit from this.
       *
       * Each search method must implement 2 different types of search:
@@ -219,6 +263,20 @@ namespace pcl
                         int k, std::vector< std::vector<int> >& k_indices,
                         std::vector< std::vector<float> >& k_sqr_distances) const;
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, in parallel.
+          *
+          * The results of all the queries are stored in the flat buffers of \a results, which is much cheaper
+          * than allocating two vectors per query point. The output does not depend on the number of threads.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are queried.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] nr_threads the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        virtual void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        BatchSearchResults &results, unsigned int nr_threads = 0) const;
+
         /** \brief Search for the k-nearest neighbors for the given query point. Use this method if the query points are of a different type than the points in the data set (e.g. PointXYZRGBA instead of PointXYZ).
           * \param[in] cloud the point cloud data
           * \param[in] indices a vector of point cloud indices to query for nearest neighbors
@@ -355,6 +413,35 @@ namespace pcl
                       std::vector< std::vector<float> > &k_sqr_distances,
                       unsigned int max_nn = 0) const;
 
+        /** \brief Search for all the nearest neighbors of a batch of query points in a given radius, in parallel.
+          *
+          * The results of all the queries are stored in the flat buffers of \a results, which is much cheaper
+          * than allocating two vectors per query point. The output does not depend on the number of threads.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are queried.
+          * \param[in] radius the radius of the sphere bounding all of the neighbors
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] max_nn if given, bounds the maximum number of neighbors returned for each query point
+          * \param[in] nr_threads the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        virtual void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      BatchSearchResults &results, unsigned int max_nn = 0, unsigned int nr_threads = 0) const;
+
+        /** \brief Search for all the nearest neighbors of a batch of query points in a given radius, with a
+          * different bound on the number of neighbors for each query point.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are queried.
+          * \param[in] radius the radius of the sphere bounding all of the neighbors
+          * \param[in] max_nn the maximum number of neighbors of each query point (0: unbounded), in the order of the queries
+          * \param[out] results the neighbors of each query point, in the order of \a indices
+          * \param[in] nr_threads the number of threads to use (0: automatic, see pcl::parallel::getNumberOfThreads)
+          */
+        virtual void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      const std::vector<unsigned int> &max_nn, BatchSearchResults &results,
+                      unsigned int nr_threads = 0) const;
+
         /** \brief Search for all the nearest neighbors of the query points in a given radius.
           * \param[in] cloud the point cloud data
           * \param[in] indices a vector of point cloud indices to query for nearest neighbors
@@ -400,6 +487,18 @@ namespace pcl
         void 
         sortResults (std::vector<int>& indices, std::vector<float>& distances) const;
 
+        /** \brief Run a single point search for each query of a batch in parallel, and gather the results in
+          * \a results. \a search is called as search (query_index, position_in_batch, k_indices, k_sqr_distances).
+          */
+        template <typename SearchFunctor> void
+        batchSearch (const PointCloud &cloud, const std::vector<int> &indices, const SearchFunctor &search,
+                     BatchSearchResults &results, unsigned int nr_threads) const;
+
+        /** \brief Gather the neighbors of a batch of queries, as returned by FLANN, in \a results. */
+        static void
+        flattenResults (const std::vector<std::vector<int> > &k_indices,
+                        const std::vector<std::vector<float> > &k_sqr_distances, BatchSearchResults &results);
+
         PointCloudConstPtr input_;
         IndicesConstPtr indices_;
         bool sorted_results_;
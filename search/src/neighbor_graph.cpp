@@ -0,0 +1,459 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/search/neighbor_graph.h>
+#include <pcl/common/parallel.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  /** \brief The maximum number of points of a leaf, which is also the size of the query batches. */
+  const int leaf_size = 32;
+
+  typedef std::pair<float, int> Neighbor;
+
+  struct Node
+  {
+    float min[3], max[3];
+    int begin, end;
+    int left, right;
+  };
+
+  /** \brief Squared distance between two boxes, 0 if they overlap. */
+  inline float
+  sqrBoxDistance (const Node &a, const Node &b)
+  {
+    float sqr_distance = 0.0f;
+    for (int d = 0; d < 3; ++d)
+    {
+      const float delta = std::max (std::max (a.min[d] - b.max[d], b.min[d] - a.max[d]), 0.0f);
+      sqr_distance += delta * delta;
+    }
+    return (sqr_distance);
+  }
+
+  /** \brief A kd-tree with leaves of at most leaf_size points, the points stored by leaf in structure of arrays
+    * layout.
+    */
+  class SelfJoinTree
+  {
+    public:
+      SelfJoinTree (const float *points, size_t stride, const std::vector<int> &indices)
+      {
+        std::vector<int> order;
+        order.reserve (indices.size ());
+        for (size_t i = 0; i < indices.size (); ++i)
+        {
+          const float *p = points + static_cast<size_t> (indices[i]) * stride;
+          if (pcl_isfinite (p[0]) && pcl_isfinite (p[1]) && pcl_isfinite (p[2]))
+            order.push_back (static_cast<int> (i));
+        }
+
+        const size_t nr_points = order.size ();
+        xyz_[0].resize (nr_points);
+        xyz_[1].resize (nr_points);
+        xyz_[2].resize (nr_points);
+        slots_.resize (nr_points);
+        labels_.resize (nr_points);
+        if (nr_points == 0)
+          return;
+
+        // The tree is built on the slots, then the coordinates are copied in the order of the leaves
+        for (size_t i = 0; i < nr_points; ++i)
+        {
+          const float *p = points + static_cast<size_t> (indices[order[i]]) * stride;
+          xyz_[0][i] = p[0];
+          xyz_[1][i] = p[1];
+          xyz_[2][i] = p[2];
+        }
+        std::vector<int> permutation (nr_points);
+        for (size_t i = 0; i < nr_points; ++i)
+          permutation[i] = static_cast<int> (i);
+        nodes_.reserve (4 * nr_points / leaf_size + 1);
+        build (permutation, 0, static_cast<int> (nr_points));
+
+        std::vector<float> coordinates (nr_points);
+        for (int d = 0; d < 3; ++d)
+        {
+          for (size_t i = 0; i < nr_points; ++i)
+            coordinates[i] = xyz_[d][permutation[i]];
+          xyz_[d].swap (coordinates);
+        }
+        for (size_t i = 0; i < nr_points; ++i)
+        {
+          slots_[i] = order[permutation[i]];
+          labels_[i] = indices[slots_[i]];
+        }
+      }
+
+      /** \brief Visit the leaves that may hold neighbors of the points of a leaf, closest first. The visitor
+        * gives the squared distance beyond which the leaves are pruned, and processes the visited leaves.
+        */
+      template <typename Visitor> void
+      traverse (int leaf, Visitor &visitor) const
+      {
+        const Node &queries = nodes_[leaf];
+        std::vector<Neighbor> stack;
+        stack.push_back (Neighbor (0.0f, 0));
+        while (!stack.empty ())
+        {
+          const Neighbor entry = stack.back ();
+          stack.pop_back ();
+          if (entry.first > visitor.bound ())
+            continue;
+
+          const Node &node = nodes_[entry.second];
+          if (node.left < 0)
+          {
+            visitor.visit (node);
+            continue;
+          }
+          const float left_distance = sqrBoxDistance (queries, nodes_[node.left]);
+          const float right_distance = sqrBoxDistance (queries, nodes_[node.right]);
+          if (left_distance <= right_distance)
+          {
+            stack.push_back (Neighbor (right_distance, node.right));
+            stack.push_back (Neighbor (left_distance, node.left));
+          }
+          else
+          {
+            stack.push_back (Neighbor (left_distance, node.left));
+            stack.push_back (Neighbor (right_distance, node.right));
+          }
+        }
+      }
+
+      /** \brief Compute the squared distances from point \a query to the points [begin, end). */
+      inline void
+      computeDistances (int query, int begin, int end, float *sqr_distances) const
+      {
+        const float qx = xyz_[0][query], qy = xyz_[1][query], qz = xyz_[2][query];
+        const float *x = &xyz_[0][0], *y = &xyz_[1][0], *z = &xyz_[2][0];
+        for (int i = begin; i < end; ++i)
+        {
+          const float dx = x[i] - qx, dy = y[i] - qy, dz = z[i] - qz;
+          sqr_distances[i - begin] = dx * dx + dy * dy + dz * dz;
+        }
+      }
+
+      /** \brief Squared distance from point \a query to the box of a node, 0 inside the box. */
+      inline float
+      sqrDistanceToBox (int query, const Node &node) const
+      {
+        float sqr_distance = 0.0f;
+        for (int d = 0; d < 3; ++d)
+        {
+          const float p = xyz_[d][query];
+          const float delta = std::max (std::max (node.min[d] - p, p - node.max[d]), 0.0f);
+          sqr_distance += delta * delta;
+        }
+        return (sqr_distance);
+      }
+
+      inline size_t
+      size () const { return (slots_.size ()); }
+
+      /** \brief The nodes of the tree, the root first. */
+      std::vector<Node> nodes_;
+
+      /** \brief The leaves of the tree, in the order of their points. */
+      std::vector<int> leaves_;
+
+      /** \brief The position in the input indices of each point. */
+      std::vector<int> slots_;
+
+      /** \brief The index in the input points of each point. */
+      std::vector<int> labels_;
+
+    private:
+      int
+      build (std::vector<int> &permutation, int begin, int end)
+      {
+        const int node_index = static_cast<int> (nodes_.size ());
+        nodes_.push_back (Node ());
+        Node node;
+        node.begin = begin;
+        node.end = end;
+        node.left = node.right = -1;
+        for (int d = 0; d < 3; ++d)
+        {
+          node.min[d] = std::numeric_limits<float>::max ();
+          node.max[d] = -std::numeric_limits<float>::max ();
+          for (int i = begin; i < end; ++i)
+          {
+            node.min[d] = std::min (node.min[d], xyz_[d][permutation[i]]);
+            node.max[d] = std::max (node.max[d], xyz_[d][permutation[i]]);
+          }
+        }
+
+        if (end - begin <= leaf_size)
+          leaves_.push_back (node_index);
+        else
+        {
+          int axis = 0;
+          for (int d = 1; d < 3; ++d)
+            if (node.max[d] - node.min[d] > node.max[axis] - node.min[axis])
+              axis = d;
+          const std::vector<float> &coordinates = xyz_[axis];
+          const int middle = begin + (end - begin) / 2;
+          std::nth_element (permutation.begin () + begin, permutation.begin () + middle, permutation.begin () + end,
+                            [&coordinates] (int a, int b) { return (coordinates[a] < coordinates[b]); });
+          node.left = build (permutation, begin, middle);
+          node.right = build (permutation, middle, end);
+        }
+        nodes_[node_index] = node;
+        return (node_index);
+      }
+
+      /** \brief The coordinates of the points, by leaf. */
+      std::vector<float> xyz_[3];
+  };
+
+  /** \brief Keeps the k nearest neighbors of the points of a leaf, sorted by distance. */
+  class KNearestVisitor
+  {
+    public:
+      KNearestVisitor (const SelfJoinTree &tree, const Node &queries, int k)
+        : neighbors_ (queries.end - queries.begin), tree_ (tree), queries_ (queries), k_ (k), bound_ (0.0f)
+      {
+        for (size_t q = 0; q < neighbors_.size (); ++q)
+          neighbors_[q].reserve (k);
+        updateBound ();
+      }
+
+      inline float
+      bound () const { return (bound_); }
+
+      void
+      visit (const Node &node)
+      {
+        float sqr_distances[leaf_size];
+        for (int q = 0; q < static_cast<int> (neighbors_.size ()); ++q)
+        {
+          std::vector<Neighbor> &neighbors = neighbors_[q];
+          const int query = queries_.begin + q;
+          if (static_cast<int> (neighbors.size ()) == k_ &&
+              tree_.sqrDistanceToBox (query, node) > neighbors.back ().first)
+            continue;
+
+          // k is small, an insertion in the sorted array is cheaper than a heap
+          tree_.computeDistances (query, node.begin, node.end, sqr_distances);
+          for (int i = 0; i < node.end - node.begin; ++i)
+          {
+            const float sqr_distance = sqr_distances[i];
+            if (static_cast<int> (neighbors.size ()) == k_)
+            {
+              if (sqr_distance >= neighbors.back ().first)
+                continue;
+            }
+            else
+              neighbors.push_back (Neighbor ());
+            int j = static_cast<int> (neighbors.size ()) - 1;
+            for (; j > 0 && neighbors[j - 1].first > sqr_distance; --j)
+              neighbors[j] = neighbors[j - 1];
+            neighbors[j] = Neighbor (sqr_distance, node.begin + i);
+          }
+        }
+        updateBound ();
+      }
+
+      /** \brief The neighbors of each query, sorted by distance. */
+      std::vector<std::vector<Neighbor> > neighbors_;
+
+    private:
+      /** \brief The leaves farther than the k-th neighbor of all the queries can be pruned. */
+      void
+      updateBound ()
+      {
+        bound_ = 0.0f;
+        for (size_t q = 0; q < neighbors_.size (); ++q)
+        {
+          if (static_cast<int> (neighbors_[q].size ()) < k_)
+          {
+            bound_ = std::numeric_limits<float>::max ();
+            return;
+          }
+          bound_ = std::max (bound_, neighbors_[q].back ().first);
+        }
+      }
+
+      const SelfJoinTree &tree_;
+      const Node &queries_;
+      const int k_;
+      float bound_;
+  };
+
+  /** \brief Collects the neighbors in a radius of the points of a leaf. */
+  class RadiusVisitor
+  {
+    public:
+      RadiusVisitor (const SelfJoinTree &tree, const Node &queries, float sqr_radius)
+        : neighbors_ (queries.end - queries.begin), tree_ (tree), queries_ (queries), sqr_radius_ (sqr_radius)
+      {
+      }
+
+      inline float
+      bound () const { return (sqr_radius_); }
+
+      void
+      visit (const Node &node)
+      {
+        float sqr_distances[leaf_size];
+        for (int q = 0; q < static_cast<int> (neighbors_.size ()); ++q)
+        {
+          const int query = queries_.begin + q;
+          if (tree_.sqrDistanceToBox (query, node) > sqr_radius_)
+            continue;
+          tree_.computeDistances (query, node.begin, node.end, sqr_distances);
+          for (int i = 0; i < node.end - node.begin; ++i)
+            if (sqr_distances[i] <= sqr_radius_)
+              neighbors_[q].push_back (Neighbor (sqr_distances[i], node.begin + i));
+        }
+      }
+
+      /** \brief The neighbors of each query. */
+      std::vector<std::vector<Neighbor> > neighbors_;
+
+    private:
+      const SelfJoinTree &tree_;
+      const Node &queries_;
+      const float sqr_radius_;
+  };
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::search::computeKNearestNeighborGraph (const float *points, size_t stride, const std::vector<int> &indices, int k,
+                                          BatchSearchResults &graph, unsigned int nr_threads)
+{
+  const SelfJoinTree tree (points, stride, indices);
+  const int nr_neighbors = std::min (std::max (k, 0), static_cast<int> (tree.size ()));
+
+  // Every finite point has the same number of neighbors, the layout of the graph is known beforehand
+  std::vector<int> counts (indices.size (), 0);
+  for (size_t i = 0; i < tree.size (); ++i)
+    counts[tree.slots_[i]] = nr_neighbors;
+  graph.offsets.resize (indices.size () + 1);
+  graph.offsets[0] = 0;
+  for (size_t i = 0; i < indices.size (); ++i)
+    graph.offsets[i + 1] = graph.offsets[i] + counts[i];
+  graph.indices.resize (graph.offsets.back ());
+  graph.sqr_distances.resize (graph.offsets.back ());
+  if (nr_neighbors == 0)
+    return;
+
+  pcl::parallel::parallel_for (0, static_cast<int> (tree.leaves_.size ()), [&] (int begin, int end)
+  {
+    for (int l = begin; l < end; ++l)
+    {
+      const Node &leaf = tree.nodes_[tree.leaves_[l]];
+      KNearestVisitor visitor (tree, leaf, nr_neighbors);
+      tree.traverse (tree.leaves_[l], visitor);
+      for (int q = 0; q < leaf.end - leaf.begin; ++q)
+      {
+        const std::vector<Neighbor> &neighbors = visitor.neighbors_[q];
+        const int offset = graph.offsets[tree.slots_[leaf.begin + q]];
+        for (int i = 0; i < nr_neighbors; ++i)
+        {
+          graph.indices[offset + i] = tree.labels_[neighbors[i].second];
+          graph.sqr_distances[offset + i] = neighbors[i].first;
+        }
+      }
+    }
+  }, 4, nr_threads);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::search::computeRadiusNeighborGraph (const float *points, size_t stride, const std::vector<int> &indices,
+                                        double radius, BatchSearchResults &graph, unsigned int max_nn,
+                                        unsigned int nr_threads)
+{
+  const SelfJoinTree tree (points, stride, indices);
+  const float sqr_radius = static_cast<float> (radius * radius);
+  const int nr_leaves = static_cast<int> (tree.leaves_.size ());
+
+  // The neighbors of each leaf are collected first, then copied into the graph in the order of the indices
+  std::vector<std::vector<Neighbor> > leaf_neighbors (nr_leaves);
+  std::vector<int> counts (indices.size (), 0);
+  pcl::parallel::parallel_for (0, nr_leaves, [&] (int begin, int end)
+  {
+    for (int l = begin; l < end; ++l)
+    {
+      const Node &leaf = tree.nodes_[tree.leaves_[l]];
+      RadiusVisitor visitor (tree, leaf, sqr_radius);
+      tree.traverse (tree.leaves_[l], visitor);
+      for (int q = 0; q < leaf.end - leaf.begin; ++q)
+      {
+        std::vector<Neighbor> &neighbors = visitor.neighbors_[q];
+        std::sort (neighbors.begin (), neighbors.end ());
+        if (max_nn > 0 && neighbors.size () > max_nn)
+          neighbors.resize (max_nn);
+        counts[tree.slots_[leaf.begin + q]] = static_cast<int> (neighbors.size ());
+        leaf_neighbors[l].insert (leaf_neighbors[l].end (), neighbors.begin (), neighbors.end ());
+      }
+    }
+  }, 4, nr_threads);
+
+  graph.offsets.resize (indices.size () + 1);
+  graph.offsets[0] = 0;
+  for (size_t i = 0; i < indices.size (); ++i)
+    graph.offsets[i + 1] = graph.offsets[i] + counts[i];
+  graph.indices.resize (graph.offsets.back ());
+  graph.sqr_distances.resize (graph.offsets.back ());
+
+  pcl::parallel::parallel_for (0, nr_leaves, [&] (int begin, int end)
+  {
+    for (int l = begin; l < end; ++l)
+    {
+      const Node &leaf = tree.nodes_[tree.leaves_[l]];
+      const std::vector<Neighbor> &neighbors = leaf_neighbors[l];
+      size_t n = 0;
+      for (int q = 0; q < leaf.end - leaf.begin; ++q)
+      {
+        const int slot = tree.slots_[leaf.begin + q];
+        for (int i = graph.offsets[slot]; i < graph.offsets[slot + 1]; ++i, ++n)
+        {
+          graph.indices[i] = tree.labels_[neighbors[n].second];
+          graph.sqr_distances[i] = neighbors[n].first;
+        }
+      }
+    }
+  }, 4, nr_threads);
+}
@@ -39,6 +39,7 @@
 #define PCL_SEGMENTATION_IMPL_EXTRACT_CLUSTERS_H_
 
 #include <pcl/segmentation/extract_clusters.h>
+#include <pcl/common/profiler.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -209,6 +210,8 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
 template <typename PointT> void 
 pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clusters)
 {
+  PCL_PROFILE_SCOPE ("EuclideanClusterExtraction::extract");
+
   if (!initCompute () || 
       (input_ != 0   && input_->points.empty ()) ||
       (indices_ != 0 && indices_->empty ()))
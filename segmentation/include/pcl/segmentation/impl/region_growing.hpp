@@ -44,6 +44,7 @@
 
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
+#include <pcl/common/profiler.h>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 
@@ -260,6 +261,8 @@ pcl::RegionGrowing<PointT, NormalT>::setInputNormals (const NormalPtr& norm)
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::extract (std::vector <pcl::PointIndices>& clusters)
 {
+  PCL_PROFILE_SCOPE ("RegionGrowing::extract");
+
   clusters_.clear ();
   clusters.clear ();
   point_neighbours_.clear ();
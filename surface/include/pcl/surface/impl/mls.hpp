@@ -47,6 +47,7 @@
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
 #include <pcl/common/geometry.h>
+#include <pcl/common/parallel.h>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -524,7 +525,8 @@ pcl::MovingLeastSquaresOMP<PointInT, PointOutT>::performProcessing (PointCloudOu
   nr_coeff_ = (order_ + 1) * (order_ + 2) / 2;
 
   // (Maximum) number of threads
-  unsigned int threads = threads_ == 0 ? 1 : threads_;
+  const pcl::parallel::ThreadReservation reservation (threads_ == 0 ? 1 : threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 
   // Create temporaries for each thread in order to avoid synchronization
   typename PointCloudOut::CloudVectorType projected_points (threads);
@@ -992,6 +992,171 @@ TEST (PCL, computeCentroid)
   EXPECT_FLOAT_EQ (-500, centroid.curvature);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, computeMeanAndCovarianceParallel)
+{
+  // Points a few meters around a UTM-like origin, spread over several reduction blocks
+  PointCloud<PointXYZ> cloud;
+  cloud.resize (5000);
+  std::vector<int> indices;
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    cloud[i].x = 500000.0f + static_cast<float> (i % 17) * 0.25f;
+    cloud[i].y = 4000000.0f + static_cast<float> (i % 13) * 0.5f - static_cast<float> (i % 7) * 0.25f;
+    cloud[i].z = 100.0f + static_cast<float> (i % 11) * 0.125f;
+    if (i % 3 == 0)
+      indices.push_back (static_cast<int> (i));
+  }
+  cloud[43].x = std::numeric_limits<float>::quiet_NaN ();
+  cloud.is_dense = false;
+
+  // Two pass reference in double precision
+  Eigen::Vector3d mean = Eigen::Vector3d::Zero ();
+  Eigen::Vector3d indices_mean = Eigen::Vector3d::Zero ();
+  unsigned int count = 0;
+  for (size_t i = 0; i < cloud.size (); ++i)
+    if (isFinite (cloud[i]))
+    {
+      mean += cloud[i].getVector3fMap ().cast<double> ();
+      ++count;
+    }
+  mean /= count;
+  for (size_t i = 0; i < indices.size (); ++i)
+    indices_mean += cloud[indices[i]].getVector3fMap ().cast<double> ();
+  indices_mean /= static_cast<double> (indices.size ());
+  Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero ();
+  Eigen::Matrix3d indices_covariance = Eigen::Matrix3d::Zero ();
+  for (size_t i = 0; i < cloud.size (); ++i)
+    if (isFinite (cloud[i]))
+    {
+      const Eigen::Vector3d d = cloud[i].getVector3fMap ().cast<double> () - mean;
+      covariance += d * d.transpose ();
+    }
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    const Eigen::Vector3d d = cloud[indices[i]].getVector3fMap ().cast<double> () - indices_mean;
+    indices_covariance += d * d.transpose ();
+  }
+
+  Eigen::Vector4d centroid;
+  Eigen::Matrix3d covariance_matrix;
+  EXPECT_EQ (count, compute3DCentroid (cloud, centroid, 0));
+  test::EXPECT_NEAR_VECTORS (mean, centroid.head<3> (), 1e-6);
+  EXPECT_EQ (1, centroid[3]);
+
+  EXPECT_EQ (count, computeCovarianceMatrix (cloud, centroid, covariance_matrix, 0));
+  EXPECT_LT ((covariance - covariance_matrix).cwiseAbs ().maxCoeff (), 1e-6);
+
+  EXPECT_EQ (count, computeMeanAndCovarianceMatrix (cloud, covariance_matrix, centroid, 0));
+  test::EXPECT_NEAR_VECTORS (mean, centroid.head<3> (), 1e-6);
+  EXPECT_LT ((covariance / count - covariance_matrix).cwiseAbs ().maxCoeff (), 1e-9);
+
+  // The result does not depend on the number of threads
+  Eigen::Vector4d centroid_threads;
+  Eigen::Matrix3d covariance_matrix_threads;
+  for (unsigned int nr_threads = 1; nr_threads <= 4; ++nr_threads)
+  {
+    EXPECT_EQ (count, computeMeanAndCovarianceMatrix (cloud, covariance_matrix_threads, centroid_threads, nr_threads));
+    EXPECT_EQ (centroid, centroid_threads);
+    EXPECT_EQ (covariance_matrix, covariance_matrix_threads);
+  }
+
+  // Index subsets
+  EXPECT_EQ (indices.size (), compute3DCentroid (cloud, indices, centroid, 2));
+  test::EXPECT_NEAR_VECTORS (indices_mean, centroid.head<3> (), 1e-6);
+  EXPECT_EQ (indices.size (), computeCovarianceMatrix (cloud, indices, centroid, covariance_matrix, 2));
+  EXPECT_LT ((indices_covariance - covariance_matrix).cwiseAbs ().maxCoeff (), 1e-6);
+  EXPECT_EQ (indices.size (), computeMeanAndCovarianceMatrix (cloud, indices, covariance_matrix, centroid, 2));
+  EXPECT_LT ((indices_covariance / static_cast<double> (indices.size ()) - covariance_matrix).cwiseAbs ().maxCoeff (), 1e-9);
+
+  // Float outputs are rounded from the double precision reduction
+  Eigen::Vector4f centroid_f;
+  Eigen::Matrix3f covariance_matrix_f;
+  EXPECT_EQ (count, computeMeanAndCovarianceMatrix (cloud, covariance_matrix_f, centroid_f, 0));
+  EXPECT_LT ((covariance / count - covariance_matrix_f.cast<double> ()).cwiseAbs ().maxCoeff (), 1e-5);
+
+  // Empty input leaves the outputs untouched
+  PointCloud<PointXYZ> empty;
+  centroid_f.setConstant (-1);
+  EXPECT_EQ (0, compute3DCentroid (empty, centroid_f, 0));
+  EXPECT_EQ (Eigen::Vector4f::Constant (-1), centroid_f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, computeMeanAndCovarianceInvalidPoint)
+{
+  // A single point with only x invalid is skipped by every path, the result is the one without it
+  PointCloud<PointXYZ> valid;
+  for (int i = 0; i < 3000; ++i)
+    valid.push_back (PointXYZ (static_cast<float> (i % 7) * 0.5f, static_cast<float> (i % 5) - 1.0f,
+                               static_cast<float> (i % 3) * 2.0f));
+  PointCloud<PointXYZ> cloud (valid);
+  cloud.points.insert (cloud.points.begin () + 1500, PointXYZ (std::numeric_limits<float>::quiet_NaN (), 1.0f, 1.0f));
+  cloud.width = static_cast<uint32_t> (cloud.size ());
+  cloud.is_dense = false;
+  std::vector<int> indices, valid_indices;
+  for (int i = 0; i < static_cast<int> (cloud.size ()); i += 2)
+  {
+    indices.push_back (i);
+    if (i != 1500)
+      valid_indices.push_back (i < 1500 ? i : i - 1);
+  }
+  const unsigned int count = static_cast<unsigned int> (valid.size ());
+  const unsigned int indices_count = static_cast<unsigned int> (valid_indices.size ());
+
+  Eigen::Vector4d centroid, expected_centroid;
+  Eigen::Matrix3d covariance_matrix, expected_covariance_matrix;
+  for (unsigned int nr_threads = 0; nr_threads <= 2; ++nr_threads)
+  {
+    // Serial overloads
+    if (nr_threads == 0)
+    {
+      ASSERT_EQ (count, computeMeanAndCovarianceMatrix (valid, expected_covariance_matrix, expected_centroid));
+      EXPECT_EQ (count, computeMeanAndCovarianceMatrix (cloud, covariance_matrix, centroid));
+      EXPECT_EQ (expected_centroid, centroid);
+      EXPECT_EQ (expected_covariance_matrix, covariance_matrix);
+      ASSERT_EQ (count, compute3DCentroid (valid, expected_centroid));
+      EXPECT_EQ (count, compute3DCentroid (cloud, centroid));
+      EXPECT_EQ (expected_centroid, centroid);
+
+      ASSERT_EQ (indices_count, computeMeanAndCovarianceMatrix (valid, valid_indices, expected_covariance_matrix,
+                                                                expected_centroid));
+      EXPECT_EQ (indices_count, computeMeanAndCovarianceMatrix (cloud, indices, covariance_matrix, centroid));
+      EXPECT_EQ (expected_centroid, centroid);
+      EXPECT_EQ (expected_covariance_matrix, covariance_matrix);
+      continue;
+    }
+
+    // Parallel overloads
+    ASSERT_EQ (count, computeMeanAndCovarianceMatrix (valid, expected_covariance_matrix, expected_centroid, nr_threads));
+    EXPECT_EQ (count, computeMeanAndCovarianceMatrix (cloud, covariance_matrix, centroid, nr_threads));
+    test::EXPECT_NEAR_VECTORS (expected_centroid, centroid, 1e-12);
+    EXPECT_LT ((expected_covariance_matrix - covariance_matrix).cwiseAbs ().maxCoeff (), 1e-12);
+    ASSERT_EQ (count, compute3DCentroid (valid, expected_centroid, nr_threads));
+    EXPECT_EQ (count, compute3DCentroid (cloud, centroid, nr_threads));
+    test::EXPECT_NEAR_VECTORS (expected_centroid, centroid, 1e-12);
+
+    ASSERT_EQ (indices_count, computeMeanAndCovarianceMatrix (valid, valid_indices, expected_covariance_matrix,
+                                                              expected_centroid, nr_threads));
+    EXPECT_EQ (indices_count, computeMeanAndCovarianceMatrix (cloud, indices, covariance_matrix, centroid, nr_threads));
+    test::EXPECT_NEAR_VECTORS (expected_centroid, centroid, 1e-12);
+    EXPECT_LT ((expected_covariance_matrix - covariance_matrix).cwiseAbs ().maxCoeff (), 1e-12);
+  }
+
+  // Structure of arrays
+  PointCloudSoA valid_soa, cloud_soa;
+  toPointCloudSoA (valid, valid_soa);
+  toPointCloudSoA (cloud, cloud_soa);
+  ASSERT_FALSE (cloud_soa.is_dense);
+  ASSERT_EQ (count, computeMeanAndCovarianceMatrix (valid_soa, expected_covariance_matrix, expected_centroid));
+  EXPECT_EQ (count, computeMeanAndCovarianceMatrix (cloud_soa, covariance_matrix, centroid));
+  EXPECT_EQ (expected_centroid, centroid);
+  EXPECT_EQ (expected_covariance_matrix, covariance_matrix);
+  ASSERT_EQ (count, compute3DCentroid (valid_soa, expected_centroid));
+  EXPECT_EQ (count, compute3DCentroid (cloud_soa, centroid));
+  EXPECT_EQ (expected_centroid, centroid);
+}
+
 int
 main (int argc, char** argv)
 {
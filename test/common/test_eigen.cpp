@@ -799,6 +799,63 @@ TEST (PCL, eigen33f)
   EXPECT_LE (float(r_fail_count) / float(iterations), 0.01);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// the batched version is checked against the single matrix version: the eigenvalues have to agree, and the
+// eigenvectors must not satisfy M * v = lambda * v less often than the ones of eigen33 (some of the random
+// matrices are degenerate, where the smallest eigenvalue is not unique)
+template <typename Scalar> void
+testEigen33Batch (Scalar epsilon)
+{
+  typedef Eigen::Matrix<Scalar, 3, 3> Matrix;
+  typedef Eigen::Matrix<Scalar, 3, 1> Vector;
+
+  // not a multiple of the batch width, to exercise the partially filled last batch
+  const size_t nr_matrices = 100003;
+  std::vector<Matrix, Eigen::aligned_allocator<Matrix> > matrices (nr_matrices);
+  for (size_t idx = 0; idx < nr_matrices; ++idx)
+    generateSymPosMatrix3x3 (matrices[idx]);
+
+  std::vector<Scalar> eigenvalues (nr_matrices);
+  std::vector<Vector, Eigen::aligned_allocator<Vector> > eigenvectors (nr_matrices);
+  eigen33 (&matrices[0], nr_matrices, &eigenvalues[0], &eigenvectors[0]);
+
+  unsigned value_fail_count = 0;
+  unsigned fail_count = 0;
+  unsigned reference_fail_count = 0;
+  for (size_t idx = 0; idx < nr_matrices; ++idx)
+  {
+    Scalar eigenvalue;
+    Vector eigenvector;
+    eigen33 (matrices[idx], eigenvalue, eigenvector);
+
+    const Scalar scale = std::max (matrices[idx].cwiseAbs ().maxCoeff (), Scalar (1));
+    if (std::abs (eigenvalue - eigenvalues[idx]) > epsilon * scale)
+      ++value_fail_count;
+
+    const Vector residual = matrices[idx] * eigenvectors[idx] - eigenvalues[idx] * eigenvectors[idx];
+    if (!(residual.norm () <= epsilon * scale))
+      ++fail_count;
+    const Vector reference_residual = matrices[idx] * eigenvector - eigenvalue * eigenvector;
+    if (!(reference_residual.norm () <= epsilon * scale))
+      ++reference_fail_count;
+  }
+  EXPECT_LE (float (value_fail_count) / float (nr_matrices), 0.01);
+  EXPECT_LE (float (fail_count) / float (nr_matrices), float (reference_fail_count) / float (nr_matrices) + 0.001);
+
+  // an empty batch is a no-op
+  eigen33 (&matrices[0], 0, &eigenvalues[0], &eigenvectors[0]);
+}
+
+TEST (PCL, eigen33Batchd)
+{
+  testEigen33Batch<double> (1e-6);
+}
+
+TEST (PCL, eigen33Batchf)
+{
+  testEigen33Batch<float> (1e-3f);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, transformLine)
 {
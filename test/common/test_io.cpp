@@ -39,6 +39,7 @@
 #include <pcl/pcl_tests.h>
 #include <pcl/point_types.h>
 #include <pcl/common/io.h>
+#include <pcl/conversions.h>
 
 using namespace pcl;
 using namespace std;
@@ -356,6 +357,61 @@ TEST (PCL, CopyPointCloudWithSameTypes)
   ASSERT_EQ (0, cloud_out.size ());
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCLPointCloud2Converter)
+{
+  CloudXYZRGBNormal cloud;
+  for (int i = 0; i < 1000; ++i)
+  {
+    PointXYZRGBNormal p;
+    p.x = static_cast<float> (i); p.y = static_cast<float> (2 * i); p.z = static_cast<float> (-i);
+    p.r = static_cast<uint8_t> (i); p.g = static_cast<uint8_t> (i + 1); p.b = static_cast<uint8_t> (i + 2);
+    p.normal_x = 1.0f; p.normal_y = 0.0f; p.normal_z = 0.0f; p.curvature = static_cast<float> (i) / 1000.0f;
+    cloud.push_back (p);
+  }
+  PCLPointCloud2 msg;
+  toPCLPointCloud2 (cloud, msg);
+
+  // Non contiguous conversion: the message fields are packed differently than in PointXYZRGB
+  PCLPointCloud2Converter<PointXYZRGB> converter;
+  EXPECT_FALSE (converter.isCached (msg));
+  CloudXYZRGB reference, converted;
+  for (int frame = 0; frame < 3; ++frame)
+  {
+    converter.fromPCLPointCloud2 (msg, converted);
+    EXPECT_TRUE (converter.isCached (msg));
+    fromPCLPointCloud2 (msg, reference);
+    ASSERT_EQ (reference.size (), converted.size ());
+    for (size_t i = 0; i < converted.size (); ++i)
+    {
+      EXPECT_XYZ_EQ (cloud[i], converted[i]);
+      EXPECT_RGB_EQ (cloud[i], converted[i]);
+      EXPECT_XYZ_EQ (reference[i], converted[i]);
+    }
+  }
+
+  // A different schema invalidates the cached mapping
+  CloudXYZ cloud_xyz;
+  copyPointCloud (cloud, cloud_xyz);
+  PCLPointCloud2 msg_xyz;
+  toPCLPointCloud2 (cloud_xyz, msg_xyz);
+  EXPECT_FALSE (converter.isCached (msg_xyz));
+  converter.fromPCLPointCloud2 (msg_xyz, converted);
+  EXPECT_TRUE (converter.isCached (msg_xyz));
+  EXPECT_FALSE (converter.isCached (msg));
+  ASSERT_EQ (cloud.size (), converted.size ());
+  for (size_t i = 0; i < converted.size (); ++i)
+    EXPECT_XYZ_EQ (cloud[i], converted[i]);
+
+  // Same field layout, but a renamed field
+  msg_xyz.fields[2].name = "w";
+  EXPECT_FALSE (converter.isCached (msg_xyz));
+
+  converter.reset ();
+  EXPECT_TRUE (converter.getFieldMap ().empty ());
+  EXPECT_FALSE (converter.isCached (msg));
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -0,0 +1,146 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/common/morton.h>
+#include <pcl/point_types.h>
+#include <algorithm>
+#include <limits>
+
+using namespace pcl;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, encodeMorton3D)
+{
+  EXPECT_EQ (encodeMorton3D (0, 0, 0), 0u);
+  EXPECT_EQ (encodeMorton3D (1, 0, 0), 1u);
+  EXPECT_EQ (encodeMorton3D (0, 1, 0), 2u);
+  EXPECT_EQ (encodeMorton3D (0, 0, 1), 4u);
+  EXPECT_EQ (encodeMorton3D (3, 0, 0), 9u);
+  EXPECT_EQ (encodeMorton3D (0x1fffff, 0x1fffff, 0x1fffff), (uint64_t (1) << 63) - 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, sortMortonCodes)
+{
+  std::vector<uint64_t> codes (100000);
+  for (size_t i = 0; i < codes.size (); ++i)
+    codes[i] = (uint64_t (rand ()) << 32 | uint64_t (rand ())) % 1000;
+  std::vector<uint64_t> sorted = codes;
+
+  std::vector<int> order;
+  sortMortonCodes (sorted, order, 4);
+  ASSERT_EQ (order.size (), codes.size ());
+  for (size_t i = 0; i < codes.size (); ++i)
+  {
+    EXPECT_EQ (sorted[i], codes[order[i]]);
+    if (i > 0)
+    {
+      EXPECT_LE (sorted[i - 1], sorted[i]);
+      // Equal codes keep their original order
+      if (sorted[i - 1] == sorted[i])
+        EXPECT_LT (order[i - 1], order[i]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, computeMortonOrder)
+{
+  PointCloud<PointXYZ> cloud;
+  for (int z = 0; z < 8; ++z)
+    for (int y = 0; y < 8; ++y)
+      for (int x = 0; x < 8; ++x)
+        cloud.push_back (PointXYZ (static_cast<float> (x), static_cast<float> (y), static_cast<float> (z)));
+  cloud[10].x = std::numeric_limits<float>::quiet_NaN ();
+  cloud[3].z = std::numeric_limits<float>::quiet_NaN ();
+
+  std::vector<int> order;
+  computeMortonOrder (cloud, order);
+  ASSERT_EQ (order.size (), cloud.size ());
+
+  std::vector<int> sorted_order = order;
+  std::sort (sorted_order.begin (), sorted_order.end ());
+  for (size_t i = 0; i < sorted_order.size (); ++i)
+    EXPECT_EQ (sorted_order[i], static_cast<int> (i));
+
+  // The first 8 points form the 2x2x2 cube at the origin, the non finite points are last
+  for (size_t i = 0; i < 8; ++i)
+  {
+    EXPECT_LE (cloud[order[i]].x, 1.0f);
+    EXPECT_LE (cloud[order[i]].y, 1.0f);
+    EXPECT_LE (cloud[order[i]].z, 1.0f);
+  }
+  EXPECT_EQ (order[order.size () - 2], 3);
+  EXPECT_EQ (order[order.size () - 1], 10);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, reorderPointCloud)
+{
+  PointCloud<PointXYZ> cloud (64, 48);
+  for (size_t i = 0; i < cloud.size (); ++i)
+    cloud[i] = PointXYZ (static_cast<float> (rand ()) / RAND_MAX, static_cast<float> (rand ()) / RAND_MAX,
+                         static_cast<float> (rand ()) / RAND_MAX);
+
+  PointCloud<PointXYZ> reordered;
+  std::vector<int> order;
+  reorderPointCloud (cloud, reordered, order);
+  ASSERT_EQ (reordered.size (), cloud.size ());
+  EXPECT_EQ (reordered.height, 1u);
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (reordered[i].x, cloud[order[i]].x);
+    EXPECT_EQ (reordered[i].y, cloud[order[i]].y);
+    EXPECT_EQ (reordered[i].z, cloud[order[i]].z);
+  }
+
+  // In place
+  PointCloud<PointXYZ> in_place = cloud;
+  reorderPointCloud (in_place, in_place, order);
+  for (size_t i = 0; i < cloud.size (); ++i)
+    EXPECT_EQ (in_place[i].x, reordered[i].x);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
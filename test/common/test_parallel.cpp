@@ -0,0 +1,162 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/common/parallel.h>
+#include <vector>
+
+using namespace pcl;
+
+struct SquareBody
+{
+  SquareBody (std::vector<int> &values) : values_ (values) {}
+
+  void
+  operator () (int begin, int end) const
+  {
+    for (int i = begin; i < end; ++i)
+      values_[i] = i * i;
+  }
+
+  std::vector<int> &values_;
+};
+
+struct InverseSumBody
+{
+  double
+  operator () (int begin, int end) const
+  {
+    double sum = 0.0;
+    for (int i = begin; i < end; ++i)
+      sum += 1.0 / (1.0 + i);
+    return (sum);
+  }
+};
+
+struct Sum
+{
+  double
+  operator () (double a, double b) const { return (a + b); }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ParallelFor)
+{
+  for (int grain_size = 0; grain_size < 40; grain_size += 7)
+  {
+    std::vector<int> values (1001, -1);
+    parallel::parallel_for (1, 1000, SquareBody (values), grain_size);
+    EXPECT_EQ (-1, values[0]);
+    EXPECT_EQ (-1, values[1000]);
+    for (int i = 1; i < 1000; ++i)
+      EXPECT_EQ (i * i, values[i]);
+  }
+
+  // Empty range
+  std::vector<int> values (10, -1);
+  parallel::parallel_for (5, 5, SquareBody (values));
+  for (size_t i = 0; i < values.size (); ++i)
+    EXPECT_EQ (-1, values[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ParallelReduce)
+{
+  const int n = 100000;
+  double expected = 0.0;
+  for (int i = 0; i < n; ++i)
+    expected += 1.0 / (1.0 + i);
+
+  const double sum = parallel::parallel_reduce (0, n, 0.0, InverseSumBody (), Sum ());
+  EXPECT_NEAR (expected, sum, 1e-9);
+
+  // The result does not depend on the number of threads
+  for (unsigned int nr_threads = 1; nr_threads <= 4; ++nr_threads)
+    EXPECT_EQ (sum, parallel::parallel_reduce (0, n, 0.0, InverseSumBody (), Sum (), 0, nr_threads));
+
+  EXPECT_EQ (2.0, parallel::parallel_reduce (3, 3, 2.0, InverseSumBody (), Sum ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ParallelThreadBudget)
+{
+  const unsigned int max_threads = parallel::getMaxThreads ();
+  EXPECT_GE (max_threads, 1u);
+
+  // Without OpenMP everything runs in the calling thread
+  parallel::setMaxThreads (2);
+  EXPECT_LE (parallel::getMaxThreads (), 2u);
+  EXPECT_EQ (parallel::getMaxThreads (), parallel::getNumberOfThreads ());
+  EXPECT_EQ (parallel::getMaxThreads (), parallel::getNumberOfThreads (8));
+  EXPECT_EQ (1u, parallel::getNumberOfThreads (1));
+
+#ifdef _OPENMP
+  // Nested regions run in the calling thread
+  unsigned int nested_threads = 0;
+#pragma omp parallel num_threads(2)
+  {
+#pragma omp master
+    nested_threads = parallel::getNumberOfThreads ();
+  }
+  EXPECT_EQ (1u, nested_threads);
+
+  // The regions running at the same time share the budget, each one gets at least the calling thread
+  parallel::setMaxThreads (4);
+  {
+    const parallel::ThreadReservation first (3);
+    EXPECT_EQ (3u, first.getNumberOfThreads ());
+    const parallel::ThreadReservation second;
+    EXPECT_EQ (1u, second.getNumberOfThreads ());
+    const parallel::ThreadReservation third;
+    EXPECT_EQ (1u, third.getNumberOfThreads ());
+  }
+  const parallel::ThreadReservation after;
+  EXPECT_EQ (4u, after.getNumberOfThreads ());
+#endif
+
+  parallel::setMaxThreads (0);
+  EXPECT_GE (parallel::getMaxThreads (), 1u);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
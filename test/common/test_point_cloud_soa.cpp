@@ -0,0 +1,185 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_cloud_soa.h>
+#include <pcl/pcl_tests.h>
+#include <pcl/common/centroid.h>
+#include <pcl/common/transforms.h>
+
+using namespace pcl;
+
+PointCloud<PointXYZRGBNormal> cloud;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudSoA, Conversion)
+{
+  PointCloudSoA cloud_soa;
+  toPointCloudSoA (cloud, cloud_soa);
+  ASSERT_EQ (cloud.size (), cloud_soa.size ());
+  EXPECT_EQ (cloud.width, cloud_soa.width);
+  EXPECT_EQ (cloud.height, cloud_soa.height);
+  EXPECT_TRUE (cloud_soa.hasNormals ());
+  EXPECT_TRUE (cloud_soa.hasColor ());
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (cloud[i].x, cloud_soa.x[i]);
+    EXPECT_EQ (cloud[i].normal_z, cloud_soa.normal_z[i]);
+    EXPECT_EQ (cloud[i].rgba, cloud_soa.rgba[i]);
+  }
+
+  PointCloud<PointXYZRGBNormal> cloud_back;
+  fromPointCloudSoA (cloud_soa, cloud_back);
+  ASSERT_EQ (cloud.size (), cloud_back.size ());
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_XYZ_EQ (cloud[i], cloud_back[i]);
+    EXPECT_NORMAL_EQ (cloud[i], cloud_back[i]);
+    EXPECT_RGBA_EQ (cloud[i], cloud_back[i]);
+  }
+
+  // Point types without normals or color only produce the xyz streams
+  PointCloud<PointXYZ> cloud_xyz;
+  fromPointCloudSoA (cloud_soa, cloud_xyz);
+  PointCloudSoA cloud_xyz_soa;
+  toPointCloudSoA (cloud_xyz, cloud_xyz_soa);
+  EXPECT_FALSE (cloud_xyz_soa.hasNormals ());
+  EXPECT_FALSE (cloud_xyz_soa.hasColor ());
+  EXPECT_EQ (cloud.size (), cloud_xyz_soa.size ());
+
+  // Indexed conversion
+  std::vector<int> indices;
+  indices.push_back (5);
+  indices.push_back (2);
+  toPointCloudSoA (cloud, indices, cloud_soa);
+  ASSERT_EQ (2, cloud_soa.size ());
+  EXPECT_EQ (cloud[5].y, cloud_soa.y[0]);
+  EXPECT_EQ (cloud[2].z, cloud_soa.z[1]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudSoA, Transform)
+{
+  Eigen::Affine3f transform = Eigen::Affine3f::Identity ();
+  transform.translate (Eigen::Vector3f (1.0f, -2.0f, 0.5f));
+  transform.rotate (Eigen::AngleAxisf (0.3f, Eigen::Vector3f (1.0f, 2.0f, 3.0f).normalized ()));
+
+  PointCloud<PointXYZRGBNormal> cloud_out;
+  transformPointCloudWithNormals (cloud, cloud_out, transform);
+
+  PointCloudSoA cloud_soa, cloud_soa_out;
+  toPointCloudSoA (cloud, cloud_soa);
+  transformPointCloudWithNormals (cloud_soa, cloud_soa_out, transform);
+  ASSERT_EQ (cloud_out.size (), cloud_soa_out.size ());
+  for (size_t i = 0; i < cloud_out.size (); ++i)
+  {
+    EXPECT_NEAR (cloud_out[i].x, cloud_soa_out.x[i], 1e-5);
+    EXPECT_NEAR (cloud_out[i].y, cloud_soa_out.y[i], 1e-5);
+    EXPECT_NEAR (cloud_out[i].z, cloud_soa_out.z[i], 1e-5);
+    EXPECT_NEAR (cloud_out[i].normal_x, cloud_soa_out.normal_x[i], 1e-5);
+    EXPECT_NEAR (cloud_out[i].normal_y, cloud_soa_out.normal_y[i], 1e-5);
+    EXPECT_NEAR (cloud_out[i].normal_z, cloud_soa_out.normal_z[i], 1e-5);
+    EXPECT_EQ (cloud[i].rgba, cloud_soa_out.rgba[i]);
+  }
+
+  // In place, xyz only
+  transformPointCloud (cloud_soa, cloud_soa, transform);
+  for (size_t i = 0; i < cloud_out.size (); ++i)
+  {
+    EXPECT_NEAR (cloud_out[i].x, cloud_soa.x[i], 1e-5);
+    EXPECT_NEAR (cloud_out[i].y, cloud_soa.y[i], 1e-5);
+    EXPECT_NEAR (cloud_out[i].z, cloud_soa.z[i], 1e-5);
+    EXPECT_EQ (cloud[i].normal_x, cloud_soa.normal_x[i]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudSoA, Centroid)
+{
+  PointCloudSoA cloud_soa;
+  toPointCloudSoA (cloud, cloud_soa);
+
+  Eigen::Vector4f centroid, centroid_soa;
+  EXPECT_EQ (compute3DCentroid (cloud, centroid), compute3DCentroid (cloud_soa, centroid_soa));
+  test::EXPECT_NEAR_VECTORS (centroid, centroid_soa, 1e-5);
+
+  Eigen::Matrix3d covariance, covariance_soa;
+  Eigen::Vector4d mean, mean_soa;
+  EXPECT_EQ (computeMeanAndCovarianceMatrix (cloud, covariance, mean),
+             computeMeanAndCovarianceMatrix (cloud_soa, covariance_soa, mean_soa));
+  test::EXPECT_NEAR_VECTORS (mean, mean_soa, 1e-6);
+  for (int i = 0; i < 9; ++i)
+    EXPECT_NEAR (covariance (i), covariance_soa (i), 1e-6);
+
+  // Invalid points are skipped for non dense clouds
+  cloud_soa.x[3] = std::numeric_limits<float>::quiet_NaN ();
+  cloud_soa.is_dense = false;
+  EXPECT_EQ (cloud.size () - 1, compute3DCentroid (cloud_soa, centroid_soa));
+  EXPECT_EQ (cloud.size () - 1, computeMeanAndCovarianceMatrix (cloud_soa, covariance_soa, mean_soa));
+
+  PointCloudSoA empty;
+  EXPECT_EQ (0, compute3DCentroid (empty, centroid_soa));
+  EXPECT_EQ (0, computeMeanAndCovarianceMatrix (empty, covariance_soa, mean_soa));
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  cloud.width = 4;
+  cloud.height = 3;
+  cloud.points.resize (cloud.width * cloud.height);
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    PointXYZRGBNormal &p = cloud[i];
+    p.x = static_cast<float> (i) * 0.5f;
+    p.y = static_cast<float> (i % 4) - 1.0f;
+    p.z = 3.0f - static_cast<float> (i * i) * 0.1f;
+    Eigen::Vector3f n (static_cast<float> (i), 1.0f, 2.0f);
+    p.getNormalVector3fMap () = n.normalized ();
+    p.r = static_cast<uint8_t> (10 * i);
+    p.g = static_cast<uint8_t> (255 - i);
+    p.b = static_cast<uint8_t> (i);
+    p.a = 255;
+  }
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
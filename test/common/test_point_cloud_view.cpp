@@ -0,0 +1,150 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_cloud_view.h>
+#include <pcl/conversions.h>
+#include <pcl/pcl_tests.h>
+#include <pcl/common/centroid.h>
+
+using namespace pcl;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudView, MatchingLayout)
+{
+  PointCloud<PointXYZ> cloud (4, 3);
+  for (size_t i = 0; i < cloud.size (); ++i)
+    cloud[i] = PointXYZ (static_cast<float> (i), static_cast<float> (2 * i), static_cast<float> (3 * i));
+  cloud.header.frame_id = "frame";
+
+  PCLPointCloud2::Ptr msg (new PCLPointCloud2);
+  toPCLPointCloud2 (cloud, *msg);
+  ASSERT_TRUE (PointCloudView<PointXYZ>::isCompatible (*msg));
+
+  PointCloudView<PointXYZ> view;
+  ASSERT_TRUE (view.setInput (msg));
+  EXPECT_EQ (cloud.width, view.width);
+  EXPECT_EQ (cloud.height, view.height);
+  EXPECT_EQ (cloud.size (), view.size ());
+  EXPECT_TRUE (view.isOrganized ());
+  EXPECT_EQ ("frame", view.header.frame_id);
+  // The view aliases the blob
+  EXPECT_EQ (reinterpret_cast<const PointXYZ*> (&msg->data[0]), view.data ());
+  for (size_t i = 0; i < cloud.size (); ++i)
+    EXPECT_XYZ_EQ (cloud[i], view[i]);
+  EXPECT_XYZ_EQ (cloud (2, 1), view (2, 1));
+  EXPECT_XYZ_EQ (cloud.at (3, 2), view.at (3, 2));
+  EXPECT_THROW (view.at (cloud.size ()), std::out_of_range);
+
+  // The view keeps the blob alive
+  const PCLPointCloud2 *blob = msg.get ();
+  msg.reset ();
+  EXPECT_EQ (reinterpret_cast<const PointXYZ*> (&blob->data[0]), view.data ());
+
+  // Algorithms taking a ConstCloudIterator work on the view
+  Eigen::Vector4f centroid, view_centroid;
+  compute3DCentroid (cloud, centroid);
+  ConstCloudIterator<PointXYZ> it (view);
+  EXPECT_EQ (cloud.size (), compute3DCentroid (it, view_centroid));
+  test::EXPECT_EQ_VECTORS (centroid, view_centroid);
+
+  std::vector<int> indices;
+  indices.push_back (1);
+  indices.push_back (7);
+  compute3DCentroid (cloud, indices, centroid);
+  ConstCloudIterator<PointXYZ> it_indices (view, indices);
+  EXPECT_EQ (indices.size (), compute3DCentroid (it_indices, view_centroid));
+  test::EXPECT_EQ_VECTORS (centroid, view_centroid);
+
+  PointCloud<PointXYZ> copy;
+  view.toPointCloud (copy);
+  ASSERT_EQ (cloud.size (), copy.size ());
+  EXPECT_EQ (cloud.width, copy.width);
+  for (size_t i = 0; i < cloud.size (); ++i)
+    EXPECT_XYZ_EQ (cloud[i], copy[i]);
+
+  view.reset ();
+  EXPECT_TRUE (view.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudView, MismatchingLayout)
+{
+  PointCloud<PointXYZRGB> cloud (5, 1);
+  PCLPointCloud2 msg;
+  toPCLPointCloud2 (cloud, msg);
+
+  // Different point type
+  PointCloudView<PointXYZ> view_xyz;
+  EXPECT_FALSE (view_xyz.setInput (msg));
+  EXPECT_TRUE (view_xyz.empty ());
+
+  // Same point type, but fields at other offsets
+  PointCloudView<PointXYZRGB> view;
+  EXPECT_TRUE (view.setInput (msg));
+  std::swap (msg.fields[0].offset, msg.fields[1].offset);
+  EXPECT_FALSE (view.setInput (msg));
+
+  // Missing field
+  toPCLPointCloud2 (cloud, msg);
+  msg.fields.pop_back ();
+  EXPECT_FALSE (view.setInput (msg));
+
+  // Padded rows
+  toPCLPointCloud2 (cloud, msg);
+  msg.width = 1;
+  msg.height = 5;
+  msg.row_step = 2 * msg.point_step;
+  EXPECT_FALSE (view.setInput (msg));
+
+  // Other byte order than the host
+  toPCLPointCloud2 (cloud, msg);
+  EXPECT_TRUE (view.setInput (msg));
+  msg.is_bigendian = !msg.is_bigendian;
+  EXPECT_FALSE (PointCloudView<PointXYZRGB>::isCompatible (msg));
+  EXPECT_FALSE (view.setInput (msg));
+  EXPECT_TRUE (view.empty ());
+}
+
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
@@ -0,0 +1,210 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/common/profiler.h>
+#include <boost/thread/thread.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace pcl;
+
+void
+profiledFunction (int nr_nested)
+{
+  PCL_PROFILE_SCOPE ("outer");
+  for (int i = 0; i < nr_nested; ++i)
+  {
+    PCL_PROFILE_SCOPE (std::string ("inner"));
+    boost::this_thread::sleep (boost::posix_time::milliseconds (1));
+  }
+}
+
+const profiler::RegionStatistics*
+findRegion (const std::vector<profiler::RegionStatistics> &statistics, const std::string &name)
+{
+  for (size_t i = 0; i < statistics.size (); ++i)
+    if (statistics[i].name == name)
+      return (&statistics[i]);
+  return (NULL);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ProfilerDisabled)
+{
+  profiler::reset ();
+  EXPECT_FALSE (profiler::isEnabled ());
+  profiledFunction (1);
+
+  std::vector<profiler::RegionStatistics> statistics;
+  profiler::getStatistics (statistics);
+  EXPECT_TRUE (statistics.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ProfilerStatistics)
+{
+  profiler::reset ();
+  profiler::setEnabled (true);
+  profiledFunction (3);
+  profiledFunction (2);
+  boost::thread worker (&profiledFunction, 1);
+  worker.join ();
+  profiler::setEnabled (false);
+
+  std::vector<profiler::RegionStatistics> statistics;
+  profiler::getStatistics (statistics);
+  ASSERT_EQ (2u, statistics.size ());
+
+  // Sorted by total time, the outer region includes the inner ones
+  EXPECT_EQ ("outer", statistics[0].name);
+  const profiler::RegionStatistics *outer = findRegion (statistics, "outer");
+  const profiler::RegionStatistics *inner = findRegion (statistics, "inner");
+  ASSERT_TRUE (outer != NULL);
+  ASSERT_TRUE (inner != NULL);
+  EXPECT_EQ (3u, outer->calls);
+  EXPECT_EQ (6u, inner->calls);
+  EXPECT_GE (inner->min, 1.0);
+  EXPECT_LE (inner->min, inner->median);
+  EXPECT_LE (inner->median, inner->percentile_90);
+  EXPECT_LE (inner->percentile_90, inner->percentile_99);
+  EXPECT_LE (inner->percentile_99, inner->max);
+  EXPECT_GE (outer->total, inner->total);
+  EXPECT_NEAR (outer->total, outer->self + inner->total, 1e-6);
+  EXPECT_DOUBLE_EQ (inner->total, inner->self);
+
+  profiler::reset ();
+  profiler::getStatistics (statistics);
+  EXPECT_TRUE (statistics.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ProfilerExport)
+{
+  profiler::reset ();
+  profiler::setEnabled (true);
+  profiledFunction (2);
+  profiler::setEnabled (false);
+
+  const std::string trace_file ("test_profiler_trace.json");
+  ASSERT_TRUE (profiler::saveChromeTrace (trace_file));
+  std::ifstream trace (trace_file.c_str ());
+  std::stringstream trace_content;
+  trace_content << trace.rdbuf ();
+  EXPECT_NE (std::string::npos, trace_content.str ().find ("\"traceEvents\""));
+  EXPECT_NE (std::string::npos, trace_content.str ().find ("\"name\":\"inner\""));
+  EXPECT_NE (std::string::npos, trace_content.str ().find ("\"ph\":\"X\""));
+  trace.close ();
+  remove (trace_file.c_str ());
+
+  const std::string csv_file ("test_profiler.csv");
+  ASSERT_TRUE (profiler::saveCSV (csv_file));
+  std::ifstream csv (csv_file.c_str ());
+  std::string line;
+  std::getline (csv, line);
+  EXPECT_EQ (0u, line.find ("name,calls,total_ms"));
+  std::getline (csv, line);
+  EXPECT_EQ (0u, line.find ("outer,1,"));
+  std::getline (csv, line);
+  EXPECT_EQ (0u, line.find ("inner,2,"));
+  csv.close ();
+  remove (csv_file.c_str ());
+  profiler::reset ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+recordRegions (int nr_regions)
+{
+  for (int i = 0; i < nr_regions; ++i)
+  {
+    PCL_PROFILE_SCOPE ("worker");
+  }
+}
+
+TEST (PCL, ProfilerConcurrentReads)
+{
+  // The statistics can be read while other threads record events
+  profiler::reset ();
+  profiler::setEnabled (true);
+  boost::thread worker_1 (&recordRegions, 20000);
+  boost::thread worker_2 (&recordRegions, 20000);
+  std::vector<profiler::RegionStatistics> statistics;
+  for (int i = 0; i < 20; ++i)
+    profiler::getStatistics (statistics);
+  worker_1.join ();
+  worker_2.join ();
+  profiler::setEnabled (false);
+
+  profiler::getStatistics (statistics);
+  const profiler::RegionStatistics *worker = findRegion (statistics, "worker");
+  ASSERT_TRUE (worker != NULL);
+  EXPECT_EQ (40000u, worker->calls);
+  EXPECT_EQ (0u, profiler::getNumberOfDroppedEvents ());
+  profiler::reset ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ProfilerMaxEvents)
+{
+  profiler::reset ();
+  profiler::setMaxEventsPerThread (10);
+  profiler::setEnabled (true);
+  recordRegions (25);
+  profiler::setEnabled (false);
+
+  std::vector<profiler::RegionStatistics> statistics;
+  profiler::getStatistics (statistics);
+  const profiler::RegionStatistics *worker = findRegion (statistics, "worker");
+  ASSERT_TRUE (worker != NULL);
+  EXPECT_EQ (10u, worker->calls);
+  EXPECT_EQ (15u, profiler::getNumberOfDroppedEvents ());
+
+  profiler::reset ();
+  EXPECT_EQ (0u, profiler::getNumberOfDroppedEvents ());
+  profiler::setMaxEventsPerThread (size_t (1) << 20);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -0,0 +1,97 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/range_image/range_image.h>
+#include <pcl/common/random.h>
+
+using namespace pcl;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, RangeImageCreateFromPointCloudParallel)
+{
+  // A noisy cylinder around the sensor, with overlapping points so that the z-buffer averages and replaces ranges
+  PointCloud<PointXYZ> cloud;
+  common::UniformGenerator<float> angle (-static_cast<float> (M_PI), static_cast<float> (M_PI), 42);
+  common::UniformGenerator<float> height (-1.0f, 1.0f, 43);
+  common::UniformGenerator<float> noise (0.0f, 0.05f, 44);
+  for (int i = 0; i < 50000; ++i)
+  {
+    const float a = angle.run (), r = 5.0f + 2.0f * std::sin (3.0f * a) + noise.run ();
+    cloud.push_back (PointXYZ (r * std::cos (a), r * std::sin (a), height.run ()));
+  }
+  cloud.push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f));
+
+  const int max_no_of_threads = RangeImage::max_no_of_threads;
+  RangeImage serial, parallel;
+  RangeImage::max_no_of_threads = 1;
+  serial.createFromPointCloud (cloud, deg2rad (0.5f), deg2rad (360.0f), deg2rad (180.0f),
+                               Eigen::Affine3f::Identity (), RangeImage::CAMERA_FRAME, 0.02f, 0.0f, 1);
+  RangeImage::max_no_of_threads = 4;
+  parallel.createFromPointCloud (cloud, deg2rad (0.5f), deg2rad (360.0f), deg2rad (180.0f),
+                                 Eigen::Affine3f::Identity (), RangeImage::CAMERA_FRAME, 0.02f, 0.0f, 1);
+  RangeImage::max_no_of_threads = max_no_of_threads;
+
+  ASSERT_EQ (serial.width, parallel.width);
+  ASSERT_EQ (serial.height, parallel.height);
+  int nr_valid = 0;
+  for (size_t i = 0; i < serial.size (); ++i)
+  {
+    if (!pcl_isfinite (serial[i].range))
+    {
+      EXPECT_EQ (serial[i].range, parallel[i].range);
+      continue;
+    }
+    ++nr_valid;
+    EXPECT_EQ (serial[i].range, parallel[i].range);
+    EXPECT_EQ (serial[i].x, parallel[i].x);
+    EXPECT_EQ (serial[i].y, parallel[i].y);
+    EXPECT_EQ (serial[i].z, parallel[i].z);
+    EXPECT_GE (serial[i].range, 3.0f);
+    EXPECT_LE (serial[i].range, 7.3f);
+  }
+  EXPECT_GT (nr_valid, 0);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
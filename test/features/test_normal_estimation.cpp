@@ -213,6 +213,139 @@ TEST (PCL, NormalEstimationOpenMP)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalEstimationBatch)
+{
+  // The batched eigen solver has to give the same normals as computePointNormal for every point
+  PointCloud<PointXYZ>::Ptr cloudptr = cloud.makeShared ();
+  search::KdTree<PointXYZ>::Ptr kdtree (new search::KdTree<PointXYZ> (false));
+  kdtree->setInputCloud (cloudptr);
+
+  NormalEstimation<PointXYZ, Normal> n;
+  n.setInputCloud (cloudptr);
+  n.setSearchMethod (kdtree);
+  n.setKSearch (10);
+  PointCloud<Normal> normals;
+  n.compute (normals);
+  ASSERT_EQ (cloud.size (), normals.size ());
+
+  NormalEstimationOMP<PointXYZ, Normal> n_omp (2);
+  n_omp.setInputCloud (cloudptr);
+  n_omp.setSearchMethod (kdtree);
+  n_omp.setKSearch (10);
+  PointCloud<Normal> normals_omp;
+  n_omp.compute (normals_omp);
+  ASSERT_EQ (cloud.size (), normals_omp.size ());
+  EXPECT_EQ (normals.is_dense, normals_omp.is_dense);
+
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    kdtree->nearestKSearch (cloud[i], 10, nn_indices, nn_dists);
+    Eigen::Vector4f plane_parameters;
+    float curvature;
+    computePointNormal (cloud, nn_indices, plane_parameters, curvature);
+    flipNormalTowardsViewpoint (cloud[i], 0, 0, 0, plane_parameters);
+
+    for (int d = 0; d < 3; ++d)
+    {
+      EXPECT_NEAR (plane_parameters[d], normals[i].normal[d], 1e-4);
+      EXPECT_EQ (normals[i].normal[d], normals_omp[i].normal[d]);
+    }
+    EXPECT_NEAR (curvature, normals[i].curvature, 1e-4);
+    EXPECT_EQ (normals[i].curvature, normals_omp[i].curvature);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// A search giving the same neighbors to every query, whether they are valid or not
+class FixedNeighbors : public search::Search<PointXYZ>
+{
+  public:
+    FixedNeighbors (const std::vector<int> &neighbors) : search::Search<PointXYZ> ("FixedNeighbors"), neighbors_ (neighbors) {}
+
+    int
+    nearestKSearch (const PointXYZ &, int, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+    {
+      k_indices = neighbors_;
+      k_sqr_distances.assign (neighbors_.size (), 0.0f);
+      return (static_cast<int> (neighbors_.size ()));
+    }
+
+    int
+    radiusSearch (const PointXYZ &point, double, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                  unsigned int = 0) const
+    {
+      return (nearestKSearch (point, 0, k_indices, k_sqr_distances));
+    }
+
+  private:
+    std::vector<int> neighbors_;
+};
+
+TEST (PCL, NormalEstimationInvalidNeighborhood)
+{
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  input->push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+  input->push_back (PointXYZ (1.0f, 0.0f, 0.0f));
+
+  // A surface whose first three points are invalid and last three points span the z = 0 plane
+  const float nan = std::numeric_limits<float>::quiet_NaN ();
+  PointCloud<PointXYZ>::Ptr surface (new PointCloud<PointXYZ>);
+  surface->push_back (PointXYZ (nan, 0.0f, 0.0f));
+  surface->push_back (PointXYZ (nan, nan, nan));
+  surface->push_back (PointXYZ (0.0f, nan, 1.0f));
+  surface->push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+  surface->push_back (PointXYZ (1.0f, 0.0f, 0.0f));
+  surface->push_back (PointXYZ (0.0f, 1.0f, 0.0f));
+  surface->is_dense = false;
+
+  NormalEstimation<PointXYZ, Normal> n;
+  n.setInputCloud (input);
+  n.setSearchSurface (surface);
+  n.setKSearch (3);
+
+  // No valid neighbor: NaN normal and curvature, and a non-dense output
+  std::vector<int> invalid_neighbors (3);
+  invalid_neighbors[0] = 0; invalid_neighbors[1] = 1; invalid_neighbors[2] = 2;
+  n.setSearchMethod (search::Search<PointXYZ>::Ptr (new FixedNeighbors (invalid_neighbors)));
+  PointCloud<Normal> normals;
+  n.compute (normals);
+  ASSERT_EQ (input->size (), normals.size ());
+  EXPECT_FALSE (normals.is_dense);
+  for (size_t i = 0; i < normals.size (); ++i)
+  {
+    EXPECT_TRUE (pcl_isnan (normals[i].normal_x));
+    EXPECT_TRUE (pcl_isnan (normals[i].normal_y));
+    EXPECT_TRUE (pcl_isnan (normals[i].normal_z));
+    EXPECT_TRUE (pcl_isnan (normals[i].curvature));
+  }
+
+  NormalEstimationOMP<PointXYZ, Normal> n_omp (2);
+  n_omp.setInputCloud (input);
+  n_omp.setSearchSurface (surface);
+  n_omp.setKSearch (3);
+  n_omp.setSearchMethod (search::Search<PointXYZ>::Ptr (new FixedNeighbors (invalid_neighbors)));
+  PointCloud<Normal> normals_omp;
+  n_omp.compute (normals_omp);
+  EXPECT_FALSE (normals_omp.is_dense);
+
+  // The invalid neighbors are skipped when there are valid ones
+  std::vector<int> mixed_neighbors (invalid_neighbors);
+  mixed_neighbors.push_back (3); mixed_neighbors.push_back (4); mixed_neighbors.push_back (5);
+  n.setSearchMethod (search::Search<PointXYZ>::Ptr (new FixedNeighbors (mixed_neighbors)));
+  n.compute (normals);
+  EXPECT_TRUE (normals.is_dense);
+  for (size_t i = 0; i < normals.size (); ++i)
+  {
+    EXPECT_NEAR (0.0f, normals[i].normal_x, 1e-5);
+    EXPECT_NEAR (0.0f, normals[i].normal_y, 1e-5);
+    EXPECT_NEAR (1.0f, std::abs (normals[i].normal_z), 1e-5);
+    EXPECT_NEAR (0.0f, normals[i].curvature, 1e-5);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
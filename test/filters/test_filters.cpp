@@ -58,6 +58,7 @@
 #include <pcl/filters/median_filter.h>
 #include <pcl/filters/normal_refinement.h>
 
+#include <pcl/search/hash_grid.h>
 #include <pcl/common/transforms.h>
 #include <pcl/common/eigen.h>
 
@@ -1159,6 +1160,19 @@ TEST (RadiusOutlierRemoval, Filters)
   EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].x, -0.077893, 1e-4);
   EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].y, 0.16039, 1e-4);
   EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].z, -0.021299, 1e-4);
+
+  // Same filter with a hash grid sized to the search radius
+  RadiusOutlierRemoval<PointXYZ> outrem_grid;
+  outrem_grid.setSearchMethod (search::HashGrid<PointXYZ>::Ptr (new search::HashGrid<PointXYZ> (0.02)));
+  outrem_grid.setInputCloud (cloud);
+  outrem_grid.setRadiusSearch (0.02);
+  outrem_grid.setMinNeighborsInRadius (14);
+  outrem_grid.filter (cloud_out);
+
+  EXPECT_EQ (int (cloud_out.points.size ()), 307);
+  EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].x, -0.077893, 1e-4);
+  EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].y, 0.16039, 1e-4);
+  EXPECT_NEAR (cloud_out.points[cloud_out.points.size () - 1].z, -0.021299, 1e-4);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2186,6 +2200,42 @@ TEST (MedianFilter, Filters)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RemoveNaNFromPointCloudView, Filters)
+{
+  PointCloud<PointXYZ> cloud (5, 2);
+  for (size_t i = 0; i < cloud.size (); ++i)
+    cloud[i] = PointXYZ (static_cast<float> (i), static_cast<float> (2 * i), static_cast<float> (3 * i));
+  cloud[3].y = std::numeric_limits<float>::quiet_NaN ();
+  cloud[7].z = std::numeric_limits<float>::quiet_NaN ();
+  cloud.is_dense = false;
+  cloud.header.frame_id = "frame";
+
+  PCLPointCloud2 msg;
+  toPCLPointCloud2 (cloud, msg);
+  PointCloudView<PointXYZ> view;
+  ASSERT_TRUE (view.setInput (msg));
+
+  PointCloud<PointXYZ> expected, output;
+  std::vector<int> expected_index, index;
+  removeNaNFromPointCloud (cloud, expected, expected_index);
+  removeNaNFromPointCloud (view, output, index);
+
+  EXPECT_EQ ("frame", output.header.frame_id);
+  EXPECT_EQ (8u, output.width);
+  EXPECT_EQ (1u, output.height);
+  EXPECT_TRUE (output.is_dense);
+  ASSERT_EQ (expected.size (), output.size ());
+  ASSERT_EQ (expected_index.size (), index.size ());
+  for (size_t i = 0; i < output.size (); ++i)
+  {
+    EXPECT_EQ (expected_index[i], index[i]);
+    EXPECT_EQ (expected[i].x, output[i].x);
+    EXPECT_EQ (expected[i].y, output[i].y);
+    EXPECT_EQ (expected[i].z, output[i].z);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 #include <pcl/common/time.h>
 TEST (NormalRefinement, Filters)
@@ -0,0 +1,331 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/compression/octree_pointcloud_compression.h>
+
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+typedef pcl::PointCloud<pcl::PointXYZRGBA> CloudRGBA;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+CloudRGBA::Ptr
+createFrame (int frame)
+{
+  // a noisy surface with a moving patch, so that the prediction frames change the tree structure
+  CloudRGBA::Ptr cloud (new CloudRGBA);
+  srand (frame + 1);
+  for (int i = 0; i < 120; ++i)
+    for (int j = 0; j < 120; ++j)
+    {
+      pcl::PointXYZRGBA p;
+      p.x = static_cast<float> (i) * 0.01f + static_cast<float> (rand ()) / static_cast<float> (RAND_MAX) * 0.004f;
+      p.y = static_cast<float> (j) * 0.01f;
+      p.z = 0.2f * sinf (static_cast<float> (i + j) * 0.05f);
+      if (i > 20 + 10 * frame && i < 50 + 10 * frame && j > 40 && j < 70)
+        p.z += 0.3f;
+      p.r = static_cast<uint8_t> (2 * i);
+      p.g = static_cast<uint8_t> (2 * j);
+      p.b = static_cast<uint8_t> (rand () & 0xFF);
+      p.a = 255;
+      cloud->push_back (p);
+    }
+  return (cloud);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+expectEqualClouds (const CloudRGBA &a, const CloudRGBA &b)
+{
+  ASSERT_EQ (a.size (), b.size ());
+  for (size_t i = 0; i < a.size (); ++i)
+  {
+    EXPECT_EQ (a[i].x, b[i].x);
+    EXPECT_EQ (a[i].y, b[i].y);
+    EXPECT_EQ (a[i].z, b[i].z);
+    EXPECT_EQ (a[i].rgba, b[i].rgba);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Compression_Subtrees)
+{
+  const pcl::io::compression_Profiles_e profiles[] = {pcl::io::LOW_RES_ONLINE_COMPRESSION_WITH_COLOR,
+                                                      pcl::io::MED_RES_ONLINE_COMPRESSION_WITHOUT_COLOR,
+                                                      pcl::io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR};
+  for (size_t p = 0; p < sizeof (profiles) / sizeof (profiles[0]); ++p)
+  {
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> legacy_encoder (profiles[p]);
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> subtree_encoder (profiles[p]);
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> legacy_decoder, subtree_decoder;
+    subtree_encoder.setSubtreeDepth (3);
+    subtree_encoder.setNumberOfThreads (2);
+    subtree_decoder.setNumberOfThreads (2);
+
+    std::stringstream legacy_stream, subtree_stream;
+    for (int frame = 0; frame < 4; ++frame)
+    {
+      CloudRGBA::Ptr cloud = createFrame (frame);
+      legacy_encoder.encodePointCloud (cloud, legacy_stream);
+      subtree_encoder.encodePointCloud (cloud, subtree_stream);
+    }
+    EXPECT_TRUE (subtree_encoder.getFrameIndex ()[0].subtree_coded);
+    EXPECT_FALSE (legacy_encoder.getFrameIndex ()[0].subtree_coded);
+    EXPECT_FALSE (subtree_encoder.getFrameIndex ()[1].i_frame);
+
+    // the subtree coding keeps the decoded points and their order
+    for (int frame = 0; frame < 4; ++frame)
+    {
+      CloudRGBA::Ptr legacy_cloud (new CloudRGBA), subtree_cloud (new CloudRGBA);
+      legacy_decoder.decodePointCloud (legacy_stream, legacy_cloud);
+      subtree_decoder.decodePointCloud (subtree_stream, subtree_cloud);
+      EXPECT_GT (legacy_cloud->size (), 1000u);
+      expectEqualClouds (*legacy_cloud, *subtree_cloud);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Compression_Region)
+{
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> encoder (pcl::io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> decoder, region_decoder;
+  encoder.setSubtreeDepth (4);
+
+  std::stringstream stream;
+  for (int frame = 0; frame < 3; ++frame)
+    encoder.encodePointCloud (createFrame (frame), stream);
+
+  const Eigen::Vector3f min_pt (0.3f, 0.2f, -1.0f), max_pt (0.6f, 0.5f, 1.0f);
+  for (int frame = 0; frame < 3; ++frame)
+  {
+    CloudRGBA::Ptr cloud (new CloudRGBA), region_cloud (new CloudRGBA);
+    decoder.decodePointCloud (stream, cloud);
+    stream.seekg (encoder.getFrameIndex ()[frame].offset);
+    region_decoder.decodePointCloud (stream, region_cloud, min_pt, max_pt);
+    ASSERT_LT (region_cloud->size (), cloud->size ());
+
+    // the region holds the points of the decoded subtrees, in the order of the complete frame
+    size_t j = 0, inside = 0;
+    for (size_t i = 0; i < cloud->size (); ++i)
+    {
+      const pcl::PointXYZRGBA &p = (*cloud)[i];
+      const bool in_region = p.x >= min_pt[0] && p.x <= max_pt[0] && p.y >= min_pt[1] && p.y <= max_pt[1];
+      inside += in_region;
+      if (j < region_cloud->size () && (*region_cloud)[j].x == p.x && (*region_cloud)[j].y == p.y &&
+          (*region_cloud)[j].z == p.z && (*region_cloud)[j].rgba == p.rgba)
+        ++j;
+      else
+        EXPECT_FALSE (in_region);
+    }
+    EXPECT_EQ (region_cloud->size (), j);
+    EXPECT_GT (inside, 0u);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Compression_Frame_Index)
+{
+  // short intra frame period, so that the index has several random access points
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> encoder (pcl::io::MANUAL_CONFIGURATION, false, 0.001,
+                                                                   0.01, false, 2, true, 6);
+  encoder.setSubtreeDepth (2);
+
+  std::stringstream stream;
+  for (int frame = 0; frame < 6; ++frame)
+    encoder.encodePointCloud (createFrame (frame), stream);
+  encoder.writeFrameIndex (stream);
+
+  std::vector<pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA>::FrameIndexEntry> index;
+  ASSERT_TRUE ((pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA>::readFrameIndex (stream, index)));
+  ASSERT_EQ (encoder.getFrameIndex ().size (), index.size ());
+  EXPECT_EQ (0, stream.tellg ());
+  for (size_t i = 0; i < index.size (); ++i)
+  {
+    EXPECT_EQ (encoder.getFrameIndex ()[i].frame_ID, index[i].frame_ID);
+    EXPECT_EQ (encoder.getFrameIndex ()[i].i_frame, index[i].i_frame);
+    EXPECT_EQ (encoder.getFrameIndex ()[i].offset, index[i].offset);
+    EXPECT_EQ (encoder.getFrameIndex ()[i].size, index[i].size);
+  }
+
+  // last intra frame
+  size_t seek_frame = index.size () - 1;
+  while (seek_frame > 0 && !index[seek_frame].i_frame)
+    --seek_frame;
+  ASSERT_GT (seek_frame, 0u);
+
+  // decode the stream sequentially, the index at its end is skipped
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> decoder;
+  std::vector<CloudRGBA::Ptr> clouds;
+  for (size_t i = 0; i < index.size (); ++i)
+  {
+    clouds.push_back (CloudRGBA::Ptr (new CloudRGBA));
+    decoder.decodePointCloud (stream, clouds.back ());
+  }
+  CloudRGBA::Ptr end_cloud (new CloudRGBA);
+  EXPECT_FALSE (decoder.decodePointCloud (stream, end_cloud));
+  EXPECT_TRUE (end_cloud->empty ());
+
+  // seek to an intra frame and decode the following frames
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> seek_decoder;
+  stream.clear ();
+  stream.seekg (index[seek_frame].offset);
+  for (size_t i = seek_frame; i < index.size (); ++i)
+  {
+    CloudRGBA::Ptr cloud (new CloudRGBA);
+    seek_decoder.decodePointCloud (stream, cloud);
+    expectEqualClouds (*clouds[i], *cloud);
+  }
+
+  // streams without index
+  std::stringstream no_index_stream (stream.str ().substr (0, static_cast<size_t> (index.back ().offset + index.back ().size)));
+  EXPECT_FALSE ((pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA>::readFrameIndex (no_index_stream, index)));
+  EXPECT_TRUE (index.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Compression_Corrupted_Frame)
+{
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> encoder (pcl::io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+  encoder.setSubtreeDepth (2);
+  std::stringstream stream;
+  encoder.encodePointCloud (createFrame (0), stream);
+
+  CloudRGBA::Ptr cloud (new CloudRGBA);
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> decoder;
+  EXPECT_TRUE (decoder.decodePointCloud (stream, cloud));
+  EXPECT_FALSE (cloud->empty ());
+
+  // cut the data of the last subtree
+  const std::string data = stream.str ();
+  std::stringstream corrupted_stream (data.substr (0, static_cast<size_t> (encoder.getFrameIndex ()[0].size - 1)));
+
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> corrupted_decoder;
+  EXPECT_FALSE (corrupted_decoder.decodePointCloud (corrupted_stream, cloud));
+  EXPECT_TRUE (cloud->empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename T> void
+expectCorruptedSize (const std::string &data, size_t position, T size)
+{
+  std::string corrupted_data = data;
+  memcpy (&corrupted_data[position], &size, sizeof (size));
+  std::stringstream corrupted_stream (corrupted_data);
+
+  CloudRGBA::Ptr cloud (new CloudRGBA);
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> decoder;
+  EXPECT_FALSE (decoder.decodePointCloud (corrupted_stream, cloud)) << "size at " << position;
+  EXPECT_TRUE (cloud->empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Compression_Corrupted_Sizes)
+{
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> encoder (pcl::io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+  encoder.setSubtreeDepth (2);
+  std::stringstream stream;
+  encoder.encodePointCloud (createFrame (0), stream);
+  const std::string data = stream.str ();
+  const size_t frame_size = static_cast<size_t> (encoder.getFrameIndex ()[0].size);
+
+  // the subtree payload ends the frame and starts with its own size
+  size_t payload = 0;
+  for (size_t i = 0; i + sizeof (uint64_t) <= frame_size && payload == 0; ++i)
+  {
+    uint64_t payload_size;
+    memcpy (&payload_size, &data[i], sizeof (payload_size));
+    if (i + sizeof (payload_size) + payload_size == frame_size)
+      payload = i + sizeof (payload_size);
+  }
+  ASSERT_GT (payload, 0u);
+
+  // the payload header: subtree depth, number of subtrees, number of points, size of the tree structure
+  const size_t chunk_count_position = payload + 1;
+  const size_t structure_size_position = chunk_count_position + sizeof (uint32_t) + sizeof (uint64_t);
+  uint32_t chunk_count;
+  memcpy (&chunk_count, &data[chunk_count_position], sizeof (chunk_count));
+  ASSERT_GT (chunk_count, 1u);
+
+  // the subtree table (key, number of leaves, number of points, data size) is followed by the data of all subtrees
+  const size_t entry_size = 5 * sizeof (uint32_t) + sizeof (uint64_t);
+  size_t table_end = 0;
+  uint64_t last_data_size = 0;
+  for (size_t end = frame_size; end >= structure_size_position + chunk_count * entry_size && table_end == 0; --end)
+  {
+    uint64_t data_size = 0;
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+      memcpy (&last_data_size, &data[end - (chunk_count - i) * entry_size + 5 * sizeof (uint32_t)], sizeof (last_data_size));
+      data_size += last_data_size;
+    }
+    if (end + data_size == frame_size)
+      table_end = end;
+  }
+  ASSERT_GT (table_end, 0u);
+  const size_t last_point_count_position = table_end - entry_size + 4 * sizeof (uint32_t);
+  const size_t last_data_size_position = table_end - sizeof (uint64_t);
+  // the data of a subtree starts with the size of its average color vector
+  const size_t last_color_size_position = frame_size - static_cast<size_t> (last_data_size);
+
+  const uint64_t huge_size = static_cast<uint64_t> (1) << 40;
+  expectCorruptedSize (data, payload - sizeof (uint64_t), huge_size);
+  expectCorruptedSize (data, chunk_count_position, std::numeric_limits<uint32_t>::max ());
+  expectCorruptedSize (data, structure_size_position, huge_size);
+  expectCorruptedSize (data, last_point_count_position, std::numeric_limits<uint32_t>::max ());
+  expectCorruptedSize (data, last_data_size_position, huge_size);
+  expectCorruptedSize (data, last_color_size_position, huge_size);
+  // a plausible but wrong size of the average colors, which would make the decoder read past the end of them
+  uint64_t color_size;
+  memcpy (&color_size, &data[last_color_size_position], sizeof (color_size));
+  expectCorruptedSize (data, last_color_size_position, color_size - 3);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
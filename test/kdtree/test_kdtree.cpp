@@ -39,6 +39,7 @@
 #include <gtest/gtest.h>
 #include <iostream>  // For debug
 #include <map>
+#include <limits>
 #include <pcl/common/time.h>
 #include <pcl/kdtree/kdtree_flann.h>
 #include <pcl/point_cloud.h>
@@ -207,6 +208,154 @@ TEST (PCL, KdTreeFLANN_nearestKSearch)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTreeFLANN_spatialReordering)
+{
+  KdTreeFLANN<MyPoint> kdtree, kdtree_reordered;
+  kdtree.setInputCloud (cloud_big.makeShared ());
+  kdtree_reordered.setSpatialReordering (true);
+  EXPECT_TRUE (kdtree_reordered.getSpatialReordering ());
+  kdtree_reordered.setInputCloud (cloud_big.makeShared ());
+
+  vector<int> k_indices, k_indices_reordered;
+  vector<float> k_distances, k_distances_reordered;
+  for (size_t i = 0; i < cloud_big.points.size (); i += 1000)
+  {
+    kdtree.nearestKSearch (cloud_big.points[i], 10, k_indices, k_distances);
+    kdtree_reordered.nearestKSearch (cloud_big.points[i], 10, k_indices_reordered, k_distances_reordered);
+    ASSERT_EQ (k_indices.size (), k_indices_reordered.size ());
+    for (size_t j = 0; j < k_indices.size (); ++j)
+    {
+      EXPECT_EQ (k_distances[j], k_distances_reordered[j]);
+      EXPECT_EQ (euclideanDistance (cloud_big.points[i], cloud_big.points[k_indices_reordered[j]]),
+                 euclideanDistance (cloud_big.points[i], cloud_big.points[k_indices[j]]));
+    }
+
+    kdtree.radiusSearch (static_cast<int> (i), 20.0, k_indices, k_distances);
+    kdtree_reordered.radiusSearch (static_cast<int> (i), 20.0, k_indices_reordered, k_distances_reordered);
+    sort (k_indices.begin (), k_indices.end ());
+    sort (k_indices_reordered.begin (), k_indices_reordered.end ());
+    EXPECT_TRUE (k_indices == k_indices_reordered);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTreeFLANN_copyVsAliasedCloud)
+{
+  // Without indices the tree is built on the cloud memory, with a full set of indices on a copy of the points
+  boost::shared_ptr<std::vector<int> > all_indices (new std::vector<int> (cloud.points.size ()));
+  for (size_t i = 0; i < all_indices->size (); ++i)
+    (*all_indices)[i] = static_cast<int> (i);
+
+  KdTreeFLANN<MyPoint> kdtree, kdtree_copy;
+  kdtree.setInputCloud (cloud.makeShared ());
+  kdtree_copy.setInputCloud (cloud.makeShared (), all_indices);
+
+  vector<int> k_indices, k_indices_copy;
+  vector<float> k_distances, k_distances_copy;
+  for (size_t i = 0; i < cloud.points.size (); i += 7)
+  {
+    kdtree.nearestKSearch (cloud.points[i], 5, k_indices, k_distances);
+    kdtree_copy.nearestKSearch (cloud.points[i], 5, k_indices_copy, k_distances_copy);
+    EXPECT_TRUE (k_distances == k_distances_copy);
+
+    kdtree.radiusSearch (cloud.points[i], 0.15, k_indices, k_distances);
+    kdtree_copy.radiusSearch (cloud.points[i], 0.15, k_indices_copy, k_distances_copy);
+    sort (k_indices.begin (), k_indices.end ());
+    sort (k_indices_copy.begin (), k_indices_copy.end ());
+    EXPECT_TRUE (k_indices == k_indices_copy);
+  }
+
+  // Invalid points are left out of the tree
+  PointCloud<MyPoint>::Ptr cloud_nan = cloud.makeShared ();
+  cloud_nan->points[0].x = std::numeric_limits<float>::quiet_NaN ();
+  kdtree.setInputCloud (cloud_nan);
+  kdtree.radiusSearch (cloud.points[0], 0.05, k_indices, k_distances);
+  EXPECT_TRUE (k_indices.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTreeFLANN_saveLoadIndex)
+{
+  const std::string file_name = "test_kdtree_index.flann";
+  PointCloud<MyPoint>::ConstPtr cloud_ptr = cloud_big.makeShared ();
+
+  // A tree built on the cloud memory and a tree on a reordered copy of a subset of the points
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (size_t i = 0; i < cloud_big.points.size (); i += 3)
+    indices->push_back (static_cast<int> (i));
+  for (int reordered = 0; reordered < 2; ++reordered)
+  {
+    boost::shared_ptr<std::vector<int> > tree_indices;
+    if (reordered)
+      tree_indices = indices;
+    KdTreeFLANN<MyPoint> kdtree;
+    kdtree.setSpatialReordering (reordered != 0);
+    kdtree.setInputCloud (cloud_ptr, tree_indices);
+    ASSERT_TRUE (kdtree.saveIndex (file_name));
+
+    KdTreeFLANN<MyPoint> kdtree_loaded;
+    ASSERT_TRUE (kdtree_loaded.loadIndex (file_name, cloud_ptr, tree_indices));
+
+    vector<int> k_indices, k_indices_loaded;
+    vector<float> k_distances, k_distances_loaded;
+    for (size_t i = 0; i < cloud_big.points.size (); i += 1000)
+    {
+      kdtree.nearestKSearch (cloud_big.points[i], 10, k_indices, k_distances);
+      kdtree_loaded.nearestKSearch (cloud_big.points[i], 10, k_indices_loaded, k_distances_loaded);
+      EXPECT_TRUE (k_indices == k_indices_loaded);
+      EXPECT_TRUE (k_distances == k_distances_loaded);
+
+      kdtree.radiusSearch (cloud_big.points[i], 20.0, k_indices, k_distances);
+      kdtree_loaded.radiusSearch (cloud_big.points[i], 20.0, k_indices_loaded, k_distances_loaded);
+      sort (k_indices.begin (), k_indices.end ());
+      sort (k_indices_loaded.begin (), k_indices_loaded.end ());
+      EXPECT_TRUE (k_indices == k_indices_loaded);
+    }
+
+    // The copy of a loaded tree shares its file
+    KdTreeFLANN<MyPoint> kdtree_copy (kdtree_loaded);
+    kdtree_copy.nearestKSearch (cloud_big.points[0], 10, k_indices_loaded, k_distances_loaded);
+    kdtree.nearestKSearch (cloud_big.points[0], 10, k_indices, k_distances);
+    EXPECT_TRUE (k_indices == k_indices_loaded);
+
+    // A loaded tree can be saved again
+    ASSERT_TRUE (kdtree_loaded.saveIndex (file_name));
+    EXPECT_TRUE (KdTreeFLANN<MyPoint> ().loadIndex (file_name, cloud_ptr, tree_indices));
+  }
+
+  // The index is only loaded for the cloud and the indices it was built from
+  KdTreeFLANN<MyPoint> kdtree;
+  EXPECT_FALSE (kdtree.loadIndex (file_name, cloud_ptr));
+  PointCloud<MyPoint>::Ptr cloud_modified = cloud_big.makeShared ();
+  cloud_modified->points[indices->back ()].x += 1.0f;
+  EXPECT_FALSE (kdtree.loadIndex (file_name, cloud_modified, indices));
+  EXPECT_TRUE (kdtree.loadIndex (file_name, cloud_ptr, indices));
+
+  // A failed load keeps the current tree
+  vector<int> k_indices, k_indices_kept;
+  vector<float> k_distances, k_distances_kept;
+  kdtree.nearestKSearch (cloud_big.points[(*indices)[10]], 5, k_indices, k_distances);
+  EXPECT_FALSE (kdtree.loadIndex (file_name, cloud_modified, indices));
+  EXPECT_FALSE (kdtree.loadIndex ("does_not_exist.flann", cloud_ptr));
+  EXPECT_TRUE (kdtree.getInputCloud () == cloud_ptr);
+  EXPECT_TRUE (kdtree.getIndices () == indices);
+  kdtree.nearestKSearch (cloud_big.points[(*indices)[10]], 5, k_indices_kept, k_distances_kept);
+  EXPECT_TRUE (k_indices == k_indices_kept);
+  EXPECT_TRUE (k_distances == k_distances_kept);
+  EXPECT_EQ (k_indices_kept[0], (*indices)[10]);
+
+  // Truncated or invalid files are rejected
+  {
+    std::ofstream truncated (file_name.c_str (), std::ios::binary | std::ios::in | std::ios::out);
+    truncated.seekp (0);
+    truncated.write ("PCLXXXXX", 8);
+  }
+  EXPECT_FALSE (kdtree.loadIndex (file_name, cloud_ptr, indices));
+  EXPECT_FALSE (kdtree.loadIndex ("does_not_exist.flann", cloud_ptr, indices));
+  remove (file_name.c_str ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class MyPointRepresentationXY : public PointRepresentation<MyPoint>
 {
@@ -889,6 +889,236 @@ TEST (PCL, Octree_Pointcloud_Density_Test)
         ASSERT_EQ(octreeB.getVoxelDensityAtPoint (PointXYZ(x, y, z)), 1u);
 }
 
+TEST (PCL, Octree_Pointcloud_Bulk_Build_Test)
+{
+  const unsigned int test_runs = 10;
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  for (unsigned int test_id = 0; test_id < test_runs; test_id++)
+  {
+    // instantiate point cloud with a few invalid points
+    PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+    const size_t pointCount = 1 + rand () % 5000;
+    for (size_t i = 0; i < pointCount; i++)
+    {
+      if (rand () % 50 == 0)
+        cloudIn->push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f));
+      else
+        cloudIn->push_back (PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX - 5.0),
+                                      static_cast<float> (20.0 * rand () / RAND_MAX),
+                                      static_cast<float> (3.0 * rand () / RAND_MAX)));
+    }
+
+    const double resolution = 0.05 + 0.5 * rand () / RAND_MAX;
+
+    // bulk build, a second call adds the points again to the non empty octree
+    OctreePointCloudSearch<PointXYZ> octreeA (resolution);
+    octreeA.setInputCloud (cloudIn);
+    octreeA.addPointsFromInputCloud ();
+    octreeA.addPointsFromInputCloud ();
+
+    // point by point build
+    OctreePointCloudSearch<PointXYZ> octreeB (resolution);
+    octreeB.setInputCloud (cloudIn);
+    for (unsigned int run = 0; run < 2; run++)
+      for (size_t i = 0; i < pointCount; i++)
+        if (isFinite (cloudIn->points[i]))
+          octreeB.addPointFromCloud (static_cast<int> (i), IndicesPtr ());
+
+    ASSERT_EQ (octreeB.getTreeDepth (), octreeA.getTreeDepth ());
+    ASSERT_EQ (octreeB.getLeafCount (), octreeA.getLeafCount ());
+    ASSERT_EQ (octreeB.getBranchCount (), octreeA.getBranchCount ());
+
+    double minA[3], maxA[3], minB[3], maxB[3];
+    octreeA.getBoundingBox (minA[0], minA[1], minA[2], maxA[0], maxA[1], maxA[2]);
+    octreeB.getBoundingBox (minB[0], minB[1], minB[2], maxB[0], maxB[1], maxB[2]);
+    for (int d = 0; d < 3; d++)
+    {
+      ASSERT_EQ (minB[d], minA[d]);
+      ASSERT_EQ (maxB[d], maxA[d]);
+    }
+
+    // both octrees hold the same indices in the same order
+    OctreePointCloudSearch<PointXYZ>::LeafNodeIterator itA = octreeA.leaf_begin ();
+    OctreePointCloudSearch<PointXYZ>::LeafNodeIterator itB = octreeB.leaf_begin ();
+    for (; itB != octreeB.leaf_end (); ++itA, ++itB)
+    {
+      ASSERT_TRUE (itA != octreeA.leaf_end ());
+      ASSERT_TRUE (itA.getCurrentOctreeKey () == itB.getCurrentOctreeKey ());
+
+      std::vector<int> indicesA, indicesB;
+      itA.getLeafContainer ().getPointIndices (indicesA);
+      itB.getLeafContainer ().getPointIndices (indicesB);
+      ASSERT_EQ (indicesB, indicesA);
+    }
+    ASSERT_FALSE (itA != octreeA.leaf_end ());
+
+    // voxel centroids
+    OctreePointCloudVoxelCentroid<PointXYZ> centroidsA (resolution);
+    centroidsA.setInputCloud (cloudIn);
+    centroidsA.addPointsFromInputCloud ();
+
+    OctreePointCloudVoxelCentroid<PointXYZ> centroidsB (resolution);
+    centroidsB.setInputCloud (cloudIn);
+    for (size_t i = 0; i < pointCount; i++)
+      if (isFinite (cloudIn->points[i]))
+        centroidsB.addPointFromCloud (static_cast<int> (i), IndicesPtr ());
+
+    OctreePointCloudVoxelCentroid<PointXYZ>::AlignedPointTVector voxelCentroidsA, voxelCentroidsB;
+    ASSERT_EQ (centroidsB.getVoxelCentroids (voxelCentroidsB), centroidsA.getVoxelCentroids (voxelCentroidsA));
+    for (size_t i = 0; i < voxelCentroidsB.size (); i++)
+    {
+      ASSERT_EQ (voxelCentroidsB[i].x, voxelCentroidsA[i].x);
+      ASSERT_EQ (voxelCentroidsB[i].y, voxelCentroidsA[i].y);
+      ASSERT_EQ (voxelCentroidsB[i].z, voxelCentroidsA[i].z);
+    }
+  }
+}
+
+// octree overriding addPointIdx only, as octrees written before the bulk build do
+class CountingOctree : public OctreePointCloudSearch<PointXYZ>
+{
+  public:
+    CountingOctree (const double resolution) : OctreePointCloudSearch<PointXYZ> (resolution), added_points_ (0) {}
+
+    size_t added_points_;
+
+  protected:
+    virtual void
+    addPointIdx (const int point_idx_arg)
+    {
+      ++added_points_;
+      OctreePointCloudSearch<PointXYZ>::addPointIdx (point_idx_arg);
+    }
+};
+
+TEST (PCL, Octree_Pointcloud_Bulk_Build_Disabled_Test)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  for (size_t i = 0; i < 1000; i++)
+    cloudIn->push_back (PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX)));
+
+  // the bulk build bypasses addPointIdx
+  CountingOctree octreeA (0.5);
+  ASSERT_TRUE (octreeA.getBulkBuild ());
+  octreeA.setInputCloud (cloudIn);
+  octreeA.addPointsFromInputCloud ();
+  EXPECT_EQ (0u, octreeA.added_points_);
+
+  // without it every point goes through addPointIdx, and the octree is the same
+  CountingOctree octreeB (0.5);
+  octreeB.setBulkBuild (false);
+  ASSERT_FALSE (octreeB.getBulkBuild ());
+  octreeB.setInputCloud (cloudIn);
+  octreeB.addPointsFromInputCloud ();
+  EXPECT_EQ (cloudIn->points.size (), octreeB.added_points_);
+  ASSERT_EQ (octreeA.getLeafCount (), octreeB.getLeafCount ());
+  ASSERT_EQ (octreeA.getBranchCount (), octreeB.getBranchCount ());
+}
+
+template<typename OctreeT> void
+expectSameLeaves (OctreeT& octreeA, OctreeT& octreeB)
+{
+  ASSERT_EQ (octreeA.getLeafCount (), octreeB.getLeafCount ());
+  ASSERT_EQ (octreeA.getBranchCount (), octreeB.getBranchCount ());
+
+  typename OctreeT::LeafNodeIterator itA = octreeA.leaf_begin ();
+  typename OctreeT::LeafNodeIterator itB = octreeB.leaf_begin ();
+  for (; itB != octreeB.leaf_end (); ++itA, ++itB)
+  {
+    ASSERT_TRUE (itA != octreeA.leaf_end ());
+    ASSERT_TRUE (itA.getCurrentOctreeKey () == itB.getCurrentOctreeKey ());
+    ASSERT_EQ (itA.getCurrentOctreeDepth (), itB.getCurrentOctreeDepth ());
+
+    std::vector<int> indicesA, indicesB;
+    itA.getLeafContainer ().getPointIndices (indicesA);
+    itB.getLeafContainer ().getPointIndices (indicesB);
+    ASSERT_EQ (indicesA, indicesB);
+  }
+  ASSERT_FALSE (itA != octreeA.leaf_end ());
+}
+
+TEST (PCL, Octree_Pointcloud_Node_Arena_Test)
+{
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  for (size_t i = 0; i < 3000; i++)
+    cloudIn->push_back (PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX)));
+
+  // heap allocated nodes
+  OctreePointCloudSearch<PointXYZ> octreeA (0.25);
+  octreeA.setInputCloud (cloudIn);
+  octreeA.addPointsFromInputCloud ();
+
+  // arena allocated nodes
+  OctreePointCloudSearch<PointXYZ> octreeB (0.25);
+  octreeB.setUseNodeArena (true);
+  ASSERT_TRUE (octreeB.getUseNodeArena ());
+  octreeB.setInputCloud (cloudIn);
+  octreeB.addPointsFromInputCloud ();
+
+  expectSameLeaves (octreeA, octreeB);
+
+  std::vector<int> indicesA, indicesB;
+  std::vector<float> distancesA, distancesB;
+  for (size_t i = 0; i < 100; i++)
+  {
+    const PointXYZ& query = cloudIn->points[rand () % cloudIn->points.size ()];
+    octreeA.radiusSearch (query, 1.0, indicesA, distancesA);
+    octreeB.radiusSearch (query, 1.0, indicesB, distancesB);
+    ASSERT_EQ (indicesA, indicesB);
+  }
+
+  // removed nodes are recycled
+  for (size_t i = 0; i < cloudIn->points.size (); i += 2)
+  {
+    octreeA.deleteVoxelAtPoint (cloudIn->points[i]);
+    octreeB.deleteVoxelAtPoint (cloudIn->points[i]);
+  }
+  expectSameLeaves (octreeA, octreeB);
+
+  octreeA.addPointsFromInputCloud ();
+  octreeB.addPointsFromInputCloud ();
+  expectSameLeaves (octreeA, octreeB);
+
+  // copies are heap allocated
+  {
+    OctreePointCloudSearch<PointXYZ> octreeC (octreeB);
+    ASSERT_FALSE (octreeC.getUseNodeArena ());
+    expectSameLeaves (octreeB, octreeC);
+  }
+
+  octreeB.deleteTree ();
+  ASSERT_EQ (0u, octreeB.getLeafCount ());
+  ASSERT_EQ (1u, octreeB.getBranchCount ());
+
+  // dynamic depth, point by point insertion
+  octreeA.deleteTree ();
+  octreeA.enableDynamicDepth (8);
+  octreeA.addPointsFromInputCloud ();
+  octreeB.enableDynamicDepth (8);
+  octreeB.addPointsFromInputCloud ();
+  expectSameLeaves (octreeA, octreeB);
+
+  // a filled octree keeps its allocation
+  octreeB.setUseNodeArena (false);
+  ASSERT_TRUE (octreeB.getUseNodeArena ());
+  expectSameLeaves (octreeA, octreeB);
+
+  // back to the heap
+  octreeB.deleteTree ();
+  octreeB.setUseNodeArena (false);
+  ASSERT_FALSE (octreeB.getUseNodeArena ());
+  octreeB.addPointsFromInputCloud ();
+  expectSameLeaves (octreeA, octreeB);
+}
+
 TEST (PCL, Octree_Pointcloud_Iterator_Test)
 {
   // instantiate point cloud and fill it with point data
@@ -1620,6 +1850,91 @@ TEST (PCL, Octree_Pointcloud_Ray_Traversal)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Batched_Ray_Traversal)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  for (int i = 0; i < 2000; ++i)
+    cloudIn->push_back (PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX)));
+
+  octree::OctreePointCloudSearch<PointXYZ> octree_search (0.5f);
+  octree_search.setInputCloud (cloudIn);
+  octree_search.addPointsFromInputCloud ();
+
+  std::vector<Eigen::Vector3f> origins, directions;
+  for (int i = 0; i < 500; ++i)
+  {
+    origins.push_back (Eigen::Vector3f (static_cast<float> (14.0 * rand () / RAND_MAX - 2.0),
+                                        static_cast<float> (14.0 * rand () / RAND_MAX - 2.0),
+                                        static_cast<float> (14.0 * rand () / RAND_MAX - 2.0)));
+    directions.push_back (Eigen::Vector3f (static_cast<float> (2.0 * rand () / RAND_MAX - 1.0),
+                                           static_cast<float> (2.0 * rand () / RAND_MAX - 1.0),
+                                           static_cast<float> (2.0 * rand () / RAND_MAX - 1.0)));
+  }
+  origins.push_back (Eigen::Vector3f (5.0f, 5.0f, 5.0f));
+  directions.push_back (Eigen::Vector3f::Zero ());
+  origins.push_back (Eigen::Vector3f (std::numeric_limits<float>::quiet_NaN (), 5.0f, 5.0f));
+  directions.push_back (Eigen::Vector3f::UnitX ());
+
+  // the packets give the same voxels in the same order as the single ray traversal
+  std::vector<pcl::PointCloud<pcl::PointXYZ>::VectorType> voxel_center_lists;
+  std::vector<std::vector<int> > k_indices, k_indices_single_thread;
+  octree_search.getIntersectedVoxelCenters (origins, directions, voxel_center_lists);
+  octree_search.getIntersectedVoxelIndices (origins, directions, k_indices);
+  octree_search.getIntersectedVoxelIndices (origins, directions, k_indices_single_thread, 0, 0.0f, 1);
+  ASSERT_EQ (voxel_center_lists.size (), origins.size ());
+  ASSERT_EQ (k_indices.size (), origins.size ());
+  EXPECT_TRUE (voxel_center_lists[500].empty () && voxel_center_lists[501].empty ());
+  EXPECT_TRUE (k_indices == k_indices_single_thread);
+
+  pcl::PointCloud<pcl::PointXYZ>::VectorType voxelsInRay;
+  std::vector<int> indicesInRay;
+  for (std::size_t i = 0; i < 500; ++i)
+  {
+    octree_search.getIntersectedVoxelCenters (origins[i], directions[i], voxelsInRay);
+    octree_search.getIntersectedVoxelIndices (origins[i], directions[i], indicesInRay);
+
+    ASSERT_EQ (voxel_center_lists[i].size (), voxelsInRay.size ());
+    for (std::size_t j = 0; j < voxelsInRay.size (); ++j)
+      EXPECT_EQ (voxel_center_lists[i][j].getVector3fMap (), voxelsInRay[j].getVector3fMap ());
+    EXPECT_TRUE (k_indices[i] == indicesInRay);
+  }
+
+  // first hit
+  octree_search.getIntersectedVoxelCenters (origins, directions, voxel_center_lists, 1);
+  for (std::size_t i = 0; i < 500; ++i)
+  {
+    octree_search.getIntersectedVoxelCenters (origins[i], directions[i], voxelsInRay, 1);
+    ASSERT_EQ (voxel_center_lists[i].size (), voxelsInRay.size ());
+    if (!voxelsInRay.empty ())
+      EXPECT_EQ (voxel_center_lists[i][0].getVector3fMap (), voxelsInRay[0].getVector3fMap ());
+  }
+
+  // the voxels within the maximum range are a prefix of the voxels along the unlimited ray
+  const float max_range = 4.0f;
+  const float half_diagonal = 0.5f * std::sqrt (3.0f) * 0.5f;
+  octree_search.getIntersectedVoxelCenters (origins, directions, voxel_center_lists, 0, max_range);
+  for (std::size_t i = 0; i < 500; ++i)
+  {
+    octree_search.getIntersectedVoxelCenters (origins[i], directions[i], voxelsInRay);
+    ASSERT_LE (voxel_center_lists[i].size (), voxelsInRay.size ());
+    for (std::size_t j = 0; j < voxelsInRay.size (); ++j)
+    {
+      const float distance = (voxelsInRay[j].getVector3fMap () - origins[i]).norm ();
+      if (j < voxel_center_lists[i].size ())
+      {
+        EXPECT_EQ (voxel_center_lists[i][j].getVector3fMap (), voxelsInRay[j].getVector3fMap ());
+        EXPECT_LE (distance, max_range + half_diagonal);
+      }
+      else
+      {
+        EXPECT_GT (distance, max_range - half_diagonal);
+      }
+    }
+  }
+}
+
 TEST (PCL, Octree_Pointcloud_Adjacency)
 {
 
@@ -1699,6 +2014,124 @@ TEST (PCL, Octree_Pointcloud_Adjacency)
   }
 
 }
+TEST (PCL, Octree_Pointcloud_Occupancy_Map)
+{
+  const double resolution = 0.1;
+  const Eigen::Vector3f origin (0.05f, 0.05f, 0.05f);
+
+  // wall in front of the sensor
+  PointCloud<PointXYZ> scan;
+  for (float y = -1.0f; y <= 1.0f; y += 0.05f)
+    for (float z = -1.0f; z <= 1.0f; z += 0.05f)
+      scan.push_back (PointXYZ (2.05f, y, z));
+  scan.push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f));
+
+  OctreePointCloudOccupancyMap<PointXYZ> octree (resolution);
+  octree.insertScan (scan, origin);
+
+  float occupancy;
+  ASSERT_TRUE (octree.getOccupancyAtPoint (PointXYZ (2.05f, 0.05f, 0.05f), occupancy));
+  EXPECT_NEAR (occupancy, 0.7f, 1e-5);
+  ASSERT_TRUE (octree.getOccupancyAtPoint (PointXYZ (1.05f, 0.05f, 0.05f), occupancy));
+  EXPECT_NEAR (occupancy, 0.4f, 1e-5);
+  EXPECT_FALSE (octree.getOccupancyAtPoint (PointXYZ (2.55f, 0.05f, 0.05f), occupancy));
+
+  // every voxel a beam passes through is observed
+  for (std::size_t i = 0; i < scan.size () - 1; i += 7)
+  {
+    const Eigen::Vector3f end = scan[i].getVector3fMap ();
+    for (float t = 0.0f; t < 1.0f; t += 0.002f)
+    {
+      PointXYZ sample;
+      sample.getVector3fMap () = origin + (end - origin) * t;
+      EXPECT_TRUE (octree.getOccupancyAtPoint (sample, occupancy));
+    }
+  }
+
+  // leaf bookkeeping matches the tree
+  std::size_t leaf_count = 0;
+  for (OctreePointCloudOccupancyMap<PointXYZ>::LeafNodeIterator it = octree.leaf_begin ();
+       it != octree.leaf_end (); ++it)
+    ++leaf_count;
+  EXPECT_EQ (leaf_count, octree.getLeafCount ());
+
+  // the scan is inserted the same way on any number of threads and by single voxel updates
+  OctreePointCloudOccupancyMap<PointXYZ> octree_single_thread (resolution);
+  octree_single_thread.insertScan (scan, origin, -1.0, 1);
+  EXPECT_EQ (octree.getLeafCount (), octree_single_thread.getLeafCount ());
+  EXPECT_EQ (octree.getBranchCount (), octree_single_thread.getBranchCount ());
+
+  OctreePointCloudOccupancyMap<PointXYZ>::AlignedPointTVector occupied_centers, free_centers;
+  octree.getOccupiedVoxelCenters (occupied_centers);
+  octree.getFreeVoxelCenters (free_centers);
+  EXPECT_FALSE (occupied_centers.empty ());
+  for (std::size_t i = 0; i < occupied_centers.size (); ++i)
+    EXPECT_NEAR (occupied_centers[i].x, 2.05f, resolution);
+  for (std::size_t i = 0; i < scan.size () - 1; ++i)
+  {
+    ASSERT_TRUE (octree.getOccupancyAtPoint (scan[i], occupancy));
+    EXPECT_GT (occupancy, 0.5f);
+  }
+
+  OctreePointCloudOccupancyMap<PointXYZ> octree_voxels (resolution);
+  for (std::size_t i = 0; i < free_centers.size (); ++i)
+    octree_voxels.updateVoxelAtPoint (free_centers[i], false);
+  for (std::size_t i = 0; i < occupied_centers.size (); ++i)
+    octree_voxels.updateVoxelAtPoint (occupied_centers[i], true);
+  EXPECT_EQ (octree.getLeafCount (), octree_voxels.getLeafCount ());
+  for (std::size_t i = 0; i < free_centers.size (); ++i)
+  {
+    ASSERT_TRUE (octree_voxels.getOccupancyAtPoint (free_centers[i], occupancy));
+    EXPECT_NEAR (occupancy, 0.4f, 1e-5);
+  }
+
+  // repeated scans saturate at the clamping thresholds, and the uniform free space is pruned
+  OctreePointCloudOccupancyMap<PointXYZ> octree_unpruned (resolution);
+  octree_unpruned.setPruning (false);
+  for (int i = 0; i < 10; ++i)
+  {
+    octree.insertScan (scan, origin);
+    octree_unpruned.insertScan (scan, origin);
+  }
+  EXPECT_LT (octree.getLeafCount (), octree_unpruned.getLeafCount ());
+
+  leaf_count = 0;
+  for (OctreePointCloudOccupancyMap<PointXYZ>::LeafNodeIterator it = octree.leaf_begin ();
+       it != octree.leaf_end (); ++it)
+    ++leaf_count;
+  EXPECT_EQ (leaf_count, octree.getLeafCount ());
+
+  octree_unpruned.getFreeVoxelCenters (free_centers);
+  for (std::size_t i = 0; i < free_centers.size (); ++i)
+  {
+    ASSERT_TRUE (octree.getOccupancyAtPoint (free_centers[i], occupancy));
+    EXPECT_NEAR (occupancy, octree.getClampingThresholdMin (), 1e-5);
+  }
+  octree_unpruned.getOccupiedVoxelCenters (occupied_centers);
+  for (std::size_t i = 0; i < occupied_centers.size (); ++i)
+  {
+    ASSERT_TRUE (octree.getOccupancyAtPoint (occupied_centers[i], occupancy));
+    EXPECT_NEAR (occupancy, octree.getClampingThresholdMax (), 1e-5);
+  }
+
+  // a hit inside a pruned voxel splits it again
+  const std::size_t pruned_leaf_count = octree.getLeafCount ();
+  octree.updateVoxelAtPoint (PointXYZ (1.05f, 0.05f, 0.05f), true);
+  EXPECT_GT (octree.getLeafCount (), pruned_leaf_count);
+  ASSERT_TRUE (octree.getOccupancyAtPoint (PointXYZ (1.05f, 0.05f, 0.05f), occupancy));
+  EXPECT_GT (occupancy, octree.getClampingThresholdMin ());
+  ASSERT_TRUE (octree.getOccupancyAtPoint (PointXYZ (1.15f, 0.05f, 0.05f), occupancy));
+  EXPECT_NEAR (occupancy, octree.getClampingThresholdMin (), 1e-5);
+
+  // beams beyond the maximum range only clear space
+  OctreePointCloudOccupancyMap<PointXYZ> octree_range (resolution);
+  octree_range.insertScan (scan, origin, 1.0);
+  EXPECT_FALSE (octree_range.getOccupancyAtPoint (PointXYZ (2.05f, 0.05f, 0.05f), occupancy));
+  ASSERT_TRUE (octree_range.getOccupancyAtPoint (PointXYZ (0.95f, 0.05f, 0.05f), occupancy));
+  EXPECT_NEAR (occupancy, 0.4f, 1e-5);
+  EXPECT_EQ (octree_range.getOccupiedVoxelCenters (occupied_centers), 0);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -61,6 +61,7 @@
 #include <pcl/registration/ppf_registration.h>
 #include <pcl/registration/ndt.h>
 #include <pcl/registration/sample_consensus_prerejective.h>
+#include <pcl/search/incremental_kdtree.h>
 // We need Histogram<2> to function, so we'll explicitely add kdtree_flann.hpp here
 #include <pcl/kdtree/impl/kdtree_flann.hpp>
 //(pcl::Histogram<2>)
@@ -199,6 +200,37 @@ TEST (PCL, IterativeClosestPoint)
 //  EXPECT_EQ (transformation (3, 3), 1);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IterativeClosestPoint_IncrementalKdTree)
+{
+  IterativeClosestPoint<PointXYZ, PointXYZ> reg;
+  reg.setInputSource (cloud_source.makeShared ());
+  reg.setInputTarget (cloud_target.makeShared ());
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.setMaxCorrespondenceDistance (0.05);
+  PointCloud<PointXYZ> output_kdtree;
+  reg.align (output_kdtree);
+  const double fitness_kdtree = reg.getFitnessScore ();
+
+  // The correspondences are searched with any search method, here a dynamic kd-tree
+  search::IncrementalKdTree<PointXYZ>::Ptr tree (new search::IncrementalKdTree<PointXYZ>);
+  reg.setSearchMethodTarget (tree);
+  EXPECT_FALSE (reg.getSearchMethodTarget ());
+  PointCloud<PointXYZ> output;
+  reg.align (output);
+  EXPECT_EQ (cloud_target.size (), tree->getInputCloud ()->size ());
+
+  ASSERT_EQ (output_kdtree.size (), output.size ());
+  EXPECT_NEAR (fitness_kdtree, reg.getFitnessScore (), 1e-6);
+  for (size_t i = 0; i < output.size (); ++i)
+  {
+    EXPECT_NEAR (output_kdtree[i].x, output[i].x, 1e-4);
+    EXPECT_NEAR (output_kdtree[i].y, output[i].y, 1e-4);
+    EXPECT_NEAR (output_kdtree[i].z, output[i].z, 1e-4);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void
 sampleRandomTransform (Eigen::Affine3f &trans, float max_angle, float max_trans)
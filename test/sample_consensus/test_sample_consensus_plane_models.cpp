@@ -133,6 +133,33 @@ TEST (SampleConsensusModelPlane, Base)
   ASSERT_EQ (indices_.size (), indices->size ());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelPlane, DistancesSoA)
+{
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+
+  Eigen::VectorXf coeff (4);
+  coeff << plane_coeffs_[0], plane_coeffs_[1], plane_coeffs_[2], 1.0f;
+  coeff /= coeff.head<3> ().norm ();
+
+  std::vector<double> distances;
+  model->getDistancesToModel (coeff, distances);
+
+  // The SoA overload evaluates every point of the given cloud instead of the model indices
+  PointCloudSoA cloud_soa;
+  toPointCloudSoA (*cloud_, indices_, cloud_soa);
+  std::vector<double> distances_soa;
+  model->getDistancesToModelSoA (coeff, cloud_soa, distances_soa);
+
+  ASSERT_EQ (distances.size (), distances_soa.size ());
+  for (size_t i = 0; i < distances.size (); ++i)
+    EXPECT_NEAR (distances[i], distances_soa[i], 1e-5);
+
+  // Invalid models do not produce any distance
+  model->getDistancesToModelSoA (coeff.head<3> (), cloud_soa, distances_soa);
+  EXPECT_TRUE (distances_soa.empty ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelPlane, RANSAC)
 {
@@ -239,6 +266,35 @@ TEST (SampleConsensusModelNormalPlane, RANSAC)
   verifyPlaneSac (model, sac);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelNormalPlane, DistancesSoA)
+{
+  SampleConsensusModelNormalPlanePtr model (new SampleConsensusModelNormalPlane<PointXYZ, Normal> (cloud_));
+  model->setInputNormals (normals_);
+  model->setNormalDistanceWeight (0.01);
+
+  Eigen::VectorXf coeff (4);
+  coeff << plane_coeffs_[0], plane_coeffs_[1], plane_coeffs_[2], 1.0f;
+  coeff /= coeff.head<3> ().norm ();
+
+  PointCloudSoA cloud_soa;
+  toPointCloudSoA (*cloud_, indices_, cloud_soa);
+
+  // The curvature weighted normal distance cannot be computed from a structure of arrays, so the
+  // model must not fall back to the plain point to plane distances of its base class
+  SampleConsensusModel<PointXYZ>::Ptr base_model = model;
+  std::vector<double> distances_soa (1, 0.0);
+  base_model->getDistancesToModelSoA (coeff, cloud_soa, distances_soa);
+  EXPECT_TRUE (distances_soa.empty ());
+
+  SampleConsensusModelNormalParallelPlanePtr parallel_model (
+      new SampleConsensusModelNormalParallelPlane<PointXYZ, Normal> (cloud_));
+  parallel_model->setInputNormals (normals_);
+  distances_soa.assign (1, 0.0);
+  parallel_model->getDistancesToModelSoA (coeff, cloud_soa, distances_soa);
+  EXPECT_TRUE (distances_soa.empty ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelNormalParallelPlane, RANSAC)
 {
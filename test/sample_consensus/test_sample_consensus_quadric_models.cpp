@@ -206,7 +206,34 @@ TEST (SampleConsensusModelNormalSphere, RANSAC)
   EXPECT_NEAR (0.025, coeff_refined[1], 1e-2);
   EXPECT_NEAR (1.000, coeff_refined[2], 1e-2);
   EXPECT_NEAR (0.050, coeff_refined[3], 1e-2);
+
+  // The structure of arrays overload applies the same normal weighting
+  model->setNormalDistanceWeight (0.1);
+  coeff[3] += 0.01f;
+  std::vector<double> distances, distances_soa;
+  model->getDistancesToModel (coeff, distances);
+
+  PointCloudSoA cloud_soa (cloud.size (), true);
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    cloud_soa.x[i] = cloud.points[i].x;
+    cloud_soa.y[i] = cloud.points[i].y;
+    cloud_soa.z[i] = cloud.points[i].z;
+    cloud_soa.normal_x[i] = normals.points[i].normal_x;
+    cloud_soa.normal_y[i] = normals.points[i].normal_y;
+    cloud_soa.normal_z[i] = normals.points[i].normal_z;
+  }
+  model->getDistancesToModelSoA (coeff, cloud_soa, distances_soa);
+  ASSERT_EQ (distances.size (), distances_soa.size ());
+  for (size_t i = 0; i < distances.size (); ++i)
+    EXPECT_NEAR (distances[i], distances_soa[i], 1e-5);
+
+  // Normals are required
+  cloud_soa.resize (cloud.size (), false, false);
+  model->getDistancesToModelSoA (coeff, cloud_soa, distances_soa);
+  EXPECT_TRUE (distances_soa.empty ());
 }
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelCone, RANSAC)
 {
@@ -0,0 +1,171 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/brute_force.h>
+#include <pcl/search/impl/brute_force.hpp>
+
+using namespace pcl;
+
+float
+randomFloat ()
+{
+  return (static_cast<float> (rand ()) / RAND_MAX);
+}
+
+// Compares the results of the tiled search with the ones of the default search, for all the points of queries
+template <typename PointT> void
+compareSearches (const typename PointCloud<PointT>::ConstPtr &cloud,
+                 const boost::shared_ptr<std::vector<int> > &indices,
+                 const PointCloud<PointT> &queries, double radius)
+{
+  search::BruteForce<PointT> reference (true);
+  reference.setInputCloud (cloud, indices);
+  search::BruteForce<PointT> tiled (true);
+  tiled.setInputCloud (cloud, indices);
+  tiled.setTiledSearch (true);
+  EXPECT_TRUE (tiled.getTiledSearch ());
+
+  std::vector<int> k_indices, tiled_indices;
+  std::vector<float> k_sqr_distances, tiled_sqr_distances;
+  for (size_t q = 0; q < queries.size (); ++q)
+  {
+    const int k = 1 + static_cast<int> (q % 12);
+    ASSERT_EQ (reference.nearestKSearch (queries[q], k, k_indices, k_sqr_distances),
+               tiled.nearestKSearch (queries[q], k, tiled_indices, tiled_sqr_distances));
+    for (size_t i = 0; i < k_indices.size (); ++i)
+    {
+      EXPECT_NEAR (k_sqr_distances[i], tiled_sqr_distances[i], 1e-5f * k_sqr_distances[i]);
+      EXPECT_NEAR (k_sqr_distances[i], search::detail::BruteForceCoordinates<PointT>::squaredDistance (
+                                                 cloud->points[tiled_indices[i]], queries[q]),
+                   1e-5f * k_sqr_distances[i]);
+    }
+
+    ASSERT_EQ (reference.radiusSearch (queries[q], radius, k_indices, k_sqr_distances),
+               tiled.radiusSearch (queries[q], radius, tiled_indices, tiled_sqr_distances));
+    for (size_t i = 0; i < k_indices.size (); ++i)
+      EXPECT_NEAR (k_sqr_distances[i], tiled_sqr_distances[i], 1e-5f * k_sqr_distances[i]);
+
+    // max_nn keeps the first neighbors in index order
+    reference.setSortedResults (false);
+    tiled.setSortedResults (false);
+    ASSERT_EQ (reference.radiusSearch (queries[q], radius, k_indices, k_sqr_distances, 5),
+               tiled.radiusSearch (queries[q], radius, tiled_indices, tiled_sqr_distances, 5));
+    EXPECT_EQ (k_indices, tiled_indices);
+    reference.setSortedResults (true);
+    tiled.setSortedResults (true);
+  }
+
+  // The batch searches give the same results as the single ones
+  search::BatchSearchResults results;
+  tiled.nearestKSearch (queries, std::vector<int> (), 7, results, 2);
+  ASSERT_EQ (queries.size (), results.getNumberOfQueries ());
+  for (size_t q = 0; q < queries.size (); ++q)
+  {
+    tiled.nearestKSearch (queries[q], 7, tiled_indices, tiled_sqr_distances);
+    ASSERT_EQ (tiled_indices.size (), results.getNumberOfNeighbors (q));
+    for (size_t i = 0; i < tiled_indices.size (); ++i)
+    {
+      EXPECT_EQ (tiled_indices[i], results.indices[results.offsets[q] + i]);
+      EXPECT_EQ (tiled_sqr_distances[i], results.sqr_distances[results.offsets[q] + i]);
+    }
+  }
+
+  tiled.radiusSearch (queries, std::vector<int> (), radius, results, 0, 2);
+  ASSERT_EQ (queries.size (), results.getNumberOfQueries ());
+  for (size_t q = 0; q < queries.size (); ++q)
+  {
+    tiled.radiusSearch (queries[q], radius, tiled_indices, tiled_sqr_distances);
+    ASSERT_EQ (tiled_indices.size (), results.getNumberOfNeighbors (q));
+    for (size_t i = 0; i < tiled_indices.size (); ++i)
+      EXPECT_EQ (tiled_sqr_distances[i], results.sqr_distances[results.offsets[q] + i]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, BruteForceTiledPoints)
+{
+  srand (3);
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 3000; ++i)
+    cloud->push_back (PointXYZ (randomFloat (), randomFloat (), randomFloat ()));
+  // Invalid points are skipped
+  for (int i = 0; i < 3000; i += 97)
+    cloud->points[i].y = std::numeric_limits<float>::quiet_NaN ();
+  cloud->is_dense = false;
+
+  PointCloud<PointXYZ> queries;
+  for (int i = 0; i < 100; ++i)
+    queries.push_back (PointXYZ (randomFloat (), randomFloat (), randomFloat ()));
+
+  compareSearches<PointXYZ> (cloud, boost::shared_ptr<std::vector<int> > (), queries, 0.1);
+
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = 0; i < 3000; i += 3)
+    indices->push_back (i);
+  compareSearches<PointXYZ> (cloud, indices, queries, 0.15);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, BruteForceTiledHistograms)
+{
+  srand (5);
+  PointCloud<Histogram<33> >::Ptr cloud (new PointCloud<Histogram<33> >);
+  PointCloud<Histogram<33> > queries;
+  for (int i = 0; i < 1100; ++i)
+  {
+    Histogram<33> descriptor;
+    for (int j = 0; j < 33; ++j)
+      descriptor.histogram[j] = randomFloat ();
+    if (i < 1000)
+      cloud->push_back (descriptor);
+    else
+      queries.push_back (descriptor);
+  }
+  compareSearches<Histogram<33> > (cloud, boost::shared_ptr<std::vector<int> > (), queries, 1.5);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -367,6 +367,47 @@ TEST (PCL, FlannSearch_compareToKdTreeFlann)
   delete kdtree_search;
 }
 
+/* Test for FlannSearch batched nearestKSearch and radiusSearch */
+TEST (PCL, FlannSearch_batchSearch)
+{
+  // The tree is built on a subset of the points, so that its indices have to be mapped back to the cloud
+  boost::shared_ptr<vector<int> > tree_indices (new vector<int>);
+  for (int i = 0; i < static_cast<int> (cloud.size ()); i += 2)
+    tree_indices->push_back (i);
+  pcl::search::FlannSearch<PointXYZ> flann_search;
+  flann_search.setInputCloud (cloud.makeShared (), tree_indices);
+
+  vector<int> queries;
+  for (int i = 0; i < static_cast<int> (cloud.size ()); i += 3)
+    queries.push_back (i);
+
+  pcl::search::BatchSearchResults results;
+  vector<int> k_indices;
+  vector<float> k_distances;
+  flann_search.nearestKSearch (cloud, queries, 5, results, 2);
+  ASSERT_EQ (results.getNumberOfQueries (), queries.size ());
+  for (size_t i = 0; i < queries.size (); ++i)
+  {
+    flann_search.nearestKSearch (cloud, queries[i], 5, k_indices, k_distances);
+    ASSERT_EQ (results.getNumberOfNeighbors (i), static_cast<int> (k_indices.size ()));
+    for (size_t j = 0; j < k_indices.size (); ++j)
+    {
+      EXPECT_EQ (results.indices[results.offsets[i] + j], k_indices[j]);
+      EXPECT_EQ (results.sqr_distances[results.offsets[i] + j], k_distances[j]);
+    }
+  }
+
+  flann_search.radiusSearch (cloud, std::vector<int> (), 0.15, results, 4, 2);
+  ASSERT_EQ (results.getNumberOfQueries (), cloud.size ());
+  for (size_t i = 0; i < cloud.size (); ++i)
+  {
+    flann_search.radiusSearch (cloud, static_cast<int> (i), 0.15, k_indices, k_distances, 4);
+    ASSERT_EQ (results.getNumberOfNeighbors (i), static_cast<int> (k_indices.size ()));
+    for (size_t j = 0; j < k_indices.size (); ++j)
+      EXPECT_EQ (results.indices[results.offsets[i] + j], k_indices[j]);
+  }
+}
+
 int
 main (int argc, char** argv)
 {
@@ -0,0 +1,167 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/common/distances.h>
+#include <pcl/search/hash_grid.h>
+#include <algorithm>
+#include <limits>
+
+using namespace pcl;
+
+PointCloud<PointXYZ>::Ptr
+randomCloud (size_t size, float scale)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (size_t i = 0; i < size; ++i)
+    cloud->push_back (PointXYZ (scale * static_cast<float> (rand ()) / RAND_MAX - 0.5f * scale,
+                                scale * static_cast<float> (rand ()) / RAND_MAX,
+                                scale * static_cast<float> (rand ()) / RAND_MAX));
+  return (cloud);
+}
+
+// Brute force neighbors of a query among the given points, sorted by distance
+std::vector<std::pair<float, int> >
+bruteForce (const PointCloud<PointXYZ> &cloud, const std::vector<int> &points, const PointXYZ &query)
+{
+  std::vector<std::pair<float, int> > neighbors;
+  for (size_t i = 0; i < points.size (); ++i)
+    if (pcl_isfinite (cloud[points[i]].x))
+      neighbors.push_back (std::make_pair (squaredEuclideanDistance (cloud[points[i]], query), points[i]));
+  std::sort (neighbors.begin (), neighbors.end ());
+  return (neighbors);
+}
+
+void
+checkSearches (const search::HashGrid<PointXYZ> &grid, const std::vector<int> &points, float scale)
+{
+  const PointCloud<PointXYZ> &cloud = *grid.getInputCloud ();
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  for (int q = 0; q < 50; ++q)
+  {
+    // Queries inside the grid and far away from it
+    const float spread = q < 40 ? 1.0f : 5.0f;
+    const PointXYZ query (spread * scale * static_cast<float> (rand ()) / RAND_MAX - 0.5f * scale,
+                          spread * scale * static_cast<float> (rand ()) / RAND_MAX,
+                          spread * scale * static_cast<float> (rand ()) / RAND_MAX);
+    const std::vector<std::pair<float, int> > truth = bruteForce (cloud, points, query);
+
+    const int k = 1 + q % 20;
+    ASSERT_EQ (std::min (k, static_cast<int> (truth.size ())), grid.nearestKSearch (query, k, k_indices, k_sqr_distances));
+    for (size_t i = 0; i < k_indices.size (); ++i)
+    {
+      EXPECT_FLOAT_EQ (truth[i].first, k_sqr_distances[i]);
+      EXPECT_FLOAT_EQ (truth[i].first, squaredEuclideanDistance (cloud[k_indices[i]], query));
+    }
+
+    // Radii smaller and larger than the cells
+    const double radius = grid.getResolution () * (0.5 + 0.5 * (q % 4));
+    size_t nr_expected = 0;
+    while (nr_expected < truth.size () && truth[nr_expected].first <= radius * radius)
+      ++nr_expected;
+    ASSERT_EQ (nr_expected, static_cast<size_t> (grid.radiusSearch (query, radius, k_indices, k_sqr_distances)));
+    for (size_t i = 0; i < k_indices.size (); ++i)
+    {
+      EXPECT_FLOAT_EQ (truth[i].first, k_sqr_distances[i]);
+      if (i > 0)
+      {
+        EXPECT_LE (k_sqr_distances[i - 1], k_sqr_distances[i]);
+      }
+    }
+
+    // max_nn keeps the closest neighbors
+    grid.radiusSearch (query, radius, k_indices, k_sqr_distances, 3);
+    ASSERT_EQ (std::min<size_t> (nr_expected, 3), k_indices.size ());
+    for (size_t i = 0; i < k_indices.size (); ++i)
+      EXPECT_FLOAT_EQ (truth[i].first, k_sqr_distances[i]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HashGrid)
+{
+  srand (7);
+  PointCloud<PointXYZ>::Ptr cloud = randomCloud (20000, 10.0f);
+  std::vector<int> points (cloud->size ());
+  for (size_t i = 0; i < points.size (); ++i)
+    points[i] = static_cast<int> (i);
+
+  search::HashGrid<PointXYZ> grid (0.3);
+  grid.setInputCloud (cloud);
+  EXPECT_GT (grid.getNumberOfCells (), 1000);
+  checkSearches (grid, points, 10.0f);
+
+  // Cells much smaller than the point spacing
+  grid.setResolution (0.01);
+  grid.setInputCloud (cloud);
+  checkSearches (grid, points, 10.0f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HashGrid_indicesAndInvalidPoints)
+{
+  srand (8);
+  PointCloud<PointXYZ>::Ptr cloud = randomCloud (5000, 5.0f);
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = 0; i < 5000; i += 3)
+    indices->push_back (i);
+  for (int i = 0; i < 5000; i += 7)
+    cloud->points[i].x = std::numeric_limits<float>::quiet_NaN ();
+
+  search::HashGrid<PointXYZ> grid (0.5);
+  grid.setInputCloud (cloud, indices);
+  checkSearches (grid, *indices, 5.0f);
+
+  // Searches on an empty grid find nothing
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  grid.setInputCloud (PointCloud<PointXYZ>::Ptr (new PointCloud<PointXYZ>));
+  EXPECT_EQ (0, grid.nearestKSearch (PointXYZ (0.0f, 0.0f, 0.0f), 5, k_indices, k_sqr_distances));
+  EXPECT_EQ (0, grid.radiusSearch (PointXYZ (0.0f, 0.0f, 0.0f), 1.0, k_indices, k_sqr_distances));
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
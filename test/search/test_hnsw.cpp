@@ -0,0 +1,343 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/hnsw.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+
+using namespace pcl;
+
+typedef search::HNSW<FPFHSignature33> Search;
+
+// Histograms drawn around a few random centers, like the descriptors of a scene with repeated structures
+PointCloud<FPFHSignature33>::Ptr
+randomDescriptors (size_t size, unsigned int seed)
+{
+  srand (seed);
+  std::vector<FPFHSignature33> centers (20);
+  for (size_t c = 0; c < centers.size (); ++c)
+    for (int d = 0; d < 33; ++d)
+      centers[c].histogram[d] = 100.0f * static_cast<float> (rand ()) / RAND_MAX;
+
+  PointCloud<FPFHSignature33>::Ptr cloud (new PointCloud<FPFHSignature33>);
+  for (size_t i = 0; i < size; ++i)
+  {
+    FPFHSignature33 descriptor = centers[rand () % centers.size ()];
+    for (int d = 0; d < 33; ++d)
+      descriptor.histogram[d] += 20.0f * static_cast<float> (rand ()) / RAND_MAX;
+    cloud->push_back (descriptor);
+  }
+  return (cloud);
+}
+
+// Move the last points of a cloud to a cloud of queries
+PointCloud<FPFHSignature33>::Ptr
+splitQueries (PointCloud<FPFHSignature33> &cloud, size_t nr_queries)
+{
+  PointCloud<FPFHSignature33>::Ptr queries (new PointCloud<FPFHSignature33>);
+  queries->points.assign (cloud.points.end () - nr_queries, cloud.points.end ());
+  cloud.points.resize (cloud.points.size () - nr_queries);
+  cloud.width = static_cast<uint32_t> (cloud.points.size ());
+  return (queries);
+}
+
+float
+sqrDistance (const FPFHSignature33 &a, const FPFHSignature33 &b)
+{
+  float sqr_distance = 0.0f;
+  for (int d = 0; d < 33; ++d)
+    sqr_distance += (a.histogram[d] - b.histogram[d]) * (a.histogram[d] - b.histogram[d]);
+  return (sqr_distance);
+}
+
+std::vector<int>
+bruteForceKSearch (const PointCloud<FPFHSignature33> &cloud, const FPFHSignature33 &query, int k)
+{
+  std::vector<std::pair<float, int> > distances;
+  for (size_t i = 0; i < cloud.size (); ++i)
+    if (pcl_isfinite (cloud[i].histogram[0]))
+      distances.push_back (std::make_pair (sqrDistance (cloud[i], query), static_cast<int> (i)));
+  std::partial_sort (distances.begin (), distances.begin () + k, distances.end ());
+  std::vector<int> indices (k);
+  for (int i = 0; i < k; ++i)
+    indices[i] = distances[i].second;
+  return (indices);
+}
+
+// The fraction of the true k nearest neighbors of the queries found by the search
+float
+recall (const Search &search, const PointCloud<FPFHSignature33> &queries, int k)
+{
+  const PointCloud<FPFHSignature33> &cloud = *search.getInputCloud ();
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  int nr_found = 0;
+  for (size_t q = 0; q < queries.size (); ++q)
+  {
+    EXPECT_EQ (k, search.nearestKSearch (queries[q], k, k_indices, k_sqr_distances));
+    for (int i = 0; i < k; ++i)
+    {
+      EXPECT_NEAR (sqrDistance (cloud[k_indices[i]], queries[q]), k_sqr_distances[i], 1e-4f * k_sqr_distances[i]);
+      if (i > 0)
+      {
+        EXPECT_LE (k_sqr_distances[i - 1], k_sqr_distances[i]);
+      }
+    }
+    const std::vector<int> truth = bruteForceKSearch (cloud, queries[q], k);
+    const std::set<int> found (k_indices.begin (), k_indices.end ());
+    for (int i = 0; i < k; ++i)
+      nr_found += static_cast<int> (found.count (truth[i]));
+  }
+  return (static_cast<float> (nr_found) / static_cast<float> (k * queries.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HNSW_nearestKSearch)
+{
+  PointCloud<FPFHSignature33>::Ptr cloud = randomDescriptors (5100, 1);
+  PointCloud<FPFHSignature33>::Ptr queries = splitQueries (*cloud, 100);
+
+  Search search;
+  search.setNumberOfThreads (1);
+  search.setInputCloud (cloud);
+  EXPECT_EQ (5000, search.size ());
+  EXPECT_GE (recall (search, *queries, 10), 0.95f);
+
+  // Every point of the graph finds itself
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  for (int i = 0; i < 5000; i += 50)
+  {
+    search.nearestKSearch (cloud->points[i], 1, k_indices, k_sqr_distances);
+    EXPECT_EQ (0.0f, k_sqr_distances[0]);
+  }
+
+  // A parallel build gives a graph of the same quality
+  Search parallel_search;
+  parallel_search.setNumberOfThreads (4);
+  parallel_search.setInputCloud (cloud);
+  EXPECT_EQ (5000, parallel_search.size ());
+  EXPECT_GE (recall (parallel_search, *queries, 10), 0.95f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HNSW_invalidPointsAndIndices)
+{
+  PointCloud<FPFHSignature33>::Ptr cloud = randomDescriptors (1000, 3);
+  for (size_t i = 0; i < cloud->size (); i += 10)
+    cloud->points[i].histogram[5] = std::numeric_limits<float>::quiet_NaN ();
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = 0; i < 1000; i += 2)
+    indices->push_back (i);
+
+  Search search;
+  search.setInputCloud (cloud, indices);
+  EXPECT_EQ (400, search.size ());
+
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  for (int i = 1; i < 1000; i += 10)
+  {
+    EXPECT_EQ (50, search.nearestKSearch (cloud->points[i], 50, k_indices, k_sqr_distances));
+    for (size_t j = 0; j < k_indices.size (); ++j)
+      EXPECT_TRUE (k_indices[j] % 2 == 0 && k_indices[j] % 10 != 0);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HNSW_radiusSearch)
+{
+  PointCloud<FPFHSignature33>::Ptr cloud = randomDescriptors (3000, 4);
+  Search search;
+  search.setInputCloud (cloud);
+
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  const double radius = 45.0;
+  int nr_expected = 0, nr_found = 0;
+  for (int q = 0; q < 3000; q += 100)
+  {
+    const FPFHSignature33 &query = cloud->points[q];
+    search.radiusSearch (query, radius, k_indices, k_sqr_distances);
+    for (size_t i = 0; i < k_indices.size (); ++i)
+      EXPECT_LE (k_sqr_distances[i], radius * radius);
+    nr_found += static_cast<int> (k_indices.size ());
+    for (size_t i = 0; i < cloud->size (); ++i)
+      nr_expected += sqrDistance (cloud->points[i], query) <= radius * radius;
+
+    EXPECT_EQ (std::min (5, static_cast<int> (k_indices.size ())),
+               search.radiusSearch (query, radius, k_indices, k_sqr_distances, 5));
+  }
+  EXPECT_GT (nr_expected, 30 * 50);
+  EXPECT_GE (static_cast<float> (nr_found), 0.95f * static_cast<float> (nr_expected));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HNSW_addPoints)
+{
+  PointCloud<FPFHSignature33>::Ptr cloud = randomDescriptors (4100, 5);
+  PointCloud<FPFHSignature33>::Ptr queries = splitQueries (*cloud, 100);
+  PointCloud<FPFHSignature33>::Ptr first (new PointCloud<FPFHSignature33>);
+  PointCloud<FPFHSignature33> second;
+  first->points.assign (cloud->points.begin (), cloud->points.begin () + 2500);
+  second.points.assign (cloud->points.begin () + 2500, cloud->points.end ());
+
+  Search search;
+  search.setInputCloud (first);
+  search.addPoints (second);
+  EXPECT_EQ (4000, search.size ());
+  EXPECT_EQ (4000, search.getInputCloud ()->size ());
+  EXPECT_EQ (2500, first->size ());
+  EXPECT_GE (recall (search, *queries, 10), 0.95f);
+
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  for (int i = 2500; i < 4000; i += 50)
+  {
+    search.nearestKSearch (cloud->points[i], 1, k_indices, k_sqr_distances);
+    EXPECT_EQ (0.0f, k_sqr_distances[0]);
+  }
+
+  // Points can be added to an empty search as well
+  Search incremental;
+  incremental.addPoints (*first);
+  incremental.addPoints (second);
+  EXPECT_EQ (4000, incremental.size ());
+  EXPECT_GE (recall (incremental, *queries, 10), 0.95f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HNSW_saveLoad)
+{
+  PointCloud<FPFHSignature33>::Ptr cloud = randomDescriptors (2050, 7);
+  PointCloud<FPFHSignature33>::Ptr queries = splitQueries (*cloud, 50);
+  Search search;
+  search.setInputCloud (cloud);
+  ASSERT_TRUE (search.saveIndex ("test_hnsw.bin"));
+
+  Search loaded;
+  ASSERT_TRUE (loaded.loadIndex ("test_hnsw.bin", cloud));
+  EXPECT_EQ (search.size (), loaded.size ());
+
+  std::vector<int> k_indices, loaded_indices;
+  std::vector<float> k_sqr_distances, loaded_sqr_distances;
+  for (size_t q = 0; q < queries->size (); ++q)
+  {
+    search.nearestKSearch (queries->points[q], 10, k_indices, k_sqr_distances);
+    loaded.nearestKSearch (queries->points[q], 10, loaded_indices, loaded_sqr_distances);
+    EXPECT_EQ (k_indices, loaded_indices);
+    EXPECT_EQ (k_sqr_distances, loaded_sqr_distances);
+  }
+
+  // A truncated file, a file for another descriptor or a cloud too small for the index are rejected
+  std::ifstream in ("test_hnsw.bin", std::ios::binary);
+  std::vector<char> bytes ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+  std::ofstream out ("test_hnsw_truncated.bin", std::ios::binary);
+  out.write (&bytes[0], bytes.size () / 2);
+  out.close ();
+  EXPECT_FALSE (loaded.loadIndex ("test_hnsw_truncated.bin", cloud));
+  EXPECT_FALSE (search::HNSW<PFHSignature125> ().loadIndex ("test_hnsw.bin",
+                                                            PointCloud<PFHSignature125>::Ptr (new PointCloud<PFHSignature125>)));
+  PointCloud<FPFHSignature33>::Ptr small (new PointCloud<FPFHSignature33>);
+  small->points.assign (cloud->points.begin (), cloud->points.begin () + 100);
+  EXPECT_FALSE (loaded.loadIndex ("test_hnsw.bin", small));
+  EXPECT_FALSE (loaded.loadIndex ("test_hnsw_missing.bin", cloud));
+
+  // An entry point below the top layer: the 40 bytes header (magic, version and 7 ints) is followed by the index
+  // mapping and the layer of each node
+  int nr_nodes, max_layer;
+  std::memcpy (&nr_nodes, &bytes[28], sizeof (int));
+  std::memcpy (&max_layer, &bytes[36], sizeof (int));
+  ASSERT_GT (max_layer, 0);
+  int lower_node = -1;
+  for (int i = 0; i < nr_nodes && lower_node < 0; ++i)
+  {
+    int layer;
+    std::memcpy (&layer, &bytes[40 + (nr_nodes + i) * sizeof (int)], sizeof (int));
+    if (layer < max_layer)
+      lower_node = i;
+  }
+  ASSERT_GE (lower_node, 0);
+  std::vector<char> corrupted (bytes);
+  std::memcpy (&corrupted[32], &lower_node, sizeof (int));
+  out.open ("test_hnsw_corrupted.bin", std::ios::binary);
+  out.write (&corrupted[0], corrupted.size ());
+  out.close ();
+  EXPECT_FALSE (loaded.loadIndex ("test_hnsw_corrupted.bin", cloud));
+
+  // Node counts, connection counts or layers that do not fit in the file are rejected before anything is allocated
+  const int huge_values[] = { std::numeric_limits<int>::max (), std::numeric_limits<int>::max () / 4, nr_nodes + 1 };
+  for (size_t v = 0; v < sizeof (huge_values) / sizeof (huge_values[0]); ++v)
+  {
+    const size_t offsets[] = { 20, 28, 40 + (nr_nodes + lower_node) * sizeof (int) };
+    for (size_t o = 0; o < sizeof (offsets) / sizeof (offsets[0]); ++o)
+    {
+      corrupted = bytes;
+      std::memcpy (&corrupted[offsets[o]], &huge_values[v], sizeof (int));
+      out.open ("test_hnsw_corrupted.bin", std::ios::binary);
+      out.write (&corrupted[0], corrupted.size ());
+      out.close ();
+      EXPECT_FALSE (loaded.loadIndex ("test_hnsw_corrupted.bin", cloud));
+    }
+  }
+
+  // The failed loads left the graph untouched
+  EXPECT_EQ (2000, loaded.size ());
+  loaded.nearestKSearch (queries->points[0], 10, loaded_indices, loaded_sqr_distances);
+  search.nearestKSearch (queries->points[0], 10, k_indices, k_sqr_distances);
+  EXPECT_EQ (k_indices, loaded_indices);
+
+  remove ("test_hnsw.bin");
+  remove ("test_hnsw_truncated.bin");
+  remove ("test_hnsw_corrupted.bin");
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
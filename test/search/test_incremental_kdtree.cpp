@@ -0,0 +1,233 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/common/distances.h>
+#include <pcl/search/incremental_kdtree.h>
+#include <algorithm>
+#include <limits>
+#include <set>
+
+using namespace pcl;
+
+typedef search::IncrementalKdTree<PointXYZ> Tree;
+
+PointCloud<PointXYZ>::Ptr
+randomCloud (size_t size, float scale)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (size_t i = 0; i < size; ++i)
+    cloud->push_back (PointXYZ (scale * static_cast<float> (rand ()) / RAND_MAX,
+                                scale * static_cast<float> (rand ()) / RAND_MAX,
+                                scale * static_cast<float> (rand ()) / RAND_MAX));
+  return (cloud);
+}
+
+// The input cloud of the tree followed by the added points, in the order of their indices
+PointCloud<PointXYZ>
+treePoints (const Tree &tree)
+{
+  PointCloud<PointXYZ> cloud = *tree.getInputCloud ();
+  cloud += tree.getAddedPoints ();
+  return (cloud);
+}
+
+// Compare the searches of the tree with a brute force search over the points that are still in the tree
+void
+checkSearches (const Tree &tree, const std::vector<bool> &alive)
+{
+  const PointCloud<PointXYZ> cloud = treePoints (tree);
+  ASSERT_EQ (cloud.size (), alive.size ());
+  EXPECT_EQ (tree.size (), static_cast<int> (std::count (alive.begin (), alive.end (), true)));
+
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  for (int q = 0; q < 20; ++q)
+  {
+    const PointXYZ query (10.0f * static_cast<float> (rand ()) / RAND_MAX,
+                          10.0f * static_cast<float> (rand ()) / RAND_MAX,
+                          10.0f * static_cast<float> (rand ()) / RAND_MAX);
+    std::vector<std::pair<float, int> > brute_force;
+    for (size_t i = 0; i < cloud.size (); ++i)
+      if (alive[i])
+        brute_force.push_back (std::make_pair (squaredEuclideanDistance (cloud[i], query), static_cast<int> (i)));
+    std::sort (brute_force.begin (), brute_force.end ());
+
+    const int k = 7;
+    tree.nearestKSearch (query, k, k_indices, k_sqr_distances);
+    ASSERT_EQ (k_indices.size (), std::min (brute_force.size (), size_t (k)));
+    for (size_t i = 0; i < k_indices.size (); ++i)
+      EXPECT_FLOAT_EQ (k_sqr_distances[i], brute_force[i].first);
+
+    const float radius = 1.0f;
+    tree.radiusSearch (query, radius, k_indices, k_sqr_distances);
+    std::set<int> expected;
+    for (size_t i = 0; i < brute_force.size () && brute_force[i].first <= radius * radius; ++i)
+      expected.insert (brute_force[i].second);
+    EXPECT_EQ (std::set<int> (k_indices.begin (), k_indices.end ()), expected);
+    for (size_t i = 1; i < k_sqr_distances.size (); ++i)
+      EXPECT_LE (k_sqr_distances[i - 1], k_sqr_distances[i]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IncrementalKdTree_build)
+{
+  PointCloud<PointXYZ>::Ptr cloud = randomCloud (2000, 10.0f);
+  cloud->points[5].x = std::numeric_limits<float>::quiet_NaN ();
+
+  Tree tree;
+  tree.setInputCloud (cloud);
+  std::vector<bool> alive (cloud->size (), true);
+  alive[5] = false;
+  checkSearches (tree, alive);
+
+  // A subset of the points, the indices still refer to the cloud
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = 0; i < static_cast<int> (cloud->size ()); i += 3)
+    indices->push_back (i);
+  tree.setInputCloud (cloud, indices);
+  alive.assign (cloud->size (), false);
+  for (size_t i = 0; i < indices->size (); ++i)
+    alive[(*indices)[i]] = (*indices)[i] != 5;
+  checkSearches (tree, alive);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IncrementalKdTree_addRemove)
+{
+  Tree tree;
+  PointCloud<PointXYZ>::Ptr input = randomCloud (500, 10.0f);
+  tree.setInputCloud (input);
+  std::vector<bool> alive (500, true);
+
+  for (int frame = 0; frame < 10; ++frame)
+  {
+    // Points sorted along x, the worst case for the balance of the tree
+    PointCloud<PointXYZ>::Ptr scan = randomCloud (300, 10.0f);
+    for (size_t i = 0; i < scan->size (); ++i)
+      (*scan)[i].x = 10.0f * static_cast<float> (i) / static_cast<float> (scan->size ());
+    EXPECT_EQ (tree.addPoints (*scan), 300);
+    alive.resize (alive.size () + scan->size (), true);
+
+    std::vector<int> removed;
+    for (int i = 0; i < 100; ++i)
+      removed.push_back (rand () % static_cast<int> (alive.size ()));
+    int nr_alive_removed = 0;
+    std::set<int> unique_removed (removed.begin (), removed.end ());
+    for (std::set<int>::const_iterator it = unique_removed.begin (); it != unique_removed.end (); ++it)
+      nr_alive_removed += alive[*it] ? 1 : 0;
+    EXPECT_EQ (tree.removePoints (removed), nr_alive_removed);
+    for (size_t i = 0; i < removed.size (); ++i)
+      alive[removed[i]] = false;
+    EXPECT_FALSE (tree.removePoint (removed[0]));
+
+    checkSearches (tree, alive);
+  }
+
+  // The input cloud is neither copied nor grown, so that the users comparing it to their cloud, like
+  // Feature::initCompute, keep the tree
+  EXPECT_EQ (tree.getInputCloud (), input);
+  EXPECT_EQ (input->size (), 500u);
+  EXPECT_EQ (tree.getAddedPoints ().size (), 3000u);
+  EXPECT_EQ (tree.getPoint (600).x, tree.getAddedPoints ()[100].x);
+
+  // Clear a box
+  const Eigen::Vector3f min_pt (2.0f, 2.0f, 2.0f), max_pt (6.0f, 6.0f, 6.0f);
+  const PointCloud<PointXYZ> cloud = treePoints (tree);
+  int nr_in_box = 0;
+  for (size_t i = 0; i < cloud.size (); ++i)
+    if (alive[i] && cloud[i].getVector3fMap ().cwiseMax (min_pt) == cloud[i].getVector3fMap () &&
+        cloud[i].getVector3fMap ().cwiseMin (max_pt) == cloud[i].getVector3fMap ())
+    {
+      alive[i] = false;
+      ++nr_in_box;
+    }
+  std::vector<int> in_box;
+  EXPECT_EQ (tree.boxSearch (min_pt, max_pt, in_box), nr_in_box);
+  EXPECT_EQ (tree.removePointsInBox (min_pt, max_pt), nr_in_box);
+  EXPECT_EQ (tree.boxSearch (min_pt, max_pt, in_box), 0);
+  checkSearches (tree, alive);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IncrementalKdTree_downsample)
+{
+  Tree tree;
+  tree.setDownsampleResolution (1.0f);
+  tree.setInputCloud (PointCloud<PointXYZ>::Ptr (new PointCloud<PointXYZ>));
+
+  PointCloud<PointXYZ> points;
+  points.push_back (PointXYZ (0.1f, 0.1f, 0.1f));
+  points.push_back (PointXYZ (0.4f, 0.4f, 0.4f)); // closer to the center of the voxel, replaces the first point
+  points.push_back (PointXYZ (0.2f, 0.2f, 0.2f)); // farther, dropped
+  points.push_back (PointXYZ (1.5f, 0.5f, 0.5f)); // next voxel
+  EXPECT_EQ (tree.addPoints (points), 3);
+  EXPECT_EQ (tree.size (), 2);
+  EXPECT_EQ (tree.getAddedPoints ().size (), 4u);
+
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  tree.nearestKSearch (PointXYZ (0.0f, 0.0f, 0.0f), 2, k_indices, k_sqr_distances);
+  ASSERT_EQ (k_indices.size (), 2u);
+  EXPECT_EQ (k_indices[0], 1);
+  EXPECT_EQ (k_indices[1], 3);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IncrementalKdTree_invalidInput)
+{
+  PointCloud<PointXYZ>::Ptr cloud = randomCloud (100, 10.0f);
+  Tree tree;
+  tree.setInputCloud (cloud);
+
+  // A null cloud is rejected and the tree is kept
+  tree.setInputCloud (PointCloud<PointXYZ>::Ptr ());
+  EXPECT_EQ (tree.getInputCloud (), cloud);
+  EXPECT_EQ (tree.size (), 100);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -195,6 +195,57 @@ TEST (PCL, KdTree_multipointKnnSearch)
   }
 }
 
+/* Test for KdTree batched nearestKSearch and radiusSearch */
+TEST (PCL, KdTree_batchSearch)
+{
+  pcl::search::KdTree<PointXYZ> kdtree;
+  kdtree.setInputCloud (cloud.makeShared ());
+
+  std::vector<int> queries;
+  for (int i = 0; i < static_cast<int> (cloud.points.size ()); i += 3)
+    queries.push_back (i);
+
+  pcl::search::BatchSearchResults results;
+  kdtree.nearestKSearch (cloud, queries, 8, results, 4);
+  ASSERT_EQ (results.getNumberOfQueries (), queries.size ());
+  vector<int> k_indices;
+  vector<float> k_distances;
+  for (size_t i = 0; i < queries.size (); ++i)
+  {
+    kdtree.nearestKSearch (cloud, queries[i], 8, k_indices, k_distances);
+    ASSERT_EQ (results.getNumberOfNeighbors (i), static_cast<int> (k_indices.size ()));
+    for (size_t j = 0; j < k_indices.size (); ++j)
+    {
+      EXPECT_EQ (results.indices[results.offsets[i] + j], k_indices[j]);
+      EXPECT_EQ (results.sqr_distances[results.offsets[i] + j], k_distances[j]);
+    }
+  }
+
+  // Every point is queried when no indices are given, the output does not depend on the number of threads
+  pcl::search::BatchSearchResults results_single_thread;
+  kdtree.radiusSearch (cloud, std::vector<int> (), 0.15, results, 0, 4);
+  kdtree.radiusSearch (cloud, std::vector<int> (), 0.15, results_single_thread, 0, 1);
+  ASSERT_EQ (results.getNumberOfQueries (), cloud.points.size ());
+  EXPECT_TRUE (results.offsets == results_single_thread.offsets);
+  EXPECT_TRUE (results.indices == results_single_thread.indices);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    kdtree.radiusSearch (cloud, static_cast<int> (i), 0.15, k_indices, k_distances);
+    EXPECT_EQ (results.getNumberOfNeighbors (i), static_cast<int> (k_indices.size ()));
+  }
+
+  // Per query bound on the number of neighbors
+  std::vector<unsigned int> max_nn (queries.size ());
+  for (size_t i = 0; i < max_nn.size (); ++i)
+    max_nn[i] = static_cast<unsigned int> (i % 4);
+  kdtree.radiusSearch (cloud, queries, 0.25, max_nn, results);
+  for (size_t i = 0; i < queries.size (); ++i)
+  {
+    if (max_nn[i] > 0)
+      EXPECT_LE (results.getNumberOfNeighbors (i), static_cast<int> (max_nn[i]));
+  }
+}
+
 int
 main (int argc, char** argv)
 {
@@ -0,0 +1,165 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/common/distances.h>
+#include <pcl/search/neighbor_graph.h>
+#include <algorithm>
+#include <limits>
+
+using namespace pcl;
+
+PointCloud<PointXYZ>::Ptr
+randomCloud (size_t size)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (size_t i = 0; i < size; ++i)
+    cloud->push_back (PointXYZ (static_cast<float> (rand ()) / RAND_MAX,
+                                static_cast<float> (rand ()) / RAND_MAX,
+                                0.2f * static_cast<float> (rand ()) / RAND_MAX));
+  return (cloud);
+}
+
+// Brute force neighbors of a point among the given points, sorted by distance
+std::vector<float>
+bruteForce (const PointCloud<PointXYZ> &cloud, const std::vector<int> &points, int query)
+{
+  std::vector<float> sqr_distances;
+  for (size_t i = 0; i < points.size (); ++i)
+    if (pcl_isfinite (cloud[points[i]].x))
+      sqr_distances.push_back (squaredEuclideanDistance (cloud[points[i]], cloud[query]));
+  std::sort (sqr_distances.begin (), sqr_distances.end ());
+  return (sqr_distances);
+}
+
+void
+checkGraphs (const PointCloud<PointXYZ> &cloud, const std::vector<int> &points)
+{
+  search::BatchSearchResults knn, radius, radius_max_nn;
+  search::computeKNearestNeighborGraph (cloud, points, 10, knn);
+  search::computeRadiusNeighborGraph (cloud, points, 0.05, radius);
+  search::computeRadiusNeighborGraph (cloud, points, 0.05, radius_max_nn, 4);
+  ASSERT_EQ (points.size (), knn.getNumberOfQueries ());
+  ASSERT_EQ (points.size (), radius.getNumberOfQueries ());
+  ASSERT_EQ (points.size (), radius_max_nn.getNumberOfQueries ());
+
+  for (size_t q = 0; q < points.size (); q += 7)
+  {
+    if (!pcl_isfinite (cloud[points[q]].x))
+    {
+      EXPECT_EQ (0, knn.getNumberOfNeighbors (q));
+      EXPECT_EQ (0, radius.getNumberOfNeighbors (q));
+      continue;
+    }
+    const std::vector<float> truth = bruteForce (cloud, points, points[q]);
+
+    ASSERT_EQ (std::min<int> (10, static_cast<int> (truth.size ())), knn.getNumberOfNeighbors (q));
+    for (int i = 0; i < knn.getNumberOfNeighbors (q); ++i)
+    {
+      const int n = knn.offsets[q] + i;
+      EXPECT_EQ (truth[i], knn.sqr_distances[n]);
+      EXPECT_EQ (truth[i], squaredEuclideanDistance (cloud[knn.indices[n]], cloud[points[q]]));
+    }
+    EXPECT_EQ (0.0f, knn.sqr_distances[knn.offsets[q]]);
+
+    const int nr_expected = static_cast<int> (std::upper_bound (truth.begin (), truth.end (), 0.05f * 0.05f) -
+                                              truth.begin ());
+    ASSERT_EQ (nr_expected, radius.getNumberOfNeighbors (q));
+    for (int i = 0; i < nr_expected; ++i)
+      EXPECT_EQ (truth[i], radius.sqr_distances[radius.offsets[q] + i]);
+    ASSERT_EQ (std::min (nr_expected, 4), radius_max_nn.getNumberOfNeighbors (q));
+    for (int i = 0; i < radius_max_nn.getNumberOfNeighbors (q); ++i)
+      EXPECT_EQ (truth[i], radius_max_nn.sqr_distances[radius_max_nn.offsets[q] + i]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NeighborGraph)
+{
+  srand (3);
+  PointCloud<PointXYZ>::Ptr cloud = randomCloud (10000);
+  std::vector<int> points (cloud->size ());
+  for (size_t i = 0; i < points.size (); ++i)
+    points[i] = static_cast<int> (i);
+  checkGraphs (*cloud, points);
+
+  // The graph does not depend on the number of threads
+  search::BatchSearchResults graph, single_thread_graph;
+  search::computeKNearestNeighborGraph (*cloud, 8, graph);
+  search::computeKNearestNeighborGraph (*cloud, 8, single_thread_graph, 1);
+  EXPECT_EQ (single_thread_graph.offsets, graph.offsets);
+  EXPECT_EQ (single_thread_graph.indices, graph.indices);
+  search::computeRadiusNeighborGraph (*cloud, 0.03, graph);
+  search::computeRadiusNeighborGraph (*cloud, 0.03, single_thread_graph, 0, 1);
+  EXPECT_EQ (single_thread_graph.offsets, graph.offsets);
+  EXPECT_EQ (single_thread_graph.indices, graph.indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NeighborGraph_indicesAndInvalidPoints)
+{
+  srand (4);
+  PointCloud<PointXYZ>::Ptr cloud = randomCloud (5000);
+  for (size_t i = 0; i < cloud->size (); i += 11)
+    cloud->points[i].x = std::numeric_limits<float>::quiet_NaN ();
+  std::vector<int> points;
+  for (int i = cloud->size () - 1; i >= 0; i -= 2)
+    points.push_back (i);
+  checkGraphs (*cloud, points);
+
+  // Fewer points than neighbors, and no points at all
+  search::BatchSearchResults graph;
+  std::vector<int> few (points.begin (), points.begin () + 5);
+  search::computeKNearestNeighborGraph (*cloud, few, 10, graph);
+  for (size_t q = 0; q < few.size (); ++q)
+    EXPECT_EQ (pcl_isfinite (cloud->points[few[q]].x) ? 5 : 0, graph.getNumberOfNeighbors (q));
+  search::computeKNearestNeighborGraph (*cloud, std::vector<int> (), 10, graph);
+  EXPECT_EQ (0u, graph.getNumberOfQueries ());
+  search::computeRadiusNeighborGraph (PointCloud<PointXYZ> (), 0.1, graph);
+  EXPECT_EQ (0u, graph.getNumberOfQueries ());
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -362,6 +362,53 @@ TEST (PCL, Octree_Pointcloud_Neighbours_Within_Radius_Search)
   }
 }
 
+TEST (PCL, Octree_Spatial_Reordering)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> (100, 50));
+  for (size_t i = 0; i < cloudIn->points.size (); i++)
+    cloudIn->points[i] = PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                   static_cast<float> (10.0 * rand () / RAND_MAX),
+                                   static_cast<float> (10.0 * rand () / RAND_MAX));
+
+  // indices of every other point
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = 0; i < static_cast<int> (cloudIn->points.size ()); i += 2)
+    indices->push_back (i);
+
+  for (int with_indices = 0; with_indices < 2; ++with_indices)
+  {
+    pcl::search::Octree<PointXYZ> octree (0.5), octree_reordered (0.5);
+    octree_reordered.setSpatialReordering (true);
+    if (with_indices)
+    {
+      octree.setInputCloud (cloudIn, indices);
+      octree_reordered.setInputCloud (cloudIn, indices);
+    }
+    else
+    {
+      octree.setInputCloud (cloudIn);
+      octree_reordered.setInputCloud (cloudIn);
+    }
+
+    std::vector<int> k_indices, k_indices_reordered;
+    std::vector<float> k_sqr_distances, k_sqr_distances_reordered;
+    for (int i = 0; i < static_cast<int> (cloudIn->points.size ()); i += 97)
+    {
+      octree.nearestKSearch (cloudIn->points[i], 5, k_indices, k_sqr_distances);
+      octree_reordered.nearestKSearch (cloudIn->points[i], 5, k_indices_reordered, k_sqr_distances_reordered);
+      ASSERT_EQ (k_sqr_distances.size (), k_sqr_distances_reordered.size ());
+      for (size_t j = 0; j < k_sqr_distances.size (); ++j)
+        EXPECT_FLOAT_EQ (k_sqr_distances[j], k_sqr_distances_reordered[j]);
+
+      octree.radiusSearch (i, 1.0, k_indices, k_sqr_distances);
+      octree_reordered.radiusSearch (i, 1.0, k_indices_reordered, k_sqr_distances_reordered);
+      std::sort (k_indices.begin (), k_indices.end ());
+      std::sort (k_indices_reordered.begin (), k_indices_reordered.end ());
+      EXPECT_TRUE (k_indices == k_indices_reordered);
+    }
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
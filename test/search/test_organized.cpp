@@ -37,6 +37,7 @@
 
 #include <gtest/gtest.h>
 
+#include <limits>
 #include <vector>
 
 #include <stdio.h>
@@ -329,6 +330,110 @@ TEST (PCL, Organized_Neighbor_Pointcloud_Neighbours_Within_Radius_Search)
   }
 }
 
+// organized cloud of random depths, seen by a camera with the given focal length
+PointCloud<PointXYZ>::Ptr
+makeOrganizedCloud (double focal_length)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> (64, 48));
+  for (unsigned int v = 0; v < cloud->height; ++v)
+    for (unsigned int u = 0; u < cloud->width; ++u)
+    {
+      const double z = 15.0 * (double (rand ()) / double (RAND_MAX+1.0)) + 20.0;
+      (*cloud) (u, v) = PointXYZ (float ((u - 31.5) * z / focal_length), float ((v - 23.5) * z / focal_length),
+                                  float (z));
+    }
+  return (cloud);
+}
+
+TEST (PCL, Organized_Neighbor_Projection_Matrix)
+{
+  search::OrganizedNeighbor<PointXYZ> organizedNeighborSearch;
+
+  // the projection matrix of a frame is reused for the next frame of the same sensor
+  organizedNeighborSearch.setInputCloud (makeOrganizedCloud (555.0));
+  ASSERT_TRUE (organizedNeighborSearch.isValid ());
+  const Eigen::Matrix<float, 3, 4, Eigen::RowMajor> projection_matrix = organizedNeighborSearch.getProjectionMatrix ();
+  organizedNeighborSearch.setInputCloud (makeOrganizedCloud (555.0));
+  EXPECT_TRUE (organizedNeighborSearch.getProjectionMatrix () == projection_matrix);
+
+  // but estimated again for a different sensor, or if reusing it is disabled
+  organizedNeighborSearch.setInputCloud (makeOrganizedCloud (300.0));
+  EXPECT_FALSE (organizedNeighborSearch.getProjectionMatrix () == projection_matrix);
+  Eigen::Matrix3f camera_matrix;
+  organizedNeighborSearch.computeCameraMatrix (camera_matrix);
+  EXPECT_NEAR (camera_matrix (0, 0), 300.0, 1.0);
+
+  organizedNeighborSearch.setReuseProjectionMatrix (false);
+  const Eigen::Matrix<float, 3, 4, Eigen::RowMajor> estimated_matrix = organizedNeighborSearch.getProjectionMatrix ();
+  organizedNeighborSearch.setInputCloud (makeOrganizedCloud (300.0));
+  EXPECT_FALSE (organizedNeighborSearch.getProjectionMatrix () == estimated_matrix);
+
+  // a projection matrix given by the user is used as is
+  Eigen::Matrix<float, 3, 4, Eigen::RowMajor> user_matrix;
+  user_matrix << 555.0f, 0.0f, 31.5f, 0.0f,
+                 0.0f, 555.0f, 23.5f, 0.0f,
+                 0.0f, 0.0f, 1.0f, 0.0f;
+  organizedNeighborSearch.setProjectionMatrix (user_matrix);
+  PointCloud<PointXYZ>::Ptr cloud = makeOrganizedCloud (555.0);
+  organizedNeighborSearch.setInputCloud (cloud);
+  EXPECT_TRUE (organizedNeighborSearch.getProjectionMatrix () == user_matrix);
+  EXPECT_TRUE (organizedNeighborSearch.isValid ());
+
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  for (size_t i = 0; i < cloud->size (); i += 97)
+  {
+    ASSERT_EQ (organizedNeighborSearch.nearestKSearch ((*cloud)[i], 1, k_indices, k_sqr_distances), 1);
+    EXPECT_EQ (k_indices[0], int (i));
+  }
+
+  // a zero matrix restores the estimation
+  organizedNeighborSearch.setProjectionMatrix (Eigen::Matrix<float, 3, 4, Eigen::RowMajor>::Zero ());
+  organizedNeighborSearch.setInputCloud (makeOrganizedCloud (300.0));
+  organizedNeighborSearch.computeCameraMatrix (camera_matrix);
+  EXPECT_NEAR (camera_matrix (0, 0), 300.0, 1.0);
+}
+
+TEST (PCL, Organized_Neighbor_Batch_Nearest_K_Search)
+{
+  PointCloud<PointXYZ>::Ptr cloud = makeOrganizedCloud (555.0);
+  (*cloud) (10, 10).x = (*cloud) (10, 10).y = (*cloud) (10, 10).z = std::numeric_limits<float>::quiet_NaN ();
+  cloud->is_dense = false;
+
+  search::OrganizedNeighbor<PointXYZ> organizedNeighborSearch;
+  organizedNeighborSearch.setInputCloud (cloud);
+
+  // all the points of the input cloud, whose pixels are known
+  const int K = 8;
+  search::BatchSearchResults results;
+  organizedNeighborSearch.nearestKSearch (*cloud, std::vector<int> (), K, results, 2);
+  ASSERT_EQ (results.getNumberOfQueries (), cloud->size ());
+
+  // the same points in a copy of the cloud, which are projected
+  const PointCloud<PointXYZ> copy = *cloud;
+  search::BatchSearchResults copy_results;
+  organizedNeighborSearch.nearestKSearch (copy, std::vector<int> (), K, copy_results, 2);
+
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  for (size_t i = 0; i < cloud->size (); ++i)
+  {
+    if (!isFinite ((*cloud)[i]))
+    {
+      EXPECT_EQ (results.getNumberOfNeighbors (i), 0);
+      continue;
+    }
+    organizedNeighborSearch.nearestKSearch ((*cloud)[i], K, k_indices, k_sqr_distances);
+    ASSERT_EQ (results.getNumberOfNeighbors (i), K);
+    ASSERT_EQ (copy_results.getNumberOfNeighbors (i), K);
+    for (int j = 0; j < K; ++j)
+    {
+      EXPECT_EQ (results.sqr_distances[results.offsets[i] + j], k_sqr_distances[j]);
+      EXPECT_EQ (copy_results.sqr_distances[copy_results.offsets[i] + j], k_sqr_distances[j]);
+    }
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
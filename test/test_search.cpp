@@ -106,6 +106,9 @@ std::vector<int> organized_input_indices;
 /** \brief instance of brute force search method to be tested*/
 pcl::search::BruteForce<pcl::PointXYZ> brute_force;
 
+/** \brief instance of brute force search method in tiled mode to be tested*/
+pcl::search::BruteForce<pcl::PointXYZ> tiled_brute_force;
+
 /** \brief instance of KDTree search method to be tested*/
 pcl::search::KdTree<pcl::PointXYZ> KDTree;
 
@@ -617,15 +620,19 @@ main (int argc, char** argv)
   createIndices (unorganized_input_indices, unorganized_point_count - 1);
   
   brute_force.setSortedResults (true);
+  tiled_brute_force.setSortedResults (true);
+  tiled_brute_force.setTiledSearch (true);
   KDTree.setSortedResults (true);
   octree_search.setSortedResults (true);
   organized.setSortedResults (true);
   
   unorganized_search_methods.push_back (&brute_force);
+  unorganized_search_methods.push_back (&tiled_brute_force);
   unorganized_search_methods.push_back (&KDTree);
   unorganized_search_methods.push_back (&octree_search);
   
   organized_search_methods.push_back (&brute_force);
+  organized_search_methods.push_back (&tiled_brute_force);
   organized_search_methods.push_back (&KDTree);
   organized_search_methods.push_back (&octree_search);
   organized_search_methods.push_back (&organized);
@@ -266,6 +266,73 @@ TEST (PCL, TransformCopyFields)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TransformLargeCloud)
+{
+  // Large enough to take the multithreaded path
+  PointCloud<PointNormal> cloud_in (300, 300);
+  for (size_t i = 0; i < cloud_in.size (); ++i)
+  {
+    cloud_in[i].getVector3fMap () = Eigen::Vector3f (float (i % 300), float (i / 300), float (i % 7)) * 0.01f;
+    cloud_in[i].getNormalVector3fMap () = Eigen::Vector3f (float (i % 5), 1.0f, float (i % 3)).normalized ();
+    cloud_in[i].curvature = float (i);
+  }
+  // Invalid points stay invalid, the other fields are preserved
+  cloud_in[10].x = std::numeric_limits<float>::quiet_NaN ();
+  cloud_in[20].z = std::numeric_limits<float>::infinity ();
+  cloud_in.is_dense = false;
+
+  Eigen::Affine3d transform = Eigen::Translation3d (1.0, -2.0, 3.0) * Eigen::AngleAxisd (0.5, Eigen::Vector3d (1.0, 1.0, 0.0).normalized ());
+  const Eigen::Affine3f transform_f = transform.cast<float> ();
+
+  PointCloud<PointNormal> cloud_out, cloud_out_d;
+  transformPointCloudWithNormals (cloud_in, cloud_out, transform_f);
+  transformPointCloudWithNormals (cloud_in, cloud_out_d, transform);
+  ASSERT_EQ (cloud_in.size (), cloud_out.size ());
+  ASSERT_EQ (cloud_in.size (), cloud_out_d.size ());
+  for (size_t i = 0; i < cloud_in.size (); ++i)
+  {
+    EXPECT_EQ (cloud_in[i].curvature, cloud_out[i].curvature);
+    if (!isFinite (cloud_in[i]))
+    {
+      EXPECT_FALSE (isFinite (cloud_out[i]));
+      EXPECT_FALSE (isFinite (cloud_out_d[i]));
+      continue;
+    }
+    const Eigen::Vector3f p = transform_f * cloud_in[i].getVector3fMap ();
+    const Eigen::Vector3f n = transform_f.linear () * cloud_in[i].getNormalVector3fMap ();
+    EXPECT_NEAR ((p - cloud_out[i].getVector3fMap ()).norm (), 0.0f, 1e-5);
+    EXPECT_NEAR ((n - cloud_out[i].getNormalVector3fMap ()).norm (), 0.0f, 1e-5);
+    EXPECT_NEAR ((p - cloud_out_d[i].getVector3fMap ()).norm (), 0.0f, 1e-5);
+    EXPECT_NEAR ((n - cloud_out_d[i].getNormalVector3fMap ()).norm (), 0.0f, 1e-5);
+  }
+
+  // Indexed versions
+  std::vector<int> indices;
+  for (int i = static_cast<int> (cloud_in.size ()) - 1; i >= 0; i -= 2)
+    indices.push_back (i);
+  PointCloud<PointNormal> cloud_out_idx;
+  transformPointCloudWithNormals (cloud_in, indices, cloud_out_idx, transform_f);
+  ASSERT_EQ (indices.size (), cloud_out_idx.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    EXPECT_XYZ_NEAR (cloud_out[indices[i]], cloud_out_idx[i], 1e-6);
+    EXPECT_NORMAL_NEAR (cloud_out[indices[i]], cloud_out_idx[i], 1e-6);
+  }
+  transformPointCloud (cloud_in, indices, cloud_out_idx, transform_f);
+  for (size_t i = 0; i < indices.size (); ++i)
+    EXPECT_XYZ_NEAR (cloud_out[indices[i]], cloud_out_idx[i], 1e-6);
+
+  // In place
+  transformPointCloud (cloud_in, cloud_in, transform_f);
+  for (size_t i = 0; i < cloud_in.size (); ++i)
+  {
+    if (!isFinite (cloud_out[i]))
+      continue;
+    EXPECT_XYZ_NEAR (cloud_out[i], cloud_in[i], 1e-6);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, Matrix4Affine3Transform)
 {